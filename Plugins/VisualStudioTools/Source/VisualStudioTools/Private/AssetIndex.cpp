@@ -0,0 +1,259 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#include "AssetIndex.h"
+
+#include "Async/ParallelFor.h"
+#include "Engine/BlueprintGeneratedClass.h"
+
+namespace VisualStudioTools
+{
+static const FName CategoryFName = TEXT("Category");
+
+static bool FindBlueprintNativeParents(
+	const UClass* BlueprintGeneratedClass, TFunctionRef<void(UClass*)> Callback)
+{
+	bool bAnyNativeParent = false;
+	for (UClass* Super = BlueprintGeneratedClass->GetSuperClass(); Super; Super = Super->GetSuperClass())
+	{
+		// Ignore the root `UObject` class and non-native parents.
+		if (Super->HasAnyClassFlags(CLASS_Native) && Super->GetFName() != NAME_Object)
+		{
+			bAnyNativeParent = true;
+			Callback(Super);
+		}
+	}
+
+	return bAnyNativeParent;
+}
+
+static bool ShouldSerializePropertyValue(FProperty* Property)
+{
+	if (Property->ArrayDim > 1) // Skip properties that are not scalars
+	{
+		return false;
+	}
+
+	if (FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+	{
+		return true;
+	}
+
+	if (FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+	{
+		UEnum* EnumDef = NumericProperty->GetIntPropertyEnum();
+		if (EnumDef != NULL)
+		{
+			return true;
+		}
+
+		if (NumericProperty->IsFloatingPoint())
+		{
+			return true;
+		}
+
+		if (NumericProperty->IsInteger())
+		{
+			return true;
+		}
+	}
+
+	if (FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+	{
+		return true;
+	}
+
+	if (FStrProperty* StringProperty = CastField<FStrProperty>(Property))
+	{
+		return true;
+	}
+
+	return false;
+}
+
+static FPropertyValue GetPropertyValue(FProperty* Property, const void* Value)
+{
+	FPropertyValue Result;
+
+	if (FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+	{
+		// Export enums as strings.
+		const int64 EnumValue = EnumProperty->GetUnderlyingProperty()->GetSignedIntPropertyValue(Value);
+		Result.Type = FPropertyValue::EType::String;
+		Result.StringValue = EnumProperty->GetEnum()->GetAuthoredNameStringByValue(EnumValue);
+	}
+	else if (FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
+	{
+		if (UEnum* EnumDef = NumericProperty->GetIntPropertyEnum())
+		{
+			Result.Type = FPropertyValue::EType::String;
+			Result.StringValue = EnumDef->GetAuthoredNameStringByValue(NumericProperty->GetSignedIntPropertyValue(Value));
+		}
+		else if (NumericProperty->IsFloatingPoint())
+		{
+			Result.Type = FPropertyValue::EType::Number;
+			Result.NumberValue = NumericProperty->GetFloatingPointPropertyValue(Value);
+		}
+		else if (NumericProperty->IsInteger())
+		{
+			Result.Type = FPropertyValue::EType::Integer;
+			Result.IntegerValue = NumericProperty->GetSignedIntPropertyValue(Value);
+		}
+	}
+	else if (FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+	{
+		Result.Type = FPropertyValue::EType::Bool;
+		Result.bBoolValue = BoolProperty->GetPropertyValue(Value);
+	}
+	else if (FStrProperty* StringProperty = CastField<FStrProperty>(Property))
+	{
+		Result.Type = FPropertyValue::EType::String;
+		Result.StringValue = StringProperty->GetPropertyValue(Value);
+	}
+
+	return Result;
+}
+
+const FNativeClassFields& FNativeClassCache::FindOrAdd(UClass* NativeClass)
+{
+	if (TUniquePtr<FNativeClassFields>* Existing = Classes.Find(NativeClass))
+	{
+		return **Existing;
+	}
+
+	TUniquePtr<FNativeClassFields> Fields = MakeUnique<FNativeClassFields>();
+	Fields->Class = NativeClass;
+	Fields->DefaultObject = NativeClass->GetDefaultObject(false);
+	Fields->DisplayName = FString::Printf(TEXT("%s%s"), NativeClass->GetPrefixCPP(), *NativeClass->GetName());
+
+	for (TFieldIterator<FProperty> It(NativeClass, EFieldIteratorFlags::ExcludeSuper); It; ++It)
+	{
+		Fields->Properties.Add(*It);
+		Fields->PropertyCategories.Add(It->GetMetaData(CategoryFName));
+		Fields->PropertyHasValue.Add(ShouldSerializePropertyValue(*It));
+	}
+
+	for (TFieldIterator<UFunction> It(NativeClass, EFieldIteratorFlags::ExcludeSuper); It; ++It)
+	{
+		Fields->Functions.Add(It->GetFName());
+	}
+
+	return *Classes.Add(NativeClass, MoveTemp(Fields));
+}
+
+/**
+* Compares the blueprint CDO against each of its native parents.
+* Only reads from the loaded classes, so it is safe to run on worker threads.
+*/
+static void AnalyzeBlueprint(const UBlueprintGeneratedClass* BlueprintGeneratedClass, FBlueprintAnalysis& Analysis)
+{
+	const UObject* GeneratedClassDefault = BlueprintGeneratedClass->ClassDefaultObject;
+
+	for (FParentAnalysis& ParentAnalysis : Analysis.Parents)
+	{
+		const FNativeClassFields& Parent = *ParentAnalysis.Parent;
+
+		// Retrieve the properties from the parent class that changed in the Blueprint class, by comparing their CDOs.
+		for (int32 PropIdx = 0; PropIdx < Parent.Properties.Num(); PropIdx++)
+		{
+			FProperty* Property = Parent.Properties[PropIdx];
+			for (int32 Idx = 0; Idx < Property->ArrayDim; Idx++)
+			{
+				const uint8* PropertyValue = Property->ContainerPtrToValuePtr<uint8>(GeneratedClassDefault, Idx);
+				const uint8* DefaultPropertyValue = Property->ContainerPtrToValuePtrForDefaults<uint8>(Parent.Class, Parent.DefaultObject, Idx);
+
+				if (!Property->Identical(PropertyValue, DefaultPropertyValue))
+				{
+					ParentAnalysis.ChangedProperties.Add(PropIdx);
+					ParentAnalysis.ChangedValues.Add(Parent.PropertyHasValue[PropIdx]
+						? GetPropertyValue(Property, PropertyValue)
+						: FPropertyValue());
+					break;
+				}
+			}
+		}
+
+		// Iterate over the functions originally from the parent class
+		// and check if they are implemented in the BP class as well.
+		for (int32 FnIdx = 0; FnIdx < Parent.Functions.Num(); FnIdx++)
+		{
+			UFunction* Fn = BlueprintGeneratedClass->FindFunctionByName(Parent.Functions[FnIdx], EIncludeSuperFlag::ExcludeSuper);
+			// If the function not present in the BP class directly, it means it was implemented. Otherwise, ignore.
+			if (Fn)
+			{
+				ParentAnalysis.ImplementedFunctions.Add(FnIdx);
+			}
+		}
+	}
+}
+
+void FAssetIndex::AddBlueprint(const FBlueprintAnalysis& Analysis)
+{
+	if (Analysis.Parents.Num() == 0)
+	{
+		return;
+	}
+
+	const int32 BlueprintIndex = Blueprints.Add(Analysis.Blueprint);
+
+	for (const FParentAnalysis& ParentAnalysis : Analysis.Parents)
+	{
+		const FNativeClassFields& Parent = *ParentAnalysis.Parent;
+
+		FClassEntry& ClassEntry = Classes.FindOrAdd(Parent.Class->GetFName());
+		if (ClassEntry.Name.IsEmpty())
+		{
+			ClassEntry.Name = Parent.DisplayName;
+		}
+
+		ClassEntry.Blueprints.Add(BlueprintIndex);
+
+		for (int32 Idx = 0; Idx < ParentAnalysis.ChangedProperties.Num(); Idx++)
+		{
+			const int32 PropIdx = ParentAnalysis.ChangedProperties[Idx];
+
+			FPropertyEntry* PropEntry = ClassEntry.Properties.Find(Parent.Properties[PropIdx]->GetFName());
+			if (!PropEntry)
+			{
+				PropEntry = &ClassEntry.Properties.Add(Parent.Properties[PropIdx]->GetFName());
+				PropEntry->Categories = Parent.PropertyCategories[PropIdx];
+			}
+
+			PropEntry->Values.Add({ BlueprintIndex, ParentAnalysis.ChangedValues[Idx] });
+		}
+
+		for (int32 FnIdx : ParentAnalysis.ImplementedFunctions)
+		{
+			ClassEntry.Functions.FindOrAdd(Parent.Functions[FnIdx]).Blueprints.Add(BlueprintIndex);
+		}
+	}
+}
+
+void AnalyzeBlueprints(
+	FNativeClassCache& NativeClasses,
+	TArrayView<UBlueprintGeneratedClass* const> BlueprintClasses,
+	TArray<FBlueprintAnalysis>& OutAnalyses)
+{
+	const int32 FirstAnalysis = OutAnalyses.Num();
+	OutAnalyses.SetNum(FirstAnalysis + BlueprintClasses.Num());
+
+	for (int32 Idx = 0; Idx < BlueprintClasses.Num(); Idx++)
+	{
+		const UBlueprintGeneratedClass* BlueprintGeneratedClass = BlueprintClasses[Idx];
+		FBlueprintAnalysis& Analysis = OutAnalyses[FirstAnalysis + Idx];
+
+		Analysis.Blueprint.Name = BlueprintGeneratedClass->GetName();
+		Analysis.Blueprint.Path = BlueprintGeneratedClass->GetPathName();
+
+		FindBlueprintNativeParents(BlueprintGeneratedClass, [&](UClass* Parent)
+		{
+			Analysis.Parents.AddDefaulted_GetRef().Parent = &NativeClasses.FindOrAdd(Parent);
+		});
+	}
+
+	ParallelFor(BlueprintClasses.Num(), [&](int32 Idx)
+	{
+		AnalyzeBlueprint(BlueprintClasses[Idx], OutAnalyses[FirstAnalysis + Idx]);
+	});
+}
+} // namespace VisualStudioTools
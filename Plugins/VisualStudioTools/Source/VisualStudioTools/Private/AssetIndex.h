@@ -0,0 +1,140 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UBlueprintGeneratedClass;
+
+namespace VisualStudioTools
+{
+/**
+* A scalar property value extracted from a blueprint CDO.
+* Mirrors the scalar conversions of `FJsonObjectConverter`, without building a `FJsonValue`.
+*/
+struct FPropertyValue
+{
+	enum class EType : uint8
+	{
+		None,
+		Bool,
+		Integer,
+		Number,
+		String,
+	};
+
+	EType Type = EType::None;
+	bool bBoolValue = false;
+	int64 IntegerValue = 0;
+	double NumberValue = 0.0;
+	FString StringValue;
+};
+
+/**
+* The fields of a native class that blueprints can override.
+* They are gathered once per class and shared by every blueprint deriving from it,
+* instead of walking the class fields again for each blueprint.
+*/
+struct FNativeClassFields
+{
+	UClass* Class;
+	const UObject* DefaultObject;
+	FString DisplayName;
+
+	// Properties defined in the class itself, the super classes are processed individually.
+	TArray<FProperty*> Properties;
+	TArray<FString> PropertyCategories;
+	TArray<bool> PropertyHasValue;
+
+	// Functions defined in the class itself.
+	TArray<FName> Functions;
+};
+
+/**
+* Shared by the analyses of every blueprint deriving from the same native classes.
+* Entries are never removed, so references to them stay valid for the cache lifetime.
+*/
+struct FNativeClassCache
+{
+	TMap<const UClass*, TUniquePtr<FNativeClassFields>> Classes;
+
+	const FNativeClassFields& FindOrAdd(UClass* NativeClass);
+};
+
+/**
+* The data extracted from one blueprint for one of its native parents.
+* Properties and functions are indices into the parent's `FNativeClassFields`.
+*/
+struct FParentAnalysis
+{
+	const FNativeClassFields* Parent;
+	TArray<int32> ChangedProperties;
+	TArray<FPropertyValue> ChangedValues;
+	TArray<int32> ImplementedFunctions;
+};
+
+struct FBlueprintEntry
+{
+	FString Name;
+	FString Path;
+};
+
+struct FBlueprintAnalysis
+{
+	FBlueprintEntry Blueprint;
+	TArray<FParentAnalysis> Parents;
+};
+
+/**
+* The index only stores data extracted from the loaded blueprints (names, paths and values).
+* It must never hold pointers to the blueprint classes or their fields, since those are
+* garbage collected during the scan when a memory ceiling is set.
+*/
+struct FPropertyValueEntry
+{
+	int32 Blueprint;
+	FPropertyValue Value;
+};
+
+struct FPropertyEntry
+{
+	FString Categories;
+	TArray<FPropertyValueEntry> Values;
+};
+
+struct FFunctionEntry
+{
+	TArray<int32> Blueprints;
+};
+
+struct FClassEntry
+{
+	FString Name;
+	TArray<int32> Blueprints;
+	TMap<FName, FPropertyEntry> Properties;
+	TMap<FName, FFunctionEntry> Functions;
+};
+
+using ClassMap = TMap<FName, FClassEntry>;
+
+struct FAssetIndex
+{
+	TSet<FString> AssetPathCache;
+	ClassMap Classes;
+	TArray<FBlueprintEntry> Blueprints;
+
+	/** Adds the blueprint to the index, if it derives from any native class. */
+	void AddBlueprint(const FBlueprintAnalysis& Analysis);
+};
+
+/**
+* Analyzes a batch of loaded blueprints and appends the results to `OutAnalyses`, in the batch order.
+* The native parents are resolved on the game thread and the CDO comparisons run in parallel.
+* The analyses only reference the native class fields, so they stay valid after the blueprints are unloaded.
+*/
+void AnalyzeBlueprints(
+	FNativeClassCache& NativeClasses,
+	TArrayView<UBlueprintGeneratedClass* const> BlueprintClasses,
+	TArray<FBlueprintAnalysis>& OutAnalyses);
+} // namespace VisualStudioTools
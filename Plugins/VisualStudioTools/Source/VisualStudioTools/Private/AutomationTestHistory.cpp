@@ -0,0 +1,212 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#include "AutomationTestHistory.h"
+
+#include "Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "VisualStudioTools.h"
+
+namespace VisualStudioTools
+{
+static constexpr int32 HistoryFileVersion = 1;
+
+// Number of passing runs kept per test for the rolling baseline.
+static constexpr int32 MaxRecentDurations = 10;
+
+// Passing runs required before a test can be flagged as a performance regression.
+static constexpr int32 MinRegressionBaselineRuns = 3;
+
+FString FAutomationTestHistory::GetDefaultFilePath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("VisualStudioTools") / TEXT("TestHistory.json");
+}
+
+bool FAutomationTestHistory::Load(const FString& FilePath)
+{
+	Records.Reset();
+
+	FString Contents;
+	if (!FFileHelper::LoadFileToString(Contents, *FilePath))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> Root;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Contents);
+	if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid()
+		|| Root->GetIntegerField(TEXT("version")) != HistoryFileVersion)
+	{
+		UE_LOG(LogVisualStudioTools, Display, TEXT("Ignoring outdated test history: %s"), *FilePath);
+		return false;
+	}
+
+	const TSharedPtr<FJsonObject>* Tests = nullptr;
+	if (!Root->TryGetObjectField(TEXT("tests"), Tests))
+	{
+		return false;
+	}
+
+	for (const auto& Item : (*Tests)->Values)
+	{
+		const TSharedPtr<FJsonObject> TestObject = Item.Value->AsObject();
+		if (!TestObject.IsValid())
+		{
+			continue;
+		}
+
+		FTestRecord& Record = Records.Add(Item.Key);
+		for (const TSharedPtr<FJsonValue>& Duration : TestObject->GetArrayField(TEXT("durations")))
+		{
+			Record.RecentDurations.Add(Duration->AsNumber());
+		}
+
+		Record.RunCount = TestObject->GetIntegerField(TEXT("runs"));
+		Record.FailureCount = TestObject->GetIntegerField(TEXT("failures"));
+		Record.bLastRunFailed = TestObject->GetBoolField(TEXT("lastRunFailed"));
+
+		FString LastFailure;
+		if (TestObject->TryGetStringField(TEXT("lastFailure"), LastFailure))
+		{
+			FDateTime::ParseIso8601(*LastFailure, Record.LastFailure);
+		}
+	}
+
+	return true;
+}
+
+bool FAutomationTestHistory::Save(const FString& FilePath) const
+{
+	FString Contents;
+	TSharedRef<TJsonWriter<>> Json = TJsonWriterFactory<>::Create(&Contents);
+
+	Json->WriteObjectStart();
+	Json->WriteValue(TEXT("version"), HistoryFileVersion);
+
+	Json->WriteObjectStart(TEXT("tests"));
+	for (const auto& Item : Records)
+	{
+		const FTestRecord& Record = Item.Value;
+
+		Json->WriteObjectStart(Item.Key);
+		Json->WriteValue(TEXT("durations"), Record.RecentDurations);
+		Json->WriteValue(TEXT("runs"), Record.RunCount);
+		Json->WriteValue(TEXT("failures"), Record.FailureCount);
+		Json->WriteValue(TEXT("lastRunFailed"), Record.bLastRunFailed);
+		if (Record.FailureCount > 0)
+		{
+			Json->WriteValue(TEXT("lastFailure"), Record.LastFailure.ToIso8601());
+		}
+		Json->WriteObjectEnd();
+	}
+	Json->WriteObjectEnd();
+
+	Json->WriteObjectEnd();
+	Json->Close();
+
+	if (!FFileHelper::SaveStringToFile(Contents, *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogVisualStudioTools, Warning, TEXT("Failed to write the test history: %s"), *FilePath);
+		return false;
+	}
+
+	return true;
+}
+
+void FAutomationTestHistory::SortTests(TArray<FAutomationTestInfo>& InOutTests) const
+{
+	TMap<FString, double> Durations;
+	GetDurations(Durations);
+
+	auto GetDuration = [&](const FAutomationTestInfo& Test)
+	{
+		const double* Duration = Durations.Find(Test.GetTestName());
+		return Duration ? *Duration : -1.0;
+	};
+
+	InOutTests.StableSort([&](const FAutomationTestInfo& A, const FAutomationTestInfo& B)
+		{
+			const FTestRecord* RecordA = Records.Find(A.GetTestName());
+			const FTestRecord* RecordB = Records.Find(B.GetTestName());
+
+			const bool bFailedA = RecordA && RecordA->bLastRunFailed;
+			const bool bFailedB = RecordB && RecordB->bLastRunFailed;
+			if (bFailedA != bFailedB)
+			{
+				return bFailedA;
+			}
+
+			if (bFailedA)
+			{
+				return RecordA->LastFailure > RecordB->LastFailure;
+			}
+
+			return GetDuration(A) > GetDuration(B);
+		});
+}
+
+void FAutomationTestHistory::GetDurations(TMap<FString, double>& OutDurations) const
+{
+	for (const auto& Item : Records)
+	{
+		const double Baseline = GetBaseline(Item.Value, 1);
+		if (Baseline >= 0.0)
+		{
+			OutDurations.Add(Item.Key, Baseline);
+		}
+	}
+}
+
+bool FAutomationTestHistory::IsRegression(const FString& TestCommand, double Duration, double Factor) const
+{
+	const FTestRecord* Record = Records.Find(TestCommand);
+	if (!Record || Factor <= 0.0)
+	{
+		return false;
+	}
+
+	const double Baseline = GetBaseline(*Record, MinRegressionBaselineRuns);
+	return Baseline > 0.0 && Duration > Baseline * Factor;
+}
+
+void FAutomationTestHistory::AddResult(const FString& TestCommand, bool bSuccess, double Duration)
+{
+	FTestRecord& Record = Records.FindOrAdd(TestCommand);
+	Record.RunCount++;
+	Record.bLastRunFailed = !bSuccess;
+
+	if (bSuccess)
+	{
+		// Failed runs often stop early, keep them out of the baseline.
+		if (Record.RecentDurations.Num() >= MaxRecentDurations)
+		{
+			Record.RecentDurations.RemoveAt(0);
+		}
+
+		Record.RecentDurations.Add(Duration);
+	}
+	else
+	{
+		Record.FailureCount++;
+		Record.LastFailure = FDateTime::UtcNow();
+	}
+}
+
+double FAutomationTestHistory::GetBaseline(const FTestRecord& Record, int32 MinRuns)
+{
+	if (Record.RecentDurations.Num() < FMath::Max(MinRuns, 1))
+	{
+		return -1.0;
+	}
+
+	TArray<double> Sorted = Record.RecentDurations;
+	Sorted.Sort();
+
+	const int32 Middle = Sorted.Num() / 2;
+	return Sorted.Num() % 2 == 0 ? (Sorted[Middle - 1] + Sorted[Middle]) * 0.5 : Sorted[Middle];
+}
+} // namespace VisualStudioTools
@@ -0,0 +1,62 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+namespace VisualStudioTools
+{
+/**
+* Local database of the automation test results, stored as a small json file.
+*
+* For each test it keeps the durations of the recent passing runs and when the test last failed.
+* It is used to run the recently failed tests first, to balance the test shards, and to detect
+* tests that became slower than their rolling baseline.
+*/
+class FAutomationTestHistory
+{
+public:
+	/** Default location of the history file for the current project. */
+	static FString GetDefaultFilePath();
+
+	/** Reads the history from disk. Returns false, leaving the history empty, if the file is missing or invalid. */
+	bool Load(const FString& FilePath);
+
+	bool Save(const FString& FilePath) const;
+
+	/**
+	* Orders the tests to run: the tests that failed in their last run first, most recent failure first,
+	* then the longest tests first. Tests without history keep their relative order after them.
+	*/
+	void SortTests(TArray<FAutomationTestInfo>& InOutTests) const;
+
+	/** Retrieves the baseline duration of each test that passed at least once. */
+	void GetDurations(TMap<FString, double>& OutDurations) const;
+
+	/**
+	* Checks if a passing run was slower than the baseline of the test by more than the given factor.
+	* Must be called before the result is added.
+	*/
+	bool IsRegression(const FString& TestCommand, double Duration, double Factor) const;
+
+	void AddResult(const FString& TestCommand, bool bSuccess, double Duration);
+
+private:
+	struct FTestRecord
+	{
+		// Durations of the most recent passing runs, oldest first.
+		TArray<double> RecentDurations;
+		int32 RunCount = 0;
+		int32 FailureCount = 0;
+		bool bLastRunFailed = false;
+		FDateTime LastFailure;
+	};
+
+	/** Median of the recent durations, or a negative value if there are fewer than `MinRuns`. */
+	static double GetBaseline(const FTestRecord& Record, int32 MinRuns);
+
+	TMap<FString, FTestRecord> Records;
+};
+} // namespace VisualStudioTools
@@ -0,0 +1,340 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#include "AutomationTestSharding.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+#include "VisualStudioTools.h"
+
+namespace VisualStudioTools
+{
+static constexpr auto RunTestPrefix = TEXT("[RUNTEST]");
+
+// Duration assumed for tests without history, so new tests are spread across the workers.
+static constexpr double DefaultTestDuration = 1.0;
+
+TArray<FTestResultBlock> ReadTestResults(const FString& ResultsFile)
+{
+	TArray<FTestResultBlock> OutResults;
+
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *ResultsFile))
+	{
+		return OutResults;
+	}
+
+	for (FString& Line : Lines)
+	{
+		if (Line.StartsWith(RunTestPrefix))
+		{
+			// [RUNTEST]TestCommand|DisplayName|Result|Duration
+			TArray<FString> Fields;
+			Line.RightChop(FCString::Strlen(RunTestPrefix)).ParseIntoArray(Fields, TEXT("|"), false);
+			if (Fields.Num() < 4)
+			{
+				continue;
+			}
+
+			FTestResultBlock& Block = OutResults.AddDefaulted_GetRef();
+			Block.TestCommand = Fields[0];
+			// Performance regressions are reported separately, but the test itself passed.
+			Block.bSuccess = Fields[Fields.Num() - 2] == TEXT("OK") || Fields[Fields.Num() - 2] == TEXT("REGRESSED");
+			Block.Duration = FCString::Atod(*Fields.Last());
+			Block.Lines.Add(MoveTemp(Line));
+		}
+		else if (OutResults.Num() > 0)
+		{
+			OutResults.Last().Lines.Add(MoveTemp(Line));
+		}
+	}
+
+	return OutResults;
+}
+
+/**
+* Assigns the tests to the workers, longest first, each to the worker with the smallest total duration.
+* Each shard keeps the tests in their original order.
+*/
+static TArray<TArray<int32>> PartitionTests(const TArray<FAutomationTestInfo>& Tests, const FShardedTestRunOptions& Options)
+{
+	TArray<double> Durations;
+	Durations.Reserve(Tests.Num());
+	for (const FAutomationTestInfo& Test : Tests)
+	{
+		const double* Duration = Options.Durations.Find(Test.GetTestName());
+		Durations.Add(Duration ? FMath::Max(*Duration, 0.0) : DefaultTestDuration);
+	}
+
+	TArray<int32> Order;
+	Order.Reserve(Tests.Num());
+	for (int32 Idx = 0; Idx < Tests.Num(); Idx++)
+	{
+		Order.Add(Idx);
+	}
+
+	Order.StableSort([&](int32 A, int32 B) { return Durations[A] > Durations[B]; });
+
+	const int32 NumShards = FMath::Clamp(Options.NumWorkers, 1, FMath::Max(1, Tests.Num()));
+	TArray<TArray<int32>> Shards;
+	TArray<double> Loads;
+	Shards.SetNum(NumShards);
+	Loads.SetNumZeroed(NumShards);
+
+	for (int32 TestIdx : Order)
+	{
+		int32 ShardIdx = 0;
+		for (int32 Idx = 1; Idx < NumShards; Idx++)
+		{
+			if (Loads[Idx] < Loads[ShardIdx])
+			{
+				ShardIdx = Idx;
+			}
+		}
+
+		Shards[ShardIdx].Add(TestIdx);
+		Loads[ShardIdx] += Durations[TestIdx];
+	}
+
+	for (TArray<int32>& Shard : Shards)
+	{
+		Shard.Sort();
+	}
+
+	Shards.RemoveAll([](const TArray<int32>& Shard) { return Shard.Num() == 0; });
+	return Shards;
+}
+
+struct FTestWorker
+{
+	FProcHandle Process;
+	TArray<int32> Tests;
+	FString ResultsFile;
+
+	// Number of tests of the shard reported so far, and started as far as the events are concerned.
+	int32 NumReported = 0;
+	int32 NumStarted = 0;
+	int64 LastResultsSize = -1;
+
+	// Set for the tests left by a crashed worker.
+	bool bRedispatched = false;
+};
+
+int32 RunTestsSharded(const TArray<FAutomationTestInfo>& Tests, const FString& ResultsFile, const FShardedTestRunOptions& Options)
+{
+	const FString WorkDir = FPaths::ConvertRelativePathToFull(
+		FPaths::ProjectSavedDir() / TEXT("VisualStudioTools") / TEXT("TestWorkers") / FGuid::NewGuid().ToString());
+	IFileManager::Get().MakeDirectory(*WorkDir, true);
+
+	TMap<FString, int32> TestsByCommand;
+	for (int32 Idx = 0; Idx < Tests.Num(); Idx++)
+	{
+		TestsByCommand.Add(Tests[Idx].GetTestName(), Idx);
+	}
+
+	TArray<FTestWorker> PendingWorkers;
+	for (TArray<int32>& Shard : PartitionTests(Tests, Options))
+	{
+		PendingWorkers.AddDefaulted_GetRef().Tests = MoveTemp(Shard);
+	}
+
+	TArray<TOptional<FTestResultBlock>> Results;
+	Results.SetNum(Tests.Num());
+
+	auto ReportResult = [&](int32 TestIdx, FTestResultBlock&& Block)
+	{
+		if (Options.OnTestResult)
+		{
+			Options.OnTestResult(Block);
+		}
+
+		Results[TestIdx] = MoveTemp(Block);
+	};
+
+	// A worker runs its shard in order, so its next test starts when the previous one is reported.
+	auto StartNextTest = [&](FTestWorker& Worker)
+	{
+		if (Options.OnTestStarted && Worker.NumStarted <= Worker.NumReported && Worker.NumReported < Worker.Tests.Num())
+		{
+			Options.OnTestStarted(Tests[Worker.Tests[Worker.NumReported]]);
+			Worker.NumStarted = Worker.NumReported + 1;
+		}
+	};
+
+	// Reports the results the worker wrote since the previous call. While the worker runs, its last
+	// block is left for later since the error lines of that test may not be written yet.
+	auto CollectResults = [&](FTestWorker& Worker, bool bExited)
+	{
+		const int64 Size = IFileManager::Get().FileSize(*Worker.ResultsFile);
+		if (!bExited && Size == Worker.LastResultsSize)
+		{
+			return;
+		}
+
+		Worker.LastResultsSize = Size;
+
+		TArray<FTestResultBlock> Blocks = ReadTestResults(Worker.ResultsFile);
+		const int32 NumComplete = bExited ? Blocks.Num() : Blocks.Num() - 1;
+		for (int32 Idx = Worker.NumReported; Idx < NumComplete; Idx++)
+		{
+			const int32* TestIdx = TestsByCommand.Find(Blocks[Idx].TestCommand);
+			if (TestIdx && !Results[*TestIdx].IsSet())
+			{
+				ReportResult(*TestIdx, MoveTemp(Blocks[Idx]));
+			}
+		}
+
+		Worker.NumReported = FMath::Max(Worker.NumReported, NumComplete);
+		StartNextTest(Worker);
+	};
+
+	TArray<FTestWorker> Workers;
+	int32 NumLaunched = 0;
+	bool bCancelled = false;
+	// Set when a launch fails, the shard then waits until a running worker exits before trying again.
+	bool bLaunchFailed = false;
+
+	const FString ExecutablePath = FPlatformProcess::ExecutablePath();
+	const FString ProjectFilePath = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+
+	while (PendingWorkers.Num() > 0 || Workers.Num() > 0)
+	{
+		// Launch the pending shards while there are free workers.
+		while (PendingWorkers.Num() > 0 && Workers.Num() < Options.NumWorkers && !bLaunchFailed)
+		{
+			FTestWorker Worker = PendingWorkers.Pop(EAllowShrinking::No);
+
+			const FString TestListFile = WorkDir / FString::Printf(TEXT("Worker%d.txt"), NumLaunched);
+			Worker.ResultsFile = WorkDir / FString::Printf(TEXT("Worker%d.results"), NumLaunched);
+			NumLaunched++;
+
+			TArray<FString> TestCommands;
+			for (int32 TestIdx : Worker.Tests)
+			{
+				TestCommands.Add(Tests[TestIdx].GetTestName());
+			}
+
+			FFileHelper::SaveStringArrayToFile(TestCommands, *TestListFile, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+
+			const FString Params = FString::Printf(
+				TEXT("\"%s\" -run=VSTestAdapter -runtests=\"%s\" -testresultfile=\"%s\" %s -unattended -nullrhi -nosound -nosplash -nocrashreports -stdout"),
+				*ProjectFilePath, *TestListFile, *Worker.ResultsFile, *Options.WorkerParams);
+
+			Worker.Process = FPlatformProcess::CreateProc(*ExecutablePath, *Params, false, true, true, nullptr, 0, nullptr, nullptr);
+			if (!Worker.Process.IsValid())
+			{
+				UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to launch test worker: %s %s"), *ExecutablePath, *Params);
+				PendingWorkers.Push(MoveTemp(Worker));
+				bLaunchFailed = true;
+				break;
+			}
+
+			UE_LOG(LogVisualStudioTools, Display, TEXT("Launched test worker %d with %d tests."), NumLaunched, Worker.Tests.Num());
+			StartNextTest(Worker);
+			Workers.Add(MoveTemp(Worker));
+		}
+
+		if (Workers.Num() == 0)
+		{
+			// No worker could be launched, the remaining tests are reported as failed below.
+			break;
+		}
+
+		FPlatformProcess::Sleep(0.1f);
+
+		if (Options.ShouldCancel && Options.ShouldCancel())
+		{
+			UE_LOG(LogVisualStudioTools, Display, TEXT("Test run cancelled, stopping %d workers."), Workers.Num());
+
+			for (FTestWorker& Worker : Workers)
+			{
+				FPlatformProcess::TerminateProc(Worker.Process, true);
+				FPlatformProcess::CloseProc(Worker.Process);
+				CollectResults(Worker, true);
+			}
+
+			Workers.Reset();
+			PendingWorkers.Reset();
+			bCancelled = true;
+			break;
+		}
+
+		for (int32 WorkerIdx = Workers.Num() - 1; WorkerIdx >= 0; WorkerIdx--)
+		{
+			FTestWorker& Worker = Workers[WorkerIdx];
+			if (FPlatformProcess::IsProcRunning(Worker.Process))
+			{
+				CollectResults(Worker, false);
+				continue;
+			}
+
+			FPlatformProcess::CloseProc(Worker.Process);
+			CollectResults(Worker, true);
+			bLaunchFailed = false;
+
+			TArray<int32> Unreported = Worker.Tests.FilterByPredicate([&](int32 TestIdx) { return !Results[TestIdx].IsSet(); });
+			if (Worker.bRedispatched && Unreported.Num() == Worker.Tests.Num())
+			{
+				// A second worker in a row exited without any result, most likely it could not start.
+				// Leave the tests without results instead of launching one process per test.
+				UE_LOG(LogVisualStudioTools, Error, TEXT("Test worker exited without reporting any result, %d tests are not run."), Unreported.Num());
+			}
+			else if (Unreported.Num() > 0)
+			{
+				// The tests run in the shard order, so the first one without a result crashed the worker.
+				const FAutomationTestInfo& CrashedTest = Tests[Unreported[0]];
+				UE_LOG(LogVisualStudioTools, Error, TEXT("Test worker exited while running %s, %d tests left to dispatch."),
+					*CrashedTest.GetDisplayName(), Unreported.Num() - 1);
+
+				FTestResultBlock Block;
+				Block.TestCommand = CrashedTest.GetTestName();
+				Block.Lines.Add(FString::Printf(TEXT("%s%s|%s|FAIL|0"), RunTestPrefix, *CrashedTest.GetTestName(), *CrashedTest.GetDisplayName()));
+				Block.Lines.Add(TEXT("The test worker process exited before the test completed."));
+				ReportResult(Unreported[0], MoveTemp(Block));
+
+				Unreported.RemoveAt(0);
+				if (Unreported.Num() > 0)
+				{
+					FTestWorker& Retry = PendingWorkers.AddDefaulted_GetRef();
+					Retry.Tests = MoveTemp(Unreported);
+					Retry.bRedispatched = true;
+				}
+			}
+
+			Workers.RemoveAtSwap(WorkerIdx);
+		}
+	}
+
+	// Merge the results in the original test order, so the output matches a serial run.
+	bool bAllSuccessful = !bCancelled;
+	TArray<FString> Lines;
+	for (int32 Idx = 0; Idx < Tests.Num(); Idx++)
+	{
+		if (!Results[Idx].IsSet())
+		{
+			if (bCancelled)
+			{
+				// The tests that did not run are left out, as they would be in a cancelled serial run.
+				continue;
+			}
+
+			FTestResultBlock Block;
+			Block.TestCommand = Tests[Idx].GetTestName();
+			Block.Lines.Add(FString::Printf(TEXT("%s%s|%s|FAIL|0"), RunTestPrefix, *Tests[Idx].GetTestName(), *Tests[Idx].GetDisplayName()));
+			Block.Lines.Add(TEXT("The test could not be dispatched to a worker process."));
+			ReportResult(Idx, MoveTemp(Block));
+		}
+
+		bAllSuccessful = bAllSuccessful && Results[Idx]->bSuccess;
+		Lines.Append(Results[Idx]->Lines);
+	}
+
+	FFileHelper::SaveStringArrayToFile(Lines, *ResultsFile, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+	IFileManager::Get().DeleteDirectory(*WorkDir, false, true);
+
+	return bAllSuccessful ? 0 : 1;
+}
+} // namespace VisualStudioTools
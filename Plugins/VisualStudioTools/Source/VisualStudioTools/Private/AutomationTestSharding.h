@@ -0,0 +1,63 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+namespace VisualStudioTools
+{
+/**
+* The lines written to the results file for one test: the `[RUNTEST]` line followed by its error messages.
+*/
+struct FTestResultBlock
+{
+	FString TestCommand;
+	bool bSuccess = false;
+	double Duration = 0.0;
+	TArray<FString> Lines;
+};
+
+/** Parses the `[RUNTEST]` blocks of a results file, in file order. */
+TArray<FTestResultBlock> ReadTestResults(const FString& ResultsFile);
+
+struct FShardedTestRunOptions
+{
+	int32 NumWorkers = 1;
+
+	/** Duration of each test in a previous run, used to balance the shards. */
+	TMap<FString, double> Durations;
+
+	/** Extra parameters passed to each worker process, such as the test filters. */
+	FString WorkerParams;
+
+	/**
+	* Invoked for each result as soon as a worker reports it, before it is written to the merged results file.
+	* The results of different workers arrive interleaved, not in the original test order.
+	*/
+	TFunction<void(FTestResultBlock&)> OnTestResult;
+
+	/** Invoked when a worker starts a test, which is when the previous test of its shard was reported. */
+	TFunction<void(const FAutomationTestInfo&)> OnTestStarted;
+
+	/**
+	* Polled while the workers run. When it returns true the workers are terminated, and the tests
+	* without a result are left out of the results file.
+	*/
+	TFunction<bool()> ShouldCancel;
+};
+
+/**
+* Runs the tests across child editor processes and writes the merged results to `ResultsFile`,
+* in the same format and order as a serial run. Each worker runs its tests in the order of `Tests`.
+*
+* The tests are split in shards of similar total duration (longest tests first, each assigned
+* to the least loaded worker). When a worker exits before reporting all of its tests, the first
+* missing test is reported as failed since it is the one that crashed the worker, and the rest
+* are dispatched to a new worker.
+*
+* Returns 0 if all the tests passed and the run was not cancelled.
+*/
+int32 RunTestsSharded(const TArray<FAutomationTestInfo>& Tests, const FString& ResultsFile, const FShardedTestRunOptions& Options);
+} // namespace VisualStudioTools
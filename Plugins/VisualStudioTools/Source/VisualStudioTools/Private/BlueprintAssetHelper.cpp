@@ -9,7 +9,11 @@
 #include "Engine/BlueprintGeneratedClass.h"
 #include "Engine/Engine.h"
 #include "Engine/StreamableManager.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
 #include "Misc/ScopeExit.h"
+#include "UObject/GarbageCollection.h"
+#include "UObject/UObjectGlobals.h"
 #include "VisualStudioTools.h"
 
 namespace VisualStudioTools
@@ -49,9 +53,86 @@ static FString GetObjectPathString(const FAssetData& InAssetData)
 
 #endif // FILTER_ASSETS_BY_CLASS_PATH
 
-void ForEachAsset(
+FString GetPackageFilePath(const FAssetData& AssetData)
+{
+	FString PackageFileName;
+	FString PackageFile;
+	if (FPackageName::TryConvertLongPackageNameToFilename(AssetData.PackageName.ToString(), PackageFileName) &&
+		FPackageName::FindPackageFileWithoutExtension(PackageFileName, PackageFile))
+	{
+		return FPaths::ConvertRelativePathToFull(MoveTemp(PackageFile));
+	}
+
+	return FString();
+}
+
+void GetProjectContentPaths(TArray<FString>& OutRootPaths)
+{
+	FPackageName::QueryRootContentPaths(OutRootPaths);
+
+	const FString ProjectDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir());
+	OutRootPaths.RemoveAll([&](const FString& RootPath)
+		{
+			FString RootDir;
+			return !FPackageName::TryConvertLongPackageNameToFilename(RootPath, RootDir)
+				|| !FPaths::IsUnderDirectory(FPaths::ConvertRelativePathToFull(RootDir), ProjectDir);
+		});
+}
+
+static FSoftClassPath GetGeneratedClassPath(const FAssetData& AssetData)
+{
+	return AssetData.GetTagValueRef<FString>(FBlueprintTags::GeneratedClassPath);
+}
+
+static UBlueprintGeneratedClass* GetLoadedClass(
+	const TSharedPtr<FStreamableHandle>& Handle,
+	const FAssetData& AssetData,
+	const FSoftClassPath& GenClassPath)
+{
+	if (!Handle.IsValid())
+	{
+		UE_LOG(LogVisualStudioTools, Warning, TEXT("Failed to get a streamable handle for Blueprint. Skipping. GenClassPath: %s"), *GenClassPath.ToString());
+		return nullptr;
+	}
+
+	if (auto BlueprintGeneratedClass = Cast<UBlueprintGeneratedClass>(Handle->GetLoadedAsset()))
+	{
+		return BlueprintGeneratedClass;
+	}
+
+	// Log some extra information to help the user understand why the asset failed to load.
+
+	FString ObjectPathString = AssetHelpers::GetObjectPathString(AssetData);
+
+	FString Msg = !GenClassPath.ToString().Contains(ObjectPathString)
+		? FString::Printf(
+			TEXT("ObjectPath is not compatible with GenClassPath, consider re-saving it to avoid future issues. { ObjectPath: %s, GenClassPath: %s }"),
+			*ObjectPathString,
+			*GenClassPath.ToString())
+		: FString::Printf(TEXT("ClassPath: %s"), *GenClassPath.ToString());
+
+	UE_LOG(LogVisualStudioTools, Warning, TEXT("Failed to load Blueprint. Skipping. %s"), *Msg);
+	return nullptr;
+}
+
+static uint64 GetUsedPhysicalMemory()
+{
+	return FPlatformMemory::GetStats().UsedPhysical;
+}
+
+/**
+* Growth required since the last collection before collecting again while above the ceiling.
+* A tenth of the ceiling, but at least 64 MB.
+*/
+static uint64 GetCollectionMargin(uint64 MemoryCeiling)
+{
+	return FMath::Max<uint64>(MemoryCeiling / 10, 64ull * 1024 * 1024);
+}
+
+void ForEachAssetBatch(
 	const TArray<FAssetData>& TargetAssets,
-	TFunctionRef<void(UBlueprintGeneratedClass*, const FAssetData& AssetData)> Callback)
+	TFunctionRef<void(TArrayView<UBlueprintGeneratedClass* const> Classes, TArrayView<const FAssetData* const> AssetData)> Callback,
+	const FForEachAssetOptions& Options)
 {
 	// Show a simpler logging output.
 	// LogTimes are still useful to tell how long it takes to process each asset.
@@ -66,47 +147,137 @@ void ForEachAsset(
 		GEngine->Exec(nullptr, TEXT("log reset"));
 	};
 
+	const int32 LoadBatchSize = FMath::Max(1, Options.LoadBatchSize);
+	const double StartTime = FPlatformTime::Seconds();
+	const uint64 MemoryCeiling = static_cast<uint64>(FMath::Max(0, Options.MemoryCeilingMB)) * 1024 * 1024;
+	uint64 PeakUsedMemory = GetUsedPhysicalMemory();
+	int32 NumCollections = 0;
+	// Memory still in use after the last collection, zero before the first one.
+	uint64 UsedMemoryAfterCollection = 0;
+	bool bWarnedAboutCeiling = false;
+	double ProcessingTime = 0.0;
+
 	FStreamableManager AssetLoader;
 
-	for (int32 Idx = 0; Idx < TargetAssets.Num(); Idx++)
+	// Handles for the requests in flight, indexed by their position in `TargetAssets`.
+	// Requests are issued ahead of the current item, but always consumed in order,
+	// so the callback order is deterministic regardless of the load batch size.
+	TArray<TSharedPtr<FStreamableHandle>> Handles;
+	Handles.SetNum(TargetAssets.Num());
+	int32 NextRequest = 0;
+
+	// Loaded classes waiting to be passed to the callback, and the handles keeping them alive.
+	TArray<UBlueprintGeneratedClass*> BatchClasses;
+	TArray<const FAssetData*> BatchAssets;
+	TArray<TSharedPtr<FStreamableHandle>> BatchHandles;
+
+	auto FlushBatch = [&]()
 	{
-		const FAssetData AssetData = TargetAssets[Idx];
-		FSoftClassPath GenClassPath = AssetData.GetTagValueRef<FString>(FBlueprintTags::GeneratedClassPath);
-		UE_LOG(LogVisualStudioTools, Display, TEXT("Processing blueprints [%d/%d]: %s"), Idx + 1, TargetAssets.Num(), *GenClassPath.ToString());
+		if (BatchClasses.Num() > 0)
+		{
+			const double ProcessingStartTime = FPlatformTime::Seconds();
+			Callback(BatchClasses, BatchAssets);
+			ProcessingTime += FPlatformTime::Seconds() - ProcessingStartTime;
+		}
 
-		TSharedPtr<FStreamableHandle> Handle = AssetLoader.RequestSyncLoad(GenClassPath);
-		ON_SCOPE_EXIT
+		// We're done, notify an unload.
+		for (const TSharedPtr<FStreamableHandle>& Handle : BatchHandles)
 		{
-			// We're done, notify an unload.
 			Handle->ReleaseHandle();
-		};
+		}
+
+		BatchClasses.Reset();
+		BatchAssets.Reset();
+		BatchHandles.Reset();
 
-		if (!Handle.IsValid())
+		const uint64 UsedMemory = GetUsedPhysicalMemory();
+		PeakUsedMemory = FMath::Max(PeakUsedMemory, UsedMemory);
+
+		// When a collection cannot get below the ceiling (engine and editor data alone may exceed
+		// it), collecting again after every batch would only repeat the same full GC.
+		if (MemoryCeiling > 0 && UsedMemory > MemoryCeiling &&
+			(UsedMemoryAfterCollection <= MemoryCeiling || UsedMemory >= UsedMemoryAfterCollection + GetCollectionMargin(MemoryCeiling)))
 		{
-			UE_LOG(LogVisualStudioTools, Warning, TEXT("Failed to get a streamable handle for Blueprint. Skipping. GenClassPath: %s"), *GenClassPath.ToString());
-			continue;
+			// Released handles only make the packages eligible for collection, so without an
+			// explicit GC every blueprint in the scan would stay resident until the commandlet ends.
+			// The requests still in flight are kept alive by their handles.
+			UE_LOG(LogVisualStudioTools, Display, TEXT("Used memory %.1f MB is above the %d MB ceiling, collecting garbage."),
+				UsedMemory / (1024.0 * 1024.0), Options.MemoryCeilingMB);
+
+			FlushAsyncLoading();
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			NumCollections++;
+
+			UsedMemoryAfterCollection = GetUsedPhysicalMemory();
+			if (UsedMemoryAfterCollection > MemoryCeiling && !bWarnedAboutCeiling)
+			{
+				UE_LOG(LogVisualStudioTools, Warning, TEXT("Used memory %.1f MB is still above the %d MB ceiling after garbage collection. Collecting again only after it grows by %.1f MB."),
+					UsedMemoryAfterCollection / (1024.0 * 1024.0), Options.MemoryCeilingMB, GetCollectionMargin(MemoryCeiling) / (1024.0 * 1024.0));
+				bWarnedAboutCeiling = true;
+			}
 		}
+	};
 
-		if (auto BlueprintGeneratedClass = Cast<UBlueprintGeneratedClass>(Handle->GetLoadedAsset()))
+	for (int32 Idx = 0; Idx < TargetAssets.Num(); Idx++)
+	{
+		// Keep the window of in-flight requests full.
+		for (; NextRequest < TargetAssets.Num() && NextRequest < Idx + LoadBatchSize; NextRequest++)
 		{
-			Callback(BlueprintGeneratedClass, AssetData);
+			const FSoftClassPath RequestPath = GetGeneratedClassPath(TargetAssets[NextRequest]);
+			Handles[NextRequest] = LoadBatchSize > 1
+				? AssetLoader.RequestAsyncLoad(RequestPath, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority)
+				: AssetLoader.RequestSyncLoad(RequestPath);
 		}
-		else
-		{
-			// Log some extra information to help the user understand why the asset failed to load.
 
-			FString ObjectPathString = AssetHelpers::GetObjectPathString(AssetData);
+		const FAssetData& AssetData = TargetAssets[Idx];
+		const FSoftClassPath GenClassPath = GetGeneratedClassPath(AssetData);
+		UE_LOG(LogVisualStudioTools, Display, TEXT("Processing blueprints [%d/%d]: %s"), Idx + 1, TargetAssets.Num(), *GenClassPath.ToString());
+
+		TSharedPtr<FStreamableHandle> Handle = MoveTemp(Handles[Idx]);
+		if (Handle.IsValid())
+		{
+			// The async loader keeps working on the rest of the window while we wait for this one.
+			Handle->WaitUntilComplete();
+			BatchHandles.Add(Handle);
+		}
 
-			FString Msg = !GenClassPath.ToString().Contains(ObjectPathString)
-				? FString::Printf(
-					TEXT("ObjectPath is not compatible with GenClassPath, consider re-saving it to avoid future issues. { ObjectPath: %s, GenClassPath: %s }"),
-					*ObjectPathString,
-					*GenClassPath.ToString())
-				: FString::Printf(TEXT("ClassPath: %s"), *GenClassPath.ToString());
+		if (UBlueprintGeneratedClass* BlueprintGeneratedClass = GetLoadedClass(Handle, AssetData, GenClassPath))
+		{
+			BatchClasses.Add(BlueprintGeneratedClass);
+			BatchAssets.Add(&AssetData);
+		}
 
-			UE_LOG(LogVisualStudioTools, Warning, TEXT("Failed to load Blueprint. Skipping. %s"), *Msg);
+		if (BatchClasses.Num() >= LoadBatchSize)
+		{
+			FlushBatch();
 		}
 	}
+
+	FlushBatch();
+
+	const double TotalTime = FPlatformTime::Seconds() - StartTime;
+	UE_LOG(LogVisualStudioTools, Display, TEXT("Processed %d blueprints in %.3f seconds (load batch size: %d)."),
+		TargetAssets.Num(), TotalTime, LoadBatchSize);
+	UE_LOG(LogVisualStudioTools, Display, TEXT("Loading took %.3f seconds, processing took %.3f seconds."),
+		TotalTime - ProcessingTime, ProcessingTime);
+	UE_LOG(LogVisualStudioTools, Display, TEXT("Peak used memory during the scan: %.1f MB (%d garbage collections)."),
+		PeakUsedMemory / (1024.0 * 1024.0), NumCollections);
+}
+
+void ForEachAsset(
+	const TArray<FAssetData>& TargetAssets,
+	TFunctionRef<void(UBlueprintGeneratedClass*, const FAssetData& AssetData)> Callback,
+	const FForEachAssetOptions& Options)
+{
+	ForEachAssetBatch(TargetAssets,
+		[&](TArrayView<UBlueprintGeneratedClass* const> Classes, TArrayView<const FAssetData* const> AssetData)
+		{
+			for (int32 Idx = 0; Idx < Classes.Num(); Idx++)
+			{
+				Callback(Classes[Idx], *AssetData[Idx]);
+			}
+		},
+		Options);
 }
 
 }
@@ -7,20 +7,60 @@
 
 class UBlueprintGeneratedClass;
 
-namespace VisualStudioTools 
+namespace VisualStudioTools
 {
 namespace AssetHelpers
 {
 void SetBlueprintClassFilter(FARFilter& InOutFilter);
 
+/** Retrieves the full path of the asset's package file on disk, or an empty string if it cannot be found. */
+FString GetPackageFilePath(const FAssetData& AssetData);
+
+/** Retrieves the content root paths located under the project directory, e.g. `/Game/` and the roots of the project plugins. */
+void GetProjectContentPaths(TArray<FString>& OutRootPaths);
+
+/**
+* Options that control how `ForEachAsset` loads the target assets.
+*/
+struct FForEachAssetOptions
+{
+	/**
+	* Number of asset loads kept in flight at the same time.
+	* A value of 1 loads each asset synchronously, one at a time.
+	* Larger values issue async requests for a sliding window of assets so that
+	* package I/O and deserialization overlap with the processing of earlier assets.
+	* This is also the maximum number of classes passed at once to `ForEachAssetBatch` callbacks.
+	*/
+	int32 LoadBatchSize = 1;
+
+	/**
+	* Used physical memory, in megabytes, above which the loaded blueprints are garbage collected
+	* before the scan resumes. Callbacks must not keep references to the loaded classes.
+	* A value of 0 disables the ceiling.
+	*/
+	int32 MemoryCeilingMB = 0;
+};
+
 /**
 * Loads each blueprint asset and invokes the callback with the resulting blueprint generated class.
 * Each iteration will load the asset using a FStreamableHandle and verify that is a valid blueprint
 * before invoking the callback.
+* The callback is always invoked in the same order as `TargetAssets`, regardless of the load batch size.
 */
 void ForEachAsset(
 	const TArray<FAssetData>& TargetAssets,
-	TFunctionRef<void(UBlueprintGeneratedClass*, const FAssetData& AssetData)> Callback);
+	TFunctionRef<void(UBlueprintGeneratedClass*, const FAssetData& AssetData)> Callback,
+	const FForEachAssetOptions& Options = FForEachAssetOptions());
+
+/**
+* Same as `ForEachAsset`, but invokes the callback with batches of up to `LoadBatchSize` loaded classes.
+* The classes of a batch are kept loaded until the callback returns, so they can be processed in parallel.
+* Garbage collection for the memory ceiling only happens between batches.
+*/
+void ForEachAssetBatch(
+	const TArray<FAssetData>& TargetAssets,
+	TFunctionRef<void(TArrayView<UBlueprintGeneratedClass* const> Classes, TArrayView<const FAssetData* const> AssetData)> Callback,
+	const FForEachAssetOptions& Options = FForEachAssetOptions());
 
 } // namespace AssetHelpers
 } // namespace VisualStudioTools
@@ -0,0 +1,228 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#include "BlueprintCallGraphIndex.h"
+
+#include "Algo/Sort.h"
+#include "AssetRegistry/AssetData.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/NameAsStringProxyArchive.h"
+#include "VisualStudioTools.h"
+
+namespace VisualStudioTools
+{
+static constexpr uint32 CallGraphFileMagic = 0x47435356; // 'VSCG'
+static constexpr int32 CallGraphFileVersion = 1;
+
+FString FBlueprintCallGraphIndex::GetDefaultFilePath()
+{
+	return FPaths::ProjectIntermediateDir() / TEXT("VisualStudioTools") / TEXT("BlueprintCallGraph.bin");
+}
+
+FName FBlueprintCallGraphIndex::MakeFunctionKey(const FString& ClassNameWithoutPrefix, const FString& FunctionName)
+{
+	return FName(*FString::Printf(TEXT("%s::%s"), *ClassNameWithoutPrefix, *FunctionName));
+}
+
+bool FBlueprintCallGraphIndex::Load(const FString& FilePath)
+{
+	Records.Reset();
+	Callers.Reset();
+	DirtyPackages.Reset();
+
+	TUniquePtr<FArchive> FileReader{ IFileManager::Get().CreateFileReader(*FilePath) };
+	if (!FileReader)
+	{
+		return false;
+	}
+
+	// FNames are not serialized by plain file archives, write them as strings.
+	FNameAsStringProxyArchive Ar(*FileReader);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int32 NumRecords = 0;
+	Ar << Magic << Version;
+	if (Magic != CallGraphFileMagic || Version != CallGraphFileVersion)
+	{
+		UE_LOG(LogVisualStudioTools, Display, TEXT("Ignoring outdated call graph index: %s"), *FilePath);
+		return false;
+	}
+
+	Ar << NumRecords;
+	for (int32 Idx = 0; Idx < NumRecords && !Ar.IsError(); Idx++)
+	{
+		FName PackageName;
+		FBlueprintRecord Record;
+		Ar << PackageName << Record;
+
+		Records.Add(PackageName, MoveTemp(Record));
+	}
+
+	if (Ar.IsError())
+	{
+		UE_LOG(LogVisualStudioTools, Warning, TEXT("Failed to read the call graph index, it will be rebuilt: %s"), *FilePath);
+		Records.Reset();
+		return false;
+	}
+
+	for (const auto& Item : Records)
+	{
+		AddToReverseIndex(Item.Key, Item.Value);
+	}
+
+	return true;
+}
+
+bool FBlueprintCallGraphIndex::Save(const FString& FilePath) const
+{
+	TUniquePtr<FArchive> FileWriter{ IFileManager::Get().CreateFileWriter(*FilePath) };
+	if (!FileWriter)
+	{
+		UE_LOG(LogVisualStudioTools, Warning, TEXT("Failed to write the call graph index: %s"), *FilePath);
+		return false;
+	}
+
+	FNameAsStringProxyArchive Ar(*FileWriter);
+
+	uint32 Magic = CallGraphFileMagic;
+	int32 Version = CallGraphFileVersion;
+	int32 NumRecords = Records.Num();
+	Ar << Magic << Version << NumRecords;
+
+	for (const auto& Item : Records)
+	{
+		// Archives take non-const references, even when saving.
+		FName PackageName = Item.Key;
+		FBlueprintRecord Record = Item.Value;
+		Ar << PackageName << Record;
+	}
+
+	return FileWriter->Close();
+}
+
+bool FBlueprintCallGraphIndex::Update(const TArray<FAssetData>& BlueprintAssets, const AssetHelpers::FForEachAssetOptions& LoadOptions)
+{
+	TSet<FName> PresentPackages;
+	TArray<FAssetData> StaleAssets;
+	TMap<FName, FFileStatData> StaleFileStats;
+
+	for (const FAssetData& AssetData : BlueprintAssets)
+	{
+		PresentPackages.Add(AssetData.PackageName);
+
+		const FString PackageFilePath = AssetHelpers::GetPackageFilePath(AssetData);
+		const FFileStatData FileStat = IFileManager::Get().GetStatData(*PackageFilePath);
+
+		const FBlueprintRecord* Record = Records.Find(AssetData.PackageName);
+		if (Record == nullptr
+			|| DirtyPackages.Contains(AssetData.PackageName)
+			|| Record->TimeStamp != FileStat.ModificationTime
+			|| Record->FileSize != FileStat.FileSize)
+		{
+			StaleAssets.Add(AssetData);
+			StaleFileStats.Add(AssetData.PackageName, FileStat);
+		}
+	}
+
+	// Drop the packages that were deleted or are no longer blueprints.
+	int32 NumRemoved = 0;
+	for (auto It = Records.CreateIterator(); It; ++It)
+	{
+		if (!PresentPackages.Contains(It.Key()))
+		{
+			RemoveFromReverseIndex(It.Key(), It.Value());
+			It.RemoveCurrent();
+			NumRemoved++;
+		}
+	}
+
+	// Remove the stale entries up front. Blueprints that fail to load are recorded without calls,
+	// so they are not reloaded on every update until their package changes.
+	for (const FAssetData& AssetData : StaleAssets)
+	{
+		if (const FBlueprintRecord* Record = Records.Find(AssetData.PackageName))
+		{
+			RemoveFromReverseIndex(AssetData.PackageName, *Record);
+		}
+
+		const FFileStatData& FileStat = StaleFileStats[AssetData.PackageName];
+
+		FBlueprintRecord& Record = Records.Add(AssetData.PackageName);
+		Record.BlueprintName = AssetData.AssetName.ToString();
+		Record.PackageFilePath = AssetHelpers::GetPackageFilePath(AssetData);
+		Record.TimeStamp = FileStat.ModificationTime;
+		Record.FileSize = FileStat.FileSize;
+	}
+
+	AssetHelpers::ForEachAsset(StaleAssets,
+		[&](UBlueprintGeneratedClass* BlueprintGeneratedClass, const FAssetData& AssetData)
+		{
+			FBlueprintRecord& Record = Records.FindChecked(AssetData.PackageName);
+			Record.BlueprintName = BlueprintGeneratedClass->GetName();
+
+			for (const UFunction* Fn : BlueprintGeneratedClass->CalledFunctions)
+			{
+				if (Fn && Fn->HasAnyFunctionFlags(EFunctionFlags::FUNC_Native))
+				{
+					Record.CalledFunctions.AddUnique(MakeFunctionKey(Fn->GetOwnerClass()->GetName(), Fn->GetName()));
+				}
+			}
+		},
+		LoadOptions);
+
+	for (const FAssetData& AssetData : StaleAssets)
+	{
+		AddToReverseIndex(AssetData.PackageName, Records.FindChecked(AssetData.PackageName));
+	}
+
+	DirtyPackages.Reset();
+
+	UE_LOG(LogVisualStudioTools, Display, TEXT("Call graph index updated: %d blueprints, %d reloaded, %d removed."), Records.Num(), StaleAssets.Num(), NumRemoved);
+	return StaleAssets.Num() > 0 || NumRemoved > 0;
+}
+
+void FBlueprintCallGraphIndex::MarkPackageDirty(FName PackageName)
+{
+	DirtyPackages.Add(PackageName);
+}
+
+void FBlueprintCallGraphIndex::FindCallers(FName FunctionKey, TArray<const FBlueprintRecord*>& OutCallers) const
+{
+	if (const TArray<FName>* Packages = Callers.Find(FunctionKey))
+	{
+		for (FName PackageName : *Packages)
+		{
+			OutCallers.Add(&Records.FindChecked(PackageName));
+		}
+
+		// The packages are in update order, report the callers in a stable order instead.
+		Algo::Sort(OutCallers, [](const FBlueprintRecord* A, const FBlueprintRecord* B) { return A->PackageFilePath < B->PackageFilePath; });
+	}
+}
+
+void FBlueprintCallGraphIndex::AddToReverseIndex(FName PackageName, const FBlueprintRecord& Record)
+{
+	for (FName FunctionKey : Record.CalledFunctions)
+	{
+		Callers.FindOrAdd(FunctionKey).Add(PackageName);
+	}
+}
+
+void FBlueprintCallGraphIndex::RemoveFromReverseIndex(FName PackageName, const FBlueprintRecord& Record)
+{
+	for (FName FunctionKey : Record.CalledFunctions)
+	{
+		if (TArray<FName>* Packages = Callers.Find(FunctionKey))
+		{
+			Packages->RemoveSingle(PackageName);
+			if (Packages->Num() == 0)
+			{
+				Callers.Remove(FunctionKey);
+			}
+		}
+	}
+}
+} // namespace VisualStudioTools
@@ -0,0 +1,77 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "BlueprintAssetHelpers.h"
+#include "CoreMinimal.h"
+
+namespace VisualStudioTools
+{
+/**
+* Persistent reverse call graph: for each native function, the blueprints that call it.
+*
+* The index is built once from `UBlueprintGeneratedClass::CalledFunctions` and stored on disk.
+* Each entry remembers the timestamp and size of its package file, so later updates only
+* reload the blueprints whose packages changed, were added or were explicitly marked dirty.
+* After an update, looking up the callers of a function is a hash lookup with no asset loading.
+*/
+class FBlueprintCallGraphIndex
+{
+public:
+	struct FBlueprintRecord
+	{
+		FString BlueprintName;
+		FString PackageFilePath;
+		FDateTime TimeStamp;
+		int64 FileSize = 0;
+
+		// Native functions called by the blueprint, see `MakeFunctionKey`.
+		TArray<FName> CalledFunctions;
+
+		friend FArchive& operator<<(FArchive& Ar, FBlueprintRecord& Record)
+		{
+			return Ar << Record.BlueprintName << Record.PackageFilePath << Record.TimeStamp << Record.FileSize << Record.CalledFunctions;
+		}
+	};
+
+	/** Default location of the index file for the current project. */
+	static FString GetDefaultFilePath();
+
+	/** Key of a native function in the index, using the owner class name without its prefix. */
+	static FName MakeFunctionKey(const FString& ClassNameWithoutPrefix, const FString& FunctionName);
+
+	/** Reads the index from disk. Returns false, leaving the index empty, if the file is missing or outdated. */
+	bool Load(const FString& FilePath);
+
+	bool Save(const FString& FilePath) const;
+
+	/**
+	* Brings the index up to date with the given blueprint assets.
+	* Entries for packages that are no longer present are removed, and only new, changed or
+	* dirty packages are loaded. Returns whether any entry was added, reloaded or removed, i.e.
+	* whether the index needs to be saved.
+	*/
+	bool Update(const TArray<FAssetData>& BlueprintAssets, const AssetHelpers::FForEachAssetOptions& LoadOptions);
+
+	/** Forces the package to be reloaded on the next update, even if its file did not change. */
+	void MarkPackageDirty(FName PackageName);
+
+	/** Retrieves the blueprints calling the given function key. */
+	void FindCallers(FName FunctionKey, TArray<const FBlueprintRecord*>& OutCallers) const;
+
+	int32 Num() const { return Records.Num(); }
+
+private:
+	void AddToReverseIndex(FName PackageName, const FBlueprintRecord& Record);
+	void RemoveFromReverseIndex(FName PackageName, const FBlueprintRecord& Record);
+
+	// Records keyed by package name.
+	TMap<FName, FBlueprintRecord> Records;
+
+	// Function key to the packages of the blueprints calling it, derived from `Records`.
+	TMap<FName, TArray<FName>> Callers;
+
+	TSet<FName> DirtyPackages;
+};
+} // namespace VisualStudioTools
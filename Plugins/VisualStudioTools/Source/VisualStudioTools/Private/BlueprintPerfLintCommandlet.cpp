@@ -0,0 +1,788 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#include "BlueprintPerfLintCommandlet.h"
+
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "BlueprintAssetHelpers.h"
+#include "Components/ActorComponent.h"
+#include "EdGraphSchema_K2.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "GameFramework/Actor.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_CustomEvent.h"
+#include "K2Node_Event.h"
+#include "K2Node_FunctionEntry.h"
+#include "K2Node_MacroInstance.h"
+#include "Misc/FileHelper.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "VisualStudioTools.h"
+
+namespace VisualStudioTools
+{
+enum class ELintSeverity : uint8
+{
+	Info,
+	Warning,
+	Error,
+};
+
+static const TCHAR* LexToString(ELintSeverity Severity)
+{
+	switch (Severity)
+	{
+	case ELintSeverity::Error:
+		return TEXT("error");
+	case ELintSeverity::Warning:
+		return TEXT("warning");
+	default:
+		return TEXT("info");
+	}
+}
+
+static bool LexTryParseString(ELintSeverity& OutSeverity, const FString& Value)
+{
+	for (ELintSeverity Severity : { ELintSeverity::Info, ELintSeverity::Warning, ELintSeverity::Error })
+	{
+		if (Value.Equals(LexToString(Severity), ESearchCase::IgnoreCase))
+		{
+			OutSeverity = Severity;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/** Part of the blueprint a call rule applies to. */
+enum class ELintScope : uint8
+{
+	// Any graph of the blueprint, from the compiled `CalledFunctions`.
+	Any,
+	// The nodes executed from the Tick event.
+	Tick,
+	// The nodes executed from the construction script.
+	Construction,
+};
+
+struct FLintRule
+{
+	enum class EType : uint8
+	{
+		// Tick enabled at start with the Tick event implemented, at an interval up to `MaxTickInterval`.
+		Tick,
+		// Tick enabled at start without the Tick event implemented in the blueprint.
+		TickWithoutEvent,
+		// Calls to any of `Functions` in `Scope`.
+		Call,
+		// Construction scripts executing more than `MaxNodes` nodes.
+		ConstructionScript,
+	};
+
+	FString Id;
+	EType Type = EType::Call;
+	ELintSeverity Severity = ELintSeverity::Warning;
+
+	ELintScope Scope = ELintScope::Any;
+
+	// For `Any` rules, calls made only from this scope are left to the rules of that scope.
+	TOptional<ELintScope> ExcludedScope;
+
+	// Native functions keyed by their class name without prefix, or `*` for any function of the class.
+	TMultiMap<FString, FString> Functions;
+
+	double MaxTickInterval = 0.0;
+	int32 MaxNodes = 0;
+};
+
+/**
+* Rules used when no rule file is given. The rule files use the same format.
+*/
+static constexpr auto DefaultRulesJson = TEXT(R"json({
+	"rules": [
+		{ "id": "tick-every-frame", "type": "tick", "severity": "warning", "maxInterval": 0.0 },
+		{ "id": "tick-without-event", "type": "tick-without-event", "severity": "info" },
+		{
+			"id": "get-all-actors-in-tick", "type": "call", "scope": "tick", "severity": "error",
+			"functions": [
+				"UGameplayStatics::GetAllActorsOfClass",
+				"UGameplayStatics::GetAllActorsOfClassWithTag",
+				"UGameplayStatics::GetAllActorsWithInterface",
+				"UGameplayStatics::GetAllActorsWithTag"
+			]
+		},
+		{
+			"id": "get-all-actors", "type": "call", "scope": "any", "excludeScope": "tick", "severity": "warning",
+			"functions": [
+				"UGameplayStatics::GetAllActorsOfClass",
+				"UGameplayStatics::GetAllActorsOfClassWithTag",
+				"UGameplayStatics::GetAllActorsWithInterface",
+				"UGameplayStatics::GetAllActorsWithTag"
+			]
+		},
+		{
+			"id": "component-lookup-in-tick", "type": "call", "scope": "tick", "severity": "warning",
+			"functions": [
+				"AActor::GetComponentByClass",
+				"AActor::K2_GetComponentsByClass",
+				"AActor::GetComponentsByTag",
+				"AActor::GetComponentsByInterface"
+			]
+		},
+		{
+			"id": "string-in-tick", "type": "call", "scope": "tick", "severity": "warning",
+			"functions": [
+				"UKismetStringLibrary::*",
+				"UKismetTextLibrary::*",
+				"UKismetSystemLibrary::PrintString",
+				"UKismetSystemLibrary::PrintText"
+			]
+		},
+		{
+			"id": "blocking-load", "type": "call", "scope": "any", "severity": "warning",
+			"functions": [
+				"UKismetSystemLibrary::LoadAsset_Blocking",
+				"UKismetSystemLibrary::LoadClassAsset_Blocking"
+			]
+		},
+		{
+			"id": "spawn-in-construction", "type": "call", "scope": "construction", "severity": "warning",
+			"functions": [
+				"UGameplayStatics::BeginDeferredActorSpawnFromClass",
+				"UGameplayStatics::GetAllActorsOfClass"
+			]
+		},
+		{ "id": "large-construction-script", "type": "construction-script", "severity": "warning", "maxNodes": 100 }
+	]
+})json");
+
+static bool ParseRule(const TSharedPtr<FJsonObject>& RuleObject, FLintRule& OutRule)
+{
+	FString Type;
+	if (!RuleObject->TryGetStringField(TEXT("id"), OutRule.Id) || !RuleObject->TryGetStringField(TEXT("type"), Type))
+	{
+		UE_LOG(LogVisualStudioTools, Error, TEXT("Lint rules require an 'id' and a 'type'."));
+		return false;
+	}
+
+	FString Severity;
+	if (RuleObject->TryGetStringField(TEXT("severity"), Severity) && !LexTryParseString(OutRule.Severity, Severity))
+	{
+		UE_LOG(LogVisualStudioTools, Error, TEXT("Lint rule '%s' has an invalid severity: %s"), *OutRule.Id, *Severity);
+		return false;
+	}
+
+	if (Type == TEXT("tick"))
+	{
+		OutRule.Type = FLintRule::EType::Tick;
+		RuleObject->TryGetNumberField(TEXT("maxInterval"), OutRule.MaxTickInterval);
+	}
+	else if (Type == TEXT("tick-without-event"))
+	{
+		OutRule.Type = FLintRule::EType::TickWithoutEvent;
+	}
+	else if (Type == TEXT("construction-script"))
+	{
+		OutRule.Type = FLintRule::EType::ConstructionScript;
+		RuleObject->TryGetNumberField(TEXT("maxNodes"), OutRule.MaxNodes);
+	}
+	else if (Type == TEXT("call"))
+	{
+		OutRule.Type = FLintRule::EType::Call;
+
+		FString Scope = TEXT("any");
+		RuleObject->TryGetStringField(TEXT("scope"), Scope);
+		if (Scope == TEXT("tick"))
+		{
+			OutRule.Scope = ELintScope::Tick;
+		}
+		else if (Scope == TEXT("construction"))
+		{
+			OutRule.Scope = ELintScope::Construction;
+		}
+		else if (Scope != TEXT("any"))
+		{
+			UE_LOG(LogVisualStudioTools, Error, TEXT("Lint rule '%s' has an invalid scope: %s"), *OutRule.Id, *Scope);
+			return false;
+		}
+
+		FString ExcludedScope;
+		if (RuleObject->TryGetStringField(TEXT("excludeScope"), ExcludedScope))
+		{
+			if (OutRule.Scope != ELintScope::Any)
+			{
+				UE_LOG(LogVisualStudioTools, Error, TEXT("Lint rule '%s' can only exclude a scope with the 'any' scope."), *OutRule.Id);
+				return false;
+			}
+			else if (ExcludedScope == TEXT("tick"))
+			{
+				OutRule.ExcludedScope = ELintScope::Tick;
+			}
+			else if (ExcludedScope == TEXT("construction"))
+			{
+				OutRule.ExcludedScope = ELintScope::Construction;
+			}
+			else
+			{
+				UE_LOG(LogVisualStudioTools, Error, TEXT("Lint rule '%s' has an invalid excluded scope: %s"), *OutRule.Id, *ExcludedScope);
+				return false;
+			}
+		}
+
+		TArray<FString> Functions;
+		RuleObject->TryGetStringArrayField(TEXT("functions"), Functions);
+		for (const FString& Function : Functions)
+		{
+			FString ClassName;
+			FString FunctionName;
+			if (!Function.Split(TEXT("::"), &ClassName, &FunctionName))
+			{
+				UE_LOG(LogVisualStudioTools, Error, TEXT("Lint rule '%s' function should be in the qualified 'NativeClassName::MethodName' format: %s"), *OutRule.Id, *Function);
+				return false;
+			}
+
+			// The class names of the called functions are compared without their prefix.
+			if (ClassName.Len() > 1 && (ClassName[0] == TEXT('U') || ClassName[0] == TEXT('A')))
+			{
+				ClassName.RightChopInline(1);
+			}
+
+			OutRule.Functions.Add(ClassName, FunctionName);
+		}
+	}
+	else
+	{
+		UE_LOG(LogVisualStudioTools, Error, TEXT("Lint rule '%s' has an unknown type: %s"), *OutRule.Id, *Type);
+		return false;
+	}
+
+	return true;
+}
+
+static bool ParseRules(const FString& RulesJson, TArray<FLintRule>& OutRules)
+{
+	TSharedPtr<FJsonObject> Root;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(RulesJson), Root) || !Root.IsValid())
+	{
+		UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to parse the lint rules."));
+		return false;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* RuleValues = nullptr;
+	if (!Root->TryGetArrayField(TEXT("rules"), RuleValues))
+	{
+		UE_LOG(LogVisualStudioTools, Error, TEXT("The lint rules require a 'rules' array."));
+		return false;
+	}
+
+	for (const TSharedPtr<FJsonValue>& RuleValue : *RuleValues)
+	{
+		const TSharedPtr<FJsonObject>* RuleObject = nullptr;
+		if (!RuleValue->TryGetObject(RuleObject) || !ParseRule(*RuleObject, OutRules.AddDefaulted_GetRef()))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+struct FLintIssue
+{
+	FString RuleId;
+	ELintSeverity Severity = ELintSeverity::Info;
+	FString Message;
+};
+
+struct FLintResult
+{
+	FString Name;
+	FString Path;
+	TArray<FLintIssue> Issues;
+};
+
+static const FName ReceiveTickName = TEXT("ReceiveTick");
+
+/**
+* Finds the nodes where the execution of the blueprint's own function or custom event starts.
+* Functions inherited from parent blueprints are not followed.
+*/
+static void FindFunctionEntryNodes(UBlueprint* Blueprint, FName FunctionName, TArray<UEdGraphNode*>& OutNodes)
+{
+	for (UEdGraph* Graph : Blueprint->FunctionGraphs)
+	{
+		if (Graph && Graph->GetFName() == FunctionName)
+		{
+			for (UEdGraphNode* Node : Graph->Nodes)
+			{
+				if (Node && Node->IsA<UK2Node_FunctionEntry>())
+				{
+					OutNodes.Add(Node);
+				}
+			}
+		}
+	}
+
+	for (UEdGraph* Graph : Blueprint->UbergraphPages)
+	{
+		if (!Graph)
+		{
+			continue;
+		}
+
+		for (UEdGraphNode* Node : Graph->Nodes)
+		{
+			const UK2Node_CustomEvent* CustomEvent = Cast<UK2Node_CustomEvent>(Node);
+			if (CustomEvent && CustomEvent->CustomFunctionName == FunctionName)
+			{
+				OutNodes.Add(Node);
+			}
+		}
+	}
+}
+
+/**
+* Collects the nodes executed from the root nodes: the nodes linked to their exec outputs, the pure
+* nodes feeding their inputs, the nodes of the macros they expand, and the graphs of the blueprint's
+* own functions and custom events they call.
+*/
+static void CollectReachableNodes(UBlueprint* Blueprint, TArray<UEdGraphNode*> PendingNodes, TSet<UEdGraphNode*>& OutNodes)
+{
+	while (PendingNodes.Num() > 0)
+	{
+		UEdGraphNode* Node = PendingNodes.Pop(EAllowShrinking::No);
+		if (!Node || OutNodes.Contains(Node))
+		{
+			continue;
+		}
+
+		OutNodes.Add(Node);
+
+		for (const UEdGraphPin* Pin : Node->Pins)
+		{
+			const bool bExecPin = Pin->PinType.PinCategory == UEdGraphSchema_K2::PC_Exec;
+			for (const UEdGraphPin* LinkedPin : Pin->LinkedTo)
+			{
+				UEdGraphNode* LinkedNode = LinkedPin->GetOwningNode();
+				const UK2Node* LinkedK2Node = Cast<UK2Node>(LinkedNode);
+
+				// Follow the execution forward, and the data back to the pure nodes evaluated for this node.
+				if ((bExecPin && Pin->Direction == EGPD_Output)
+					|| (!bExecPin && Pin->Direction == EGPD_Input && LinkedK2Node && LinkedK2Node->IsNodePure()))
+				{
+					PendingNodes.Add(LinkedNode);
+				}
+			}
+		}
+
+		if (const UK2Node_MacroInstance* MacroInstance = Cast<UK2Node_MacroInstance>(Node))
+		{
+			// Conservatively consider every node of the macro as executed.
+			if (const UEdGraph* MacroGraph = MacroInstance->GetMacroGraph())
+			{
+				for (UEdGraphNode* MacroNode : MacroGraph->Nodes)
+				{
+					PendingNodes.Add(MacroNode);
+				}
+			}
+		}
+		else if (const UK2Node_CallFunction* CallNode = Cast<UK2Node_CallFunction>(Node))
+		{
+			FindFunctionEntryNodes(Blueprint, CallNode->FunctionReference.GetMemberName(), PendingNodes);
+		}
+	}
+}
+
+static bool MatchesFunction(const FLintRule& Rule, const UFunction* Function)
+{
+	if (!Function || !Function->HasAnyFunctionFlags(EFunctionFlags::FUNC_Native))
+	{
+		return false;
+	}
+
+	const FString FunctionName = Function->GetName();
+	for (auto It = Rule.Functions.CreateConstKeyIterator(Function->GetOwnerClass()->GetName()); It; ++It)
+	{
+		if (It.Value() == TEXT("*") || It.Value() == FunctionName)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static FString GetQualifiedName(const UFunction* Function)
+{
+	return FString::Printf(TEXT("%s::%s"), *Function->GetOwnerClass()->GetName(), *Function->GetName());
+}
+
+/**
+* Finds the Tick event the blueprint runs: its own, or the nearest one in its parent blueprints.
+* @return The blueprint owning the event graph with the Tick event, or nullptr if none implements it.
+*/
+static UBlueprint* FindTickEventNodes(UBlueprint* Blueprint, TArray<UEdGraphNode*>& OutNodes)
+{
+	for (UBlueprint* Current = Blueprint; Current; Current = UBlueprint::GetBlueprintFromClass(Cast<UBlueprintGeneratedClass>(Current->ParentClass)))
+	{
+		for (UEdGraph* Graph : Current->UbergraphPages)
+		{
+			if (!Graph)
+			{
+				continue;
+			}
+
+			for (UEdGraphNode* Node : Graph->Nodes)
+			{
+				const UK2Node_Event* EventNode = Cast<UK2Node_Event>(Node);
+				if (EventNode && !EventNode->IsA<UK2Node_CustomEvent>() && EventNode->EventReference.GetMemberName() == ReceiveTickName)
+				{
+					OutNodes.Add(Node);
+				}
+			}
+		}
+
+		if (OutNodes.Num() > 0)
+		{
+			return Current;
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+* Collects the functions called from the blueprint's graphs outside of `ExcludedNodes`, including
+* the calls inside the macros used there.
+*/
+static void CollectCallsOutside(UBlueprint* Blueprint, const TSet<UEdGraphNode*>& ExcludedNodes, TSet<const UFunction*>& OutFunctions)
+{
+	auto AddCall = [&OutFunctions](const UEdGraphNode* Node)
+	{
+		if (const UK2Node_CallFunction* CallNode = Cast<UK2Node_CallFunction>(Node))
+		{
+			OutFunctions.Add(CallNode->GetTargetFunction());
+		}
+	};
+
+	TArray<UEdGraph*> Graphs;
+	Blueprint->GetAllGraphs(Graphs);
+	for (const UEdGraph* Graph : Graphs)
+	{
+		for (UEdGraphNode* Node : Graph->Nodes)
+		{
+			if (!Node || ExcludedNodes.Contains(Node))
+			{
+				continue;
+			}
+
+			AddCall(Node);
+
+			const UK2Node_MacroInstance* MacroInstance = Cast<UK2Node_MacroInstance>(Node);
+			if (const UEdGraph* MacroGraph = MacroInstance ? MacroInstance->GetMacroGraph() : nullptr)
+			{
+				for (const UEdGraphNode* MacroNode : MacroGraph->Nodes)
+				{
+					AddCall(MacroNode);
+				}
+			}
+		}
+	}
+}
+
+/** Checks the blueprint against all the rules. */
+static void LintBlueprint(UBlueprintGeneratedClass* BlueprintClass, const TArray<FLintRule>& Rules, TArray<FLintIssue>& OutIssues)
+{
+	UBlueprint* Blueprint = UBlueprint::GetBlueprintFromClass(BlueprintClass);
+
+	// Tick settings from the class defaults.
+	const FTickFunction* TickFunction = nullptr;
+	if (const AActor* ActorDefaults = Cast<AActor>(BlueprintClass->GetDefaultObject()))
+	{
+		TickFunction = &ActorDefaults->PrimaryActorTick;
+	}
+	else if (const UActorComponent* ComponentDefaults = Cast<UActorComponent>(BlueprintClass->GetDefaultObject()))
+	{
+		TickFunction = &ComponentDefaults->PrimaryComponentTick;
+	}
+
+	const bool bTickEnabled = TickFunction && TickFunction->bCanEverTick && TickFunction->bStartWithTickEnabled;
+
+	// Nodes executed from the Tick event and from the construction script. An inherited Tick event
+	// runs in this blueprint too, its functions are looked up in the blueprint that implements it.
+	TArray<UEdGraphNode*> TickRoots;
+	TArray<UEdGraphNode*> ConstructionRoots;
+	UBlueprint* TickBlueprint = nullptr;
+	if (Blueprint)
+	{
+		TickBlueprint = FindTickEventNodes(Blueprint, TickRoots);
+		FindFunctionEntryNodes(Blueprint, UEdGraphSchema_K2::FN_UserConstructionScript, ConstructionRoots);
+	}
+
+	TSet<UEdGraphNode*> TickNodes;
+	TSet<UEdGraphNode*> ConstructionNodes;
+	CollectReachableNodes(TickBlueprint, TickRoots, TickNodes);
+	CollectReachableNodes(Blueprint, ConstructionRoots, ConstructionNodes);
+
+	auto AddIssue = [&](const FLintRule& Rule, FString&& Message)
+	{
+		OutIssues.Add(FLintIssue{ Rule.Id, Rule.Severity, MoveTemp(Message) });
+	};
+
+	auto CheckCalls = [&](const FLintRule& Rule, const TSet<UEdGraphNode*>& Nodes, const TCHAR* ScopeName)
+	{
+		TSet<const UFunction*> Reported;
+		for (const UEdGraphNode* Node : Nodes)
+		{
+			const UK2Node_CallFunction* CallNode = Cast<UK2Node_CallFunction>(Node);
+			const UFunction* Function = CallNode ? CallNode->GetTargetFunction() : nullptr;
+			if (MatchesFunction(Rule, Function) && !Reported.Contains(Function))
+			{
+				Reported.Add(Function);
+				AddIssue(Rule, FString::Printf(TEXT("Calls %s from %s."), *GetQualifiedName(Function), ScopeName));
+			}
+		}
+	};
+
+	for (const FLintRule& Rule : Rules)
+	{
+		switch (Rule.Type)
+		{
+		case FLintRule::EType::Tick:
+			if (bTickEnabled && TickRoots.Num() > 0 && TickFunction->TickInterval <= Rule.MaxTickInterval)
+			{
+				AddIssue(Rule, FString::Printf(TEXT("Implements the Tick event with a tick interval of %g seconds."), TickFunction->TickInterval));
+			}
+			break;
+
+		case FLintRule::EType::TickWithoutEvent:
+			if (bTickEnabled && Blueprint && TickRoots.Num() == 0)
+			{
+				AddIssue(Rule, TEXT("Tick is enabled but the blueprint does not implement the Tick event."));
+			}
+			break;
+
+		case FLintRule::EType::ConstructionScript:
+			if (ConstructionNodes.Num() > Rule.MaxNodes)
+			{
+				AddIssue(Rule, FString::Printf(TEXT("The construction script executes %d nodes, more than %d."), ConstructionNodes.Num(), Rule.MaxNodes));
+			}
+			break;
+
+		case FLintRule::EType::Call:
+			if (Rule.Scope == ELintScope::Tick)
+			{
+				CheckCalls(Rule, TickNodes, TEXT("the Tick event"));
+			}
+			else if (Rule.Scope == ELintScope::Construction)
+			{
+				CheckCalls(Rule, ConstructionNodes, TEXT("the construction script"));
+			}
+			else
+			{
+				// Same call graph as the blueprint references, so cooked blueprints without graphs are covered too.
+				// Their calls cannot be told apart by scope, so nothing is excluded for them.
+				TSet<const UFunction*> ExcludedCalls;
+				TSet<const UFunction*> OtherCalls;
+				if (Rule.ExcludedScope.IsSet() && Blueprint)
+				{
+					const TSet<UEdGraphNode*>& ExcludedNodes = Rule.ExcludedScope.GetValue() == ELintScope::Tick ? TickNodes : ConstructionNodes;
+					for (const UEdGraphNode* Node : ExcludedNodes)
+					{
+						if (const UK2Node_CallFunction* CallNode = Cast<UK2Node_CallFunction>(Node))
+						{
+							ExcludedCalls.Add(CallNode->GetTargetFunction());
+						}
+					}
+					CollectCallsOutside(Blueprint, ExcludedNodes, OtherCalls);
+				}
+
+				TSet<const UFunction*> Reported;
+				for (const UFunction* Function : BlueprintClass->CalledFunctions)
+				{
+					if (ExcludedCalls.Contains(Function) && !OtherCalls.Contains(Function))
+					{
+						continue;
+					}
+
+					if (MatchesFunction(Rule, Function) && !Reported.Contains(Function))
+					{
+						Reported.Add(Function);
+						AddIssue(Rule, FString::Printf(TEXT("Calls %s."), *GetQualifiedName(Function)));
+					}
+				}
+			}
+			break;
+		}
+	}
+}
+
+using JsonWriter = TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>;
+
+static void SerializeResults(const TArray<FLintResult>& Results, int32 TotalAssetCount, FArchive& OutArchive)
+{
+	TSharedRef<JsonWriter> Json = JsonWriter::Create(&OutArchive);
+	Json->WriteObjectStart();
+
+	int32 IssueCount = 0;
+	Json->WriteIdentifierPrefix(TEXT("blueprints"));
+	Json->WriteArrayStart();
+	for (const FLintResult& Result : Results)
+	{
+		Json->WriteObjectStart();
+		Json->WriteValue(TEXT("name"), Result.Name);
+		Json->WriteValue(TEXT("path"), Result.Path);
+
+		Json->WriteIdentifierPrefix(TEXT("issues"));
+		Json->WriteArrayStart();
+		for (const FLintIssue& Issue : Result.Issues)
+		{
+			Json->WriteObjectStart();
+			Json->WriteValue(TEXT("rule"), Issue.RuleId);
+			Json->WriteValue(TEXT("severity"), LexToString(Issue.Severity));
+			Json->WriteValue(TEXT("message"), Issue.Message);
+			Json->WriteObjectEnd();
+		}
+		Json->WriteArrayEnd();
+
+		Json->WriteObjectEnd();
+		IssueCount += Result.Issues.Num();
+	}
+	Json->WriteArrayEnd();
+
+	Json->WriteIdentifierPrefix(TEXT("metadata"));
+	Json->WriteObjectStart();
+	{
+		Json->WriteValue(TEXT("asset_count"), TotalAssetCount);
+		Json->WriteValue(TEXT("issue_count"), IssueCount);
+	}
+	Json->WriteObjectEnd();
+
+	Json->WriteObjectEnd();
+	Json->Close();
+}
+} // namespace VisualStudioTools
+
+static constexpr auto RulesParam = TEXT("rules");
+static constexpr auto PathsParam = TEXT("paths");
+static constexpr auto FailOnParam = TEXT("failon");
+
+UVsBlueprintPerfLintCommandlet::UVsBlueprintPerfLintCommandlet()
+	: Super()
+{
+	HelpDescription = TEXT("Commandlet for reporting known expensive patterns in blueprints.");
+
+	HelpParamNames.Add(RulesParam);
+	HelpParamDescriptions.Add(TEXT("[Optional] Path to a json file with the lint rules, replacing the default rules."));
+
+	HelpParamNames.Add(PathsParam);
+	HelpParamDescriptions.Add(TEXT("[Optional] Comma separated list of content paths to scan recursively. Defaults to '/Game'."));
+
+	HelpParamNames.Add(FailOnParam);
+	HelpParamDescriptions.Add(TEXT("[Optional] Return an error code when an issue of this severity or higher is found: 'info', 'warning' or 'error'. The output is written either way."));
+
+	HelpUsage = TEXT("<Editor-Cmd.exe> <path_to_uproject> -run=VsBlueprintPerfLint -output=<path_to_output_file> [-rules=<path_to_rules_file>] [-paths=<content_path,...>] [-failon=<severity>] [-loadbatch=<count>] [-maxmemory=<megabytes>] [-unattended -noshadercompile -nosound -nullrhi -nocpuprofilertrace -nocrashreports -nosplash]");
+}
+
+int32 UVsBlueprintPerfLintCommandlet::Run(
+	TArray<FString>& Tokens,
+	TArray<FString>& Switches,
+	TMap<FString, FString>& ParamVals,
+	FArchive& OutArchive)
+{
+	using namespace VisualStudioTools;
+
+	FString RulesJson = DefaultRulesJson;
+	if (const FString* RulesFile = ParamVals.Find(RulesParam))
+	{
+		if (!FFileHelper::LoadFileToString(RulesJson, **RulesFile))
+		{
+			UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to read the rules file: %s"), **RulesFile);
+			return -1;
+		}
+	}
+
+	TArray<FLintRule> Rules;
+	if (!ParseRules(RulesJson, Rules))
+	{
+		PrintHelp();
+		return -1;
+	}
+
+	TOptional<ELintSeverity> FailOnSeverity;
+	if (const FString* FailOn = ParamVals.Find(FailOnParam))
+	{
+		ELintSeverity Severity;
+		if (!LexTryParseString(Severity, *FailOn))
+		{
+			UE_LOG(LogVisualStudioTools, Error, TEXT("Invalid severity: %s"), **FailOn);
+			PrintHelp();
+			return -1;
+		}
+
+		FailOnSeverity = Severity;
+	}
+
+	FARFilter Filter;
+	Filter.bRecursivePaths = true;
+	Filter.bRecursiveClasses = true;
+	AssetHelpers::SetBlueprintClassFilter(Filter);
+
+	TArray<FString> Paths;
+	ParamVals.FindRef(PathsParam).ParseIntoArray(Paths, TEXT(","));
+	if (Paths.Num() == 0)
+	{
+		Paths.Add(TEXT("/Game"));
+	}
+
+	for (const FString& Path : Paths)
+	{
+		Filter.PackagePaths.Add(FName(*Path.TrimStartAndEnd()));
+	}
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	TArray<FAssetData> TargetAssets;
+	AssetRegistry.GetAssets(Filter, TargetAssets);
+
+	if (TargetAssets.Num() == 0)
+	{
+		UE_LOG(LogVisualStudioTools, Warning, TEXT("No blueprints found in %s."), *FString::Join(Paths, TEXT(", ")));
+	}
+	else
+	{
+		UE_LOG(LogVisualStudioTools, Display, TEXT("Linting %d blueprints."), TargetAssets.Num());
+	}
+
+	TArray<FLintResult> Results;
+	bool bFailed = false;
+	AssetHelpers::ForEachAsset(TargetAssets,
+		[&](UBlueprintGeneratedClass* BlueprintClass, const FAssetData& AssetData)
+		{
+			TArray<FLintIssue> Issues;
+			LintBlueprint(BlueprintClass, Rules, Issues);
+			if (Issues.Num() == 0)
+			{
+				return;
+			}
+
+			for (const FLintIssue& Issue : Issues)
+			{
+				bFailed = bFailed || (FailOnSeverity.IsSet() && Issue.Severity >= FailOnSeverity.GetValue());
+			}
+
+			Results.Add(FLintResult{ BlueprintClass->GetName(), AssetHelpers::GetPackageFilePath(AssetData), MoveTemp(Issues) });
+		},
+		GetAssetLoadOptions(ParamVals));
+
+	SerializeResults(Results, TargetAssets.Num(), OutArchive);
+
+	UE_LOG(LogVisualStudioTools, Display, TEXT("Found issues in %d of %d blueprints."), Results.Num(), TargetAssets.Num());
+
+	return bFailed ? 1 : 0;
+}
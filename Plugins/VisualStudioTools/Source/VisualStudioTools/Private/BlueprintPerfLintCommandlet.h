@@ -0,0 +1,25 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VisualStudioToolsCommandletBase.h"
+
+#include "BlueprintPerfLintCommandlet.generated.h"
+
+UCLASS()
+class UVsBlueprintPerfLintCommandlet
+	: public UVisualStudioToolsCommandletBase
+{
+	GENERATED_BODY()
+
+public:
+	UVsBlueprintPerfLintCommandlet();
+
+	int32 Run(
+		TArray<FString>& Tokens,
+		TArray<FString>& Switches,
+		TMap<FString, FString>& ParamVals,
+		FArchive& OutArchive) override;
+};
@@ -7,13 +7,15 @@
 #include "Algo/Transform.h"
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "BlueprintAssetHelpers.h"
+#include "BlueprintCallGraphIndex.h"
 #include "Engine/BlueprintGeneratedClass.h"
 #include "FindInBlueprintManager.h"
 #include "JsonObjectConverter.h"
-#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
 #include "Misc/ScopeExit.h"
 #include "Policies/CondensedJsonPrintPolicy.h"
 #include "VisualStudioTools.h"
+#include "WarmAssetCache.h"
 
 namespace VisualStudioTools
 {
@@ -91,64 +93,177 @@ TArray<FAssetData> SearchForCandidateAssets(const FString& SearchQuery)
 }
 
 /**
-* Loads each blueprint asset and filters the collection to items which use the 
-* target UFunction in their call graph, matching the native class and function names.
+* A blueprint found by the search, with the full path of its package file.
 */
-TMap<FString, FAssetData> GetConfirmedAssets(
-	const FString& FunctionName, const FString& ClassNameWithoutPrefix, const TArray<FAssetData>& InAssets)
+struct FBlueprintReference
 {
-	TMap<FString, FAssetData> OutResults;
+	FString Name;
+	FString Path;
+};
 
+/**
+* A requested native function, along with the blueprints found to call it.
+*/
+struct FSymbolQuery
+{
+	FString Symbol;
+	FString FunctionName;
+	FString ClassNameWithoutPrefix;
+	TArray<FBlueprintReference> References;
+};
+
+/**
+* Loads each blueprint asset once and matches its call graph against all the requested symbols,
+* comparing the native class and function names. Symbols are looked up by function name, so
+* each called function is only compared with the symbols that share its name.
+*/
+void GetConfirmedAssets(
+	TArray<FSymbolQuery>& InOutQueries,
+	const TArray<FAssetData>& InAssets,
+	const AssetHelpers::FForEachAssetOptions& LoadOptions)
+{
+	TMultiMap<FName, int32> QueriesByFunctionName;
+	for (int32 Idx = 0; Idx < InOutQueries.Num(); Idx++)
+	{
+		QueriesByFunctionName.Add(FName(*InOutQueries[Idx].FunctionName), Idx);
+	}
+
+	TArray<int32, TInlineAllocator<8>> MatchingQueries;
 	AssetHelpers::ForEachAsset(InAssets,
-		[&](UBlueprintGeneratedClass* BlueprintClassName, const FAssetData AssetData)
+		[&](UBlueprintGeneratedClass* BlueprintClassName, const FAssetData& AssetData)
 		{
-			auto MatchingFunction = Algo::FindByPredicate(BlueprintClassName->CalledFunctions,
-				[&](const UFunction* Fn)
+			MatchingQueries.Reset();
+			for (const UFunction* Fn : BlueprintClassName->CalledFunctions)
+			{
+				if (!Fn || !Fn->HasAnyFunctionFlags(EFunctionFlags::FUNC_Native))
 				{
-					return Fn->HasAnyFunctionFlags(EFunctionFlags::FUNC_Native)
-						&& Fn->GetName() == FunctionName
-						&& Fn->GetOwnerClass()->GetName() == ClassNameWithoutPrefix;
-				});
+					continue;
+				}
+
+				for (auto It = QueriesByFunctionName.CreateConstKeyIterator(Fn->GetFName()); It; ++It)
+				{
+					if (Fn->GetOwnerClass()->GetName() == InOutQueries[It.Value()].ClassNameWithoutPrefix)
+					{
+						MatchingQueries.AddUnique(It.Value());
+					}
+				}
+			}
 
-			if (MatchingFunction != nullptr)
+			if (MatchingQueries.Num() > 0)
 			{
-				OutResults.Add(BlueprintClassName->GetName(), AssetData);
+				const FBlueprintReference Reference{ BlueprintClassName->GetName(), AssetHelpers::GetPackageFilePath(AssetData) };
+				for (int32 QueryIdx : MatchingQueries)
+				{
+					InOutQueries[QueryIdx].References.Add(Reference);
+				}
 			}
-		});
+		},
+		LoadOptions);
+}
+
+/**
+* Finds the callers of the requested functions in the persistent call graph index, updating it first.
+* Only the blueprints whose packages changed since the last query are loaded.
+* Returns the number of blueprints in the index.
+*/
+static int32 GetIndexedReferences(
+	TArray<FSymbolQuery>& InOutQueries,
+	const AssetHelpers::FForEachAssetOptions& LoadOptions)
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	// Only the project blueprints are indexed, engine content does not call the project functions.
+	TArray<FString> RootPaths;
+	AssetHelpers::GetProjectContentPaths(RootPaths);
+
+	FARFilter Filter;
+	Filter.bRecursivePaths = true;
+	Filter.bRecursiveClasses = true;
+	for (const FString& RootPath : RootPaths)
+	{
+		// Root paths end with a slash, package paths do not.
+		Filter.PackagePaths.Add(FName(*RootPath.LeftChop(1)));
+	}
+	AssetHelpers::SetBlueprintClassFilter(Filter);
+
+	TArray<FAssetData> BlueprintAssets;
+	AssetRegistry.GetAssets(Filter, BlueprintAssets);
+
+	FBlueprintCallGraphIndex LocalCallGraph;
+	const FBlueprintCallGraphIndex* CallGraphPtr = &LocalCallGraph;
+	if (FWarmAssetCache* WarmCache = FWarmAssetCache::Get())
+	{
+		// The server keeps the call graph in memory between requests.
+		CallGraphPtr = &WarmCache->GetCallGraph(BlueprintAssets, LoadOptions);
+	}
+	else
+	{
+		const FString IndexFilePath = FBlueprintCallGraphIndex::GetDefaultFilePath();
+		LocalCallGraph.Load(IndexFilePath);
+		if (LocalCallGraph.Update(BlueprintAssets, LoadOptions))
+		{
+			LocalCallGraph.Save(IndexFilePath);
+		}
+	}
 
-	return OutResults;
+	const FBlueprintCallGraphIndex& CallGraph = *CallGraphPtr;
+
+	TArray<const FBlueprintCallGraphIndex::FBlueprintRecord*> Callers;
+	for (FSymbolQuery& Query : InOutQueries)
+	{
+		Callers.Reset();
+		CallGraph.FindCallers(FBlueprintCallGraphIndex::MakeFunctionKey(Query.ClassNameWithoutPrefix, Query.FunctionName), Callers);
+
+		Algo::Transform(Callers, Query.References,
+			[](const FBlueprintCallGraphIndex::FBlueprintRecord* Record)
+			{
+				return FBlueprintReference{ Record->BlueprintName, Record->PackageFilePath };
+			});
+	}
+
+	return CallGraph.Num();
 }
-using JsonWriter = TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>;
 
-static void SerializeBlueprintReference(
-	TSharedRef<JsonWriter>& Json, const FString& BlueprintClassName, const FAssetData& Asset)
+/**
+* Creates a FiB search query for function nodes where the native name matches any of the requested symbols.
+*/
+static FString MakeSearchQuery(const TArray<FSymbolQuery>& Queries)
 {
-	FString PackageFileName;
-	FString PackageFile;
-	FString PackageFilePath;
-	if (FPackageName::TryConvertLongPackageNameToFilename(Asset.GetPackage()->GetName(), PackageFileName) &&
-		FPackageName::FindPackageFileWithoutExtension(PackageFileName, PackageFile))
+	TArray<FString> NameTerms;
+	for (const FSymbolQuery& Query : Queries)
+	{
+		NameTerms.AddUnique(FString::Printf(TEXT("\"Native Name\"=+%s"), *Query.FunctionName));
+	}
+
+	if (NameTerms.Num() == 1)
 	{
-		PackageFilePath = FPaths::ConvertRelativePathToFull(MoveTemp(PackageFile));
+		return FString::Printf(TEXT("Nodes(%s & ClassName=K2Node_CallFunction)"), *NameTerms[0]);
 	}
 
+	return FString::Printf(TEXT("Nodes((%s) & ClassName=K2Node_CallFunction)"), *FString::Join(NameTerms, TEXT(" | ")));
+}
+
+using JsonWriter = TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>;
+
+static void SerializeBlueprintReference(
+	TSharedRef<JsonWriter>& Json, const FBlueprintReference& Reference)
+{
 	Json->WriteObjectStart();
-	Json->WriteValue(TEXT("name"), BlueprintClassName);
-	Json->WriteValue(TEXT("path"), PackageFilePath);
+	Json->WriteValue(TEXT("name"), Reference.Name);
+	Json->WriteValue(TEXT("path"), Reference.Path);
 	Json->WriteObjectEnd();
 }
 
 static void SerializeBlueprints(
-	TSharedRef<JsonWriter>& Json, const TMap<FString, FAssetData>& InAssets)
+	TSharedRef<JsonWriter>& Json, const TArray<FBlueprintReference>& References)
 {
 	Json->WriteIdentifierPrefix(TEXT("blueprints"));
 	Json->WriteArrayStart();
 
-	for (auto& Item : InAssets)
+	for (const FBlueprintReference& Reference : References)
 	{
-		const FString& BlueprintClassName = Item.Key;
-		const FAssetData& Asset = Item.Value;
-		SerializeBlueprintReference(Json, BlueprintClassName, Asset);
+		SerializeBlueprintReference(Json, Reference);
 	}
 
 	Json->WriteArrayEnd();
@@ -165,15 +280,45 @@ static void SerializeMetadata(
 	Json->WriteObjectEnd();
 }
 
+static void SerializeSymbols(
+	TSharedRef<JsonWriter>& Json, const TArray<FSymbolQuery>& Queries)
+{
+	Json->WriteIdentifierPrefix(TEXT("symbols"));
+	Json->WriteArrayStart();
+
+	for (const FSymbolQuery& Query : Queries)
+	{
+		Json->WriteObjectStart();
+		Json->WriteValue(TEXT("symbol"), Query.Symbol);
+		SerializeBlueprints(Json, Query.References);
+		Json->WriteObjectEnd();
+	}
+
+	Json->WriteArrayEnd();
+}
+
+/**
+* Writes the results as a single `blueprints` list when only the `symbol` parameter was given,
+* keeping the original output format, or as a `symbols` list with the references for each symbol.
+*/
 static void SerializeResults(
-	const TMap<FString, FAssetData>& InAssets,
+	const TArray<FSymbolQuery>& Queries,
+	bool bSingleSymbol,
 	FArchive& OutArchive,
 	int TotalAssetCount)
 {
 	TSharedRef<JsonWriter> Json = JsonWriter::Create(&OutArchive);
 	Json->WriteObjectStart();
 
-	SerializeBlueprints(Json, InAssets);
+	if (bSingleSymbol)
+	{
+		SerializeBlueprints(Json, Queries[0].References);
+	}
+	else
+	{
+		SerializeSymbols(Json, Queries);
+	}
+
 	SerializeMetadata(Json, TotalAssetCount);
 
 	Json->WriteObjectEnd();
@@ -182,6 +327,70 @@ static void SerializeResults(
 } // namespace VisualStudioTools
 
 static constexpr auto SymbolParamVal = TEXT("symbol");
+static constexpr auto SymbolsParamVal = TEXT("symbols");
+static constexpr auto SymbolsFileParamVal = TEXT("symbolsfile");
+static constexpr auto CallGraphSwitch = TEXT("callgraph");
+
+namespace VisualStudioTools
+{
+/**
+* Collects the requested symbols from the `symbol`, `symbols` and `symbolsfile` parameters.
+* Returns false if any of them is not in the qualified 'NativeClassName::MethodName' format.
+*/
+static bool ParseSymbolQueries(const TMap<FString, FString>& ParamVals, TArray<FSymbolQuery>& OutQueries)
+{
+	TArray<FString> Symbols;
+	if (const FString* SymbolParam = ParamVals.Find(SymbolParamVal))
+	{
+		Symbols.Add(*SymbolParam);
+	}
+
+	if (const FString* SymbolsParam = ParamVals.Find(SymbolsParamVal))
+	{
+		TArray<FString> ParsedSymbols;
+		SymbolsParam->ParseIntoArray(ParsedSymbols, TEXT(","));
+		Symbols.Append(ParsedSymbols);
+	}
+
+	if (const FString* SymbolsFileParam = ParamVals.Find(SymbolsFileParamVal))
+	{
+		TArray<FString> FileSymbols;
+		if (!FFileHelper::LoadFileToStringArray(FileSymbols, **SymbolsFileParam))
+		{
+			UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to read the symbols file: %s"), **SymbolsFileParam);
+			return false;
+		}
+
+		Symbols.Append(FileSymbols);
+	}
+
+	TSet<FString> SeenSymbols;
+	for (FString& Symbol : Symbols)
+	{
+		Symbol.TrimStartAndEndInline();
+		if (Symbol.IsEmpty() || SeenSymbols.Contains(Symbol))
+		{
+			continue;
+		}
+
+		SeenSymbols.Add(Symbol);
+
+		FSymbolQuery Query;
+		FString ClassNameNative;
+		if (!Symbol.Split(TEXT("::"), &ClassNameNative, &Query.FunctionName))
+		{
+			UE_LOG(LogVisualStudioTools, Error, TEXT("Reference parameter should be in the qualified 'NativeClassName::MethodName' format: %s"), *Symbol);
+			return false;
+		}
+
+		Query.Symbol = Symbol;
+		Query.ClassNameWithoutPrefix = StripClassPrefix(ClassNameNative);
+		OutQueries.Add(MoveTemp(Query));
+	}
+
+	return true;
+}
+} // namespace VisualStudioTools
 
 UVsBlueprintReferencesCommandlet::UVsBlueprintReferencesCommandlet()
 	: Super()
@@ -191,7 +400,16 @@ UVsBlueprintReferencesCommandlet::UVsBlueprintReferencesCommandlet()
 	HelpParamNames.Add(SymbolParamVal);
 	HelpParamDescriptions.Add(TEXT("[Optional] Fully qualified symbol to search for in the blueprints."));
 
-	HelpUsage = TEXT("<Editor-Cmd.exe> <path_to_uproject> -run=VsBlueprintReferences -output=<path_to_output_file> -symbol=<ClassName::FunctionName> [-unattended -noshadercompile -nosound -nullrhi -nocpuprofilertrace -nocrashreports -nosplash]");
+	HelpParamNames.Add(SymbolsParamVal);
+	HelpParamDescriptions.Add(TEXT("[Optional] Comma separated list of fully qualified symbols to search for in a single pass. The results are listed per symbol."));
+
+	HelpParamNames.Add(SymbolsFileParamVal);
+	HelpParamDescriptions.Add(TEXT("[Optional] Path to a file with one fully qualified symbol per line, searched the same way as the 'symbols' parameter."));
+
+	HelpParamNames.Add(CallGraphSwitch);
+	HelpParamDescriptions.Add(TEXT("[Optional] Answer the query from the persistent call graph index instead of a blueprint search. The index is built on first use and updated for the changed packages only."));
+
+	HelpUsage = TEXT("<Editor-Cmd.exe> <path_to_uproject> -run=VsBlueprintReferences -output=<path_to_output_file> (-symbol=<ClassName::FunctionName> | -symbols=<ClassName::FunctionName,...> | -symbolsfile=<path_to_symbols_file>) [-callgraph] [-loadbatch=<count>] [-maxmemory=<megabytes>] [-unattended -noshadercompile -nosound -nullrhi -nocpuprofilertrace -nocrashreports -nosplash]");
 }
 
 int32 UVsBlueprintReferencesCommandlet::Run(
@@ -203,46 +421,63 @@ int32 UVsBlueprintReferencesCommandlet::Run(
 	using namespace VisualStudioTools;
 	GIsRunning = true; // Required for the blueprint search to work.
 
-	FString* ReferencesSymbol = ParamVals.Find(SymbolParamVal);
-	if (ReferencesSymbol->IsEmpty())
+	TArray<FSymbolQuery> Queries;
+	if (!ParseSymbolQueries(ParamVals, Queries))
 	{
-		UE_LOG(LogVisualStudioTools, Error, TEXT("Missing required symbol parameter."));
 		PrintHelp();
 		return -1;
 	}
 
-	FString FunctionName;
-	FString ClassNameNative;
-	if (!ReferencesSymbol->Split(TEXT("::"), &ClassNameNative, &FunctionName))
+	if (Queries.Num() == 0)
 	{
-		UE_LOG(LogVisualStudioTools, Error, TEXT("Reference parameter should be in the qualified 'NativeClassName::MethodName' format."));
+		UE_LOG(LogVisualStudioTools, Error, TEXT("Missing required symbol parameter."));
 		PrintHelp();
 		return -1;
 	}
 
-	// Execute the search in two stages:
-	// 1. Use FindInBlueprints to get all candidate blueprints with calls to functions that match the requested symbol
-	// 2. Confirm the blueprints reference the requested function, by matching the target UFunction in their call graph.
-	// The first step acts as a filter to avoid loading too many blueprints to inspect their call graph.
-	// The second step is required because the FiB data does not always allow for searching with the function
-	// qualified with the owned class name, if the function is static.
+	// Keep the original output format for single symbol queries.
+	const bool bSingleSymbol = !ParamVals.Contains(SymbolsParamVal) && !ParamVals.Contains(SymbolsFileParamVal);
+
+	// The server answers the queries from its warm call graph, without running a blueprint search.
+	// Unless the index was explicitly requested, an empty call graph falls back to the search.
+	const bool bCallGraphRequested = Switches.Contains(CallGraphSwitch);
+	int32 TotalAssetCount = 0;
+	bool bAnswered = false;
+	if (bCallGraphRequested || FWarmAssetCache::Get() != nullptr)
+	{
+		TotalAssetCount = GetIndexedReferences(Queries, GetAssetLoadOptions(ParamVals));
+		bAnswered = bCallGraphRequested || TotalAssetCount > 0;
+	}
+
+	if (!bAnswered)
+	{
+		// Execute the search in two stages:
+		// 1. Use FindInBlueprints to get all candidate blueprints with calls to functions that match the requested symbols
+		// 2. Confirm the blueprints reference the requested functions, by matching the target UFunctions in their call graph.
+		// The first step acts as a filter to avoid loading too many blueprints to inspect their call graph.
+		// The second step is required because the FiB data does not always allow for searching with the function
+		// qualified with the owned class name, if the function is static.
+		// All the symbols share a single search and each candidate is loaded only once.
+		FString SearchValue = MakeSearchQuery(Queries);
+
+		UE_LOG(LogVisualStudioTools, Display, TEXT("Blueprint search query: %s"), *SearchValue);
+
+		// Step 1: Execute the Fib search
+		TArray<FAssetData> TargetAssets = SearchForCandidateAssets(SearchValue);
 
-	FString ClassNameWithoutPrefix = StripClassPrefix(ClassNameNative);
-	
-	// Create a FiB search query for function nodes where the native name matches the requested symbol
-	FString SearchValue = FString::Printf(TEXT("Nodes(\"Native Name\"=+%s & ClassName=K2Node_CallFunction)"), *FunctionName);
-	
-	UE_LOG(LogVisualStudioTools, Display, TEXT("Blueprint search query: %s"), *SearchValue);
+		// Step 2: Load the assets to confirm they are a match
+		GetConfirmedAssets(Queries, TargetAssets, GetAssetLoadOptions(ParamVals));
 
-	// Step 1: Execute the Fib search
-	TArray<FAssetData> TargetAssets = SearchForCandidateAssets(SearchValue);
-	
-	// Step 2: Load the assets to confirm they are a match
-	TMap<FString, FAssetData> MatchAssets = GetConfirmedAssets(FunctionName, ClassNameWithoutPrefix, TargetAssets);
+		TotalAssetCount = TargetAssets.Num();
+	}
 
 	// Finally, write the results back to the output
-	SerializeResults(MatchAssets, OutArchive, TargetAssets.Num());
+	SerializeResults(Queries, bSingleSymbol, OutArchive, TotalAssetCount);
+
+	for (const FSymbolQuery& Query : Queries)
+	{
+		UE_LOG(LogVisualStudioTools, Display, TEXT("Found %d blueprints for %s."), Query.References.Num(), *Query.Symbol);
+	}
 
-	UE_LOG(LogVisualStudioTools, Display, TEXT("Found %d blueprints."), MatchAssets.Num());
 	return 0;
-}
\ No newline at end of file
+}
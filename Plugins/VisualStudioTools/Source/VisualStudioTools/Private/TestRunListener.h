@@ -0,0 +1,32 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace VisualStudioTools
+{
+/**
+* Receives the progress of a test run while it happens, in addition to the results file.
+* The server commandlet uses it to stream the events to the IDE.
+*/
+class ITestRunListener
+{
+public:
+	virtual ~ITestRunListener() = default;
+
+	virtual void OnTestStarted(const FString& TestCommand, const FString& DisplayName) = 0;
+
+	virtual void OnTestError(const FString& TestCommand, const FString& Message) = 0;
+
+	/** `Result` is the same as in the results file: OK, FAIL or REGRESSED. */
+	virtual void OnTestFinished(const FString& TestCommand, const FString& Result, double Duration) = 0;
+
+	/**
+	* Polled between the tests. A test that already started always runs to completion,
+	* since the automation framework cannot abort its latent commands.
+	*/
+	virtual bool IsCancelRequested() = 0;
+};
+} // namespace VisualStudioTools
@@ -0,0 +1,74 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "BlueprintCallGraphIndex.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+namespace VisualStudioTools
+{
+namespace CallGraphIndexTests
+{
+// Project blueprint known to call `UKismetSystemLibrary::PrintString`.
+static const TCHAR* KnownCallerPackage = TEXT("/Game/Mechanics/Player/Blueprints/BP_ThirdPersonCharacter");
+static const TCHAR* KnownCallerName = TEXT("BP_ThirdPersonCharacter_C");
+
+static bool ContainsCaller(const FBlueprintCallGraphIndex& CallGraph, FName FunctionKey, const FString& BlueprintName)
+{
+	TArray<const FBlueprintCallGraphIndex::FBlueprintRecord*> Callers;
+	CallGraph.FindCallers(FunctionKey, Callers);
+	return Callers.ContainsByPredicate([&](const FBlueprintCallGraphIndex::FBlueprintRecord* Record)
+		{
+			return Record->BlueprintName == BlueprintName;
+		});
+}
+} // namespace CallGraphIndexTests
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBlueprintCallGraphIndexTest, "VisualStudioTools.CallGraphIndex.FindCallers",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBlueprintCallGraphIndexTest::RunTest(const FString& Parameters)
+{
+	using namespace CallGraphIndexTests;
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	TArray<FAssetData> BlueprintAssets;
+	AssetRegistry.GetAssetsByPackageName(KnownCallerPackage, BlueprintAssets);
+	if (!TestEqual(TEXT("Known blueprint assets"), BlueprintAssets.Num(), 1))
+	{
+		return false;
+	}
+
+	const FName FunctionKey = FBlueprintCallGraphIndex::MakeFunctionKey(TEXT("KismetSystemLibrary"), TEXT("PrintString"));
+
+	FBlueprintCallGraphIndex CallGraph;
+	TestTrue(TEXT("Update of an empty index"), CallGraph.Update(BlueprintAssets, AssetHelpers::FForEachAssetOptions()));
+	TestEqual(TEXT("Indexed blueprints"), CallGraph.Num(), 1);
+	TestTrue(TEXT("Known caller found"), ContainsCaller(CallGraph, FunctionKey, KnownCallerName));
+	TestFalse(TEXT("Update without changes"), CallGraph.Update(BlueprintAssets, AssetHelpers::FForEachAssetOptions()));
+
+	// The callers must survive a round-trip through the index file.
+	const FString FilePath = FPaths::AutomationTransientDir() / TEXT("BlueprintCallGraph.bin");
+	TestTrue(TEXT("Index saved"), CallGraph.Save(FilePath));
+
+	FBlueprintCallGraphIndex LoadedCallGraph;
+	TestTrue(TEXT("Index loaded"), LoadedCallGraph.Load(FilePath));
+	TestTrue(TEXT("Known caller found after loading"), ContainsCaller(LoadedCallGraph, FunctionKey, KnownCallerName));
+	IFileManager::Get().Delete(*FilePath);
+
+	// Removed blueprints no longer report their calls.
+	TestTrue(TEXT("Update without blueprints"), LoadedCallGraph.Update(TArray<FAssetData>(), AssetHelpers::FForEachAssetOptions()));
+	TestFalse(TEXT("Removed caller not found"), ContainsCaller(LoadedCallGraph, FunctionKey, KnownCallerName));
+
+	return true;
+}
+} // namespace VisualStudioTools
+
+#endif // WITH_DEV_AUTOMATION_TESTS
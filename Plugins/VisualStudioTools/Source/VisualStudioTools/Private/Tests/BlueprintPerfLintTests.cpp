@@ -0,0 +1,51 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "BlueprintPerfLintCommandlet.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/StrongObjectPtr.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBlueprintPerfLintScanTest, "VisualStudioTools.PerfLint.ScansProjectBlueprints",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBlueprintPerfLintScanTest::RunTest(const FString& Parameters)
+{
+	TStrongObjectPtr<UVsBlueprintPerfLintCommandlet> Commandlet(NewObject<UVsBlueprintPerfLintCommandlet>());
+
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParamVals.Add(TEXT("paths"), TEXT("/Game"));
+
+	TArray<uint8> Output;
+	FMemoryWriter OutArchive(Output);
+	Commandlet->Run(Tokens, Switches, ParamVals, OutArchive);
+
+	// The results are written as TCHAR json.
+	const FString Json(Output.Num() / sizeof(TCHAR), reinterpret_cast<const TCHAR*>(Output.GetData()));
+
+	TSharedPtr<FJsonObject> Root;
+	if (!TestTrue(TEXT("Output is valid json"), FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Root) && Root.IsValid()))
+	{
+		return false;
+	}
+
+	const TSharedPtr<FJsonObject>* Metadata = nullptr;
+	if (!TestTrue(TEXT("Output has metadata"), Root->TryGetObjectField(TEXT("metadata"), Metadata)))
+	{
+		return false;
+	}
+
+	// The project content has blueprints, an empty scan means the class filter missed them.
+	TestTrue(TEXT("Blueprints scanned in /Game"), (*Metadata)->GetIntegerField(TEXT("asset_count")) > 0);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
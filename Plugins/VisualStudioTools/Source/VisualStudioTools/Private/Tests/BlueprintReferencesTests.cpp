@@ -0,0 +1,70 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "BlueprintReferencesCommandlet.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/StrongObjectPtr.h"
+#include "WarmAssetCache.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBlueprintReferencesServerTest, "VisualStudioTools.References.ServerMode",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBlueprintReferencesServerTest::RunTest(const FString& Parameters)
+{
+	using namespace VisualStudioTools;
+
+	// Answer the request the way the server does, against the warm cache.
+	const bool bOwnsCache = FWarmAssetCache::Get() == nullptr;
+	FWarmAssetCache::Initialize();
+	FWarmAssetCache::Get()->Refresh();
+
+	TStrongObjectPtr<UVsBlueprintReferencesCommandlet> Commandlet(NewObject<UVsBlueprintReferencesCommandlet>());
+
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParamVals.Add(TEXT("symbol"), TEXT("UKismetSystemLibrary::PrintString"));
+
+	TArray<uint8> Output;
+	FMemoryWriter OutArchive(Output);
+	const int32 Result = Commandlet->Run(Tokens, Switches, ParamVals, OutArchive);
+
+	if (bOwnsCache)
+	{
+		FWarmAssetCache::Shutdown();
+	}
+
+	TestEqual(TEXT("Commandlet result"), Result, 0);
+
+	// The results are written as TCHAR json.
+	const FString Json(Output.Num() / sizeof(TCHAR), reinterpret_cast<const TCHAR*>(Output.GetData()));
+
+	TSharedPtr<FJsonObject> Root;
+	if (!TestTrue(TEXT("Output is valid json"), FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Root) && Root.IsValid()))
+	{
+		return false;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Blueprints = nullptr;
+	if (!TestTrue(TEXT("Output has blueprints"), Root->TryGetArrayField(TEXT("blueprints"), Blueprints)))
+	{
+		return false;
+	}
+
+	// The player character is known to call PrintString.
+	const bool bFound = Blueprints->ContainsByPredicate([](const TSharedPtr<FJsonValue>& Value)
+		{
+			return Value->AsObject()->GetStringField(TEXT("name")) == TEXT("BP_ThirdPersonCharacter_C");
+		});
+	TestTrue(TEXT("Known reference found"), bFound);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
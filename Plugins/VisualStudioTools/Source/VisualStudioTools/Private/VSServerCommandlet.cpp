@@ -1,118 +1,255 @@
 // Copyright 2022 (c) Microsoft. All rights reserved.
 
 #include "VSServerCommandlet.h"
+#include "BlueprintPerfLintCommandlet.h"
+#include "BlueprintReferencesCommandlet.h"
+#include "TestRunListener.h"
+#include "VSServerTransport.h"
 #include "VSTestAdapterCommandlet.h"
+#include "VisualStudioToolsCommandlet.h"
+#include "WarmAssetCache.h"
 
-#include "Windows/AllowWindowsPlatformTypes.h"
-
-#include "HAL/PlatformNamedPipe.h"
-#include "Runtime/Core/Public/Async/TaskGraphInterfaces.h"
-#include "Runtime/Core/Public/Containers/Ticker.h"
-#include "Runtime/Engine/Classes/Engine/World.h"
-#include "Runtime/Engine/Public/TimerManager.h"
 #include "Runtime/Launch/Resources/Version.h"
-#include "Runtime\CoreUObject\Public\UObject\UObjectGlobals.h"
-#include <chrono>
-#include <codecvt>
-#include <fstream>
-#include <string>
-#include <thread>
-#include <windows.h>
-
-#include "Windows/HideWindowsPlatformTypes.h"
+#include "Runtime/CoreUObject/Public/UObject/UObjectGlobals.h"
+#include "Misc/ScopeExit.h"
+#include "UObject/StrongObjectPtr.h"
+#include <exception>
 
 #include "VisualStudioTools.h"
 
 static constexpr auto NamedPipeParam = TEXT("NamedPipe");
+static constexpr auto ServerProtocolParam = TEXT("ServerProtocol");
 static constexpr auto KillServerParam = TEXT("KillVSServer");
+static constexpr auto StreamEventsSwitch = TEXT("streamevents");
+static constexpr auto CancelTestsMessage = TEXT("CancelTests");
 
 UVSServerCommandlet::UVSServerCommandlet()
 {
 	HelpDescription = TEXT("Commandlet for Unreal Engine server mode.");
-	HelpUsage = TEXT("<Editor-Cmd.exe> <path_to_uproject> -run=VSServer [-stdout -multiprocess -silent -unattended -AllowStdOutLogVerbosity -NoShaderCompile]");
+	HelpUsage = TEXT("<Editor-Cmd.exe> <path_to_uproject> -run=VSServer -NamedPipe=<name> [-stdout -multiprocess -silent -unattended -AllowStdOutLogVerbosity -NoShaderCompile]");
 
 	HelpParamNames.Add(NamedPipeParam);
-	HelpParamDescriptions.Add(TEXT("[Required] The name of the named pipe used to communicate with Visual Studio."));
+	HelpParamDescriptions.Add(TEXT("[Required] The name of the endpoint used to communicate with Visual Studio. A named pipe on Windows, a UNIX domain socket elsewhere."));
+
+	HelpParamNames.Add(ServerProtocolParam);
+	HelpParamDescriptions.Add(TEXT("[Optional] Wire protocol spoken with the client. 1, the default, connects to the pipe created by Visual Studio and exchanges one raw request per connection. 2 creates the endpoint and keeps the connection open, with length-prefixed messages and test progress events. Other platforms always use 2."));
 
 	HelpParamNames.Add(KillServerParam);
 	HelpParamDescriptions.Add(TEXT("[Optional] Quit the server mode commandlet immediately."));
+
+	HelpParamNames.Add(StreamEventsSwitch);
+	HelpParamDescriptions.Add(TEXT("[Optional] Passed with a VSTestAdapter request, streams the start, error and finish events of each test before the response. Send 'CancelTests' during the run to stop after the current test."));
 }
 
-void UVSServerCommandlet::ExecuteSubCommandlet(FString ueServerNamedPipe)
+/**
+* Streams the progress of a test run to the client, as messages sent before the response of the request:
+*   @start|TestCommand|DisplayName
+*   @error|TestCommand|Message
+*   @finish|TestCommand|Result|Duration
+* The client can send `CancelTests` while the tests run to stop after the current test.
+*/
+class FTestEventStream : public VisualStudioTools::ITestRunListener
 {
-	char buffer[1024];
-	DWORD dwRead;
-	std::string result = "0";
-
-	// Open the named pipe.
-	std::wstring pipeName = L"\\\\.\\pipe\\";
-	pipeName.append(ueServerNamedPipe.GetCharArray().GetData());
-	HANDLE HPipe = CreateFile(pipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
-	if (HPipe != INVALID_HANDLE_VALUE)
-	{
-		ConnectNamedPipe(HPipe, NULL);
-		DWORD dwState;
-		BOOL bSuccess = GetNamedPipeHandleState(HPipe, &dwState, NULL, NULL, NULL, NULL, 0);
-		if (bSuccess)
+public:
+	explicit FTestEventStream(VisualStudioTools::FServerConnection& InConnection)
+		: Connection(InConnection)
+	{
+	}
+
+	virtual void OnTestStarted(const FString& TestCommand, const FString& DisplayName) override
+	{
+		Send(FString::Printf(TEXT("@start|%s|%s"), *TestCommand, *DisplayName));
+	}
+
+	virtual void OnTestError(const FString& TestCommand, const FString& Message) override
+	{
+		Send(FString::Printf(TEXT("@error|%s|%s"), *TestCommand, *Message));
+	}
+
+	virtual void OnTestFinished(const FString& TestCommand, const FString& Result, double Duration) override
+	{
+		Send(FString::Printf(TEXT("@finish|%s|%s|%g"), *TestCommand, *Result, Duration));
+	}
+
+	virtual bool IsCancelRequested() override
+	{
+		while (!bCancelled && Connection.HasPendingData())
 		{
-			// Read data from the named pipe.
-			ReadFile(HPipe, buffer, sizeof(buffer) - 1, &dwRead, NULL);
-			buffer[dwRead] = '\0';
-			std::string strSubCommandletParams(buffer, dwRead);
-			FString SubCommandletParams = FString(strSubCommandletParams.c_str());
-
-			// Determine which sub-commandlet to invoke, and write back result response.
-			if (SubCommandletParams.Contains("VSTestAdapter"))
+			FString Message;
+			if (!Connection.ReadMessage(Message))
 			{
-				UVSTestAdapterCommandlet *Commandlet = NewObject<UVSTestAdapterCommandlet>();
-				try
-				{
-					int32 subCommandletResult = Commandlet->Main(SubCommandletParams);
-				}
-				catch (const std::exception &ex)
-				{
-					UE_LOG(LogVisualStudioTools, Display, TEXT("Exception invoking VSTestAdapter commandlet: %s"), UTF8_TO_TCHAR(ex.what()));
-					result = "0";
-				}
+				// Nobody is left to report the results to.
+				UE_LOG(LogVisualStudioTools, Display, TEXT("Client disconnected during the test run."));
+				bCancelled = true;
 			}
-			else if (SubCommandletParams.Contains("KillVSServer"))
+			else if (Message.TrimStartAndEnd().Equals(CancelTestsMessage, ESearchCase::IgnoreCase))
 			{
-				// When KillVSServer is passed in, then kill the Unreal Editor process to end server mode.
-				exit(0);
+				bCancelled = true;
 			}
 			else
 			{
-				// If cannot find which sub-commandlet to run, then return error.
-				result = "1";
+				UE_LOG(LogVisualStudioTools, Warning, TEXT("Ignoring request received during the test run: %s"), *Message);
 			}
+		}
+
+		return bCancelled;
+	}
+
+private:
+	void Send(const FString& Message)
+	{
+		if (!bCancelled && !Connection.WriteMessage(Message))
+		{
+			UE_LOG(LogVisualStudioTools, Display, TEXT("Client disconnected during the test run."));
+			bCancelled = true;
+		}
+	}
+
+	VisualStudioTools::FServerConnection& Connection;
+	bool bCancelled = false;
+};
+
+template <typename CommandletType>
+static FString RunCommandlet(const FString& SubCommandletParams)
+{
+	// Keep the commandlet alive across the garbage collections of the asset scan.
+	TStrongObjectPtr<CommandletType> Commandlet(NewObject<CommandletType>());
+	return Commandlet->Main(SubCommandletParams) == 0 ? TEXT("0") : TEXT("1");
+}
+
+/**
+* Runs one of the index commandlets against the warm cache. Their output is written to the file
+* given in the request, and the response only reports whether the commandlet succeeded.
+*/
+template <typename CommandletType>
+static FString RunIndexCommandlet(const FString& SubCommandletParams)
+{
+	VisualStudioTools::FWarmAssetCache::Get()->Refresh();
+	return RunCommandlet<CommandletType>(SubCommandletParams);
+}
+
+FString UVSServerCommandlet::ExecuteSubCommandlet(const FString& SubCommandletParams, VisualStudioTools::FServerConnection& Connection, bool& bOutKillServer)
+{
+	FString Result = TEXT("0");
+
+	// Determine which sub-commandlet to invoke, and write back result response.
+	// Requests for the index commandlets name them with `-run=`, the same as on the command line.
+	FString SubCommandletName;
+	FParse::Value(*SubCommandletParams, TEXT("run="), SubCommandletName);
+
+	if (SubCommandletName.Equals(TEXT("VsBlueprintReferences"), ESearchCase::IgnoreCase))
+	{
+		Result = RunIndexCommandlet<UVsBlueprintReferencesCommandlet>(SubCommandletParams);
+	}
+	else if (SubCommandletName.Equals(TEXT("VisualStudioTools"), ESearchCase::IgnoreCase))
+	{
+		Result = RunIndexCommandlet<UVisualStudioToolsCommandlet>(SubCommandletParams);
+	}
+	else if (SubCommandletName.Equals(TEXT("VsBlueprintPerfLint"), ESearchCase::IgnoreCase))
+	{
+		// The lint scans the asset registry itself and does not use the cached index.
+		Result = RunCommandlet<UVsBlueprintPerfLintCommandlet>(SubCommandletParams);
+	}
+	else if (SubCommandletParams.Contains("VSTestAdapter"))
+	{
+		UVSTestAdapterCommandlet *Commandlet = NewObject<UVSTestAdapterCommandlet>();
+
+		// Clients that ask for the events receive them while the tests run, and can cancel the run.
+		// The legacy protocol has room for the response only.
+		FTestEventStream EventStream(Connection);
+		if (FParse::Param(*SubCommandletParams, StreamEventsSwitch) && Connection.GetProtocol() == VisualStudioTools::EServerProtocol::Framed)
+		{
+			Commandlet->SetTestRunListener(&EventStream);
+		}
 
-			WriteFile(HPipe, result.c_str(), result.size(), &dwRead, NULL);
+		try
+		{
+			Result = Commandlet->Main(SubCommandletParams) == 0 ? TEXT("0") : TEXT("1");
 		}
+		catch (const std::exception &ex)
+		{
+			UE_LOG(LogVisualStudioTools, Display, TEXT("Exception invoking VSTestAdapter commandlet: %s"), UTF8_TO_TCHAR(ex.what()));
+			Result = TEXT("1");
+		}
+
+		Commandlet->SetTestRunListener(nullptr);
+	}
+	else if (SubCommandletParams.Contains(KillServerParam))
+	{
+		// When KillVSServer is passed in, acknowledge the request and end server mode.
+		bOutKillServer = true;
 	}
+	else
+	{
+		// If cannot find which sub-commandlet to run, then return error.
+		Result = TEXT("1");
+	}
+
+	return Result;
 }
 
 int32 UVSServerCommandlet::Main(const FString &ServerParams)
 {
+	using namespace VisualStudioTools;
+
 	TArray<FString> Tokens;
 	TArray<FString> Switches;
 	TMap<FString, FString> ParamVals;
 
 	ParseCommandLine(*ServerParams, Tokens, Switches, ParamVals);
-	if (ParamVals.Contains(NamedPipeParam))
+	if (!ParamVals.Contains(NamedPipeParam))
 	{
-		FString ueServerNamedPipe = ParamVals[NamedPipeParam];
+		UE_LOG(LogVisualStudioTools, Display, TEXT("Missing named pipe parameter."));
+		return 1;
+	}
 
-		// Infinite loop that listens to requests every second.
-		while (true)
-		{
-			std::this_thread::sleep_for(std::chrono::seconds(1));
-			ExecuteSubCommandlet(ueServerNamedPipe);
-		}
+	int32 ProtocolVersion = static_cast<int32>(EServerProtocol::Legacy);
+	if (const FString* ProtocolParam = ParamVals.Find(ServerProtocolParam))
+	{
+		ProtocolVersion = FCString::Atoi(**ProtocolParam);
 	}
-	else
+
+	if (ProtocolVersion != static_cast<int32>(EServerProtocol::Legacy) && ProtocolVersion != static_cast<int32>(EServerProtocol::Framed))
 	{
-		UE_LOG(LogVisualStudioTools, Display, TEXT("Missing named pipe parameter."));
+		UE_LOG(LogVisualStudioTools, Error, TEXT("Unsupported server protocol %d."), ProtocolVersion);
+		return 1;
+	}
+
+	TUniquePtr<FServerListener> Listener = FServerListener::Create(ParamVals[NamedPipeParam], static_cast<EServerProtocol>(ProtocolVersion));
+	if (!Listener)
+	{
+		return 1;
+	}
+
+	// Keep the blueprint data in memory, so the index requests after the first one only reload the changed assets.
+	GIsRunning = true; // Required for the blueprint search to work.
+	FWarmAssetCache::Initialize();
+	ON_SCOPE_EXIT
+	{
+		FWarmAssetCache::Shutdown();
+	};
+
+	// Block until a client connects, then handle its requests as they arrive over the same connection.
+	// When the client disconnects, wait for the next one. Legacy connections carry a single request.
+	while (TUniquePtr<FServerConnection> Connection = Listener->Accept())
+	{
+		FString Request;
+		while (Connection->ReadMessage(Request))
+		{
+			bool bKillServer = false;
+			const FString Response = ExecuteSubCommandlet(Request, *Connection, bKillServer);
+
+			if (!Connection->WriteMessage(Response))
+			{
+				break;
+			}
+
+			if (bKillServer)
+			{
+				return 0;
+			}
+		}
 	}
 
 	return 1;
-}
\ No newline at end of file
+}
@@ -4,7 +4,6 @@
 #pragma once
 
 #include "Commandlets/Commandlet.h"
-#include <string>
 
 #include <Runtime/Core/Public/Misc/AutomationTest.h>
 #include <Runtime/CoreUObject/Public/UObject/ObjectMacros.h>
@@ -12,6 +11,11 @@
 
 #include "VSServerCommandlet.generated.h"
 
+namespace VisualStudioTools
+{
+class FServerConnection;
+}
+
 UCLASS()
 class UVSServerCommandlet
 	: public UCommandlet
@@ -25,5 +29,10 @@ public:
 	virtual int32 Main(const FString& Params) override;
 
 private:
-	void ExecuteSubCommandlet(FString ueServerNamedPipe);
+	/**
+	* Runs the sub-commandlet requested by the message and returns the response for the client.
+	* Test runs may stream their progress over the connection before the response.
+	* Sets bOutKillServer when the client asked the server to quit.
+	*/
+	FString ExecuteSubCommandlet(const FString& SubCommandletParams, VisualStudioTools::FServerConnection& Connection, bool& bOutKillServer);
 };
\ No newline at end of file
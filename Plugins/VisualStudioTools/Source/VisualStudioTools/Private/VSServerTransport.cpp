@@ -0,0 +1,460 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#include "VSServerTransport.h"
+
+#include "HAL/PlatformProcess.h"
+#include "Misc/Paths.h"
+#include "VisualStudioTools.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#else
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace VisualStudioTools
+{
+// Upper bound for a single message, to reject corrupted length prefixes.
+static constexpr uint32 MaxMessageSize = 256 * 1024 * 1024;
+
+// Legacy requests are sent in a single write without a length, so they are read in a single call.
+static constexpr int64 MaxLegacyRequestSize = 64 * 1024;
+
+bool FServerConnection::ReadMessage(FString& OutMessage)
+{
+	if (Protocol == EServerProtocol::Legacy)
+	{
+		if (bLegacyRequestRead)
+		{
+			return false;
+		}
+		bLegacyRequestRead = true;
+
+		TArray<uint8> Request;
+		Request.SetNumUninitialized(MaxLegacyRequestSize);
+		const int64 Size = ReadAvailable(Request.GetData(), Request.Num());
+		if (Size <= 0)
+		{
+			return false;
+		}
+
+		FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Request.GetData()), static_cast<int32>(Size));
+		OutMessage = FString(Converted.Length(), Converted.Get());
+		return true;
+	}
+
+	uint8 Header[4];
+	if (!ReadBytes(Header, sizeof(Header)))
+	{
+		return false;
+	}
+
+	const uint32 Size = uint32(Header[0]) | (uint32(Header[1]) << 8) | (uint32(Header[2]) << 16) | (uint32(Header[3]) << 24);
+	if (Size > MaxMessageSize)
+	{
+		UE_LOG(LogVisualStudioTools, Error, TEXT("Rejecting server message of %u bytes."), Size);
+		return false;
+	}
+
+	TArray<uint8> Payload;
+	Payload.SetNumUninitialized(Size);
+	if (Size > 0 && !ReadBytes(Payload.GetData(), Size))
+	{
+		return false;
+	}
+
+	FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Payload.GetData()), Payload.Num());
+	OutMessage = FString(Converted.Length(), Converted.Get());
+	return true;
+}
+
+bool FServerConnection::WriteMessage(const FString& Message)
+{
+	FTCHARToUTF8 Converted(*Message, Message.Len());
+	const uint32 Size = static_cast<uint32>(Converted.Length());
+
+	if (Protocol == EServerProtocol::Legacy)
+	{
+		return WriteBytes(reinterpret_cast<const uint8*>(Converted.Get()), Size);
+	}
+
+	TArray<uint8> Buffer;
+	Buffer.Reserve(sizeof(uint32) + Size);
+	Buffer.Add(uint8(Size));
+	Buffer.Add(uint8(Size >> 8));
+	Buffer.Add(uint8(Size >> 16));
+	Buffer.Add(uint8(Size >> 24));
+	Buffer.Append(reinterpret_cast<const uint8*>(Converted.Get()), Size);
+
+	// Send the header and payload together, so the client never waits on a partial frame.
+	return WriteBytes(Buffer.GetData(), Buffer.Num());
+}
+
+#if PLATFORM_WINDOWS
+
+class FNamedPipeConnection : public FServerConnection
+{
+public:
+	FNamedPipeConnection(HANDLE InPipe, EServerProtocol InProtocol)
+		: FServerConnection(InProtocol)
+		, Pipe(InPipe)
+	{
+	}
+
+	virtual ~FNamedPipeConnection() override
+	{
+		FlushFileBuffers(Pipe);
+
+		// With the legacy protocol the IDE owns the pipe, this end is only a client.
+		if (GetProtocol() == EServerProtocol::Framed)
+		{
+			DisconnectNamedPipe(Pipe);
+		}
+
+		CloseHandle(Pipe);
+	}
+
+	virtual bool HasPendingData() override
+	{
+		DWORD BytesAvailable = 0;
+		return !PeekNamedPipe(Pipe, nullptr, 0, nullptr, &BytesAvailable, nullptr) || BytesAvailable > 0;
+	}
+
+protected:
+	virtual bool ReadBytes(uint8* Data, int64 Size) override
+	{
+		while (Size > 0)
+		{
+			DWORD BytesRead = 0;
+			const DWORD BytesToRead = static_cast<DWORD>(FMath::Min<int64>(Size, MAXDWORD));
+			if (!ReadFile(Pipe, Data, BytesToRead, &BytesRead, nullptr) || BytesRead == 0)
+			{
+				return false;
+			}
+
+			Data += BytesRead;
+			Size -= BytesRead;
+		}
+
+		return true;
+	}
+
+	virtual bool WriteBytes(const uint8* Data, int64 Size) override
+	{
+		while (Size > 0)
+		{
+			DWORD BytesWritten = 0;
+			const DWORD BytesToWrite = static_cast<DWORD>(FMath::Min<int64>(Size, MAXDWORD));
+			if (!WriteFile(Pipe, Data, BytesToWrite, &BytesWritten, nullptr))
+			{
+				return false;
+			}
+
+			Data += BytesWritten;
+			Size -= BytesWritten;
+		}
+
+		return true;
+	}
+
+	virtual int64 ReadAvailable(uint8* Data, int64 MaxSize) override
+	{
+		DWORD BytesRead = 0;
+		const DWORD BytesToRead = static_cast<DWORD>(FMath::Min<int64>(MaxSize, MAXDWORD));
+		return ReadFile(Pipe, Data, BytesToRead, &BytesRead, nullptr) ? BytesRead : 0;
+	}
+
+private:
+	HANDLE Pipe;
+};
+
+/**
+* The framed protocol: the commandlet creates the pipe and keeps each client connected until it leaves.
+*/
+class FNamedPipeListener : public FServerListener
+{
+public:
+	explicit FNamedPipeListener(const FString& InPipeName)
+		: PipeName(FString(TEXT("\\\\.\\pipe\\")) + InPipeName)
+	{
+	}
+
+	virtual TUniquePtr<FServerConnection> Accept() override
+	{
+		static constexpr DWORD BufferSize = 64 * 1024;
+
+		HANDLE Pipe = CreateNamedPipeW(
+			*PipeName,
+			PIPE_ACCESS_DUPLEX,
+			PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+			1,
+			BufferSize,
+			BufferSize,
+			0,
+			nullptr);
+
+		if (Pipe == INVALID_HANDLE_VALUE)
+		{
+			UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to create named pipe %s (error %u)."), *PipeName, GetLastError());
+			return nullptr;
+		}
+
+		// Blocks until the client connects. The client may also have connected between the two calls.
+		if (!ConnectNamedPipe(Pipe, nullptr) && GetLastError() != ERROR_PIPE_CONNECTED)
+		{
+			UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to connect named pipe %s (error %u)."), *PipeName, GetLastError());
+			CloseHandle(Pipe);
+			return nullptr;
+		}
+
+		return MakeUnique<FNamedPipeConnection>(Pipe, EServerProtocol::Framed);
+	}
+
+private:
+	FString PipeName;
+};
+
+/**
+* The legacy protocol: the IDE creates a pipe instance for each request and waits for the commandlet to open it.
+*/
+class FNamedPipeClientListener : public FServerListener
+{
+public:
+	explicit FNamedPipeClientListener(const FString& InPipeName)
+		: PipeName(FString(TEXT("\\\\.\\pipe\\")) + InPipeName)
+	{
+	}
+
+	virtual TUniquePtr<FServerConnection> Accept() override
+	{
+		// Time between the attempts while the IDE has no pipe instance waiting.
+		static constexpr float RetryInterval = 0.1f;
+
+		while (true)
+		{
+			HANDLE Pipe = CreateFileW(*PipeName, GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+			if (Pipe != INVALID_HANDLE_VALUE)
+			{
+				return MakeUnique<FNamedPipeConnection>(Pipe, EServerProtocol::Legacy);
+			}
+
+			const DWORD Error = GetLastError();
+			if (Error == ERROR_PIPE_BUSY)
+			{
+				// Another instance of the pipe is in use, block until it is released.
+				WaitNamedPipeW(*PipeName, NMPWAIT_WAIT_FOREVER);
+			}
+			else if (Error == ERROR_FILE_NOT_FOUND)
+			{
+				FPlatformProcess::Sleep(RetryInterval);
+			}
+			else
+			{
+				UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to open named pipe %s (error %u)."), *PipeName, Error);
+				return nullptr;
+			}
+		}
+	}
+
+private:
+	FString PipeName;
+};
+
+TUniquePtr<FServerListener> FServerListener::Create(const FString& Name, EServerProtocol Protocol)
+{
+	if (Protocol == EServerProtocol::Legacy)
+	{
+		return MakeUnique<FNamedPipeClientListener>(Name);
+	}
+
+	return MakeUnique<FNamedPipeListener>(Name);
+}
+
+#else
+
+class FUnixSocketConnection : public FServerConnection
+{
+public:
+	explicit FUnixSocketConnection(int InSocket)
+		: FServerConnection(EServerProtocol::Framed)
+		, Socket(InSocket)
+	{
+	}
+
+	virtual ~FUnixSocketConnection() override
+	{
+		close(Socket);
+	}
+
+	virtual bool HasPendingData() override
+	{
+		pollfd PollFd = {};
+		PollFd.fd = Socket;
+		PollFd.events = POLLIN;
+		return poll(&PollFd, 1, 0) != 0;
+	}
+
+protected:
+	virtual bool ReadBytes(uint8* Data, int64 Size) override
+	{
+		while (Size > 0)
+		{
+			const ssize_t BytesRead = recv(Socket, Data, static_cast<size_t>(Size), 0);
+			if (BytesRead < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (BytesRead <= 0)
+			{
+				return false;
+			}
+
+			Data += BytesRead;
+			Size -= BytesRead;
+		}
+
+		return true;
+	}
+
+	virtual bool WriteBytes(const uint8* Data, int64 Size) override
+	{
+#if PLATFORM_LINUX
+		// Report a closed client as an error instead of raising SIGPIPE.
+		static constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+		static constexpr int SendFlags = 0;
+#endif
+
+		while (Size > 0)
+		{
+			const ssize_t BytesWritten = send(Socket, Data, static_cast<size_t>(Size), SendFlags);
+			if (BytesWritten < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (BytesWritten <= 0)
+			{
+				return false;
+			}
+
+			Data += BytesWritten;
+			Size -= BytesWritten;
+		}
+
+		return true;
+	}
+
+	virtual int64 ReadAvailable(uint8* Data, int64 MaxSize) override
+	{
+		while (true)
+		{
+			const ssize_t BytesRead = recv(Socket, Data, static_cast<size_t>(MaxSize), 0);
+			if (BytesRead >= 0 || errno != EINTR)
+			{
+				return FMath::Max<int64>(BytesRead, 0);
+			}
+		}
+	}
+
+private:
+	int Socket;
+};
+
+class FUnixSocketListener : public FServerListener
+{
+public:
+	FUnixSocketListener(int InSocket, const FString& InSocketPath)
+		: Socket(InSocket)
+		, SocketPath(InSocketPath)
+	{
+	}
+
+	virtual ~FUnixSocketListener() override
+	{
+		close(Socket);
+		unlink(TCHAR_TO_UTF8(*SocketPath));
+	}
+
+	virtual TUniquePtr<FServerConnection> Accept() override
+	{
+		while (true)
+		{
+			const int Connection = accept(Socket, nullptr, nullptr);
+			if (Connection >= 0)
+			{
+#if PLATFORM_MAC
+				int NoSigPipe = 1;
+				setsockopt(Connection, SOL_SOCKET, SO_NOSIGPIPE, &NoSigPipe, sizeof(NoSigPipe));
+#endif
+				return MakeUnique<FUnixSocketConnection>(Connection);
+			}
+
+			if (errno != EINTR)
+			{
+				UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to accept a connection on %s (errno %d)."), *SocketPath, errno);
+				return nullptr;
+			}
+		}
+	}
+
+private:
+	int Socket;
+	FString SocketPath;
+};
+
+TUniquePtr<FServerListener> FServerListener::Create(const FString& Name, EServerProtocol Protocol)
+{
+	if (Protocol == EServerProtocol::Legacy)
+	{
+		UE_LOG(LogVisualStudioTools, Display, TEXT("The legacy server protocol is only available on Windows, using the framed protocol."));
+	}
+
+	FString SocketPath = Name.Contains(TEXT("/"))
+		? Name
+		: FPaths::Combine(FPlatformProcess::UserTempDir(), Name + TEXT(".sock"));
+	SocketPath = FPaths::ConvertRelativePathToFull(SocketPath);
+
+	sockaddr_un Address = {};
+	Address.sun_family = AF_UNIX;
+
+	FTCHARToUTF8 SocketPathUtf8(*SocketPath);
+	if (SocketPathUtf8.Length() >= static_cast<int32>(sizeof(Address.sun_path)))
+	{
+		UE_LOG(LogVisualStudioTools, Error, TEXT("Socket path is too long: %s"), *SocketPath);
+		return nullptr;
+	}
+
+	FMemory::Memcpy(Address.sun_path, SocketPathUtf8.Get(), SocketPathUtf8.Length());
+
+	const int Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (Socket < 0)
+	{
+		UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to create socket (errno %d)."), errno);
+		return nullptr;
+	}
+
+	// Remove a socket file left behind by a previous server.
+	unlink(Address.sun_path);
+
+	if (bind(Socket, reinterpret_cast<const sockaddr*>(&Address), sizeof(Address)) != 0 || listen(Socket, 1) != 0)
+	{
+		UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to listen on %s (errno %d)."), *SocketPath, errno);
+		close(Socket);
+		return nullptr;
+	}
+
+	UE_LOG(LogVisualStudioTools, Display, TEXT("Listening on %s"), *SocketPath);
+	return MakeUnique<FUnixSocketListener>(Socket, SocketPath);
+}
+
+#endif // PLATFORM_WINDOWS
+} // namespace VisualStudioTools
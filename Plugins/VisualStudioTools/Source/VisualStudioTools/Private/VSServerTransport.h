@@ -0,0 +1,99 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace VisualStudioTools
+{
+/**
+* Wire protocol between the server commandlet and the IDE, selected with `-ServerProtocol=<N>`
+* when the IDE launches the server.
+*/
+enum class EServerProtocol : int32
+{
+	/**
+	* The protocol of the current Visual Studio client, and the default. The IDE creates the named pipe
+	* and the commandlet connects to it as a client. Each connection carries one raw UTF-8 request and
+	* the raw response. Only available on Windows.
+	*/
+	Legacy = 1,
+
+	/**
+	* The commandlet creates the endpoint and the client keeps its connection open for any number of
+	* requests. Messages are framed with a 4-byte little-endian length followed by the UTF-8 payload,
+	* so they can be of any size, and test runs can stream their progress before the response.
+	*/
+	Framed = 2,
+};
+
+/**
+* A connection between the server commandlet and a single client.
+* The read and write calls block until the whole message has been transferred.
+*/
+class FServerConnection
+{
+public:
+	explicit FServerConnection(EServerProtocol InProtocol)
+		: Protocol(InProtocol)
+	{
+	}
+
+	virtual ~FServerConnection() = default;
+
+	/**
+	* Blocks until a full message is received. Returns false if the client disconnected or the message is invalid.
+	* With the legacy protocol, the connection ends after the first request.
+	*/
+	bool ReadMessage(FString& OutMessage);
+
+	/** Returns false if the client disconnected. */
+	bool WriteMessage(const FString& Message);
+
+	EServerProtocol GetProtocol() const { return Protocol; }
+
+	/**
+	* Checks, without blocking, if the client sent data that was not read yet.
+	* Also returns true when the client disconnected, so the next read reports it.
+	*/
+	virtual bool HasPendingData() = 0;
+
+protected:
+	virtual bool ReadBytes(uint8* Data, int64 Size) = 0;
+	virtual bool WriteBytes(const uint8* Data, int64 Size) = 0;
+
+	/** Blocks until the client sent at least one byte. Returns the number of bytes read, or 0 if the client disconnected. */
+	virtual int64 ReadAvailable(uint8* Data, int64 MaxSize) = 0;
+
+private:
+	EServerProtocol Protocol;
+	bool bLegacyRequestRead = false;
+};
+
+/**
+* Endpoint the server commandlet receives client connections from.
+* On Windows this is a named pipe, and on other platforms a UNIX domain socket.
+*/
+class FServerListener
+{
+public:
+	virtual ~FServerListener() = default;
+
+	/**
+	* Blocks until a client connects. With the legacy protocol, blocks until the IDE's pipe accepts a connection.
+	* Returns null if the listener failed.
+	*/
+	virtual TUniquePtr<FServerConnection> Accept() = 0;
+
+	/**
+	* Creates a listener for the given endpoint name.
+	* On Windows the name is used as the pipe name, `\\.\pipe\<Name>`.
+	* On other platforms it is used as the socket path when it contains a separator, otherwise the
+	* socket is created as `<Name>.sock` in the user temporary directory. There is no legacy client
+	* on those platforms, so they always use the framed protocol.
+	* Returns null if the endpoint could not be created.
+	*/
+	static TUniquePtr<FServerListener> Create(const FString& Name, EServerProtocol Protocol);
+};
+} // namespace VisualStudioTools
@@ -1,12 +1,15 @@
 // Copyright 2022 (c) Microsoft. All rights reserved.
 
 #include "VSTestAdapterCommandlet.h"
+#include "AutomationTestHistory.h"
+#include "AutomationTestSharding.h"
+#include "TestRunListener.h"
 
 #include "Runtime/Core/Public/Async/TaskGraphInterfaces.h"
 #include "Runtime/Core/Public/Containers/Ticker.h"
 #include "Runtime/Launch/Resources/Version.h"
-#include <string>
-#include <fstream>
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
 
 #include "VisualStudioTools.h"
 
@@ -14,51 +17,67 @@ static constexpr auto FiltersParam = TEXT("filters");
 static constexpr auto ListTestsParam = TEXT("listtests");
 static constexpr auto RunTestsParam = TEXT("runtests");
 static constexpr auto TestResultsFileParam = TEXT("testresultfile");
+static constexpr auto WorkersParam = TEXT("workers");
+static constexpr auto NoHistorySwitch = TEXT("nohistory");
+static constexpr auto RegressionFactorParam = TEXT("regressionfactor");
 static constexpr auto HelpParam = TEXT("help");
 
+/**
+* Appends a line to the output file as UTF-8. The std wide streams used previously do not accept
+* TCHAR strings on platforms where TCHAR is not wchar_t.
+*/
+static void WriteLine(FArchive& OutFile, const FString& Line)
+{
+	FTCHARToUTF8 Converted(*Line, Line.Len());
+	OutFile.Serialize(const_cast<ANSICHAR*>(Converted.Get()), Converted.Length());
+
+	ANSICHAR NewLine = '\n';
+	OutFile.Serialize(&NewLine, 1);
+}
+
 static void GetAllTests(TArray<FAutomationTestInfo>& OutTestList)
 {
 	FAutomationTestFramework& Framework = FAutomationTestFramework::GetInstance();
 	Framework.GetValidTestNames(OutTestList);
 }
 
+/**
+* Retrieves the tests listed in the file, in the order of the file. Workers of a sharded run
+* rely on that order, since their shard is already sorted by the parent process.
+*/
 static void ReadTestsFromFile(const FString& InFile, TArray<FAutomationTestInfo>& OutTestList)
 {
-	TSet<FString> TestCommands;
-
-	// Wrapping in an inner scope to ensure automatic destruction of InStream object without explicitly calling .close().
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *InFile))
 	{
-		std::wifstream InStream(*InFile);
-		if (!InStream.good())
-		{
-			UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to open file at path: %s"), *InFile);
-			return;
-		}
+		UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to open file at path: %s"), *InFile);
+		return;
+	}
 
-		std::wstring Line;
-		while (std::getline(InStream, Line))
-		{
-			if (Line.length() > 0)
-			{
-				TestCommands.Add(FString(Line.c_str()));
-			}
-		}
+	TArray<FAutomationTestInfo> AllTests;
+	GetAllTests(AllTests);
+
+	TMap<FString, const FAutomationTestInfo*> TestsByCommand;
+	TestsByCommand.Reserve(AllTests.Num());
+	for (const FAutomationTestInfo& TestInfo : AllTests)
+	{
+		TestsByCommand.Add(TestInfo.GetTestName(), &TestInfo);
 	}
 
-	GetAllTests(OutTestList);
-	for (int32 Idx = OutTestList.Num() - 1; Idx >= 0; Idx--)
+	for (const FString& Line : Lines)
 	{
-		if (!TestCommands.Contains(OutTestList[Idx].GetTestName()))
+		const FAutomationTestInfo* TestInfo = nullptr;
+		if (Line.Len() > 0 && TestsByCommand.RemoveAndCopyValue(Line, TestInfo))
 		{
-			OutTestList.RemoveAt(Idx);
+			OutTestList.Add(*TestInfo);
 		}
 	}
 }
 
 static int32 ListTests(const FString& TargetFile)
 {
-	std::wofstream OutFile(*TargetFile);
-	if (!OutFile.good())
+	TUniquePtr<FArchive> OutFile{ IFileManager::Get().CreateFileWriter(*TargetFile) };
+	if (!OutFile)
 	{
 		UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to open file at path: %s"), *TargetFile);
 		return 1;
@@ -76,23 +95,35 @@ static int32 ListTests(const FString& TargetFile)
 		const FString SourceFile = TestInfo.GetSourceFile();
 		const int32 Line = TestInfo.GetSourceFileLine();
 
-		OutFile << *TestCommand << TEXT("|") << *DisplayName << TEXT("|") << Line << TEXT("|") << *SourceFile << std::endl;
+		WriteLine(*OutFile, FString::Printf(TEXT("%s|%s|%d|%s"), *TestCommand, *DisplayName, Line, *SourceFile));
 	}
 
 	UE_LOG(LogVisualStudioTools, Display, TEXT("Found %d tests"), TestInfos.Num());
-	OutFile.close();
+	OutFile->Close();
 
 	return 0;
 }
 
-static int32 RunTests(const FString& TestListFile, const FString& ResultsFile)
+struct FRunTestsOptions
 {
-	std::wofstream OutFile(*ResultsFile);
-	if (!OutFile.good())
-	{
-		UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to open file at path: %s"), *ResultsFile);
-		return 1;
-	}
+	int32 NumWorkers = 1;
+	FString WorkerParams;
+
+	// Whether to order the tests and record the results with the test history.
+	bool bUseHistory = true;
+
+	// Passing tests slower than their baseline by this factor are reported as REGRESSED. 0 disables the check.
+	double RegressionFactor = 0.0;
+
+	// Receives the progress of the run, such as the server connection. Optional.
+	VisualStudioTools::ITestRunListener* Listener = nullptr;
+};
+
+static constexpr auto RegressedResult = TEXT("REGRESSED");
+
+static int32 RunTests(const FString& TestListFile, const FString& ResultsFile, const FRunTestsOptions& RunOptions)
+{
+	using namespace VisualStudioTools;
 
 	TArray<FAutomationTestInfo> TestInfos;
 	if (TestListFile.Equals(TEXT("All"), ESearchCase::IgnoreCase))
@@ -104,7 +135,97 @@ static int32 RunTests(const FString& TestListFile, const FString& ResultsFile)
 		ReadTestsFromFile(TestListFile, TestInfos);
 	}
 
+	FAutomationTestHistory History;
+	const FString HistoryFilePath = FAutomationTestHistory::GetDefaultFilePath();
+	if (RunOptions.bUseHistory)
+	{
+		History.Load(HistoryFilePath);
+		History.SortTests(TestInfos);
+	}
+
+	// Classifies a result against the history, then records it.
+	auto GetResult = [&](const FString& TestCommand, bool bSuccess, double Duration) -> FString
+	{
+		if (!RunOptions.bUseHistory)
+		{
+			return bSuccess ? TEXT("OK") : TEXT("FAIL");
+		}
+
+		const bool bRegressed = bSuccess && History.IsRegression(TestCommand, Duration, RunOptions.RegressionFactor);
+		History.AddResult(TestCommand, bSuccess, Duration);
+
+		return bRegressed ? RegressedResult : bSuccess ? TEXT("OK") : TEXT("FAIL");
+	};
+
+	if (RunOptions.NumWorkers > 1)
+	{
+		// The workers run their shard in the given order and leave the history to this process.
+		FShardedTestRunOptions Options;
+		Options.NumWorkers = RunOptions.NumWorkers;
+		Options.WorkerParams = RunOptions.WorkerParams + TEXT(" -nohistory");
+
+		// Balance the shards with the history, or the durations from the previous run before its results are overwritten.
+		History.GetDurations(Options.Durations);
+		if (Options.Durations.Num() == 0)
+		{
+			for (const FTestResultBlock& Block : ReadTestResults(ResultsFile))
+			{
+				Options.Durations.Add(Block.TestCommand, Block.Duration);
+			}
+		}
+
+		Options.OnTestResult = [&](FTestResultBlock& Block)
+		{
+			const FString Result = GetResult(Block.TestCommand, Block.bSuccess, Block.Duration);
+			if (Result == RegressedResult)
+			{
+				// Rewrite the result field of the worker's [RUNTEST] line.
+				const int32 ResultEnd = Block.Lines[0].Find(TEXT("|"), ESearchCase::CaseSensitive, ESearchDir::FromEnd);
+				const int32 ResultStart = Block.Lines[0].Find(TEXT("|"), ESearchCase::CaseSensitive, ESearchDir::FromEnd, ResultEnd);
+				Block.Lines[0] = Block.Lines[0].Left(ResultStart + 1) + Result + Block.Lines[0].RightChop(ResultEnd);
+			}
+
+			if (RunOptions.Listener)
+			{
+				// The lines after the [RUNTEST] line are the error messages.
+				for (int32 Idx = 1; Idx < Block.Lines.Num(); Idx++)
+				{
+					RunOptions.Listener->OnTestError(Block.TestCommand, Block.Lines[Idx]);
+				}
+
+				RunOptions.Listener->OnTestFinished(Block.TestCommand, Result, Block.Duration);
+			}
+		};
+
+		if (RunOptions.Listener)
+		{
+			Options.OnTestStarted = [&](const FAutomationTestInfo& TestInfo)
+			{
+				RunOptions.Listener->OnTestStarted(TestInfo.GetTestName(), TestInfo.GetDisplayName());
+			};
+
+			Options.ShouldCancel = [&]() { return RunOptions.Listener->IsCancelRequested(); };
+		}
+
+		const int32 ExitCode = RunTestsSharded(TestInfos, ResultsFile, Options);
+		if (RunOptions.bUseHistory)
+		{
+			History.Save(HistoryFilePath);
+		}
+
+		return ExitCode;
+	}
+
+	// Allow reading the results while they are written, the parent of a sharded run collects them as the tests complete.
+	TUniquePtr<FArchive> OutFile{ IFileManager::Get().CreateFileWriter(*ResultsFile, FILEWRITE_AllowRead) };
+	if (!OutFile)
+	{
+		UE_LOG(LogVisualStudioTools, Error, TEXT("Failed to open file at path: %s"), *ResultsFile);
+		return 1;
+	}
+
 	bool AllSuccessful = true;
+	bool bCancelled = false;
 
 	FAutomationTestFramework& Framework = FAutomationTestFramework::GetInstance();
 
@@ -113,8 +234,20 @@ static int32 RunTests(const FString& TestListFile, const FString& ResultsFile)
 		const FString TestCommand = TestInfo.GetTestName();
 		const FString DisplayName = TestInfo.GetDisplayName();
 
+		if (RunOptions.Listener && RunOptions.Listener->IsCancelRequested())
+		{
+			UE_LOG(LogVisualStudioTools, Display, TEXT("Test run cancelled before %s."), *DisplayName);
+			bCancelled = true;
+			break;
+		}
+
 		UE_LOG(LogVisualStudioTools, Log, TEXT("Running %s"), *DisplayName);
 
+		if (RunOptions.Listener)
+		{
+			RunOptions.Listener->OnTestStarted(TestCommand, DisplayName);
+		}
+
 		const int32 RoleIndex = 0; // always default to "local" role index.  Only used for multi-participant tests
 		Framework.StartTestByName(TestCommand, RoleIndex);
 
@@ -142,10 +275,15 @@ static int32 RunTests(const FString& TestListFile, const FString& ResultsFile)
 		const bool CurrentTestSuccessful = Framework.StopTest(ExecutionInfo) && ExecutionInfo.GetErrorTotal() == 0;
 		AllSuccessful = AllSuccessful && CurrentTestSuccessful;
 
-		const FString Result = CurrentTestSuccessful ? TEXT("OK") : TEXT("FAIL");
+		const FString Result = GetResult(TestCommand, CurrentTestSuccessful, ExecutionInfo.Duration);
+		if (Result == RegressedResult)
+		{
+			UE_LOG(LogVisualStudioTools, Warning, TEXT("%s took %.3f seconds, slower than its baseline by more than %gx."),
+				*DisplayName, ExecutionInfo.Duration, RunOptions.RegressionFactor);
+		}
 
 		// [RUNTEST] is part of the protocol, so do not remove.
-		OutFile << TEXT("[RUNTEST]") << *TestCommand << TEXT("|") << *DisplayName << TEXT("|") << *Result << TEXT("|") << ExecutionInfo.Duration << std::endl;
+		WriteLine(*OutFile, FString::Printf(TEXT("[RUNTEST]%s|%s|%s|%g"), *TestCommand, *DisplayName, *Result, ExecutionInfo.Duration));
 
 		if (!CurrentTestSuccessful)
 		{
@@ -153,18 +291,33 @@ static int32 RunTests(const FString& TestListFile, const FString& ResultsFile)
 			{
 				if (Entry.Event.Type == EAutomationEventType::Error)
 				{
-					OutFile << *Entry.Event.Message << std::endl;
+					WriteLine(*OutFile, Entry.Event.Message);
 					UE_LOG(LogVisualStudioTools, Error, TEXT("%s"), *Entry.Event.Message);
+
+					if (RunOptions.Listener)
+					{
+						RunOptions.Listener->OnTestError(TestCommand, Entry.Event.Message);
+					}
 				}
 			}
 
 			UE_LOG(LogVisualStudioTools, Log, TEXT("Failed  %s"), *DisplayName);
 		}
 
-		OutFile.flush();
+		if (RunOptions.Listener)
+		{
+			RunOptions.Listener->OnTestFinished(TestCommand, Result, ExecutionInfo.Duration);
+		}
+
+		OutFile->Flush();
 	}
 
-	return AllSuccessful ? 0 : 1;
+	if (RunOptions.bUseHistory)
+	{
+		History.Save(HistoryFilePath);
+	}
+
+	return AllSuccessful && !bCancelled ? 0 : 1;
 }
 
 UVSTestAdapterCommandlet::UVSTestAdapterCommandlet()
@@ -181,6 +334,15 @@ UVSTestAdapterCommandlet::UVSTestAdapterCommandlet()
 	HelpParamNames.Add(TestResultsFileParam);
 	HelpParamDescriptions.Add(TEXT("[Required] The output file from running test cases that we parse to retrieve test case results."));
 
+	HelpParamNames.Add(WorkersParam);
+	HelpParamDescriptions.Add(TEXT("[Optional] Number of editor processes used to run the tests in parallel. The tests are split by their duration in the previous results file. Defaults to 1, which runs the tests in this process."));
+
+	HelpParamNames.Add(NoHistorySwitch);
+	HelpParamDescriptions.Add(TEXT("[Optional] Do not order the tests or record their results with the local test history."));
+
+	HelpParamNames.Add(RegressionFactorParam);
+	HelpParamDescriptions.Add(TEXT("[Optional] Report passing tests slower than their rolling baseline duration by this factor with the REGRESSED result. Defaults to 0, which disables the check."));
+
 	HelpParamNames.Add(FiltersParam);
 	HelpParamDescriptions.Add(TEXT("[Optional] List of test filters to enable separated by '+'. Default is 'application+smoke+product+perf+stress+negative'"));
 
@@ -280,7 +442,19 @@ int32 UVSTestAdapterCommandlet::Main(const FString& Params)
 	}
 	else if (ParamVals.Contains(RunTestsParam) && ParamVals.Contains(TestResultsFileParam))
 	{
-		return RunTests(ParamVals[RunTestsParam], ParamVals[TestResultsFileParam]);
+		FRunTestsOptions RunOptions;
+		RunOptions.NumWorkers = ParamVals.Contains(WorkersParam) ? FCString::Atoi(*ParamVals[WorkersParam]) : 1;
+		RunOptions.bUseHistory = !Switches.Contains(NoHistorySwitch);
+		RunOptions.RegressionFactor = ParamVals.Contains(RegressionFactorParam) ? FCString::Atod(*ParamVals[RegressionFactorParam]) : 0.0;
+		RunOptions.Listener = Listener;
+
+		// The workers only run their own shard, with the same filters.
+		if (ParamVals.Contains(FiltersParam))
+		{
+			RunOptions.WorkerParams = FString::Printf(TEXT("-%s=%s"), FiltersParam, *ParamVals[FiltersParam]);
+		}
+
+		return RunTests(ParamVals[RunTestsParam], ParamVals[TestResultsFileParam], RunOptions);
 	}
 
 	PrintHelp();
@@ -11,6 +11,11 @@
 
 #include "VSTestAdapterCommandlet.generated.h"
 
+namespace VisualStudioTools
+{
+class ITestRunListener;
+}
+
 UCLASS()
 class UVSTestAdapterCommandlet
 	: public UCommandlet
@@ -23,6 +28,14 @@ public:
 public:
 	virtual int32 Main(const FString &Params) override;
 
+	/** Sets the listener notified of the progress of the next test runs. It must outlive them. */
+	void SetTestRunListener(VisualStudioTools::ITestRunListener* InListener)
+	{
+		Listener = InListener;
+	}
+
 private:
 	void PrintHelp() const;
+
+	VisualStudioTools::ITestRunListener* Listener = nullptr;
 };
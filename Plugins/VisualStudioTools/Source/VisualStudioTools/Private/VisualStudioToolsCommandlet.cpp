@@ -3,328 +3,497 @@
 #include "VisualStudioToolsCommandlet.h"
 
 #include "Algo/Transform.h"
+#include "AssetIndex.h"
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "Blueprint/BlueprintSupport.h"
 #include "BlueprintAssetHelpers.h"
 #include "Engine/BlueprintGeneratedClass.h"
-#include "JsonObjectConverter.h"
 #include "Misc/Paths.h"
 #include "Misc/ScopeExit.h"
 #include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/LargeMemoryWriter.h"
 #include "SourceCodeNavigation.h"
 #include "UObject/CoreRedirects.h"
 #include "UObject/UObjectIterator.h"
 #include "VisualStudioTools.h"
+#include "WarmAssetCache.h"
 
 namespace VisualStudioTools
 {
-static const FName CategoryFName = TEXT("Category");
 static const FName ModuleNameFName = TEXT("ModuleName");
 
-static TArray<FProperty*> GetChangedPropertiesList(
-	UStruct* InStruct, const uint8* DataPtr, const uint8* DefaultDataPtr)
+using JsonWriter = TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>;
+
+static void SerializeBlueprints(TSharedRef<JsonWriter>& Json, const TArray<FBlueprintEntry>& Items)
 {
-	TArray<FProperty*> Result;
+	Json->WriteArrayStart();
+	for (const FBlueprintEntry& Blueprint : Items)
+	{
+		Json->WriteObjectStart();
 
-	const UClass* OwnerClass = Cast<UClass>(InStruct);
+		Json->WriteValue(TEXT("name"), Blueprint.Name);
+		Json->WriteValue(TEXT("path"), Blueprint.Path);
+		Json->WriteObjectEnd();
+	}
+	Json->WriteArrayEnd();
+}
 
-	// Walk only in the properties defined in the current class, the super classes are processed individually
-	for (TFieldIterator<FProperty> It(OwnerClass, EFieldIteratorFlags::ExcludeSuper); It; ++It)
+static void SerializePropertyValue(TSharedRef<JsonWriter>& Json, const FPropertyValue& Value)
+{
+	switch (Value.Type)
 	{
-		FProperty* Property = *It;
-		for (int32 Idx = 0; Idx < Property->ArrayDim; Idx++)
+	case FPropertyValue::EType::Bool:
+		Json->WriteValue(TEXT("value"), Value.bBoolValue);
+		break;
+	case FPropertyValue::EType::Integer:
+		// Numbers were always written as doubles by the json converter, keep the same representation.
+		Json->WriteValue(TEXT("value"), static_cast<double>(Value.IntegerValue));
+		break;
+	case FPropertyValue::EType::Number:
+		Json->WriteValue(TEXT("value"), Value.NumberValue);
+		break;
+	case FPropertyValue::EType::String:
+		Json->WriteValue(TEXT("value"), Value.StringValue);
+		break;
+	default:
+		break;
+	}
+}
+
+static void SerializeProperties(TSharedRef<JsonWriter>& Json, const FClassEntry& Entry)
+{
+	Json->WriteArrayStart();
+	for (const auto& Item : Entry.Properties)
+	{
+		const auto& PropName = Item.Key;
+		const auto& PropEntry = Item.Value;
+
+		Json->WriteObjectStart();
+
+		Json->WriteValue(TEXT("name"), PropName.ToString());
+
+		Json->WriteIdentifierPrefix(TEXT("metadata"));
 		{
-			const uint8* PropertyValue = Property->ContainerPtrToValuePtr<uint8>(DataPtr, Idx);
-			const uint8* DefaultPropertyValue = Property->ContainerPtrToValuePtrForDefaults<uint8>(InStruct, DefaultDataPtr, Idx);
+			Json->WriteObjectStart();
+			if (!PropEntry.Categories.IsEmpty())
+			{
+				Json->WriteValue(TEXT("categories"), PropEntry.Categories);
+			}
+			Json->WriteObjectEnd();
+		}
 
-			if (!Property->Identical(PropertyValue, DefaultPropertyValue))
+		Json->WriteIdentifierPrefix(TEXT("values"));
+		{
+			Json->WriteArrayStart();
+			for (const auto& ValueEntry : PropEntry.Values)
 			{
-				Result.Add(Property);
-				break;
+				Json->WriteObjectStart();
+
+				Json->WriteValue(TEXT("blueprint"), ValueEntry.Blueprint);
+				SerializePropertyValue(Json, ValueEntry.Value);
+
+				Json->WriteObjectEnd();
 			}
+			Json->WriteArrayEnd();
 		}
-	}
 
-	return Result;
+		Json->WriteObjectEnd();
+	}
+	Json->WriteArrayEnd();
 }
 
-static bool FindBlueprintNativeParents(
-	const UClass* BlueprintGeneratedClass, TFunctionRef<void(UClass*)> Callback)
+static void SerializeFunctions(TSharedRef<JsonWriter>& Json, const FClassEntry& Entry)
 {
-	bool bAnyNativeParent = false;
-	for (UClass* Super = BlueprintGeneratedClass->GetSuperClass(); Super; Super = Super->GetSuperClass())
+	Json->WriteArrayStart();
+	for (const auto& Item : Entry.Functions)
 	{
-		// Ignore the root `UObject` class and non-native parents.
-		if (Super->HasAnyClassFlags(CLASS_Native) && Super->GetFName() != NAME_Object)
-		{
-			bAnyNativeParent = true;
-			Callback(Super);
-		}
+		const auto& Name = Item.Key;
+		const auto& FnEntry = Item.Value;
+		Json->WriteObjectStart();
+		Json->WriteValue(TEXT("name"), Name.ToString());
+		Json->WriteValue(TEXT("blueprints"), FnEntry.Blueprints);
+		Json->WriteObjectEnd();
 	}
-
-	return bAnyNativeParent;
+	Json->WriteArrayEnd();
 }
 
-struct FPropertyEntry
+static void SerializeClasses(TSharedRef<JsonWriter>& Json, const ClassMap& Items)
 {
-	FProperty* Property;
-	TArray<int32> Blueprints;
-};
-
-struct FFunctionEntry
-{
-	UFunction* Function;
-	TArray<int32> Blueprints;
-};
+	Json->WriteArrayStart();
+	for (const auto& Item : Items)
+	{
+		const auto& Entry = Item.Value;
+		Json->WriteObjectStart();
+		Json->WriteValue(TEXT("name"), Entry.Name);
 
-struct FClassEntry
-{
-	const UClass* Class;
-	TArray<int32> Blueprints;
-	TMap<FString, FPropertyEntry> Properties;
-	TMap<FString, FFunctionEntry> Functions;
-};
+		Json->WriteValue(TEXT("blueprints"), Entry.Blueprints);
 
-using ClassMap = TMap<FString, FClassEntry>;
+		Json->WriteIdentifierPrefix(TEXT("properties"));
+		SerializeProperties(Json, Entry);
 
-struct FAssetIndex
-{
-	TSet<FString> AssetPathCache;
-	ClassMap Classes;
-	TArray<const UClass*> Blueprints;
+		Json->WriteIdentifierPrefix(TEXT("functions"));
+		SerializeFunctions(Json, Entry);
 
-	void ProcessBlueprint(const UBlueprintGeneratedClass* BlueprintGeneratedClass)
-	{
-		if (BlueprintGeneratedClass == nullptr)
-		{
-			return;
-		}
+		Json->WriteObjectEnd();
+	}
+	Json->WriteArrayEnd();
+}
 
-		int32 BlueprintIndex = Blueprints.Num();
+static void SerializeToIndex(const FAssetIndex& Index, FArchive& IndexFile)
+{
+	TSharedRef<JsonWriter> Json = JsonWriter::Create(&IndexFile);
 
-		bool bHasAnyParent = FindBlueprintNativeParents(BlueprintGeneratedClass, [&](UClass* Parent)
-		{
-			FString ParentName = Parent->GetFName().ToString();
-			if (!Classes.Contains(ParentName))
-			{
-				Classes.Add(ParentName).Class = Parent;
-			}
+	Json->WriteObjectStart();
 
-			FClassEntry& ClassEntry = Classes[ParentName];
+	Json->WriteIdentifierPrefix(TEXT("blueprints"));
+	SerializeBlueprints(Json, Index.Blueprints);
 
-			ClassEntry.Blueprints.Add(BlueprintIndex);
+	Json->WriteIdentifierPrefix(TEXT("classes"));
+	SerializeClasses(Json, Index.Classes);
 
-			// Retrieve the properties from the parent class that changed in the Blueprint class, by comparing their CDOs.
-			UObject* GeneratedClassDefault = BlueprintGeneratedClass->ClassDefaultObject;
-			UObject* SuperClassDefault = Parent->GetDefaultObject(false);
-			TArray<FProperty*> ChangedProperties = GetChangedPropertiesList(Parent, (uint8*)GeneratedClassDefault, (uint8*)SuperClassDefault);
+	Json->WriteObjectEnd();
+	Json->Close();
+}
 
-			for (FProperty* Property : ChangedProperties)
-			{
-				FString PropertyName = Property->GetFName().ToString();
-				if (!ClassEntry.Properties.Contains(PropertyName))
-				{
-					ClassEntry.Properties.Add(PropertyName).Property = Property;
-				}
+/**
+* Compact binary index format, opt-in with `-format=binary`.
+*
+* Every section is an array of fixed-size little-endian records, located through the header,
+* so consumers can memory-map the file and read it in place without parsing.
+* All strings are stored once in a table of null-terminated UTF-8 strings, and records refer
+* to them by their byte offset in that table. Offset 0 is always the empty string.
+*
+*   Header      FBinaryIndexHeader
+*   Values      FBinaryValueRecord[ValueCount]           (8-byte aligned)
+*   Classes     FBinaryClassRecord[ClassCount]
+*   Properties  FBinaryPropertyRecord[PropertyCount]
+*   Functions   FBinaryFunctionRecord[FunctionCount]
+*   Blueprints  FBinaryBlueprintRecord[BlueprintCount]
+*   BlueprintRefs  uint32[BlueprintRefCount]             (indices into Blueprints)
+*   Strings     char[StringTableSize]
+*
+* Classes reference ranges of BlueprintRefs, Properties and Functions; properties reference
+* ranges of Values; functions reference ranges of BlueprintRefs.
+*/
+namespace BinaryIndex
+{
+static constexpr uint32 Magic = 0x49425356; // 'VSBI'
+static constexpr uint32 Version = 1;
 
-				FPropertyEntry& PropEntry = ClassEntry.Properties[PropertyName];
-				PropEntry.Blueprints.Add(BlueprintIndex);
-			}
+struct FBinaryIndexHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint32 ValuesOffset, ValueCount;
+	uint32 ClassesOffset, ClassCount;
+	uint32 PropertiesOffset, PropertyCount;
+	uint32 FunctionsOffset, FunctionCount;
+	uint32 BlueprintsOffset, BlueprintCount;
+	uint32 BlueprintRefsOffset, BlueprintRefCount;
+	uint32 StringTableOffset, StringTableSize;
+};
 
-			// Iterate over the functions originally from the parent class
-			// and check if they are implemented in the BP class as well.
-			for (TFieldIterator<UFunction> It(Parent, EFieldIteratorFlags::ExcludeSuper); It; ++It)
-			{
-				UFunction* Fn = BlueprintGeneratedClass->FindFunctionByName((*It)->GetFName(), EIncludeSuperFlag::ExcludeSuper);
-				// If the function not present in the BP class directly, it means it was implemented. Otherwise, ignore.
-				if (!Fn)
-				{
-					continue;
-				}
+struct FBinaryValueRecord
+{
+	uint32 Blueprint;
+	uint32 Type; // FPropertyValue::EType
+	uint64 Data; // bool, int64, double bits or string offset, depending on the type
+};
 
-				FString FnName = Fn->GetFName().ToString();
-				if (!ClassEntry.Functions.Contains(FnName))
-				{
-					ClassEntry.Functions.Add(FnName).Function = Fn;
-				}
+struct FBinaryClassRecord
+{
+	uint32 Name;
+	uint32 FirstBlueprintRef, NumBlueprintRefs;
+	uint32 FirstProperty, NumProperties;
+	uint32 FirstFunction, NumFunctions;
+};
 
-				FFunctionEntry& FuncEntry = ClassEntry.Functions[FnName];
-				FuncEntry.Blueprints.Add(BlueprintIndex);
-			}
-		});
+struct FBinaryPropertyRecord
+{
+	uint32 Name;
+	uint32 Categories;
+	uint32 FirstValue, NumValues;
+};
 
-		if (bHasAnyParent)
-		{
-			check(Blueprints.Add(BlueprintGeneratedClass) == BlueprintIndex);
-		}
+struct FBinaryFunctionRecord
+{
+	uint32 Name;
+	uint32 FirstBlueprintRef, NumBlueprintRefs;
+};
 
-		return;
-	}
+struct FBinaryBlueprintRecord
+{
+	uint32 Name;
+	uint32 Path;
 };
 
-using JsonWriter = TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>;
+static_assert(sizeof(FBinaryIndexHeader) % 8 == 0, "Values must stay 8-byte aligned");
+static_assert(sizeof(FBinaryValueRecord) == 16, "Unexpected padding in the value record");
 
-static bool ShouldSerializePropertyValue(FProperty* Property)
+/** Deduplicated UTF-8 string table, assigning byte offsets in insertion order. */
+struct FStringTable
 {
-	if (Property->ArrayDim > 1) // Skip properties that are not scalars
-	{
-		return false;
-	}
+	TMap<FString, uint32> Offsets;
+	uint32 Size = 1; // The leading null character is the empty string.
 
-	if (FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+	uint32 Add(const FString& Value)
 	{
-		return true;
-	}
-
-	if (FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property))
-	{
-		UEnum* EnumDef = NumericProperty->GetIntPropertyEnum();
-		if (EnumDef != NULL)
+		if (Value.IsEmpty())
 		{
-			return true;
+			return 0;
 		}
 
-		if (NumericProperty->IsFloatingPoint())
+		if (const uint32* Existing = Offsets.Find(Value))
 		{
-			return true;
+			return *Existing;
 		}
 
-		if (NumericProperty->IsInteger())
-		{
-			return true;
-		}
+		const uint32 Offset = Size;
+		Size += FTCHARToUTF8(*Value).Length() + 1;
+		Offsets.Add(Value, Offset);
+		return Offset;
 	}
 
-	if (FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+	uint32 Find(const FString& Value) const
 	{
-		return true;
+		return Value.IsEmpty() ? 0 : Offsets.FindChecked(Value);
 	}
 
-	if (FStrProperty* StringProperty = CastField<FStrProperty>(Property))
+	void Serialize(FArchive& Ar) const
 	{
-		return true;
+		uint8 Terminator = 0;
+		Ar << Terminator;
+
+		for (const auto& Item : Offsets)
+		{
+			FTCHARToUTF8 Utf8(*Item.Key);
+			Ar.Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+			Ar << Terminator;
+		}
 	}
+};
 
-	return false;
+template <typename RecordType>
+static void WriteRecord(FArchive& Ar, const RecordType& Record)
+{
+	Ar.Serialize(const_cast<RecordType*>(&Record), sizeof(RecordType));
 }
 
-static void SerializeBlueprints(TSharedRef<JsonWriter>& Json, TArray<const UClass*> Items)
+static void SerializeToIndex(const FAssetIndex& Index, FArchive& IndexFile)
 {
-	Json->WriteArrayStart();
-	for (const UClass* Blueprint : Items)
-	{
-		Json->WriteObjectStart();
+	// First pass: intern the strings and count the records, without copying the index.
+	FStringTable Strings;
+	FBinaryIndexHeader Header = {};
+	Header.Magic = Magic;
+	Header.Version = Version;
 
-		Json->WriteValue(TEXT("name"), Blueprint->GetName());
-		Json->WriteValue(TEXT("path"), Blueprint->GetPathName());
-		Json->WriteObjectEnd();
+	for (const FBlueprintEntry& Blueprint : Index.Blueprints)
+	{
+		Strings.Add(Blueprint.Name);
+		Strings.Add(Blueprint.Path);
 	}
-	Json->WriteArrayEnd();
-}
 
-static void SerializeProperties(TSharedRef<JsonWriter>& Json, FClassEntry& Entry, TArray<const UClass*>& Blueprints)
-{
-	Json->WriteArrayStart();
-	for (auto& Item : Entry.Properties)
+	for (const auto& ClassItem : Index.Classes)
 	{
-		auto& PropName = Item.Key;
-		auto& PropEntry = Item.Value;
-		FProperty* Property = PropEntry.Property;
+		const FClassEntry& Entry = ClassItem.Value;
+		Strings.Add(Entry.Name);
+		Header.BlueprintRefCount += Entry.Blueprints.Num();
 
-		Json->WriteObjectStart();
-
-		Json->WriteValue(TEXT("name"), PropName);
-
-		Json->WriteIdentifierPrefix(TEXT("metadata"));
+		for (const auto& PropItem : Entry.Properties)
 		{
-			Json->WriteObjectStart();
-			if (Property->HasMetaData(CategoryFName))
+			Strings.Add(PropItem.Key.ToString());
+			Strings.Add(PropItem.Value.Categories);
+			Header.ValueCount += PropItem.Value.Values.Num();
+
+			for (const FPropertyValueEntry& ValueEntry : PropItem.Value.Values)
 			{
-				Json->WriteValue(TEXT("categories"), Property->GetMetaData(CategoryFName));
+				if (ValueEntry.Value.Type == FPropertyValue::EType::String)
+				{
+					Strings.Add(ValueEntry.Value.StringValue);
+				}
 			}
-			Json->WriteObjectEnd();
 		}
 
-		Json->WriteIdentifierPrefix(TEXT("values"));
+		for (const auto& FnItem : Entry.Functions)
 		{
-			Json->WriteArrayStart();
-			for (auto& BlueprintEntry : PropEntry.Blueprints)
-			{
-				Json->WriteObjectStart();
+			Strings.Add(FnItem.Key.ToString());
+			Header.BlueprintRefCount += FnItem.Value.Blueprints.Num();
+		}
 
-				Json->WriteValue(TEXT("blueprint"), BlueprintEntry);
+		Header.PropertyCount += Entry.Properties.Num();
+		Header.FunctionCount += Entry.Functions.Num();
+	}
 
-				UObject* GeneratedClassDefault = Blueprints[BlueprintEntry]->ClassDefaultObject;
-				const uint8* PropData = PropEntry.Property->ContainerPtrToValuePtr<uint8>(GeneratedClassDefault);
+	Header.ClassCount = Index.Classes.Num();
+	Header.BlueprintCount = Index.Blueprints.Num();
+	Header.StringTableSize = Strings.Size;
 
-				if (ShouldSerializePropertyValue(PropEntry.Property))
+	Header.ValuesOffset = sizeof(FBinaryIndexHeader);
+	Header.ClassesOffset = Header.ValuesOffset + Header.ValueCount * sizeof(FBinaryValueRecord);
+	Header.PropertiesOffset = Header.ClassesOffset + Header.ClassCount * sizeof(FBinaryClassRecord);
+	Header.FunctionsOffset = Header.PropertiesOffset + Header.PropertyCount * sizeof(FBinaryPropertyRecord);
+	Header.BlueprintsOffset = Header.FunctionsOffset + Header.FunctionCount * sizeof(FBinaryFunctionRecord);
+	Header.BlueprintRefsOffset = Header.BlueprintsOffset + Header.BlueprintCount * sizeof(FBinaryBlueprintRecord);
+	Header.StringTableOffset = Header.BlueprintRefsOffset + Header.BlueprintRefCount * sizeof(uint32);
+
+	// Second pass: stream each section in order. The ranges are assigned in the same
+	// traversal order in every section, so running counters are enough to link them.
+	WriteRecord(IndexFile, Header);
+
+	for (const auto& ClassItem : Index.Classes)
+	{
+		for (const auto& PropItem : ClassItem.Value.Properties)
+		{
+			for (const FPropertyValueEntry& ValueEntry : PropItem.Value.Values)
+			{
+				const FPropertyValue& Value = ValueEntry.Value;
+
+				FBinaryValueRecord Record = {};
+				Record.Blueprint = ValueEntry.Blueprint;
+				Record.Type = static_cast<uint32>(Value.Type);
+				switch (Value.Type)
 				{
-					TSharedPtr<FJsonValue> JsonValue = FJsonObjectConverter::UPropertyToJsonValue(Property, PropData);
-					FJsonSerializer::Serialize(JsonValue.ToSharedRef(), TEXT("value"), Json);
+				case FPropertyValue::EType::Bool:
+					Record.Data = Value.bBoolValue ? 1 : 0;
+					break;
+				case FPropertyValue::EType::Integer:
+					Record.Data = static_cast<uint64>(Value.IntegerValue);
+					break;
+				case FPropertyValue::EType::Number:
+					FMemory::Memcpy(&Record.Data, &Value.NumberValue, sizeof(double));
+					break;
+				case FPropertyValue::EType::String:
+					Record.Data = Strings.Find(Value.StringValue);
+					break;
+				default:
+					break;
 				}
 
-				Json->WriteObjectEnd();
+				WriteRecord(IndexFile, Record);
 			}
-			Json->WriteArrayEnd();
 		}
+	}
 
-		Json->WriteObjectEnd();
+	uint32 NextProperty = 0;
+	uint32 NextFunction = 0;
+	uint32 NextBlueprintRef = 0;
+	for (const auto& ClassItem : Index.Classes)
+	{
+		const FClassEntry& Entry = ClassItem.Value;
+
+		FBinaryClassRecord Record;
+		Record.Name = Strings.Find(Entry.Name);
+		Record.FirstBlueprintRef = NextBlueprintRef;
+		Record.NumBlueprintRefs = Entry.Blueprints.Num();
+		Record.FirstProperty = NextProperty;
+		Record.NumProperties = Entry.Properties.Num();
+		Record.FirstFunction = NextFunction;
+		Record.NumFunctions = Entry.Functions.Num();
+		WriteRecord(IndexFile, Record);
+
+		NextProperty += Record.NumProperties;
+		NextFunction += Record.NumFunctions;
+		NextBlueprintRef += Record.NumBlueprintRefs;
+		for (const auto& FnItem : Entry.Functions)
+		{
+			NextBlueprintRef += FnItem.Value.Blueprints.Num();
+		}
 	}
-	Json->WriteArrayEnd();
-}
 
-static void SerializeFunctions(TSharedRef<JsonWriter>& Json, FClassEntry& Entry)
-{
-	Json->WriteArrayStart();
-	for (auto& Item : Entry.Functions)
+	uint32 NextValue = 0;
+	for (const auto& ClassItem : Index.Classes)
 	{
-		auto& Name = Item.Key;
-		auto& FnEntry = Item.Value;
-		Json->WriteObjectStart();
-		Json->WriteValue(TEXT("name"), Name);
-		Json->WriteValue(TEXT("blueprints"), FnEntry.Blueprints);
-		Json->WriteObjectEnd();
+		for (const auto& PropItem : ClassItem.Value.Properties)
+		{
+			FBinaryPropertyRecord Record;
+			Record.Name = Strings.Find(PropItem.Key.ToString());
+			Record.Categories = Strings.Find(PropItem.Value.Categories);
+			Record.FirstValue = NextValue;
+			Record.NumValues = PropItem.Value.Values.Num();
+			WriteRecord(IndexFile, Record);
+
+			NextValue += Record.NumValues;
+		}
 	}
-	Json->WriteArrayEnd();
-}
 
-static void SerializeClasses(TSharedRef<JsonWriter>& Json, ClassMap& Items, TArray<const UClass*> Blueprints)
-{
-	Json->WriteArrayStart();
-	for (auto& Item : Items)
+	NextBlueprintRef = 0;
+	for (const auto& ClassItem : Index.Classes)
 	{
-		auto& ClassName = Item.Key;
-		auto& Entry = Item.Value;
-		Json->WriteObjectStart();
-		Json->WriteValue(TEXT("name"), FString::Printf(TEXT("%s%s"), Entry.Class->GetPrefixCPP(), *Entry.Class->GetName()));
+		const FClassEntry& Entry = ClassItem.Value;
 
-		Json->WriteValue(TEXT("blueprints"), Entry.Blueprints);
+		// The class blueprint refs come first, followed by the refs of each of its functions.
+		NextBlueprintRef += Entry.Blueprints.Num();
+		for (const auto& FnItem : Entry.Functions)
+		{
+			FBinaryFunctionRecord Record;
+			Record.Name = Strings.Find(FnItem.Key.ToString());
+			Record.FirstBlueprintRef = NextBlueprintRef;
+			Record.NumBlueprintRefs = FnItem.Value.Blueprints.Num();
+			WriteRecord(IndexFile, Record);
 
-		Json->WriteIdentifierPrefix(TEXT("properties"));
-		SerializeProperties(Json, Entry, Blueprints);
+			NextBlueprintRef += Record.NumBlueprintRefs;
+		}
+	}
 
-		Json->WriteIdentifierPrefix(TEXT("functions"));
-		SerializeFunctions(Json, Entry);
+	for (const FBlueprintEntry& Blueprint : Index.Blueprints)
+	{
+		FBinaryBlueprintRecord Record;
+		Record.Name = Strings.Find(Blueprint.Name);
+		Record.Path = Strings.Find(Blueprint.Path);
+		WriteRecord(IndexFile, Record);
+	}
 
-		Json->WriteObjectEnd();
+	for (const auto& ClassItem : Index.Classes)
+	{
+		const FClassEntry& Entry = ClassItem.Value;
+		IndexFile.Serialize(const_cast<int32*>(Entry.Blueprints.GetData()), Entry.Blueprints.Num() * sizeof(int32));
+
+		for (const auto& FnItem : Entry.Functions)
+		{
+			IndexFile.Serialize(const_cast<int32*>(FnItem.Value.Blueprints.GetData()), FnItem.Value.Blueprints.Num() * sizeof(int32));
+		}
 	}
-	Json->WriteArrayEnd();
+
+	check(IndexFile.Tell() < 0 || IndexFile.Tell() == Header.StringTableOffset);
+	Strings.Serialize(IndexFile);
 }
+} // namespace BinaryIndex
 
-static void SerializeToIndex(FAssetIndex Index, FArchive& IndexFile)
+enum class EIndexFormat
 {
-	TSharedRef<JsonWriter> Json = JsonWriter::Create(&IndexFile);
-
-	Json->WriteObjectStart();
+	Json,
+	Binary,
+};
 
-	Json->WriteIdentifierPrefix(TEXT("blueprints"));
-	SerializeBlueprints(Json, Index.Blueprints);
+static void SerializeToIndex(const FAssetIndex& Index, FArchive& IndexFile, EIndexFormat Format)
+{
+	if (Format == EIndexFormat::Binary)
+	{
+		BinaryIndex::SerializeToIndex(Index, IndexFile);
+	}
+	else
+	{
+		SerializeToIndex(Index, IndexFile);
+	}
+}
 
-	Json->WriteIdentifierPrefix(TEXT("classes"));
-	SerializeClasses(Json, Index.Classes, Index.Blueprints);
+/**
+* Writes the index in every supported format to memory and logs the write time and size of each,
+* so the formats can be compared on the same project.
+*/
+static void BenchmarkIndexFormats(const FAssetIndex& Index)
+{
+	for (EIndexFormat Format : { EIndexFormat::Json, EIndexFormat::Binary })
+	{
+		FLargeMemoryWriter Writer;
+		const double StartTime = FPlatformTime::Seconds();
+		SerializeToIndex(Index, Writer, Format);
+		const double WriteTime = FPlatformTime::Seconds() - StartTime;
 
-	Json->WriteObjectEnd();
-	Json->Close();
+		UE_LOG(LogVisualStudioTools, Display, TEXT("Index format '%s': %lld bytes written in %.3f seconds."),
+			Format == EIndexFormat::Binary ? TEXT("binary") : TEXT("json"), Writer.TotalSize(), WriteTime);
+	}
 }
 
 static TArray<FString> GetModulesByPath(const FString& InDir)
@@ -373,9 +542,14 @@ static void GetNativeClassesByPath(const FString& InDir, TArray<TWeakObjectPtr<U
 	}
 }
 
-static void RunAssetScan(
-	FAssetIndex& Index,
-	const TArray<TWeakObjectPtr<UClass>>& FilterBaseClasses)
+/**
+* Scans the blueprints derived from the filter classes. Fills `LocalIndex` and returns it, unless the
+* server keeps a warm cache, in which case the cached index is returned instead.
+*/
+static const FAssetIndex& RunAssetScan(
+	FAssetIndex& LocalIndex,
+	const TArray<TWeakObjectPtr<UClass>>& FilterBaseClasses,
+	const AssetHelpers::FForEachAssetOptions& LoadOptions)
 {
 	FARFilter Filter;
 	Filter.bRecursivePaths = true;
@@ -412,17 +586,35 @@ static void RunAssetScan(
 	TArray<FAssetData> TargetAssets;
 	AssetRegistry.GetAssets(Filter, TargetAssets);
 
-	AssetHelpers::ForEachAsset(TargetAssets,
-		[&](UBlueprintGeneratedClass* BlueprintGeneratedClass, const FAssetData& /*AssetData*/)
+	if (FWarmAssetCache* WarmCache = FWarmAssetCache::Get())
+	{
+		return WarmCache->GetIndex(TargetAssets, LoadOptions);
+	}
+
+	FNativeClassCache NativeClasses;
+	TArray<FBlueprintAnalysis> Analyses;
+	AssetHelpers::ForEachAssetBatch(TargetAssets,
+		[&](TArrayView<UBlueprintGeneratedClass* const> BlueprintClasses, TArrayView<const FAssetData* const> /*AssetData*/)
 		{
-			Index.ProcessBlueprint(BlueprintGeneratedClass);
-		});
+			// Merge in the batch order so that the index is deterministic.
+			Analyses.Reset();
+			AnalyzeBlueprints(NativeClasses, BlueprintClasses, Analyses);
+			for (const FBlueprintAnalysis& Analysis : Analyses)
+			{
+				LocalIndex.AddBlueprint(Analysis);
+			}
+		},
+		LoadOptions);
+
+	return LocalIndex;
 }
 
 } // namespace VS
 
 static constexpr auto FilterSwitch = TEXT("filter");
 static constexpr auto FullSwitch = TEXT("full");
+static constexpr auto FormatParam = TEXT("format");
+static constexpr auto BenchmarkFormatsSwitch = TEXT("benchmarkformats");
 
 UVisualStudioToolsCommandlet::UVisualStudioToolsCommandlet()
 	: Super()
@@ -435,7 +627,13 @@ UVisualStudioToolsCommandlet::UVisualStudioToolsCommandlet()
 	HelpParamNames.Add(FullSwitch);
 	HelpParamDescriptions.Add(TEXT("[Optional] Scan blueprints derived from native classes from ALL modules, include the Engine. This can be _very slow_ for large projects. Incompatible with `-filter`."));
 
-	HelpUsage = TEXT("<Editor-Cmd.exe> <path_to_uproject> -run=VisualStudioTools -output=<path_to_output_file> [-filter=<subdir_native_classes>|-full] [-unattended -noshadercompile -nosound -nullrhi -nocpuprofilertrace -nocrashreports -nosplash]");
+	HelpParamNames.Add(FormatParam);
+	HelpParamDescriptions.Add(TEXT("[Optional] Format of the output file, either `json` or `binary`. Defaults to `json`. The binary format is a compact, memory-mappable layout with a shared string table."));
+
+	HelpParamNames.Add(BenchmarkFormatsSwitch);
+	HelpParamDescriptions.Add(TEXT("[Optional] Also write the index in every format to memory and log the write time and size of each."));
+
+	HelpUsage = TEXT("<Editor-Cmd.exe> <path_to_uproject> -run=VisualStudioTools -output=<path_to_output_file> [-filter=<subdir_native_classes>|-full] [-format=json|binary] [-benchmarkformats] [-loadbatch=<count>] [-maxmemory=<megabytes>] [-unattended -noshadercompile -nosound -nullrhi -nocpuprofilertrace -nocrashreports -nosplash]");
 }
 
 int32 UVisualStudioToolsCommandlet::Run(
@@ -456,6 +654,21 @@ int32 UVisualStudioToolsCommandlet::Run(
 		return -1;
 	}
 
+	EIndexFormat Format = EIndexFormat::Json;
+	if (const FString* FormatName = ParamVals.Find(FormatParam))
+	{
+		if (FormatName->Equals(TEXT("binary"), ESearchCase::IgnoreCase))
+		{
+			Format = EIndexFormat::Binary;
+		}
+		else if (!FormatName->Equals(TEXT("json"), ESearchCase::IgnoreCase))
+		{
+			UE_LOG(LogVisualStudioTools, Error, TEXT("Unknown index format: %s."), **FormatName);
+			PrintHelp();
+			return -1;
+		}
+	}
+
 	TArray<TWeakObjectPtr<UClass>> FilterBaseClasses;
 	if (!bFullScan)
 	{
@@ -483,9 +696,18 @@ int32 UVisualStudioToolsCommandlet::Run(
 		}
 	}
 
-	FAssetIndex Index;
-	RunAssetScan(Index, FilterBaseClasses);
-	SerializeToIndex(Index, OutArchive);
+	FAssetIndex LocalIndex;
+	const FAssetIndex& Index = RunAssetScan(LocalIndex, FilterBaseClasses, GetAssetLoadOptions(ParamVals));
+
+	const double WriteStartTime = FPlatformTime::Seconds();
+	SerializeToIndex(Index, OutArchive, Format);
+	UE_LOG(LogVisualStudioTools, Display, TEXT("Index written in %.3f seconds."), FPlatformTime::Seconds() - WriteStartTime);
+
+	if (Switches.Contains(BenchmarkFormatsSwitch))
+	{
+		BenchmarkIndexFormats(Index);
+	}
+
 	UE_LOG(LogVisualStudioTools, Display, TEXT("Found %d blueprints."), Index.Blueprints.Num());
 
 	return 0;
@@ -3,16 +3,22 @@
 
 #include "VisualStudioToolsCommandletBase.h"
 
+#if PLATFORM_WINDOWS
 #include "Windows/AllowWindowsPlatformTypes.h"
+#endif
 
 #include "HAL/FileManager.h"
 #include "Misc/Paths.h"
 #include "VisualStudioTools.h"
 
+#if PLATFORM_WINDOWS
 #include "Windows/HideWindowsPlatformTypes.h"
+#endif
 
 static constexpr auto HelpSwitch = TEXT("help");
 static constexpr auto OutputSwitch = TEXT("output");
+static constexpr auto LoadBatchParam = TEXT("loadbatch");
+static constexpr auto MemoryCeilingParam = TEXT("maxmemory");
 
 UVisualStudioToolsCommandletBase::UVisualStudioToolsCommandletBase()
 {
@@ -25,6 +31,12 @@ UVisualStudioToolsCommandletBase::UVisualStudioToolsCommandletBase()
 	HelpParamNames.Add(OutputSwitch);
 	HelpParamDescriptions.Add(TEXT("[Required] The file path to write the command output."));
 
+	HelpParamNames.Add(LoadBatchParam);
+	HelpParamDescriptions.Add(TEXT("[Optional] Number of blueprint loads kept in flight while scanning assets. Defaults to 1, which loads each blueprint synchronously."));
+
+	HelpParamNames.Add(MemoryCeilingParam);
+	HelpParamDescriptions.Add(TEXT("[Optional] Used memory in MB above which the loaded blueprints are garbage collected before the scan continues. Defaults to 0, which never collects."));
+
 	HelpParamNames.Add(HelpSwitch);
 	HelpParamDescriptions.Add(TEXT("[Optional] Print this help message and quit the commandlet immediately."));
 }
@@ -40,6 +52,23 @@ void UVisualStudioToolsCommandletBase::PrintHelp() const
 	}
 }
 
+VisualStudioTools::AssetHelpers::FForEachAssetOptions UVisualStudioToolsCommandletBase::GetAssetLoadOptions(const TMap<FString, FString>& ParamVals) const
+{
+	VisualStudioTools::AssetHelpers::FForEachAssetOptions Options;
+
+	if (const FString* LoadBatch = ParamVals.Find(LoadBatchParam))
+	{
+		Options.LoadBatchSize = FMath::Max(1, FCString::Atoi(**LoadBatch));
+	}
+
+	if (const FString* MemoryCeiling = ParamVals.Find(MemoryCeilingParam))
+	{
+		Options.MemoryCeilingMB = FMath::Max(0, FCString::Atoi(**MemoryCeiling));
+	}
+
+	return Options;
+}
+
 int32 UVisualStudioToolsCommandletBase::Main(const FString& Params)
 {
 	TArray<FString> Tokens;
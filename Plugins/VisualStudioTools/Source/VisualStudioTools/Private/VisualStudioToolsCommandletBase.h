@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "BlueprintAssetHelpers.h"
 #include "Commandlets/Commandlet.h"
 
 #include "VisualStudioToolsCommandletBase.generated.h"
@@ -21,6 +22,9 @@ protected:
 	
 	void PrintHelp() const;
 
+	/** Reads the asset loading options shared by the commandlets that scan blueprints. */
+	VisualStudioTools::AssetHelpers::FForEachAssetOptions GetAssetLoadOptions(const TMap<FString, FString>& ParamVals) const;
+
 	virtual int32 Run(
 		TArray<FString>& Tokens,
 		TArray<FString>& Switches,
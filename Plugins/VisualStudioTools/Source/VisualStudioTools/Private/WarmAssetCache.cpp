@@ -0,0 +1,396 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#include "WarmAssetCache.h"
+
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "DirectoryWatcherModule.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "HAL/FileManager.h"
+#include "IDirectoryWatcher.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "PackageTools.h"
+#include "UObject/Package.h"
+#include "VisualStudioTools.h"
+
+namespace VisualStudioTools
+{
+static TUniquePtr<FWarmAssetCache> GWarmAssetCache;
+
+static IAssetRegistry& GetAssetRegistry()
+{
+	return FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+}
+
+static IDirectoryWatcher* GetDirectoryWatcher()
+{
+	return FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher")).Get();
+}
+
+void FWarmAssetCache::Initialize()
+{
+	if (!GWarmAssetCache)
+	{
+		GWarmAssetCache.Reset(new FWarmAssetCache());
+	}
+}
+
+void FWarmAssetCache::Shutdown()
+{
+	GWarmAssetCache.Reset();
+}
+
+FWarmAssetCache* FWarmAssetCache::Get()
+{
+	return GWarmAssetCache.Get();
+}
+
+FWarmAssetCache::FWarmAssetCache()
+{
+	IAssetRegistry& AssetRegistry = GetAssetRegistry();
+	AssetAddedHandle = AssetRegistry.OnAssetAdded().AddRaw(this, &FWarmAssetCache::OnAssetAdded);
+	AssetRemovedHandle = AssetRegistry.OnAssetRemoved().AddRaw(this, &FWarmAssetCache::OnAssetRemoved);
+	AssetUpdatedHandle = AssetRegistry.OnAssetUpdated().AddRaw(this, &FWarmAssetCache::OnAssetUpdated);
+	AssetRenamedHandle = AssetRegistry.OnAssetRenamed().AddRaw(this, &FWarmAssetCache::OnAssetRenamed);
+
+	// Watch the content directories, so a refresh only needs to rescan what changed.
+	if (IDirectoryWatcher* DirectoryWatcher = GetDirectoryWatcher())
+	{
+		TArray<FString> RootPaths;
+		AssetHelpers::GetProjectContentPaths(RootPaths);
+
+		for (const FString& RootPath : RootPaths)
+		{
+			FString RootDir;
+			FPackageName::TryConvertLongPackageNameToFilename(RootPath, RootDir);
+			RootDir = FPaths::ConvertRelativePathToFull(RootDir);
+
+			FDelegateHandle Handle;
+			if (!DirectoryWatcher->RegisterDirectoryChangedCallback_Handle(
+				RootDir,
+				IDirectoryWatcher::FDirectoryChanged::CreateRaw(this, &FWarmAssetCache::OnDirectoryChanged),
+				Handle,
+				IDirectoryWatcher::WatchOptions::IncludeDirectoryChanges))
+			{
+				UE_LOG(LogVisualStudioTools, Warning, TEXT("Failed to watch %s, each request will rescan the whole project content."), *RootDir);
+				StopWatchingContent();
+				break;
+			}
+
+			WatchedDirectories.Add(RootDir, Handle);
+		}
+	}
+}
+
+FWarmAssetCache::~FWarmAssetCache()
+{
+	if (FAssetRegistryModule* AssetRegistryModule = FModuleManager::GetModulePtr<FAssetRegistryModule>(TEXT("AssetRegistry")))
+	{
+		IAssetRegistry& AssetRegistry = AssetRegistryModule->Get();
+		AssetRegistry.OnAssetAdded().Remove(AssetAddedHandle);
+		AssetRegistry.OnAssetRemoved().Remove(AssetRemovedHandle);
+		AssetRegistry.OnAssetUpdated().Remove(AssetUpdatedHandle);
+		AssetRegistry.OnAssetRenamed().Remove(AssetRenamedHandle);
+	}
+
+	StopWatchingContent();
+}
+
+void FWarmAssetCache::StopWatchingContent()
+{
+	if (FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher")))
+	{
+		if (IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule->Get())
+		{
+			for (const auto& Item : WatchedDirectories)
+			{
+				DirectoryWatcher->UnregisterDirectoryChangedCallback_Handle(Item.Key, Item.Value);
+			}
+		}
+	}
+
+	WatchedDirectories.Reset();
+}
+
+void FWarmAssetCache::Refresh()
+{
+	const double StartTime = FPlatformTime::Seconds();
+	IAssetRegistry& AssetRegistry = GetAssetRegistry();
+
+	// The registry reports the differences through the delegates bound in the constructor.
+	if (WatchedDirectories.Num() > 0)
+	{
+		// The commandlet does not tick the engine, deliver the notifications collected since the previous request.
+		GetDirectoryWatcher()->Tick(0.0f);
+
+		if (ChangedFiles.Num() > 0)
+		{
+			AssetRegistry.ScanFilesSynchronous(ChangedFiles.Array(), true /*bForceRescan*/);
+		}
+
+		if (ChangedPaths.Num() > 0)
+		{
+			AssetRegistry.ScanPathsSynchronous(ChangedPaths.Array(), true /*bForceRescan*/);
+		}
+
+		UE_LOG(LogVisualStudioTools, Display, TEXT("Rescanned %d changed files and %d changed paths."), ChangedFiles.Num(), ChangedPaths.Num());
+		ChangedFiles.Reset();
+		ChangedPaths.Reset();
+	}
+	else
+	{
+		TArray<FString> RootPaths;
+		AssetHelpers::GetProjectContentPaths(RootPaths);
+		AssetRegistry.ScanPathsSynchronous(RootPaths, true /*bForceRescan*/);
+	}
+
+	UnloadChangedPackages();
+
+	UE_LOG(LogVisualStudioTools, Display, TEXT("Asset registry refreshed in %.3f seconds."), FPlatformTime::Seconds() - StartTime);
+}
+
+void FWarmAssetCache::UnloadChangedPackages()
+{
+	IAssetRegistry& AssetRegistry = GetAssetRegistry();
+
+	// Loading a package that is already in memory hands back the loaded copy, without the changes
+	// made on disk. A loaded blueprint also keeps its parent class alive, so the packages depending
+	// on a changed package are unloaded with it.
+	TArray<FName> PendingPackages = ChangedPackages.Array();
+	TSet<FName> VisitedPackages = MoveTemp(ChangedPackages);
+	ChangedPackages.Reset();
+
+	TArray<UPackage*> LoadedPackages;
+	TArray<FName> Referencers;
+	while (PendingPackages.Num() > 0)
+	{
+		const FName PackageName = PendingPackages.Pop(EAllowShrinking::No);
+		if (UPackage* Package = FindPackage(nullptr, *PackageName.ToString()))
+		{
+			LoadedPackages.Add(Package);
+		}
+
+		Referencers.Reset();
+		AssetRegistry.GetReferencers(PackageName, Referencers, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+		for (FName Referencer : Referencers)
+		{
+			bool bAlreadyVisited = false;
+			VisitedPackages.Add(Referencer, &bAlreadyVisited);
+			if (!bAlreadyVisited)
+			{
+				PendingPackages.Add(Referencer);
+			}
+		}
+	}
+
+	if (LoadedPackages.Num() == 0)
+	{
+		return;
+	}
+
+	FText ErrorMessage;
+	if (UPackageTools::UnloadPackages(LoadedPackages, ErrorMessage, true /*bUnloadDirtyPackages*/))
+	{
+		UE_LOG(LogVisualStudioTools, Display, TEXT("Unloaded %d changed packages."), LoadedPackages.Num());
+	}
+	else
+	{
+		UE_LOG(LogVisualStudioTools, Warning, TEXT("Failed to unload the changed packages, their analysis may be outdated: %s"), *ErrorMessage.ToString());
+	}
+}
+
+const FAssetIndex& FWarmAssetCache::GetIndex(const TArray<FAssetData>& TargetAssets, const AssetHelpers::FForEachAssetOptions& LoadOptions)
+{
+	IAssetRegistry& AssetRegistry = GetAssetRegistry();
+
+	uint32 Key = 0;
+	TSet<FName> TargetPackages;
+	TSet<FName> StalePackages;
+	TMap<FName, FFileStatData> FileStats;
+
+	for (const FAssetData& AssetData : TargetAssets)
+	{
+		Key = HashCombine(Key, GetTypeHash(AssetData.PackageName));
+		TargetPackages.Add(AssetData.PackageName);
+
+		const FFileStatData FileStat = IFileManager::Get().GetStatData(*AssetHelpers::GetPackageFilePath(AssetData));
+		FileStats.Add(AssetData.PackageName, FileStat);
+
+		const FCachedBlueprint* Cached = Blueprints.Find(AssetData.PackageName);
+		if (Cached == nullptr
+			|| DirtyPackages.Contains(AssetData.PackageName)
+			|| Cached->TimeStamp != FileStat.ModificationTime
+			|| Cached->FileSize != FileStat.FileSize)
+		{
+			StalePackages.Add(AssetData.PackageName);
+		}
+	}
+
+	// A blueprint inherits the defaults of its blueprint parents, so it must be analyzed again
+	// when any package it depends on changed, even if its own file did not.
+	TArray<FName> PendingPackages = StalePackages.Array();
+	PendingPackages.Append(DirtyPackages.Array());
+	TArray<FName> Referencers;
+	while (PendingPackages.Num() > 0)
+	{
+		const FName PackageName = PendingPackages.Pop(EAllowShrinking::No);
+
+		Referencers.Reset();
+		AssetRegistry.GetReferencers(PackageName, Referencers, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+		for (FName Referencer : Referencers)
+		{
+			if (TargetPackages.Contains(Referencer) && !StalePackages.Contains(Referencer))
+			{
+				StalePackages.Add(Referencer);
+				PendingPackages.Add(Referencer);
+			}
+		}
+	}
+
+	DirtyPackages.Reset();
+
+	if (StalePackages.Num() == 0 && bIndexValid && Key == IndexKey)
+	{
+		UE_LOG(LogVisualStudioTools, Display, TEXT("Reusing the index of %d blueprints."), Index.Blueprints.Num());
+		return Index;
+	}
+
+	TArray<FAssetData> StaleAssets;
+	for (const FAssetData& AssetData : TargetAssets)
+	{
+		if (StalePackages.Contains(AssetData.PackageName))
+		{
+			// Reset the entry up front, so that blueprints which fail to load are not retried until they change.
+			FCachedBlueprint& Cached = Blueprints.Add(AssetData.PackageName);
+			Cached.TimeStamp = FileStats[AssetData.PackageName].ModificationTime;
+			Cached.FileSize = FileStats[AssetData.PackageName].FileSize;
+
+			StaleAssets.Add(AssetData);
+		}
+	}
+
+	TArray<FBlueprintAnalysis> Analyses;
+	AssetHelpers::ForEachAssetBatch(StaleAssets,
+		[&](TArrayView<UBlueprintGeneratedClass* const> BlueprintClasses, TArrayView<const FAssetData* const> AssetData)
+		{
+			Analyses.Reset();
+			AnalyzeBlueprints(NativeClasses, BlueprintClasses, Analyses);
+
+			for (int32 Idx = 0; Idx < Analyses.Num(); Idx++)
+			{
+				Blueprints.FindChecked(AssetData[Idx]->PackageName).Analysis = MoveTemp(Analyses[Idx]);
+			}
+		},
+		LoadOptions);
+
+	// Assemble the index in the order of the target assets, same as a full scan.
+	Index = FAssetIndex();
+	for (const FAssetData& AssetData : TargetAssets)
+	{
+		Index.AddBlueprint(Blueprints.FindChecked(AssetData.PackageName).Analysis);
+	}
+
+	IndexKey = Key;
+	bIndexValid = true;
+
+	UE_LOG(LogVisualStudioTools, Display, TEXT("Index updated: %d blueprints, %d analyzed again."), Index.Blueprints.Num(), StaleAssets.Num());
+	return Index;
+}
+
+const FBlueprintCallGraphIndex& FWarmAssetCache::GetCallGraph(const TArray<FAssetData>& BlueprintAssets, const AssetHelpers::FForEachAssetOptions& LoadOptions)
+{
+	const FString IndexFilePath = FBlueprintCallGraphIndex::GetDefaultFilePath();
+
+	if (!bCallGraphLoaded)
+	{
+		CallGraph.Load(IndexFilePath);
+		bCallGraphLoaded = true;
+	}
+
+	if (CallGraph.Update(BlueprintAssets, LoadOptions))
+	{
+		CallGraph.Save(IndexFilePath);
+	}
+
+	return CallGraph;
+}
+
+void FWarmAssetCache::MarkPackageDirty(FName PackageName)
+{
+	DirtyPackages.Add(PackageName);
+	ChangedPackages.Add(PackageName);
+	CallGraph.MarkPackageDirty(PackageName);
+	bIndexValid = false;
+}
+
+void FWarmAssetCache::OnAssetAdded(const FAssetData& AssetData)
+{
+	MarkPackageDirty(AssetData.PackageName);
+}
+
+void FWarmAssetCache::OnAssetRemoved(const FAssetData& AssetData)
+{
+	// Keep the package dirty, so the blueprints referencing it are analyzed again.
+	Blueprints.Remove(AssetData.PackageName);
+	MarkPackageDirty(AssetData.PackageName);
+}
+
+void FWarmAssetCache::OnAssetUpdated(const FAssetData& AssetData)
+{
+	MarkPackageDirty(AssetData.PackageName);
+}
+
+void FWarmAssetCache::OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath)
+{
+	const FName OldPackageName = FName(*FPackageName::ObjectPathToPackageName(OldObjectPath));
+	Blueprints.Remove(OldPackageName);
+	MarkPackageDirty(OldPackageName);
+	MarkPackageDirty(AssetData.PackageName);
+}
+
+void FWarmAssetCache::OnDirectoryChanged(const TArray<FFileChangeData>& FileChanges)
+{
+	for (const FFileChangeData& FileChange : FileChanges)
+	{
+		const FString Filename = FPaths::ConvertRelativePathToFull(FileChange.Filename);
+		const FString Extension = FPaths::GetExtension(Filename, true /*bIncludeDot*/);
+
+		FString PackageName;
+		if (FPackageName::IsPackageExtension(*Extension))
+		{
+			if (!FPackageName::TryConvertFilenameToLongPackageName(Filename, PackageName))
+			{
+				continue;
+			}
+
+			MarkPackageDirty(FName(*PackageName));
+			if (FileChange.Action == FFileChangeData::FCA_Removed)
+			{
+				// The registry only drops the assets of a deleted file when its directory is rescanned.
+				ChangedFiles.Remove(Filename);
+				ChangedPaths.Add(FPackageName::GetLongPackagePath(PackageName));
+			}
+			else
+			{
+				ChangedFiles.Add(Filename);
+			}
+		}
+		else if (Extension.IsEmpty())
+		{
+			// A directory was added, removed or renamed, rescan the directory containing it.
+			FString ParentPath;
+			if (FPackageName::TryConvertFilenameToLongPackageName(FPaths::GetPath(Filename), ParentPath))
+			{
+				ChangedPaths.Add(ParentPath);
+			}
+			else
+			{
+				TArray<FString> RootPaths;
+				AssetHelpers::GetProjectContentPaths(RootPaths);
+				ChangedPaths.Append(RootPaths);
+			}
+		}
+	}
+}
+} // namespace VisualStudioTools
@@ -0,0 +1,112 @@
+// Copyright 2022 (c) Microsoft. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "AssetIndex.h"
+#include "BlueprintAssetHelpers.h"
+#include "BlueprintCallGraphIndex.h"
+#include "CoreMinimal.h"
+
+struct FFileChangeData;
+
+namespace VisualStudioTools
+{
+/**
+* Blueprint data kept in memory between the requests handled by the server commandlet.
+*
+* The analyses of the blueprints and the call graph are kept per package, and a package is only
+* loaded again when the asset registry reports it as added, updated or renamed, or when its file
+* changed on disk. The assembled `FAssetIndex` is reused as long as neither the requested assets
+* nor their analyses changed.
+*
+* The project content directories are watched for changes, so a refresh only rescans the files
+* and directories that changed since the previous request.
+*
+* The cache only exists in server mode. Single-run commandlets do not create it and keep scanning
+* the assets from scratch.
+*/
+class FWarmAssetCache
+{
+public:
+	/** Creates the process-wide cache. */
+	static void Initialize();
+
+	static void Shutdown();
+
+	/** Retrieves the process-wide cache, or null when it was not initialized. */
+	static FWarmAssetCache* Get();
+
+	~FWarmAssetCache();
+
+	/**
+	* Rescans the project content that changed since the previous request, so that the asset registry
+	* reports the packages that were added, removed or modified. Changed packages that are still loaded,
+	* and the loaded packages depending on them, are unloaded so the next request reads them from disk.
+	* Must be called before answering a request.
+	*/
+	void Refresh();
+
+	/**
+	* Retrieves the index for the given blueprint assets.
+	* Only the blueprints that are new, changed or depend on a changed package are loaded and analyzed.
+	*/
+	const FAssetIndex& GetIndex(const TArray<FAssetData>& TargetAssets, const AssetHelpers::FForEachAssetOptions& LoadOptions);
+
+	/**
+	* Retrieves the call graph, updated for the given blueprint assets.
+	* The graph is read from disk on first use, and saved back whenever it changes.
+	*/
+	const FBlueprintCallGraphIndex& GetCallGraph(const TArray<FAssetData>& BlueprintAssets, const AssetHelpers::FForEachAssetOptions& LoadOptions);
+
+private:
+	FWarmAssetCache();
+
+	void MarkPackageDirty(FName PackageName);
+	void UnloadChangedPackages();
+	void StopWatchingContent();
+
+	void OnAssetAdded(const FAssetData& AssetData);
+	void OnAssetRemoved(const FAssetData& AssetData);
+	void OnAssetUpdated(const FAssetData& AssetData);
+	void OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath);
+	void OnDirectoryChanged(const TArray<FFileChangeData>& FileChanges);
+
+	struct FCachedBlueprint
+	{
+		FBlueprintAnalysis Analysis;
+		FDateTime TimeStamp;
+		int64 FileSize = 0;
+	};
+
+	// Referenced by the cached analyses, so it must outlive them.
+	FNativeClassCache NativeClasses;
+
+	// Analyses keyed by package name. Blueprints that failed to load have an analysis without parents.
+	TMap<FName, FCachedBlueprint> Blueprints;
+	TSet<FName> DirtyPackages;
+
+	// Packages that changed since the previous refresh, their loaded copies are outdated.
+	TSet<FName> ChangedPackages;
+
+	// Package files and content paths reported by the directory watcher since the previous refresh.
+	TSet<FString> ChangedFiles;
+	TSet<FString> ChangedPaths;
+
+	// Content directories on disk and their watcher handles. Empty when the content is not watched,
+	// in which case every refresh rescans the whole project content.
+	TMap<FString, FDelegateHandle> WatchedDirectories;
+
+	FAssetIndex Index;
+	uint32 IndexKey = 0;
+	bool bIndexValid = false;
+
+	FBlueprintCallGraphIndex CallGraph;
+	bool bCallGraphLoaded = false;
+
+	FDelegateHandle AssetAddedHandle;
+	FDelegateHandle AssetRemovedHandle;
+	FDelegateHandle AssetUpdatedHandle;
+	FDelegateHandle AssetRenamedHandle;
+};
+} // namespace VisualStudioTools
@@ -55,7 +55,9 @@ public class VisualStudioTools : ModuleRules
             new string[]
             {
                 "AssetRegistry",
+                "BlueprintGraph",
                 "CoreUObject",
+                "DirectoryWatcher",
                 "Engine",
                 "Json",
                 "JsonUtilities",
@@ -0,0 +1,240 @@
+﻿#include "ActorPoolSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/PlatformTime.h"
+#include "PooledActorComponent.h"
+#include "TimerManager.h"
+
+DECLARE_STATS_GROUP(TEXT("ActorPool"), STATGROUP_ActorPool, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Acquire"), STAT_ActorPool_Acquire, STATGROUP_ActorPool);
+DECLARE_CYCLE_STAT(TEXT("Release"), STAT_ActorPool_Release, STATGROUP_ActorPool);
+DECLARE_CYCLE_STAT(TEXT("Spawn"), STAT_ActorPool_Spawn, STATGROUP_ActorPool);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hits"), STAT_ActorPool_Hits, STATGROUP_ActorPool);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Misses"), STAT_ActorPool_Misses, STATGROUP_ActorPool);
+
+namespace ActorPool
+{
+    // Vorab erzeugte Actors entstehen weit unter der Welt, damit ihr BeginPlay nichts trifft.
+    static const FVector PrewarmLocation(0.0, 0.0, -100000.0);
+}
+
+bool UActorPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UActorPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    for (const FActorPoolClassSettings& Settings : PoolClasses)
+    {
+        UClass* ActorClass = Settings.ActorClass.LoadSynchronous();
+        if (!ActorClass)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("ActorPool: failed to load %s."), *Settings.ActorClass.ToString());
+            continue;
+        }
+
+        FindOrAddPool(ActorClass).MaxPooled = Settings.MaxPooled;
+
+        // Replizierte Actors erzeugt nur der Server, Clients bekommen sie über die Replikation.
+        const bool bReplicated = ActorClass->GetDefaultObject<AActor>()->GetIsReplicated();
+        if (!bReplicated || InWorld.GetNetMode() != NM_Client)
+        {
+            Prewarm(ActorClass, Settings.PrewarmCount);
+        }
+    }
+}
+
+void UActorPoolSubsystem::Deinitialize()
+{
+    Pools.Empty();
+
+    Super::Deinitialize();
+}
+
+FActorPoolEntry& UActorPoolSubsystem::FindOrAddPool(UClass* ActorClass)
+{
+    return Pools.FindOrAdd(ActorClass);
+}
+
+AActor* UActorPoolSubsystem::SpawnPooledActor(UClass* ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator)
+{
+    SCOPE_CYCLE_COUNTER(STAT_ActorPool_Spawn);
+    const double StartTime = FPlatformTime::Seconds();
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.Owner = Owner;
+    SpawnParams.Instigator = Instigator;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+    AActor* Actor = GetWorld()->SpawnActor<AActor>(ActorClass, Transform, SpawnParams);
+    if (Actor)
+    {
+        UPooledActorComponent* PoolComponent = NewObject<UPooledActorComponent>(Actor, TEXT("PooledActor"));
+        PoolComponent->SetIsReplicated(Actor->GetIsReplicated());
+        PoolComponent->RegisterComponent();
+        Actor->AddInstanceComponent(PoolComponent);
+
+        // BeginPlay hat die Lebensdauer schon gestartet, ab jetzt übernimmt StartLifeSpan.
+        Actor->SetLifeSpan(0.0f);
+    }
+
+    Stats.SpawnMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+    return Actor;
+}
+
+void UActorPoolSubsystem::StartLifeSpan(AActor* Actor)
+{
+    const float LifeSpan = Actor->GetClass()->GetDefaultObject<AActor>()->InitialLifeSpan;
+    UPooledActorComponent* PoolComponent = Actor->FindComponentByClass<UPooledActorComponent>();
+    if (LifeSpan <= 0.0f || !PoolComponent)
+    {
+        return;
+    }
+
+    TWeakObjectPtr<AActor> WeakActor = Actor;
+    GetWorld()->GetTimerManager().SetTimer(PoolComponent->LifeSpanTimer, FTimerDelegate::CreateWeakLambda(this, [this, WeakActor]()
+    {
+        ReleaseActor(WeakActor.Get());
+    }), LifeSpan, false);
+}
+
+AActor* UActorPoolSubsystem::AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator)
+{
+    SCOPE_CYCLE_COUNTER(STAT_ActorPool_Acquire);
+
+    if (!ActorClass)
+    {
+        return nullptr;
+    }
+
+    FActorPoolEntry& Pool = FindOrAddPool(ActorClass);
+    while (Pool.Free.Num() > 0)
+    {
+        AActor* Actor = Pool.Free.Pop();
+        UPooledActorComponent* PoolComponent = IsValid(Actor) ? Actor->FindComponentByClass<UPooledActorComponent>() : nullptr;
+        if (!PoolComponent)
+        {
+            continue;
+        }
+
+        Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+        Actor->SetOwner(Owner);
+        Actor->SetInstigator(Instigator);
+
+        if (Actor->GetIsReplicated() && Actor->HasAuthority())
+        {
+            Actor->SetNetDormancy(Actor->GetClass()->GetDefaultObject<AActor>()->NetDormancy);
+            Actor->FlushNetDormancy();
+            Actor->ForceNetUpdate();
+        }
+
+        PoolComponent->SetInPool(false);
+        StartLifeSpan(Actor);
+
+        Stats.Hits++;
+        INC_DWORD_STAT(STAT_ActorPool_Hits);
+        return Actor;
+    }
+
+    AActor* Actor = SpawnPooledActor(ActorClass, Transform, Owner, Instigator);
+    if (Actor)
+    {
+        StartLifeSpan(Actor);
+    }
+
+    Stats.Misses++;
+    INC_DWORD_STAT(STAT_ActorPool_Misses);
+    return Actor;
+}
+
+void UActorPoolSubsystem::ReleaseActor(AActor* Actor)
+{
+    SCOPE_CYCLE_COUNTER(STAT_ActorPool_Release);
+
+    if (!IsValid(Actor))
+    {
+        return;
+    }
+
+    // Replizierte Actors gibt nur der Server frei, sonst weicht der Pool-Zustand vom Server ab.
+    if (Actor->GetIsReplicated() && !Actor->HasAuthority())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("ActorPool: ignoring release of replicated actor %s without authority."), *Actor->GetName());
+        return;
+    }
+
+    UPooledActorComponent* PoolComponent = Actor->FindComponentByClass<UPooledActorComponent>();
+    if (!PoolComponent)
+    {
+        Actor->Destroy();
+        return;
+    }
+
+    if (PoolComponent->IsInPool())
+    {
+        return;
+    }
+
+    Stats.Releases++;
+
+    FActorPoolEntry& Pool = FindOrAddPool(Actor->GetClass());
+    if (Pool.Free.Num() >= Pool.MaxPooled)
+    {
+        Stats.Discarded++;
+        Actor->Destroy();
+        return;
+    }
+
+    ParkActor(Actor, *PoolComponent, Pool);
+}
+
+void UActorPoolSubsystem::ParkActor(AActor* Actor, UPooledActorComponent& PoolComponent, FActorPoolEntry& Pool)
+{
+    PoolComponent.SetInPool(true);
+    Actor->SetOwner(nullptr);
+
+    // Der Pool-Zustand geht noch raus, danach kostet der freie Actor keine Bandbreite mehr.
+    if (Actor->GetIsReplicated() && Actor->HasAuthority())
+    {
+        Actor->ForceNetUpdate();
+        Actor->SetNetDormancy(DORM_DormantAll);
+    }
+
+    Pool.Free.Add(Actor);
+}
+
+void UActorPoolSubsystem::Prewarm(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+    if (!ActorClass)
+    {
+        return;
+    }
+
+    const int32 TargetCount = FMath::Min(Count, FindOrAddPool(ActorClass).MaxPooled);
+    while (FindOrAddPool(ActorClass).Free.Num() < TargetCount)
+    {
+        AActor* Actor = SpawnPooledActor(ActorClass, FTransform(ActorPool::PrewarmLocation), nullptr, nullptr);
+        if (!Actor)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("ActorPool: failed to prewarm %s."), *ActorClass->GetName());
+            return;
+        }
+
+        // Erst nach dem Spawn nachschlagen: BeginPlay kann weitere Pools anlegen und die Map umbauen.
+        ParkActor(Actor, *Actor->FindComponentByClass<UPooledActorComponent>(), FindOrAddPool(ActorClass));
+    }
+}
+
+FActorPoolStats UActorPoolSubsystem::GetStats() const
+{
+    FActorPoolStats Result = Stats;
+    for (const TPair<TObjectPtr<UClass>, FActorPoolEntry>& Pool : Pools)
+    {
+        Result.FreeActors += Pool.Value.Free.Num();
+    }
+    return Result;
+}
@@ -0,0 +1,123 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ActorPoolSubsystem.generated.h"
+
+class APawn;
+class UPooledActorComponent;
+
+/** Pool-Einstellungen für eine Klasse, in DefaultGame.ini unter [/Script/ItsSomeKindOfMagicMP.ActorPoolSubsystem]. */
+USTRUCT()
+struct FActorPoolClassSettings
+{
+    GENERATED_BODY()
+
+    UPROPERTY(Config)
+    TSoftClassPtr<AActor> ActorClass;
+
+    /** So viele Actors werden bei BeginPlay der Welt vorab erzeugt */
+    UPROPERTY(Config)
+    int32 PrewarmCount = 0;
+
+    /** Mehr freie Actors werden nicht behalten, der Rest wird zerstört */
+    UPROPERTY(Config)
+    int32 MaxPooled = 32;
+};
+
+/** Zähler seit Start der Welt, z. B. für den Soak-Benchmark. */
+USTRUCT(BlueprintType)
+struct FActorPoolStats
+{
+    GENERATED_BODY()
+
+    /** Acquire aus dem Pool bedient */
+    UPROPERTY(BlueprintReadOnly, Category = "Pool")
+    int32 Hits = 0;
+
+    /** Acquire musste neu spawnen */
+    UPROPERTY(BlueprintReadOnly, Category = "Pool")
+    int32 Misses = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Pool")
+    int32 Releases = 0;
+
+    /** Beim Release zerstört, weil der Pool voll war */
+    UPROPERTY(BlueprintReadOnly, Category = "Pool")
+    int32 Discarded = 0;
+
+    /** Summe der Spawn-Zeit in ms, inklusive Prewarm */
+    UPROPERTY(BlueprintReadOnly, Category = "Pool")
+    float SpawnMs = 0.0f;
+
+    /** Derzeit freie Actors über alle Klassen */
+    UPROPERTY(BlueprintReadOnly, Category = "Pool")
+    int32 FreeActors = 0;
+};
+
+USTRUCT()
+struct FActorPoolEntry
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    TArray<TObjectPtr<AActor>> Free;
+
+    int32 MaxPooled = 32;
+};
+
+/**
+ * UActorPoolSubsystem
+ *
+ * Pool für Spells und Spawnable Objects (BP_Spell_*, BP_BlackHole, BP_IceStorm, ...). Statt
+ * SpawnActor / DestroyActor rufen die Blueprints AcquireActor / ReleaseActor auf; Construction
+ * Script, Registrierung der Komponenten und GC entfallen dann bei jedem weiteren Cast.
+ *
+ * Replizierte Klassen werden nur mit Autorität gepoolt, der Pool-Zustand repliziert über
+ * UPooledActorComponent, freie Actors sind dormant. Reset-Hooks: IPooledActorInterface.
+ */
+UCLASS(Config = Game)
+class ITSSOMEKINDOFMAGICMP_API UActorPoolSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+
+    /**
+     * Holt einen Actor der Klasse aus dem Pool oder spawnt einen neuen.
+     * Ein replizierter Actor, der auf einem Client geholt wird, existiert nur lokal.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Pool", meta = (DeterminesOutputType = "ActorClass"))
+    AActor* AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr);
+
+    /** Legt den Actor zurück in den Pool. Nicht gepoolte Actors werden zerstört. Replizierte Actors nur mit Autorität. */
+    UFUNCTION(BlueprintCallable, Category = "Pool")
+    void ReleaseActor(AActor* Actor);
+
+    /** Erzeugt freie Actors, bis Count erreicht ist. */
+    UFUNCTION(BlueprintCallable, Category = "Pool")
+    void Prewarm(TSubclassOf<AActor> ActorClass, int32 Count);
+
+    UFUNCTION(BlueprintPure, Category = "Pool")
+    FActorPoolStats GetStats() const;
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    AActor* SpawnPooledActor(UClass* ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator);
+    void StartLifeSpan(AActor* Actor);
+    void ParkActor(AActor* Actor, UPooledActorComponent& PoolComponent, FActorPoolEntry& Pool);
+
+    FActorPoolEntry& FindOrAddPool(UClass* ActorClass);
+
+    UPROPERTY(Config)
+    TArray<FActorPoolClassSettings> PoolClasses;
+
+    UPROPERTY()
+    TMap<TObjectPtr<UClass>, FActorPoolEntry> Pools;
+
+    FActorPoolStats Stats;
+};
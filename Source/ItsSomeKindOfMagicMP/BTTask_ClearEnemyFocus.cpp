@@ -0,0 +1,20 @@
+#include "BTTask_ClearEnemyFocus.h"
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+
+UBTTask_ClearEnemyFocus::UBTTask_ClearEnemyFocus()
+{
+    NodeName = TEXT("Clear Enemy Focus");
+}
+
+EBTNodeResult::Type UBTTask_ClearEnemyFocus::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+    AAIController* Controller = OwnerComp.GetAIOwner();
+    if (!Controller)
+    {
+        return EBTNodeResult::Failed;
+    }
+
+    Controller->ClearFocus(EAIFocusPriority::Gameplay);
+    return EBTNodeResult::Succeeded;
+}
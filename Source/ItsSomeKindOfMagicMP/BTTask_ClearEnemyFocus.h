@@ -0,0 +1,21 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_ClearEnemyFocus.generated.h"
+
+/**
+ * UBTTask_ClearEnemyFocus
+ *
+ * Ersatz für BTT_ClearFocus: löscht den Fokus, den UBTTask_SetEnemyFocus gesetzt hat.
+ */
+UCLASS(meta = (DisplayName = "Clear Enemy Focus"))
+class ITSSOMEKINDOFMAGICMP_API UBTTask_ClearEnemyFocus : public UBTTaskNode
+{
+    GENERATED_BODY()
+
+public:
+    UBTTask_ClearEnemyFocus();
+
+    virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+};
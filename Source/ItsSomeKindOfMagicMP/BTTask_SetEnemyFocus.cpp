@@ -0,0 +1,68 @@
+#include "BTTask_SetEnemyFocus.h"
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
+#include "EnemyAITypes.h"
+
+UBTTask_SetEnemyFocus::UBTTask_SetEnemyFocus()
+{
+    NodeName = TEXT("Set Enemy Focus");
+
+    FocusKey.SelectedKeyName = EnemyAI::AttackTargetKeyName;
+    FocusKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_SetEnemyFocus, FocusKey), AActor::StaticClass());
+    FocusKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_SetEnemyFocus, FocusKey));
+}
+
+void UBTTask_SetEnemyFocus::InitializeFromAsset(UBehaviorTree& Asset)
+{
+    Super::InitializeFromAsset(Asset);
+
+    if (const UBlackboardData* BBAsset = GetBlackboardAsset())
+    {
+        FocusKey.ResolveSelectedKey(*BBAsset);
+    }
+}
+
+EBTNodeResult::Type UBTTask_SetEnemyFocus::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+    AAIController* Controller = OwnerComp.GetAIOwner();
+    const UBlackboardComponent* Blackboard = OwnerComp.GetBlackboardComponent();
+    if (!Controller || !Blackboard)
+    {
+        return EBTNodeResult::Failed;
+    }
+
+    if (FocusKey.SelectedKeyType == UBlackboardKeyType_Object::StaticClass())
+    {
+        AActor* Target = Cast<AActor>(Blackboard->GetValue<UBlackboardKeyType_Object>(FocusKey.GetSelectedKeyID()));
+        if (!Target)
+        {
+            return EBTNodeResult::Failed;
+        }
+
+        Controller->SetFocus(Target);
+        return EBTNodeResult::Succeeded;
+    }
+
+    if (FocusKey.SelectedKeyType == UBlackboardKeyType_Vector::StaticClass())
+    {
+        const FVector FocalPoint = Blackboard->GetValue<UBlackboardKeyType_Vector>(FocusKey.GetSelectedKeyID());
+        if (!FAISystem::IsValidLocation(FocalPoint))
+        {
+            return EBTNodeResult::Failed;
+        }
+
+        Controller->SetFocalPoint(FocalPoint);
+        return EBTNodeResult::Succeeded;
+    }
+
+    return EBTNodeResult::Failed;
+}
+
+FString UBTTask_SetEnemyFocus::GetStaticDescription() const
+{
+    return FString::Printf(TEXT("%s: %s"), *Super::GetStaticDescription(), *FocusKey.SelectedKeyName.ToString());
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_SetEnemyFocus.generated.h"
+
+/**
+ * UBTTask_SetEnemyFocus
+ *
+ * Ersatz für BTT_FocusAttackTarget und BTT_SetFocalPoint. Mit einem Actor-Key (AttackTarget)
+ * folgt der Controller dem Actor, mit einem Vektor-Key (PointOfInterest) schaut er auf den Ort.
+ * Scheitert, wenn der Key keinen gültigen Wert hat.
+ */
+UCLASS(meta = (DisplayName = "Set Enemy Focus"))
+class ITSSOMEKINDOFMAGICMP_API UBTTask_SetEnemyFocus : public UBTTaskNode
+{
+    GENERATED_BODY()
+
+public:
+    UBTTask_SetEnemyFocus();
+
+    virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+    virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+    virtual FString GetStaticDescription() const override;
+
+    UPROPERTY(EditAnywhere, Category = "Focus")
+    FBlackboardKeySelector FocusKey;
+};
@@ -0,0 +1,85 @@
+#include "BTTask_SetEnemyMovementSpeed.h"
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "StatusEffectComponent.h"
+
+UBTTask_SetEnemyMovementSpeed::UBTTask_SetEnemyMovementSpeed()
+{
+    NodeName = TEXT("Set Enemy Movement Speed");
+}
+
+EBTNodeResult::Type UBTTask_SetEnemyMovementSpeed::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+    const AAIController* Controller = OwnerComp.GetAIOwner();
+    ACharacter* Character = Controller ? Controller->GetPawn<ACharacter>() : nullptr;
+    UCharacterMovementComponent* Movement = Character ? Character->GetCharacterMovement() : nullptr;
+    UFunction* SetMovementSpeed = Character ? Character->FindFunction(EnemyAI::SetMovementSpeedFunctionName) : nullptr;
+    if (!Movement || !SetMovementSpeed)
+    {
+        return EBTNodeResult::Failed;
+    }
+
+    // EAI_SetMovementSpeed(MovementState) -> MovementSpeed, die Gangart ist ein Byte-Enum.
+    uint8* Params = static_cast<uint8*>(FMemory_Alloca(FMath::Max<int32>(SetMovementSpeed->ParmsSize, 1)));
+    FMemory::Memzero(Params, SetMovementSpeed->ParmsSize);
+
+    FNumericProperty* SpeedProperty = nullptr;
+    bool bStateSet = false;
+    for (TFieldIterator<FProperty> It(SetMovementSpeed); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+    {
+        It->InitializeValue_InContainer(Params);
+
+        if (It->HasAnyPropertyFlags(CPF_ReturnParm | CPF_OutParm))
+        {
+            SpeedProperty = SpeedProperty ? SpeedProperty : CastField<FNumericProperty>(*It);
+        }
+        else if (FByteProperty* StateProperty = CastField<FByteProperty>(*It); StateProperty && !bStateSet)
+        {
+            StateProperty->SetPropertyValue_InContainer(Params, static_cast<uint8>(MovementState));
+            bStateSet = true;
+        }
+    }
+
+    double Speed = -1.0;
+    if (bStateSet)
+    {
+        Character->ProcessEvent(SetMovementSpeed, Params);
+        if (SpeedProperty)
+        {
+            Speed = SpeedProperty->IsFloatingPoint()
+                ? SpeedProperty->GetFloatingPointPropertyValue(SpeedProperty->ContainerPtrToValuePtr<void>(Params))
+                : static_cast<double>(SpeedProperty->GetSignedIntPropertyValue(SpeedProperty->ContainerPtrToValuePtr<void>(Params)));
+        }
+    }
+
+    for (TFieldIterator<FProperty> It(SetMovementSpeed); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+    {
+        It->DestroyValue_InContainer(Params);
+    }
+
+    if (!bStateSet)
+    {
+        UE_LOG(LogTemp, Error, TEXT("%s: %s on %s has no E_MovementState parameter."),
+            *GetNodeName(), *EnemyAI::SetMovementSpeedFunctionName.ToString(), *Character->GetClass()->GetName());
+        return EBTNodeResult::Failed;
+    }
+
+    // Mit Statuseffekten bleibt eine aktive Verlangsamung auf der neuen Geschwindigkeit bestehen.
+    UStatusEffectComponent* StatusEffects = Character->FindComponentByClass<UStatusEffectComponent>();
+    if (StatusEffects && Speed >= 0.0)
+    {
+        StatusEffects->SetBaseMaxWalkSpeed(static_cast<float>(Speed));
+    }
+    else if (Speed >= 0.0)
+    {
+        Movement->MaxWalkSpeed = static_cast<float>(Speed);
+    }
+    return EBTNodeResult::Succeeded;
+}
+
+FString UBTTask_SetEnemyMovementSpeed::GetStaticDescription() const
+{
+    return FString::Printf(TEXT("%s: %s"), *Super::GetStaticDescription(), *UEnum::GetDisplayValueAsText(MovementState).ToString());
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "EnemyAITypes.h"
+#include "BTTask_SetEnemyMovementSpeed.generated.h"
+
+/**
+ * UBTTask_SetEnemyMovementSpeed
+ *
+ * Ersatz für BTT_SetMovementSpeed. Ruft BPI_EnemyAIInterface::EAI_SetMovementSpeed im Pawn direkt
+ * auf, ohne Blueprint-Task dazwischen. Jeder Gegner schlägt seine Geschwindigkeit für die Gangart
+ * also weiter selbst nach. Die zurückgegebene Geschwindigkeit geht über den UStatusEffectComponent,
+ * wenn der Gegner einen hat, damit eine laufende Verlangsamung erhalten bleibt.
+ * Schlägt fehl, wenn der Pawn das Interface nicht implementiert.
+ */
+UCLASS(meta = (DisplayName = "Set Enemy Movement Speed"))
+class ITSSOMEKINDOFMAGICMP_API UBTTask_SetEnemyMovementSpeed : public UBTTaskNode
+{
+    GENERATED_BODY()
+
+public:
+    UBTTask_SetEnemyMovementSpeed();
+
+    virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+    virtual FString GetStaticDescription() const override;
+
+    UPROPERTY(EditAnywhere, Category = "Movement")
+    EEnemyMovementState MovementState = EEnemyMovementState::Walking;
+};
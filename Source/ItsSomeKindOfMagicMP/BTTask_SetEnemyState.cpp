@@ -0,0 +1,82 @@
+#include "BTTask_SetEnemyState.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Enum.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
+#include "GameFramework/Actor.h"
+
+UBTTask_SetEnemyState::UBTTask_SetEnemyState()
+{
+    NodeName = TEXT("Set Enemy State");
+
+    // E_AIStates ist ein Blueprint-Enum, ein Enum-Filter mit EEnemyAIState würde den Key ausschließen.
+    StateKey.SelectedKeyName = EnemyAI::StateKeyName;
+
+    AttackTargetKey.SelectedKeyName = EnemyAI::AttackTargetKeyName;
+    AttackTargetKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_SetEnemyState, AttackTargetKey), AActor::StaticClass());
+
+    PointOfInterestKey.SelectedKeyName = EnemyAI::PointOfInterestKeyName;
+    PointOfInterestKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_SetEnemyState, PointOfInterestKey));
+
+    SourceKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_SetEnemyState, SourceKey), AActor::StaticClass());
+    SourceKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTTask_SetEnemyState, SourceKey));
+    SourceKey.bNoneIsAllowedValue = true;
+}
+
+void UBTTask_SetEnemyState::InitializeFromAsset(UBehaviorTree& Asset)
+{
+    Super::InitializeFromAsset(Asset);
+
+    if (const UBlackboardData* BBAsset = GetBlackboardAsset())
+    {
+        StateKey.ResolveSelectedKey(*BBAsset);
+        AttackTargetKey.ResolveSelectedKey(*BBAsset);
+        PointOfInterestKey.ResolveSelectedKey(*BBAsset);
+        SourceKey.ResolveSelectedKey(*BBAsset);
+
+        if (StateKey.SelectedKeyType != UBlackboardKeyType_Enum::StaticClass())
+        {
+            UE_LOG(LogTemp, Error, TEXT("%s in %s: the state key %s is not an enum key."),
+                *GetNodeName(), *Asset.GetName(), *StateKey.SelectedKeyName.ToString());
+        }
+    }
+}
+
+EBTNodeResult::Type UBTTask_SetEnemyState::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+    UBlackboardComponent* Blackboard = OwnerComp.GetBlackboardComponent();
+    if (!Blackboard || StateKey.SelectedKeyType != UBlackboardKeyType_Enum::StaticClass())
+    {
+        return EBTNodeResult::Failed;
+    }
+
+    // Erst das Ziel, dann den Zustand: Decorators auf State sehen so schon das neue Ziel.
+    if (SourceKey.IsSet())
+    {
+        if (State == EEnemyAIState::Attack && SourceKey.SelectedKeyType == UBlackboardKeyType_Object::StaticClass())
+        {
+            Blackboard->SetValue<UBlackboardKeyType_Object>(AttackTargetKey.GetSelectedKeyID(),
+                Blackboard->GetValue<UBlackboardKeyType_Object>(SourceKey.GetSelectedKeyID()));
+        }
+        else if (State == EEnemyAIState::Investigate && SourceKey.SelectedKeyType == UBlackboardKeyType_Vector::StaticClass())
+        {
+            Blackboard->SetValue<UBlackboardKeyType_Vector>(PointOfInterestKey.GetSelectedKeyID(),
+                Blackboard->GetValue<UBlackboardKeyType_Vector>(SourceKey.GetSelectedKeyID()));
+        }
+    }
+
+    Blackboard->SetValue<UBlackboardKeyType_Enum>(StateKey.GetSelectedKeyID(), static_cast<UBlackboardKeyType_Enum::FDataType>(State));
+    return EBTNodeResult::Succeeded;
+}
+
+FString UBTTask_SetEnemyState::GetStaticDescription() const
+{
+    FString Description = FString::Printf(TEXT("%s: %s"), *Super::GetStaticDescription(), *UEnum::GetDisplayValueAsText(State).ToString());
+    if (!SourceKey.SelectedKeyName.IsNone())
+    {
+        Description += FString::Printf(TEXT(" (from %s)"), *SourceKey.SelectedKeyName.ToString());
+    }
+    return Description;
+}
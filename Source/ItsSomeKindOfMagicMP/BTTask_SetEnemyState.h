@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "EnemyAITypes.h"
+#include "BTTask_SetEnemyState.generated.h"
+
+/**
+ * UBTTask_SetEnemyState
+ *
+ * Ersatz für BTT_SetStateAsIdle, BTT_SetStateAsInvestigate und BTT_SetStateAsAttack, ohne den
+ * Umweg über AIC_Enemy_Base. Schreibt State und, je nach Zustand, AttackTarget bzw. PointOfInterest
+ * direkt ins Blackboard. Ohne SourceKey bleibt der bisherige Wert von AttackTarget bzw.
+ * PointOfInterest stehen. Die Keys sind mit den Namen aus BB_Enemy_Base vorbelegt.
+ */
+UCLASS(meta = (DisplayName = "Set Enemy State"))
+class ITSSOMEKINDOFMAGICMP_API UBTTask_SetEnemyState : public UBTTaskNode
+{
+    GENERATED_BODY()
+
+public:
+    UBTTask_SetEnemyState();
+
+    virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+    virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+    virtual FString GetStaticDescription() const override;
+
+    UPROPERTY(EditAnywhere, Category = "State")
+    EEnemyAIState State = EEnemyAIState::Idle;
+
+    /** Attack: ein Actor, der zum AttackTarget wird. Investigate: ein Ort, der zum PointOfInterest wird. */
+    UPROPERTY(EditAnywhere, Category = "State")
+    FBlackboardKeySelector SourceKey;
+
+    /** Enum-Key mit dem Typ E_AIStates */
+    UPROPERTY(EditAnywhere, Category = "Blackboard")
+    FBlackboardKeySelector StateKey;
+
+    UPROPERTY(EditAnywhere, Category = "Blackboard")
+    FBlackboardKeySelector AttackTargetKey;
+
+    UPROPERTY(EditAnywhere, Category = "Blackboard")
+    FBlackboardKeySelector PointOfInterestKey;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnemyAITypes.generated.h"
+
+/**
+ * Zustand eines Gegners, wie ihn der Blackboard-Key "State" in BB_Enemy_Base hält.
+ * Die Werte entsprechen den Einträgen von E_AIStates und müssen mit diesem in derselben
+ * Reihenfolge bleiben, sonst lesen AIC_Enemy_Base und die Decorators andere Zustände.
+ */
+UENUM(BlueprintType)
+enum class EEnemyAIState : uint8
+{
+    Idle,
+    Investigate,
+    Attack,
+    Dead
+};
+
+/**
+ * Gangart eines Gegners wie E_MovementState. Die Werte entsprechen den Einträgen von
+ * E_MovementState in derselben Reihenfolge, BPI_EnemyAIInterface::EAI_SetMovementSpeed bekommt sie als Byte.
+ */
+UENUM(BlueprintType)
+enum class EEnemyMovementState : uint8
+{
+    Idle,
+    Walking,
+    Running,
+    Jogging
+};
+
+namespace EnemyAI
+{
+    /** Die Namen der Keys in BB_Enemy_Base */
+    inline const FName StateKeyName = TEXT("State");
+    inline const FName AttackTargetKeyName = TEXT("AttackTarget");
+    inline const FName PointOfInterestKeyName = TEXT("PointOfInterest");
+
+    /** Die Funktion aus BPI_EnemyAIInterface, mit der ein Gegner seine Geschwindigkeit pro Gangart nachschlägt */
+    inline const FName SetMovementSpeedFunctionName = TEXT("EAI_SetMovementSpeed");
+}
@@ -0,0 +1,22 @@
+#include "EnemyBehaviorTreeComponent.h"
+
+void UEnemyBehaviorTreeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    PendingDeltaTime += DeltaTime;
+    if (PendingDeltaTime < MinTickInterval)
+    {
+        return;
+    }
+
+    const float TickDeltaTime = PendingDeltaTime;
+    PendingDeltaTime = 0.0f;
+
+    FScopeCycleCounter CycleCounter(TickStatId);
+    Super::TickComponent(TickDeltaTime, TickType, ThisTickFunction);
+}
+
+void UEnemyBehaviorTreeComponent::SetTickThrottle(float InMinTickInterval, TStatId InTickStatId)
+{
+    MinTickInterval = FMath::Max(InMinTickInterval, 0.0f);
+    TickStatId = InTickStatId;
+}
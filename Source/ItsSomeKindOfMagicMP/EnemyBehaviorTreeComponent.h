@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "EnemyBehaviorTreeComponent.generated.h"
+
+/**
+ * UEnemyBehaviorTreeComponent
+ *
+ * Ein UBehaviorTreeComponent, dessen Tick das UEnemySignificanceSubsystem drosseln kann. Der
+ * Baum plant seine Ticks selbst und überschreibt dabei das Tick-Intervall der Komponente, deshalb
+ * sammelt diese Komponente die Zeit bis zum Mindestabstand und tickt dann einmal mit der ganzen
+ * Zeit. Services und laufende Tasks bekommen so dieselbe Gesamtzeit, nur seltener.
+ *
+ * In AIC_Enemy_Base als Komponente hinzufügen: AAIController übernimmt sie als BrainComponent,
+ * RunBehaviorTree legt dann keinen eigenen UBehaviorTreeComponent mehr an.
+ */
+UCLASS(ClassGroup = AI, meta = (BlueprintSpawnableComponent))
+class ITSSOMEKINDOFMAGICMP_API UEnemyBehaviorTreeComponent : public UBehaviorTreeComponent
+{
+    GENERATED_BODY()
+
+public:
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+    /**
+     * @param InMinTickInterval Mindestabstand zwischen zwei Ticks des Baums in Sekunden, 0 = jeder Frame.
+     * @param InTickStatId Unter diesem Stat wird die Zeit des Ticks gezählt, z. B. pro Detailstufe.
+     */
+    void SetTickThrottle(float InMinTickInterval, TStatId InTickStatId);
+
+    float GetMinTickInterval() const { return MinTickInterval; }
+
+private:
+    float MinTickInterval = 0.0f;
+    float PendingDeltaTime = 0.0f;
+    TStatId TickStatId;
+};
@@ -0,0 +1,315 @@
+﻿#include "EnemySignificanceSubsystem.h"
+#include "AIController.h"
+#include "Algo/Count.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Enum.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "EnemyAITypes.h"
+#include "EnemyBehaviorTreeComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Perception/AISense_Sight.h"
+
+DECLARE_STATS_GROUP(TEXT("EnemySignificance"), STATGROUP_EnemySignificance, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Update"), STAT_EnemySignificance_Update, STATGROUP_EnemySignificance);
+DECLARE_CYCLE_STAT(TEXT("Behavior tree tick (High)"), STAT_EnemySignificance_BehaviorTreeHigh, STATGROUP_EnemySignificance);
+DECLARE_CYCLE_STAT(TEXT("Behavior tree tick (Medium)"), STAT_EnemySignificance_BehaviorTreeMedium, STATGROUP_EnemySignificance);
+DECLARE_CYCLE_STAT(TEXT("Behavior tree tick (Low)"), STAT_EnemySignificance_BehaviorTreeLow, STATGROUP_EnemySignificance);
+DECLARE_CYCLE_STAT(TEXT("Behavior tree tick (Dormant)"), STAT_EnemySignificance_BehaviorTreeDormant, STATGROUP_EnemySignificance);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies (High)"), STAT_EnemySignificance_NumHigh, STATGROUP_EnemySignificance);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies (Medium)"), STAT_EnemySignificance_NumMedium, STATGROUP_EnemySignificance);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies (Low)"), STAT_EnemySignificance_NumLow, STATGROUP_EnemySignificance);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemies (Dormant)"), STAT_EnemySignificance_NumDormant, STATGROUP_EnemySignificance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tier changes"), STAT_EnemySignificance_TierChanges, STATGROUP_EnemySignificance);
+
+namespace EnemySignificance
+{
+    static TAutoConsoleVariable<bool> CVarEnable(
+        TEXT("rune.AI.Significance.Enable"), true,
+        TEXT("Gegner nach Abstand und Sichtbarkeit drosseln. Aus = alle Gegner auf voller Rate."));
+
+    static TAutoConsoleVariable<int32> CVarForceTier(
+        TEXT("rune.AI.Significance.ForceTier"), -1,
+        TEXT("Setzt alle Gegner auf eine Stufe (0 = High bis 3 = Dormant), -1 = normal bewerten."));
+
+    static constexpr int32 NumTiers = static_cast<int32>(EEnemySignificanceTier::Count);
+
+    /** Die Zeit der Behavior Trees wird pro Stufe gezählt, der Aufrufzähler des Stats ergibt die Zeit pro Gegner. */
+    static TStatId GetBehaviorTreeStatId(EEnemySignificanceTier Tier)
+    {
+        switch (Tier)
+        {
+        case EEnemySignificanceTier::Medium:  return GET_STATID(STAT_EnemySignificance_BehaviorTreeMedium);
+        case EEnemySignificanceTier::Low:     return GET_STATID(STAT_EnemySignificance_BehaviorTreeLow);
+        case EEnemySignificanceTier::Dormant: return GET_STATID(STAT_EnemySignificance_BehaviorTreeDormant);
+        default:                              return GET_STATID(STAT_EnemySignificance_BehaviorTreeHigh);
+        }
+    }
+}
+
+bool UEnemySignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEnemySignificanceSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    CosViewHalfAngle = FMath::Cos(FMath::DegreesToRadians(ViewHalfAngleDegrees));
+
+    // Fehlende Stufen laufen mit voller Rate.
+    if (Tiers.Num() != EnemySignificance::NumTiers)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("EnemySignificance: %d tiers configured, expected %d."), Tiers.Num(), EnemySignificance::NumTiers);
+        Tiers.SetNum(EnemySignificance::NumTiers);
+    }
+
+    LoadedEnemyClass = EnemyClass.LoadSynchronous();
+    if (!LoadedEnemyClass)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("EnemySignificance: failed to load the enemy class %s, enemies are only handled when registered."),
+            *EnemyClass.ToString());
+        return;
+    }
+
+    for (TActorIterator<APawn> It(&InWorld, LoadedEnemyClass); It; ++It)
+    {
+        RegisterEnemy(*It);
+    }
+
+    ActorSpawnedHandle = InWorld.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UEnemySignificanceSubsystem::OnActorSpawned));
+}
+
+void UEnemySignificanceSubsystem::Deinitialize()
+{
+    if (UWorld* World = GetWorld())
+    {
+        World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+    }
+
+    Enemies.Empty();
+    LoadedEnemyClass = nullptr;
+
+    Super::Deinitialize();
+}
+
+TStatId UEnemySignificanceSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemySignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemySignificanceSubsystem::OnActorSpawned(AActor* Actor)
+{
+    if (Actor && Actor->IsA(LoadedEnemyClass))
+    {
+        RegisterEnemy(CastChecked<APawn>(Actor));
+    }
+}
+
+void UEnemySignificanceSubsystem::RegisterEnemy(APawn* Enemy)
+{
+    if (Enemy && !Enemies.ContainsByPredicate([Enemy](const FEnemyEntry& Entry) { return Entry.Pawn == Enemy; }))
+    {
+        FEnemyEntry& Entry = Enemies.AddDefaulted_GetRef();
+        Entry.Pawn = Enemy;
+        Entry.bApplied = ApplyTier(*Enemy, Entry.Tier);
+    }
+}
+
+void UEnemySignificanceSubsystem::UnregisterEnemy(APawn* Enemy)
+{
+    const int32 Index = Enemies.IndexOfByPredicate([Enemy](const FEnemyEntry& Entry) { return Entry.Pawn == Enemy; });
+    if (Index != INDEX_NONE)
+    {
+        // Ein Gegner, der weiterlebt, bekommt die volle Rate zurück.
+        if (Enemy && Enemies[Index].Tier != EEnemySignificanceTier::High)
+        {
+            ApplyTier(*Enemy, EEnemySignificanceTier::High);
+        }
+        Enemies.RemoveAtSwap(Index);
+    }
+}
+
+EEnemySignificanceTier UEnemySignificanceSubsystem::GetEnemyTier(const APawn* Enemy) const
+{
+    const FEnemyEntry* Entry = Enemies.FindByPredicate([Enemy](const FEnemyEntry& Entry) { return Entry.Pawn == Enemy; });
+    return Entry ? Entry->Tier : EEnemySignificanceTier::High;
+}
+
+int32 UEnemySignificanceSubsystem::GetNumEnemies(EEnemySignificanceTier Tier) const
+{
+    return Algo::CountIf(Enemies, [Tier](const FEnemyEntry& Entry) { return Entry.Tier == Tier; });
+}
+
+void UEnemySignificanceSubsystem::Tick(float DeltaTime)
+{
+    TimeUntilUpdate -= DeltaTime;
+    if (Enemies.Num() == 0 || TimeUntilUpdate > 0.0f)
+    {
+        return;
+    }
+    TimeUntilUpdate = UpdateInterval;
+
+    SCOPE_CYCLE_COUNTER(STAT_EnemySignificance_Update);
+
+    Enemies.RemoveAllSwap([](const FEnemyEntry& Entry) { return !Entry.Pawn.IsValid(); });
+    GatherViewers();
+
+    const bool bEnabled = EnemySignificance::CVarEnable.GetValueOnGameThread();
+    const int32 ForcedTier = EnemySignificance::CVarForceTier.GetValueOnGameThread();
+
+    int32 NumPerTier[EnemySignificance::NumTiers] = {};
+    for (FEnemyEntry& Entry : Enemies)
+    {
+        APawn* Enemy = Entry.Pawn.Get();
+
+        EEnemySignificanceTier Tier = EEnemySignificanceTier::High;
+        if (bEnabled && ForcedTier >= 0 && ForcedTier < EnemySignificance::NumTiers)
+        {
+            Tier = static_cast<EEnemySignificanceTier>(ForcedTier);
+        }
+        else if (bEnabled)
+        {
+            Tier = EvaluateTier(Entry, *Enemy);
+        }
+
+        if (Tier != Entry.Tier || !Entry.bApplied)
+        {
+            if (Tier != Entry.Tier)
+            {
+                INC_DWORD_STAT(STAT_EnemySignificance_TierChanges);
+            }
+            Entry.Tier = Tier;
+            Entry.bApplied = ApplyTier(*Enemy, Tier);
+        }
+
+        ++NumPerTier[static_cast<int32>(Entry.Tier)];
+    }
+
+    SET_DWORD_STAT(STAT_EnemySignificance_NumHigh, NumPerTier[static_cast<int32>(EEnemySignificanceTier::High)]);
+    SET_DWORD_STAT(STAT_EnemySignificance_NumMedium, NumPerTier[static_cast<int32>(EEnemySignificanceTier::Medium)]);
+    SET_DWORD_STAT(STAT_EnemySignificance_NumLow, NumPerTier[static_cast<int32>(EEnemySignificanceTier::Low)]);
+    SET_DWORD_STAT(STAT_EnemySignificance_NumDormant, NumPerTier[static_cast<int32>(EEnemySignificanceTier::Dormant)]);
+}
+
+void UEnemySignificanceSubsystem::GatherViewers()
+{
+    Viewers.Reset();
+
+    // Auf dem Server alle Spieler, auf einem Client nur die lokalen.
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PlayerController = It->Get();
+        if (!PlayerController || !PlayerController->GetPawnOrSpectator())
+        {
+            continue;
+        }
+
+        FVector Location;
+        FRotator Rotation;
+        PlayerController->GetPlayerViewPoint(Location, Rotation);
+
+        FViewer& Viewer = Viewers.AddDefaulted_GetRef();
+        Viewer.Location = Location;
+        Viewer.Forward = Rotation.Vector();
+    }
+}
+
+EEnemySignificanceTier UEnemySignificanceSubsystem::EvaluateTier(const FEnemyEntry& Entry, const APawn& Enemy) const
+{
+    // Der Kampfzustand steht nur mit Autorität im Blackboard.
+    int32 MaxTier = EnemySignificance::NumTiers - 1;
+    const AAIController* Controller = Cast<AAIController>(Enemy.GetController());
+    if (const UBlackboardComponent* Blackboard = Controller ? Controller->GetBlackboardComponent() : nullptr)
+    {
+        const FBlackboard::FKey StateKey = Blackboard->GetKeyID(EnemyAI::StateKeyName);
+        if (StateKey != FBlackboard::InvalidKey)
+        {
+            switch (static_cast<EEnemyAIState>(Blackboard->GetValue<UBlackboardKeyType_Enum>(StateKey)))
+            {
+            case EEnemyAIState::Attack:      return EEnemySignificanceTier::High;
+            case EEnemyAIState::Dead:        return EEnemySignificanceTier::Dormant;
+            case EEnemyAIState::Investigate: MaxTier = static_cast<int32>(EEnemySignificanceTier::Medium); break;
+            default:                         break;
+            }
+        }
+    }
+
+    // Ohne Spieler gäbe es nur unendliche Abstände, alle Gegner würden eingefroren.
+    if (Viewers.Num() == 0)
+    {
+        return EEnemySignificanceTier::High;
+    }
+
+    const FVector Location = Enemy.GetActorLocation();
+    double Distance = TNumericLimits<double>::Max();
+    for (const FViewer& Viewer : Viewers)
+    {
+        const FVector ToEnemy = Location - Viewer.Location;
+        double ViewerDistance = ToEnemy.Size();
+        if (ViewerDistance > UE_KINDA_SMALL_NUMBER && FVector::DotProduct(Viewer.Forward, ToEnemy / ViewerDistance) < CosViewHalfAngle)
+        {
+            ViewerDistance *= OffscreenDistanceScale;
+        }
+        Distance = FMath::Min(Distance, ViewerDistance);
+    }
+
+    // Grenze i liegt zwischen Stufe i und i + 1. Von der Seite der aktuellen Stufe aus gesehen
+    // liegt sie um HysteresisFraction weiter weg, ein Wechsel braucht also einen deutlichen Schritt.
+    const int32 CurrentTier = static_cast<int32>(Entry.Tier);
+    int32 Tier = 0;
+    for (int32 Boundary = 0; Boundary < EnemySignificance::NumTiers - 1; ++Boundary)
+    {
+        const float Scale = CurrentTier <= Boundary ? 1.0f + HysteresisFraction : 1.0f - HysteresisFraction;
+        if (Distance <= Tiers[Boundary].MaxDistance * Scale)
+        {
+            break;
+        }
+        Tier = Boundary + 1;
+    }
+
+    return static_cast<EEnemySignificanceTier>(FMath::Min(Tier, MaxTier));
+}
+
+bool UEnemySignificanceSubsystem::ApplyTier(APawn& Enemy, EEnemySignificanceTier Tier) const
+{
+    const FEnemySignificanceTierSettings& Settings = Tiers[static_cast<int32>(Tier)];
+
+    if (const ACharacter* Character = Cast<ACharacter>(&Enemy))
+    {
+        if (UCharacterMovementComponent* Movement = Character->GetCharacterMovement())
+        {
+            Movement->SetComponentTickInterval(Settings.MovementTickInterval);
+        }
+        if (USkeletalMeshComponent* Mesh = Character->GetMesh())
+        {
+            Mesh->SetComponentTickInterval(Settings.AnimationTickInterval);
+        }
+    }
+
+    // Auf Clients gibt es keinen KI-Controller, dort bleibt es bei Bewegung und Animation.
+    AAIController* Controller = Cast<AAIController>(Enemy.GetController());
+    if (!Controller)
+    {
+        return GetWorld()->GetNetMode() == NM_Client;
+    }
+
+    if (UEnemyBehaviorTreeComponent* BehaviorTree = Cast<UEnemyBehaviorTreeComponent>(Controller->GetBrainComponent()))
+    {
+        BehaviorTree->SetTickThrottle(Settings.BehaviorTreeTickInterval, EnemySignificance::GetBehaviorTreeStatId(Tier));
+    }
+
+    if (UAIPerceptionComponent* Perception = Controller->GetPerceptionComponent())
+    {
+        Perception->SetSenseEnabled(UAISense_Sight::StaticClass(), Settings.bSightEnabled);
+    }
+
+    return true;
+}
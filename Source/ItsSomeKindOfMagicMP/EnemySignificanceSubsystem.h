@@ -0,0 +1,137 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnemySignificanceSubsystem.generated.h"
+
+class APawn;
+
+/** Detailstufe eines Gegners, High = volle Rate. */
+UENUM(BlueprintType)
+enum class EEnemySignificanceTier : uint8
+{
+    High,
+    Medium,
+    Low,
+    Dormant,
+
+    Count UMETA(Hidden)
+};
+
+/** Einstellungen einer Stufe, in DefaultGame.ini unter [/Script/ItsSomeKindOfMagicMP.EnemySignificanceSubsystem]. */
+USTRUCT()
+struct FEnemySignificanceTierSettings
+{
+    GENERATED_BODY()
+
+    /** Bis zu diesem gewichteten Abstand zum nächsten Spieler gilt die Stufe, in cm. Bei Dormant ohne Bedeutung. */
+    UPROPERTY(Config)
+    float MaxDistance = 0.0f;
+
+    /** Mindestabstand zwischen zwei Ticks des Behavior Trees in Sekunden, 0 = jeder Frame */
+    UPROPERTY(Config)
+    float BehaviorTreeTickInterval = 0.0f;
+
+    UPROPERTY(Config)
+    float MovementTickInterval = 0.0f;
+
+    UPROPERTY(Config)
+    float AnimationTickInterval = 0.0f;
+
+    /** Aus = der Sichtsinn der Wahrnehmung ruht, Hören und Schaden bleiben aktiv. */
+    UPROPERTY(Config)
+    bool bSightEnabled = true;
+};
+
+/**
+ * UEnemySignificanceSubsystem
+ *
+ * Teilt alle Gegner (EnemyClass, standardmäßig BP_Enemy_Base) in Detailstufen ein und drosselt
+ * danach Behavior Tree, Wahrnehmung, Animation und CharacterMovement. Bewertet wird der Abstand
+ * zum nächsten Spieler; außerhalb des Blickfelds aller Spieler zählt er OffscreenDistanceScale-fach.
+ * Ein Gegner im Zustand Attack bleibt immer auf High, Investigate höchstens auf Medium, Dead geht
+ * auf Dormant. Eine Stufe wird erst verlassen, wenn der Abstand die Grenze um HysteresisFraction
+ * überschreitet, damit Gegner an einer Grenze nicht ständig wechseln. Ohne Spieler (Dedicated Server
+ * vor dem ersten Login, Benchmark mit KI-Bots) gibt es keinen Abstand, dann laufen alle auf High.
+ *
+ * Behavior Trees werden nur gedrosselt, wenn der Controller einen UEnemyBehaviorTreeComponent hat.
+ * Anzahl Gegner und Tick-Zeit der Behavior Trees pro Stufe erscheinen unter "stat EnemySignificance".
+ */
+UCLASS(Config = Game)
+class ITSSOMEKINDOFMAGICMP_API UEnemySignificanceSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /** Meldet einen Gegner an. Gegner der EnemyClass werden beim Spawnen automatisch angemeldet. */
+    void RegisterEnemy(APawn* Enemy);
+    void UnregisterEnemy(APawn* Enemy);
+
+    /** Die aktuelle Stufe, High für nicht angemeldete Gegner */
+    UFUNCTION(BlueprintPure, Category = "AI")
+    EEnemySignificanceTier GetEnemyTier(const APawn* Enemy) const;
+
+    int32 GetNumEnemies(EEnemySignificanceTier Tier) const;
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    struct FEnemyEntry
+    {
+        TWeakObjectPtr<APawn> Pawn;
+        EEnemySignificanceTier Tier = EEnemySignificanceTier::High;
+
+        /** Erst wahr, wenn die Stufe auch auf Controller, Behavior Tree und Wahrnehmung angewendet wurde */
+        bool bApplied = false;
+    };
+
+    struct FViewer
+    {
+        FVector Location = FVector::ZeroVector;
+        FVector Forward = FVector::ForwardVector;
+    };
+
+    void OnActorSpawned(AActor* Actor);
+    void GatherViewers();
+    EEnemySignificanceTier EvaluateTier(const FEnemyEntry& Entry, const APawn& Enemy) const;
+    /** @return false, wenn der Gegner noch keinen Controller hat und die Stufe später erneut angewendet werden muss */
+    bool ApplyTier(APawn& Enemy, EEnemySignificanceTier Tier) const;
+
+    UPROPERTY(Config)
+    TSoftClassPtr<APawn> EnemyClass;
+
+    /** Eine Zeile pro Stufe in der Reihenfolge von EEnemySignificanceTier */
+    UPROPERTY(Config)
+    TArray<FEnemySignificanceTierSettings> Tiers;
+
+    /** Abstände von Gegnern außerhalb des Blickfelds aller Spieler zählen so viel mehr */
+    UPROPERTY(Config)
+    float OffscreenDistanceScale = 2.0f;
+
+    /** Halber Öffnungswinkel des Blickfelds in Grad */
+    UPROPERTY(Config)
+    float ViewHalfAngleDegrees = 60.0f;
+
+    /** Anteil der Grenze, um den sie beim Wechsel in eine andere Stufe überschritten werden muss */
+    UPROPERTY(Config)
+    float HysteresisFraction = 0.1f;
+
+    /** So oft werden die Stufen neu bewertet, in Sekunden */
+    UPROPERTY(Config)
+    float UpdateInterval = 0.25f;
+
+    UPROPERTY()
+    TObjectPtr<UClass> LoadedEnemyClass;
+
+    TArray<FEnemyEntry> Enemies;
+    TArray<FViewer> Viewers;
+    float CosViewHalfAngle = 0.5f;
+    float TimeUntilUpdate = 0.0f;
+    FDelegateHandle ActorSpawnedHandle;
+};
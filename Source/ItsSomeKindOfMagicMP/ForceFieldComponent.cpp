@@ -0,0 +1,56 @@
+﻿#include "ForceFieldComponent.h"
+#include "Engine/World.h"
+#include "ForceFieldSubsystem.h"
+
+UForceFieldComponent::UForceFieldComponent()
+{
+    PrimaryComponentTick.bCanEverTick = false;
+    bAutoActivate = true;
+}
+
+void UForceFieldComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (IsActive())
+    {
+        if (UForceFieldSubsystem* Subsystem = GetWorld()->GetSubsystem<UForceFieldSubsystem>())
+        {
+            Subsystem->RegisterSource(this);
+        }
+    }
+}
+
+void UForceFieldComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UForceFieldSubsystem* Subsystem = GetWorld()->GetSubsystem<UForceFieldSubsystem>())
+    {
+        Subsystem->UnregisterSource(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void UForceFieldComponent::Activate(bool bReset)
+{
+    Super::Activate(bReset);
+
+    // Vor BeginPlay übernimmt BeginPlay die Anmeldung.
+    if (IsActive() && HasBegunPlay())
+    {
+        if (UForceFieldSubsystem* Subsystem = GetWorld()->GetSubsystem<UForceFieldSubsystem>())
+        {
+            Subsystem->RegisterSource(this);
+        }
+    }
+}
+
+void UForceFieldComponent::Deactivate()
+{
+    Super::Deactivate();
+
+    if (UForceFieldSubsystem* Subsystem = GetWorld()->GetSubsystem<UForceFieldSubsystem>())
+    {
+        Subsystem->UnregisterSource(this);
+    }
+}
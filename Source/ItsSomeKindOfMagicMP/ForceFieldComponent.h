@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "ForceFieldComponent.generated.h"
+
+UENUM(BlueprintType)
+enum class EForceFieldMode : uint8
+{
+    /** Zum Mittelpunkt hin, mit negativer Stärke davon weg (BlackHole, Pull, Push nach außen) */
+    Radial,
+
+    /** Entlang der Vorwärtsrichtung der Komponente (Push als Welle) */
+    Directional
+};
+
+UENUM(BlueprintType)
+enum class EForceFieldFalloff : uint8
+{
+    Constant,
+    Linear,
+    Quadratic
+};
+
+/**
+ * UForceFieldComponent
+ *
+ * Eine Kraftquelle für Spells wie BP_BlackHole, BP_Spell_Push oder Pull. Die Komponente hat keinen
+ * eigenen Tick: solange sie aktiv ist, verrechnet das UForceFieldSubsystem sie einmal pro Frame
+ * zusammen mit allen anderen Quellen. Aktivieren / Deaktivieren schaltet das Feld, das passt
+ * auch zum Actor-Pool.
+ */
+UCLASS(ClassGroup = (Spells), meta = (BlueprintSpawnableComponent))
+class ITSSOMEKINDOFMAGICMP_API UForceFieldComponent : public USceneComponent
+{
+    GENERATED_BODY()
+
+public:
+    UForceFieldComponent();
+
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void Activate(bool bReset = false) override;
+    virtual void Deactivate() override;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Force Field")
+    EForceFieldMode Mode = EForceFieldMode::Radial;
+
+    /** Beschleunigung in cm/s², unabhängig von der Masse. Radial: positiv zieht an, negativ stößt ab. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Force Field")
+    float Strength = 2000.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Force Field", meta = (ClampMin = "0.0"))
+    float Radius = 800.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Force Field")
+    EForceFieldFalloff Falloff = EForceFieldFalloff::Linear;
+
+    /** Halber Öffnungswinkel um die Vorwärtsrichtung, 180 = in alle Richtungen */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Force Field", meta = (ClampMin = "0.0", ClampMax = "180.0"))
+    float ConeHalfAngleDegrees = 180.0f;
+
+    /** Radial: innerhalb dieses Abstands wirkt keine Kraft, damit Ziele im Zentrum nicht zittern. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Force Field", meta = (ClampMin = "0.0"))
+    float DeadZoneRadius = 50.0f;
+
+    /** Wirkt auch auf den Instigator des Owners, z. B. den Spieler, der den Spell gecastet hat. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Force Field")
+    bool bAffectInstigator = false;
+};
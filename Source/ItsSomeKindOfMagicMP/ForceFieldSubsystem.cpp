@@ -0,0 +1,255 @@
+﻿#include "ForceFieldSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+DECLARE_STATS_GROUP(TEXT("ForceFields"), STATGROUP_ForceFields, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Tick"), STAT_ForceFields_Tick, STATGROUP_ForceFields);
+DECLARE_CYCLE_STAT(TEXT("Gather"), STAT_ForceFields_Gather, STATGROUP_ForceFields);
+DECLARE_CYCLE_STAT(TEXT("Solve"), STAT_ForceFields_Solve, STATGROUP_ForceFields);
+DECLARE_CYCLE_STAT(TEXT("Apply"), STAT_ForceFields_Apply, STATGROUP_ForceFields);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sources"), STAT_ForceFields_Sources, STATGROUP_ForceFields);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Targets"), STAT_ForceFields_Targets, STATGROUP_ForceFields);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Source-target pairs"), STAT_ForceFields_Pairs, STATGROUP_ForceFields);
+
+namespace ForceField
+{
+    /** Unter so vielen Zielen lohnt sich das Verteilen auf die Worker nicht. */
+    static constexpr int32 MinParallelTargets = 32;
+
+    static float GetFalloff(EForceFieldFalloff Falloff, double Distance, float Radius)
+    {
+        const float Alpha = Radius > 0.0f ? FMath::Clamp(static_cast<float>(Distance / Radius), 0.0f, 1.0f) : 1.0f;
+        switch (Falloff)
+        {
+        case EForceFieldFalloff::Linear:    return 1.0f - Alpha;
+        case EForceFieldFalloff::Quadratic: return FMath::Square(1.0f - Alpha);
+        default:                            return 1.0f;
+        }
+    }
+}
+
+bool UForceFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UForceFieldSubsystem::Deinitialize()
+{
+    Sources.Empty();
+
+    Super::Deinitialize();
+}
+
+TStatId UForceFieldSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UForceFieldSubsystem, STATGROUP_Tickables);
+}
+
+void UForceFieldSubsystem::RegisterSource(UForceFieldComponent* Source)
+{
+    Sources.AddUnique(Source);
+}
+
+void UForceFieldSubsystem::UnregisterSource(UForceFieldComponent* Source)
+{
+    // RemoveSingle statt RemoveSingleSwap: die Reihenfolge der übrigen Quellen bleibt gleich.
+    Sources.RemoveSingle(Source);
+}
+
+void UForceFieldSubsystem::Tick(float DeltaTime)
+{
+    if (Sources.Num() == 0 || GetWorld()->GetNetMode() == NM_Client)
+    {
+        return;
+    }
+
+    SCOPE_CYCLE_COUNTER(STAT_ForceFields_Tick);
+
+    GatherSources();
+    if (SourceSnapshots.Num() == 0)
+    {
+        return;
+    }
+
+    GatherTargets();
+    Solve(DeltaTime);
+    ApplyVelocityChanges();
+}
+
+void UForceFieldSubsystem::GatherSources()
+{
+    SCOPE_CYCLE_COUNTER(STAT_ForceFields_Gather);
+
+    SourceSnapshots.Reset();
+    IgnoredActors.Reset();
+    Queries.Reset();
+
+    Sources.RemoveAll([](const TWeakObjectPtr<UForceFieldComponent>& Source) { return !Source.IsValid(); });
+
+    for (const TWeakObjectPtr<UForceFieldComponent>& SourcePtr : Sources)
+    {
+        const UForceFieldComponent* Source = SourcePtr.Get();
+        if (Source->Strength == 0.0f || Source->Radius <= 0.0f)
+        {
+            continue;
+        }
+
+        FSourceSnapshot& Snapshot = SourceSnapshots.AddDefaulted_GetRef();
+        Snapshot.Location = Source->GetComponentLocation();
+        Snapshot.Forward = Source->GetForwardVector();
+        Snapshot.Strength = Source->Strength;
+        Snapshot.Radius = Source->Radius;
+        Snapshot.DeadZoneRadius = Source->DeadZoneRadius;
+        Snapshot.CosConeHalfAngle = Source->ConeHalfAngleDegrees >= 180.0f ? -1.0f : FMath::Cos(FMath::DegreesToRadians(Source->ConeHalfAngleDegrees));
+        Snapshot.Mode = Source->Mode;
+        Snapshot.Falloff = Source->Falloff;
+
+        const AActor* Owner = Source->GetOwner();
+        IgnoredActors.Add(Source->bAffectInstigator || !Owner ? nullptr : Owner->GetInstigator());
+
+        FSpatialQuery& Query = Queries.AddDefaulted_GetRef();
+        Query.Shape = ESpatialQueryShape::Sphere;
+        Query.Origin = Snapshot.Location;
+        Query.Radius = Snapshot.Radius;
+    }
+
+    SET_DWORD_STAT(STAT_ForceFields_Sources, SourceSnapshots.Num());
+}
+
+void UForceFieldSubsystem::GatherTargets()
+{
+    SCOPE_CYCLE_COUNTER(STAT_ForceFields_Gather);
+
+    Targets.Reset();
+    TargetLocations.Reset();
+    TargetIndices.Reset();
+    Pairs.Reset();
+
+    USpatialHashSubsystem* SpatialHash = GetWorld()->GetSubsystem<USpatialHashSubsystem>();
+    if (!SpatialHash)
+    {
+        return;
+    }
+    SpatialHash->QueryBatch(Queries, QueryResults);
+
+    // Paare in Quellen-Reihenfolge sammeln, so liegen die Quellen jedes Ziels später aufsteigend.
+    for (int32 SourceIndex = 0; SourceIndex < QueryResults.Num(); ++SourceIndex)
+    {
+        for (AActor* Actor : QueryResults[SourceIndex].Actors)
+        {
+            if (!Actor || Actor == IgnoredActors[SourceIndex])
+            {
+                continue;
+            }
+
+            int32* TargetIndex = TargetIndices.Find(Actor);
+            if (!TargetIndex)
+            {
+                TargetIndex = &TargetIndices.Add(Actor, Targets.Add(Actor));
+                TargetLocations.Add(Actor->GetActorLocation());
+            }
+            Pairs.Emplace(*TargetIndex, SourceIndex);
+        }
+    }
+
+    // Zählsortierung der Paare nach Ziel, stabil innerhalb eines Ziels.
+    TargetSourceOffsets.Reset();
+    TargetSourceOffsets.SetNumZeroed(Targets.Num() + 1);
+    for (const FIntPoint& Pair : Pairs)
+    {
+        ++TargetSourceOffsets[Pair.X + 1];
+    }
+    for (int32 i = 1; i < TargetSourceOffsets.Num(); ++i)
+    {
+        TargetSourceOffsets[i] += TargetSourceOffsets[i - 1];
+    }
+
+    TargetSources.SetNumUninitialized(Pairs.Num(), EAllowShrinking::No);
+    TArray<int32, TInlineAllocator<256>> Cursor(TargetSourceOffsets.GetData(), Targets.Num());
+    for (const FIntPoint& Pair : Pairs)
+    {
+        TargetSources[Cursor[Pair.X]++] = Pair.Y;
+    }
+
+    SET_DWORD_STAT(STAT_ForceFields_Targets, Targets.Num());
+    SET_DWORD_STAT(STAT_ForceFields_Pairs, Pairs.Num());
+}
+
+void UForceFieldSubsystem::Solve(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_ForceFields_Solve);
+
+    VelocityChanges.SetNumUninitialized(Targets.Num(), EAllowShrinking::No);
+
+    // Jeder Worker schreibt nur die Einträge seiner Ziele, es gibt keine gemeinsamen Summen.
+    ParallelFor(Targets.Num(), [this, DeltaTime](int32 TargetIndex)
+    {
+        const FVector& Location = TargetLocations[TargetIndex];
+        FVector Acceleration = FVector::ZeroVector;
+
+        for (int32 Pair = TargetSourceOffsets[TargetIndex]; Pair < TargetSourceOffsets[TargetIndex + 1]; ++Pair)
+        {
+            const FSourceSnapshot& Source = SourceSnapshots[TargetSources[Pair]];
+
+            const FVector ToSource = Source.Location - Location;
+            const double Distance = ToSource.Size();
+            if (Distance > Source.Radius)
+            {
+                continue;
+            }
+
+            // Kegel: der Winkel wird vom Feld aus zum Ziel gemessen.
+            if (Source.CosConeHalfAngle > -1.0f && Distance > UE_KINDA_SMALL_NUMBER
+                && FVector::DotProduct(Source.Forward, -ToSource / Distance) < Source.CosConeHalfAngle)
+            {
+                continue;
+            }
+
+            const float Scale = Source.Strength * ForceField::GetFalloff(Source.Falloff, Distance, Source.Radius);
+            if (Source.Mode == EForceFieldMode::Directional)
+            {
+                Acceleration += Source.Forward * Scale;
+            }
+            else if (Distance > Source.DeadZoneRadius && Distance > UE_KINDA_SMALL_NUMBER)
+            {
+                Acceleration += ToSource / Distance * Scale;
+            }
+        }
+
+        VelocityChanges[TargetIndex] = Acceleration * DeltaTime;
+    }, Targets.Num() < ForceField::MinParallelTargets ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void UForceFieldSubsystem::ApplyVelocityChanges()
+{
+    SCOPE_CYCLE_COUNTER(STAT_ForceFields_Apply);
+
+    for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); ++TargetIndex)
+    {
+        const FVector& VelocityChange = VelocityChanges[TargetIndex];
+        if (VelocityChange.IsNearlyZero())
+        {
+            continue;
+        }
+
+        AActor* Target = Targets[TargetIndex];
+        if (ACharacter* Character = Cast<ACharacter>(Target))
+        {
+            if (UCharacterMovementComponent* Movement = Character->GetCharacterMovement())
+            {
+                Movement->AddImpulse(VelocityChange, true);
+            }
+        }
+        else if (UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Target->GetRootComponent()))
+        {
+            if (Primitive->IsSimulatingPhysics())
+            {
+                Primitive->AddImpulse(VelocityChange, NAME_None, true);
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ForceFieldComponent.h"
+#include "SpatialHashSubsystem.h"
+#include "ForceFieldSubsystem.generated.h"
+
+/**
+ * UForceFieldSubsystem
+ *
+ * Verrechnet alle aktiven UForceFieldComponents in einem Durchlauf pro Frame:
+ *   1. Quellen in Anmeldereihenfolge einsammeln und ihre Ziele über USpatialHashSubsystem::QueryBatch finden
+ *   2. pro Ziel die Liste seiner Quellen bilden und die Summe der Beschleunigungen mit ParallelFor berechnen
+ *   3. die Geschwindigkeitsänderungen auf dem Game-Thread anwenden (CharacterMovement oder Physik)
+ *
+ * Die Kosten wachsen mit Quellen mal Zielen in Reichweite, nicht mit der Anzahl Actors. Quellen
+ * werden immer in derselben Reihenfolge summiert, das Ergebnis hängt also nicht von der Verteilung
+ * auf die Worker ab und ist bei festem Zeitschritt (-benchmark, Replays) reproduzierbar.
+ *
+ * Ziele sind die Actors im USpatialHashSubsystem: Effektziele und Physik-Props, die beim Spawnen
+ * simulieren. Alles andere muss dort über RegisterActor angemeldet werden.
+ *
+ * Läuft nur mit Autorität. Kosten erscheinen unter "stat ForceFields".
+ */
+UCLASS()
+class ITSSOMEKINDOFMAGICMP_API UForceFieldSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    void RegisterSource(UForceFieldComponent* Source);
+    void UnregisterSource(UForceFieldComponent* Source);
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    /** Werte einer Quelle zum Zeitpunkt des Durchlaufs, damit die Worker keine UObjects lesen */
+    struct FSourceSnapshot
+    {
+        FVector Location = FVector::ZeroVector;
+        FVector Forward = FVector::ForwardVector;
+        float Strength = 0.0f;
+        float Radius = 0.0f;
+        float DeadZoneRadius = 0.0f;
+        float CosConeHalfAngle = -1.0f;
+        EForceFieldMode Mode = EForceFieldMode::Radial;
+        EForceFieldFalloff Falloff = EForceFieldFalloff::Linear;
+    };
+
+    void GatherSources();
+    void GatherTargets();
+    void Solve(float DeltaTime);
+    void ApplyVelocityChanges();
+
+    /** In Anmeldereihenfolge, entfernt wird ohne Umsortieren */
+    TArray<TWeakObjectPtr<UForceFieldComponent>> Sources;
+
+    // Pro Frame neu aufgebaut, der Speicher bleibt erhalten.
+    TArray<FSourceSnapshot> SourceSnapshots;
+    TArray<const AActor*> IgnoredActors;
+    TArray<FSpatialQuery> Queries;
+    TArray<FSpatialQueryResult> QueryResults;
+
+    TArray<AActor*> Targets;
+    TArray<FVector> TargetLocations;
+    TArray<FVector> VelocityChanges;
+    TMap<AActor*, int32> TargetIndices;
+
+    /** Quellen pro Ziel: TargetSources[TargetSourceOffsets[i] .. TargetSourceOffsets[i + 1]) */
+    TArray<int32> TargetSourceOffsets;
+    TArray<int32> TargetSources;
+    TArray<FIntPoint> Pairs;
+};
@@ -14,10 +14,15 @@ void AONNXInferenceActor::BeginPlay()
 {
     Super::BeginPlay();
 
+    InitializeModel();
+}
+
+bool AONNXInferenceActor::InitializeModel()
+{
     if (!ModelData)
     {
         UE_LOG(LogTemp, Error, TEXT("ModelData is not set! Please assign a valid model asset in the Editor."));
-        return;
+        return false;
     }
 
     // CPU‐Runtime beschaffen
@@ -25,7 +30,7 @@ void AONNXInferenceActor::BeginPlay()
     if (!Runtime.IsValid())
     {
         UE_LOG(LogTemp, Error, TEXT("Cannot find runtime 'NNERuntimeORTCpu'. Please enable the corresponding plugin."));
-        return;
+        return false;
     }
 
     // Modell erstellen
@@ -33,7 +38,7 @@ void AONNXInferenceActor::BeginPlay()
     if (!Model.IsValid())
     {
         UE_LOG(LogTemp, Error, TEXT("Failed to create the model."));
-        return;
+        return false;
     }
 
     // Modellinstanz erstellen
@@ -41,6 +46,81 @@ void AONNXInferenceActor::BeginPlay()
     if (!ModelInstance.IsValid())
     {
         UE_LOG(LogTemp, Error, TEXT("Failed to create the model instance."));
+        return false;
+    }
+
+    // Mit konkreter Input-Shape ist auch die Output-Shape bekannt, daraus folgt die Anzahl Klassen.
+    TArray<uint32> ConcreteDims = { 1, 64, 64, 1 };
+    if (ModelInstance->SetInputTensorShapes({ UE::NNE::FTensorShape::Make(ConcreteDims) }) != UE::NNE::EResultStatus::Ok)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to set input tensor shapes."));
+        ModelInstance.Reset();
+        return false;
+    }
+
+    NumModelClasses = ResolveNumModelClasses();
+    CompileLabels(NumModelClasses);
+
+    return true;
+}
+
+int32 AONNXInferenceActor::ResolveNumModelClasses() const
+{
+    auto OutputDescs = ModelInstance->GetOutputTensorDescs();
+    check(OutputDescs.Num() == 1);
+    const auto ShapeData = OutputDescs[0].GetShape().GetData();
+    if (ShapeData.Num() >= 2 && ShapeData[1] > 0)
+    {
+        return ShapeData[1];
+    }
+    if (SpellTable && SpellTable->Entries.Num() > 0)
+    {
+        return SpellTable->Entries.Num();
+    }
+    if (RuneMappings.Num() > 0)
+    {
+        return RuneMappings.Num();
+    }
+    return 2;
+}
+
+void AONNXInferenceActor::CompileLabels(int32 NumClasses)
+{
+    IndexLabels.Reset();
+    IndexLabels.SetNum(NumClasses);
+    UnknownIndex = INDEX_NONE;
+
+    if (SpellTable)
+    {
+        if (SpellTable->Compile(NumClasses))
+        {
+            for (int32 Index = 0; Index < NumClasses; ++Index)
+            {
+                const FName RuneName = SpellTable->GetRuneName(Index);
+                if (!RuneName.IsNone())
+                {
+                    IndexLabels[Index] = RuneName.ToString();
+                }
+            }
+            UnknownIndex = SpellTable->GetUnknownIndex();
+            return;
+        }
+
+        UE_LOG(LogTemp, Error, TEXT("Spell table %s does not match the model with %d output classes, falling back to RuneMappings."),
+            *SpellTable->GetName(), NumClasses);
+    }
+
+    for (const FRuneMapping& M : RuneMappings)
+    {
+        // Wie bisher gewinnt bei doppelten Indizes das erste Mapping.
+        if (IndexLabels.IsValidIndex(M.Index) && IndexLabels[M.Index].IsEmpty())
+        {
+            IndexLabels[M.Index] = M.RuneName;
+        }
+        if (UnknownIndex == INDEX_NONE && M.RuneName.Equals(TEXT("Unknown"), ESearchCase::IgnoreCase))
+        {
+            UnknownIndex = M.Index;
+        }
     }
 }
 
@@ -70,24 +150,6 @@ FPredictionResult AONNXInferenceActor::RunInferenceBP(const TArray<float>& Input
         return Result;
     }
 
-    // ** Neu: dynamisch die Anzahl der Output-Klassen ermitteln **
-    auto OutputDescs = ModelInstance->GetOutputTensorDescs();
-    check(OutputDescs.Num() == 1);
-    const auto ShapeData = OutputDescs[0].GetShape().GetData();
-    int32 NumModelClasses = 1;
-    if (ShapeData.Num() >= 2 && ShapeData[1] > 0)
-    {
-        NumModelClasses = ShapeData[1];
-    }
-    else if (RuneMappings.Num() > 0)
-    {
-        NumModelClasses = RuneMappings.Num();
-    }
-    else
-    {
-        NumModelClasses = 2;
-    }
-
     // Input-Binding erstellen
     UE::NNE::FTensorBindingCPU InputTensor;
     InputTensor.Data = const_cast<float*>(InputData.GetData());
@@ -124,6 +186,12 @@ FPredictionResult AONNXInferenceActor::ProcessOutput(const TArray<UE::NNE::FTens
     Result.Confidence = 0.f;
     Result.PredictedLabel = TEXT("Unknown");
 
+    // Ohne InitializeModel (z. B. in Tests) oder mit anderer Klassenanzahl neu aufbauen.
+    if (IndexLabels.Num() != NumClasses)
+    {
+        CompileLabels(NumClasses);
+    }
+
     if (Outputs.Num() > 0 && Outputs[0].Data)
     {
         float* Predictions = static_cast<float*>(Outputs[0].Data);
@@ -143,15 +211,6 @@ FPredictionResult AONNXInferenceActor::ProcessOutput(const TArray<UE::NNE::FTens
         // Falls unter Threshold, auf Unknown zurücksetzen
         if (BestScore < ConfidenceThreshold)
         {
-            int32 UnknownIndex = -1;
-            for (const FRuneMapping& M : RuneMappings)
-            {
-                if (M.RuneName.Equals(TEXT("Unknown"), ESearchCase::IgnoreCase))
-                {
-                    UnknownIndex = M.Index;
-                    break;
-                }
-            }
             PredictedClass = UnknownIndex;
             BestScore = 0.f;  // auf definierten Default zurücksetzen
         }
@@ -161,20 +220,10 @@ FPredictionResult AONNXInferenceActor::ProcessOutput(const TArray<UE::NNE::FTens
         Result.Confidence = BestScore;
         Result.bSuccess = true;
 
-        // Label aus Mapping suchen
-        bool bFound = false;
-        for (const FRuneMapping& M : RuneMappings)
-        {
-            if (M.Index == PredictedClass)
-            {
-                Result.PredictedLabel = M.RuneName;
-                bFound = true;
-                break;
-            }
-        }
-        if (!bFound)
+        // Label direkt über den Index, ohne die Mappings zu durchsuchen
+        if (IndexLabels.IsValidIndex(PredictedClass) && !IndexLabels[PredictedClass].IsEmpty())
         {
-            Result.PredictedLabel = TEXT("Unknown");
+            Result.PredictedLabel = IndexLabels[PredictedClass];
         }
 
         // Loggen / On-Screen-Debug
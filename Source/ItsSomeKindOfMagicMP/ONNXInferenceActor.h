@@ -6,6 +6,7 @@
 #include "NNE.h"
 #include "NNERuntimeCPU.h"       // CPU-Modell Schnittstellen
 #include "NNERuntimeRunSync.h"    // Für RunSync und Tensorbindings
+#include "RuneSpellTable.h"
 #include "ONNXInferenceActor.generated.h"
 
 /**
@@ -75,6 +76,13 @@ protected:
     virtual void BeginPlay() override;
 
 public:
+    /**
+     * Erstellt die Modellinstanz aus ModelData. Wird von BeginPlay aufgerufen, kann aber auch
+     * ohne laufende Welt verwendet werden (z. B. in Automation-Tests).
+     * @return true, wenn die Modellinstanz bereit ist.
+     */
+    bool InitializeModel();
+
     /**
      * Führt eine Inferenz durch und gibt das Vorhersageergebnis als FPredictionResult zurück.
      * @param InputData Ein Array von Float-Werten, das die Eingabedaten (z. B. aus einer Canvas) enthält.
@@ -90,14 +98,33 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inference")
     TArray<FRuneMapping> RuneMappings;
 
+    /** Rune-Namen und Spells pro Modell-Index. Wenn gesetzt und gültig, werden RuneMappings ignoriert. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inference")
+    TObjectPtr<URuneSpellTable> SpellTable;
+
     /** Confidence-Threshold – wenn der höchste Wahrscheinlichkeitswert unter diesem Wert liegt, wird "Unknown" gewählt. */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inference")
     float ConfidenceThreshold = 0.5f; // z. B. Standardwert 0.5
 
+    /** Wandelt den Output des Modells in ein FPredictionResult um und berücksichtigt den Threshold. */
+    FPredictionResult ProcessOutput(const TArray<UE::NNE::FTensorBindingCPU>& Outputs, int32 NumClasses);
+
+    /** Die Anzahl der Output-Klassen des Modells, 0 vor InitializeModel */
+    int32 GetNumModelClasses() const { return NumModelClasses; }
+
 private:
+    /** Ermittelt die Anzahl der Output-Klassen aus der Output-Shape des Modells. */
+    int32 ResolveNumModelClasses() const;
+
+    /** Baut IndexLabels aus SpellTable oder RuneMappings für die angegebene Anzahl Klassen auf. */
+    void CompileLabels(int32 NumClasses);
+
     /** Die für die Inferenz verwendete Modellinstanz */
     TSharedPtr<UE::NNE::IModelInstanceCPU> ModelInstance;
 
-    /** Wandelt den Output des Modells in ein FPredictionResult um und berücksichtigt den Threshold. */
-    FPredictionResult ProcessOutput(const TArray<UE::NNE::FTensorBindingCPU>& Outputs, int32 NumClasses);
+    int32 NumModelClasses = 0;
+
+    /** Label pro Modell-Index, leer für Indizes ohne Mapping */
+    TArray<FString> IndexLabels;
+    int32 UnknownIndex = INDEX_NONE;
 };
\ No newline at end of file
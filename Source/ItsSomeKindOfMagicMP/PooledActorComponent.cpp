@@ -0,0 +1,123 @@
+#include "PooledActorComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "PooledActorInterface.h"
+#include "TimerManager.h"
+
+UPooledActorComponent::UPooledActorComponent()
+{
+    PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UPooledActorComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    DOREPLIFETIME(UPooledActorComponent, bInPool);
+}
+
+void UPooledActorComponent::SetInPool(bool bNewInPool)
+{
+    if (bInPool == bNewInPool)
+    {
+        return;
+    }
+
+    bInPool = bNewInPool;
+    ApplyPoolState();
+}
+
+void UPooledActorComponent::OnRep_InPool()
+{
+    ApplyPoolState();
+}
+
+void UPooledActorComponent::ApplyPoolState()
+{
+    AActor* Actor = GetOwner();
+    const AActor* Defaults = Actor->GetClass()->GetDefaultObject<AActor>();
+
+    if (bInPool)
+    {
+        Actor->GetWorldTimerManager().ClearAllTimersForObject(Actor);
+        Actor->GetWorldTimerManager().ClearTimer(LifeSpanTimer);
+
+        Actor->SetActorHiddenInGame(true);
+        Actor->SetActorEnableCollision(false);
+        Actor->SetActorTickEnabled(false);
+
+        for (UActorComponent* Component : Actor->GetComponents())
+        {
+            if (!Component || Component == this)
+            {
+                continue;
+            }
+
+            Component->SetComponentTickEnabled(false);
+            Component->Deactivate();
+
+            if (UProjectileMovementComponent* ProjectileMovement = Cast<UProjectileMovementComponent>(Component))
+            {
+                ProjectileMovement->StopMovementImmediately();
+            }
+            else if (UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Component); Primitive && Primitive->IsSimulatingPhysics())
+            {
+                Primitive->SetPhysicsLinearVelocity(FVector::ZeroVector);
+                Primitive->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+            }
+        }
+
+        if (Actor->Implements<UPooledActorInterface>())
+        {
+            IPooledActorInterface::Execute_OnReleasedToPool(Actor);
+        }
+        return;
+    }
+
+    Actor->SetActorHiddenInGame(Defaults->IsHidden());
+    Actor->SetActorEnableCollision(Defaults->GetActorEnableCollision());
+    Actor->SetActorTickEnabled(Defaults->PrimaryActorTick.bStartWithTickEnabled);
+
+    for (UActorComponent* Component : Actor->GetComponents())
+    {
+        if (!Component || Component == this)
+        {
+            continue;
+        }
+
+        const UActorComponent* Archetype = Cast<UActorComponent>(Component->GetArchetype());
+        if (Component->PrimaryComponentTick.bCanEverTick && Archetype)
+        {
+            Component->SetComponentTickEnabled(Archetype->PrimaryComponentTick.bStartWithTickEnabled);
+        }
+
+        if (Component->bAutoActivate)
+        {
+            Component->Activate(true);
+        }
+
+        // Startgeschwindigkeit wie in UProjectileMovementComponent::InitializeComponent, aber mit der neuen Ausrichtung.
+        if (UProjectileMovementComponent* ProjectileMovement = Cast<UProjectileMovementComponent>(Component))
+        {
+            const UProjectileMovementComponent* ProjectileArchetype = Cast<UProjectileMovementComponent>(Archetype);
+            ProjectileMovement->SetUpdatedComponent(Actor->GetRootComponent());
+            ProjectileMovement->Velocity = ProjectileArchetype ? ProjectileArchetype->Velocity : FVector::ForwardVector;
+            if (ProjectileMovement->InitialSpeed > 0.f)
+            {
+                ProjectileMovement->Velocity = ProjectileMovement->Velocity.GetSafeNormal() * ProjectileMovement->InitialSpeed;
+            }
+            if (ProjectileMovement->bInitialVelocityInLocalSpace)
+            {
+                ProjectileMovement->SetVelocityInLocalSpace(ProjectileMovement->Velocity);
+            }
+            ProjectileMovement->UpdateComponentVelocity();
+        }
+    }
+
+    if (Actor->Implements<UPooledActorInterface>())
+    {
+        IPooledActorInterface::Execute_OnAcquiredFromPool(Actor);
+    }
+}
@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "PooledActorComponent.generated.h"
+
+/**
+ * UPooledActorComponent
+ *
+ * Wird vom UActorPoolSubsystem an jeden gepoolten Actor gehängt. Setzt den Actor beim Zurücklegen
+ * still (versteckt, ohne Kollision, Tick und aktive Komponenten, Timer gelöscht) und beim Holen
+ * wieder auf die Standardwerte seiner Klasse. Der Zustand wird repliziert, so dass Clients
+ * dieselben Schritte und Hooks ausführen.
+ */
+UCLASS(ClassGroup = (Pool))
+class ITSSOMEKINDOFMAGICMP_API UPooledActorComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UPooledActorComponent();
+
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+    /** Legt den Actor in den Pool oder holt ihn heraus. Nur dort aufrufen, wo der Actor erzeugt wurde. */
+    void SetInPool(bool bNewInPool);
+
+    bool IsInPool() const { return bInPool; }
+
+    /** Ersetzt InitialLifeSpan der Klasse: läuft die Zeit ab, geht der Actor in den Pool statt zerstört zu werden. */
+    FTimerHandle LifeSpanTimer;
+
+private:
+    UFUNCTION()
+    void OnRep_InPool();
+
+    void ApplyPoolState();
+
+    UPROPERTY(ReplicatedUsing = OnRep_InPool)
+    bool bInPool = false;
+};
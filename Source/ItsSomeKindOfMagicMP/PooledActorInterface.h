@@ -0,0 +1,32 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "PooledActorInterface.generated.h"
+
+UINTERFACE(BlueprintType, MinimalAPI)
+class UPooledActorInterface : public UInterface
+{
+    GENERATED_BODY()
+};
+
+/**
+ * IPooledActorInterface
+ *
+ * Optionale Hooks für Actors aus dem UActorPoolSubsystem. Ein gepoolter Actor durchläuft BeginPlay
+ * nur einmal – alles, was pro Cast neu passieren muss (Schaden, Effekte starten, Variablen
+ * zurücksetzen), gehört deshalb in OnAcquiredFromPool. Beide Hooks laufen auf Server und Clients.
+ */
+class ITSSOMEKINDOFMAGICMP_API IPooledActorInterface
+{
+    GENERATED_BODY()
+
+public:
+    /** Der Actor wurde aus dem Pool geholt, Transform, Owner und Instigator sind bereits gesetzt. */
+    UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Pool")
+    void OnAcquiredFromPool();
+
+    /** Der Actor wurde in den Pool zurückgelegt und ist versteckt, ohne Kollision und Tick. */
+    UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Pool")
+    void OnReleasedToPool();
+};
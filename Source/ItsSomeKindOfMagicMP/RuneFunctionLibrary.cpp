@@ -7,6 +7,7 @@
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 #include "HAL/PlatformFilemanager.h"
+#include "RuneStrokeCodec.h"
 
 void URuneFunctionLibrary::GetCanvasGrayscaleData(UCanvasRenderTarget2D* Canvas, TArray<float>& OutData)
 {
@@ -28,18 +29,49 @@ void URuneFunctionLibrary::GetCanvasGrayscaleData(UCanvasRenderTarget2D* Canvas,
 
     int32 Width = Canvas->SizeX;
     int32 Height = Canvas->SizeY;
-    int32 Size = Width * Height;
+    if (Pixels.Num() != Width * Height)
+    {
+        UE_LOG(LogTemp, Warning,
+            TEXT("GetCanvasGrayscaleData: Pixel count mismatch: got %d, expected %d"),
+            Pixels.Num(), Width * Height);
+    }
+
+    ConvertPixelsToGrayscale(Pixels, OutData);
+}
+
+void URuneFunctionLibrary::ConvertPixelsToGrayscale(TArrayView<const FColor> Pixels, TArray<float>& OutData)
+{
+    const int32 Size = Pixels.Num();
 
     OutData.Empty(Size);
     OutData.SetNumUninitialized(Size);
 
+    // Die Rune wird weiss auf schwarz gezeichnet, daher reicht der Rotkanal.
     for (int32 i = 0; i < Size; ++i)
     {
-        const FColor& Pixel = Pixels[i];
-        OutData[i] = Pixel.R / 255.0f;
+        OutData[i] = Pixels[i].R / 255.0f;
     }
 }
 
+void URuneFunctionLibrary::RasterizeStroke(TArrayView<const FVector2f> Points, int32 Size, TArray<FColor>& OutPixels)
+{
+    RuneStrokeCodec::Rasterize(Points, Size, OutPixels);
+}
+
+void URuneFunctionLibrary::GetStrokeGrayscaleData(const TArray<FVector2D>& Points, TArray<float>& OutData)
+{
+    TArray<FVector2f> StrokePoints;
+    StrokePoints.Reserve(Points.Num());
+    for (const FVector2D& Point : Points)
+    {
+        StrokePoints.Add(FVector2f(Point));
+    }
+
+    TArray<FColor> Pixels;
+    RasterizeStroke(StrokePoints, 64, Pixels);
+    ConvertPixelsToGrayscale(Pixels, OutData);
+}
+
 bool URuneFunctionLibrary::SaveCanvasRenderTargetToPNG(UCanvasRenderTarget2D* Canvas, const FString& FolderPath, const FString& FileName)
 {
     if (!Canvas)
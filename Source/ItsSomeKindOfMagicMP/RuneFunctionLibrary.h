@@ -16,6 +16,23 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Rune")
     static void GetCanvasGrayscaleData(UCanvasRenderTarget2D* Canvas, TArray<float>& OutData);
 
+    /** Wandelt ausgelesene Pixel in Graustufenwerte (0.0 - 1.0) um. Reine Funktion, ohne Render-Target. */
+    static void ConvertPixelsToGrayscale(TArrayView<const FColor> Pixels, TArray<float>& OutData);
+
+    /**
+     * Zeichnet einen Strich (Punkte in normierten Canvas-Koordinaten 0.0 - 1.0) wei auf schwarz
+     * in eine Canvas der gegebenen Gre. Ersetzt das Render-Target dort, wo keins existiert (Server).
+     * Deterministisch: Client und Server erhalten fr denselben Strich dieselben Pixel.
+     */
+    static void RasterizeStroke(TArrayView<const FVector2f> Points, int32 Size, TArray<FColor>& OutPixels);
+
+    /**
+     * Erzeugt aus einem Strich den 64x64-Eingabetensor, exakt so wie der Server. Fr die lokale
+     * Erkennung auf dem Client, damit sie mit der autoritativen Erkennung bereinstimmt.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Rune")
+    static void GetStrokeGrayscaleData(const TArray<FVector2D>& Points, TArray<float>& OutData);
+
     /** Speichert ein CanvasRenderTarget als PNG-Datei */
     UFUNCTION(BlueprintCallable, Category = "Rune")
     static bool SaveCanvasRenderTargetToPNG(UCanvasRenderTarget2D* Canvas, const FString& FolderPath, const FString& FileName);
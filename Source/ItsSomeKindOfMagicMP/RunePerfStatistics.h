@@ -0,0 +1,18 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+namespace RunePerf
+{
+    /** Perzentil nach dem Nearest-Rank-Verfahren über bereits sortierte Werte, P zwischen 0 und 100. 0 ohne Werte. */
+    inline double Percentile(const TArray<double>& Sorted, double P)
+    {
+        if (Sorted.Num() == 0)
+        {
+            return 0.0;
+        }
+
+        const int32 Rank = FMath::CeilToInt32(P / 100.0 * Sorted.Num());
+        return Sorted[FMath::Clamp(Rank - 1, 0, Sorted.Num() - 1)];
+    }
+}
@@ -0,0 +1,66 @@
+﻿#include "RunePredictionHandoff.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/Pawn.h"
+
+void FRunePredictionHandoff::Add(AActor* Effect, TSubclassOf<AActor> SpellClass, double ReleaseTime)
+{
+    Entries.Add({ Effect, SpellClass, ReleaseTime });
+}
+
+void FRunePredictionHandoff::NotifyActorSpawned(AActor* Actor)
+{
+    if (!IsEmpty())
+    {
+        SpawnedActors.Add(Actor);
+    }
+}
+
+void FRunePredictionHandoff::Update(const APawn* Pawn, double Now, TArray<AActor*>& OutToRelease)
+{
+    for (const TWeakObjectPtr<AActor>& SpawnedActor : SpawnedActors)
+    {
+        const AActor* Actor = SpawnedActor.Get();
+        if (!Actor || !Pawn || (Actor->GetInstigator() != Pawn && Actor->GetOwner() != Pawn))
+        {
+            continue;
+        }
+
+        // Der älteste passende Effekt gehört zum ältesten Cast, der Server antwortet in Reihenfolge.
+        const int32 Index = Entries.IndexOfByPredicate([Actor](const FEntry& Entry) { return Entry.SpellClass && Actor->IsA(Entry.SpellClass); });
+        if (Index != INDEX_NONE)
+        {
+            if (AActor* Effect = Entries[Index].Effect.Get())
+            {
+                OutToRelease.Add(Effect);
+            }
+            Entries.RemoveAt(Index);
+        }
+    }
+    SpawnedActors.Reset();
+
+    for (int32 i = Entries.Num() - 1; i >= 0; --i)
+    {
+        AActor* Effect = Entries[i].Effect.Get();
+        if (!Effect || Entries[i].ReleaseTime <= Now)
+        {
+            if (Effect)
+            {
+                OutToRelease.Add(Effect);
+            }
+            Entries.RemoveAt(i);
+        }
+    }
+}
+
+void FRunePredictionHandoff::Reset(TArray<AActor*>& OutToRelease)
+{
+    for (const FEntry& Entry : Entries)
+    {
+        if (AActor* Effect = Entry.Effect.Get())
+        {
+            OutToRelease.Add(Effect);
+        }
+    }
+    Entries.Reset();
+    SpawnedActors.Reset();
+}
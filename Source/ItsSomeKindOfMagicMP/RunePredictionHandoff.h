@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SubclassOf.h"
+
+class APawn;
+
+/**
+ * FRunePredictionHandoff
+ *
+ * Übergibt bestätigte, vorhergesagte Effekte an den Spell des Servers. Der lokale Effekt bleibt
+ * nach der Bestätigung stehen, bis ein Actor der Spell-Klasse mit dem eigenen Pawn als Instigator
+ * oder Owner repliziert ist, und wird dann zur Freigabe zurückgegeben. Kommt kein solcher Actor
+ * (Spell nicht repliziert, aus dem Pool des Servers), endet der Effekt zu seiner Frist.
+ */
+class ITSSOMEKINDOFMAGICMP_API FRunePredictionHandoff
+{
+public:
+    /** Effect wartet auf einen Actor der Klasse SpellClass, längstens bis ReleaseTime. */
+    void Add(AActor* Effect, TSubclassOf<AActor> SpellClass, double ReleaseTime);
+
+    /** Merkt sich einen neuen Actor. Geprüft wird erst in Update, wenn seine replizierten Properties da sind. */
+    void NotifyActorSpawned(AActor* Actor);
+
+    /** Hängt die Effekte an, deren Spell angekommen oder deren Frist abgelaufen ist. */
+    void Update(const APawn* Pawn, double Now, TArray<AActor*>& OutToRelease);
+
+    /** Gibt alle wartenden Effekte zurück und vergisst alles. */
+    void Reset(TArray<AActor*>& OutToRelease);
+
+    bool IsEmpty() const { return Entries.Num() == 0; }
+
+private:
+    struct FEntry
+    {
+        TWeakObjectPtr<AActor> Effect;
+        TSubclassOf<AActor> SpellClass;
+        double ReleaseTime = 0.0;
+    };
+
+    TArray<FEntry> Entries;
+    TArray<TWeakObjectPtr<AActor>> SpawnedActors;
+};
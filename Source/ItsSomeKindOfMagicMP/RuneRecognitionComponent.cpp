@@ -0,0 +1,342 @@
+﻿#include "RuneRecognitionComponent.h"
+#include "ActorPoolSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "RunePerfStatistics.h"
+#include "RuneRecognitionSubsystem.h"
+
+namespace RunePrediction
+{
+    static TAutoConsoleVariable<bool> CVarEnable(
+        TEXT("rune.Prediction.Enable"), true,
+        TEXT("Casts auf dem Client lokal vorhersagen. Aus = jeder Cast wartet auf den Server."));
+
+    /** Gemessene Latenzen in ms seit dem letzten Report, nur auf dem Client. Behält die letzten MaxSamples. */
+    struct FLatencySamples
+    {
+        static constexpr int32 MaxSamples = 1024;
+
+        TArray<double> Samples;
+        int32 NextIndex = 0;
+
+        void Add(double Milliseconds)
+        {
+            if (Samples.Num() < MaxSamples)
+            {
+                Samples.Add(Milliseconds);
+                return;
+            }
+
+            Samples[NextIndex] = Milliseconds;
+            NextIndex = (NextIndex + 1) % MaxSamples;
+        }
+
+        void Reset()
+        {
+            Samples.Reset();
+            NextIndex = 0;
+        }
+    };
+
+    static FLatencySamples InputToPredictedEffectMs;
+    static FLatencySamples InputToConfirmationMs;
+
+    static FString FormatPercentiles(TArray<double> Samples)
+    {
+        if (Samples.Num() == 0)
+        {
+            return TEXT("no samples");
+        }
+
+        Samples.Sort();
+        return FString::Printf(TEXT("%d samples, p50 %.1f ms, p90 %.1f ms, p99 %.1f ms"), Samples.Num(),
+            RunePerf::Percentile(Samples, 50.0), RunePerf::Percentile(Samples, 90.0), RunePerf::Percentile(Samples, 99.0));
+    }
+
+    static FAutoConsoleCommand ReportLatencyCommand(
+        TEXT("rune.Prediction.ReportLatency"),
+        TEXT("Gibt die Latenz von Eingabe bis Effekt für vorhergesagte und bestätigte Casts aus und setzt die Messung zurück."),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            UE_LOG(LogTemp, Display, TEXT("Rune prediction, input to predicted effect: %s"), *FormatPercentiles(InputToPredictedEffectMs.Samples));
+            UE_LOG(LogTemp, Display, TEXT("Rune prediction, input to server confirmation: %s"), *FormatPercentiles(InputToConfirmationMs.Samples));
+            InputToPredictedEffectMs.Reset();
+            InputToConfirmationMs.Reset();
+        }));
+
+    static FRuneStrokeData MakeStroke(const TArray<FVector2D>& Points)
+    {
+        FRuneStrokeData Stroke;
+        Stroke.Points.Reserve(Points.Num());
+        for (const FVector2D& Point : Points)
+        {
+            Stroke.Points.Add(FVector2f(Point));
+        }
+        return Stroke;
+    }
+}
+
+URuneRecognitionComponent::URuneRecognitionComponent()
+{
+    // Tickt nur, solange Vorhersagen auf eine Antwort warten.
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bStartWithTickEnabled = false;
+    SetIsReplicatedByDefault(true);
+}
+
+void URuneRecognitionComponent::SubmitStroke(const TArray<FVector2D>& Points)
+{
+    SubmitStrokeData(RunePrediction::MakeStroke(Points));
+}
+
+void URuneRecognitionComponent::SubmitStrokeData(const FRuneStrokeData& Stroke)
+{
+    if (!Stroke.IsValid())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SubmitStroke: invalid stroke with %d points, ignored."), Stroke.Points.Num());
+        return;
+    }
+
+    if (GetOwnerRole() == ROLE_Authority)
+    {
+        ServerSubmitStroke_Implementation(Stroke, FRunePredictionKey());
+    }
+    else
+    {
+        ServerSubmitStroke(Stroke, FRunePredictionKey());
+    }
+}
+
+FRunePredictionKey URuneRecognitionComponent::PredictCast(const TArray<FVector2D>& Points)
+{
+    const FRuneStrokeData Stroke = RunePrediction::MakeStroke(Points);
+    URuneRecognitionSubsystem* Recognition = GetWorld()->GetSubsystem<URuneRecognitionSubsystem>();
+
+    if (GetOwnerRole() == ROLE_Authority || !Recognition || !RunePrediction::CVarEnable.GetValueOnGameThread())
+    {
+        SubmitStrokeData(Stroke);
+        return FRunePredictionKey();
+    }
+
+    if (!Stroke.IsValid())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("PredictCast: invalid stroke with %d points, ignored."), Stroke.Points.Num());
+        return FRunePredictionKey();
+    }
+
+    FPendingPrediction& Prediction = PendingPredictions.AddDefaulted_GetRef();
+    Prediction.InputTime = FPlatformTime::Seconds();
+
+    // Ids laufen im Kreis, 0 bleibt für "keine Vorhersage" reserviert.
+    LastPredictionId = LastPredictionId == MAX_int32 ? 1 : LastPredictionId + 1;
+    Prediction.Key.Id = LastPredictionId;
+
+    // Derselbe Tensor wie auf dem Server, nur die Antwort des Modells kann sich noch unterscheiden.
+    Prediction.LocalResult = Recognition->Recognize(Stroke);
+    if (Prediction.LocalResult.bSuccess)
+    {
+        Prediction.Effect = SpawnPredictedEffect(Prediction.LocalResult);
+        RunePrediction::InputToPredictedEffectMs.Add((FPlatformTime::Seconds() - Prediction.InputTime) * 1000.0);
+    }
+
+    const FRunePredictionKey Key = Prediction.Key;
+    const FPredictionResult LocalResult = Prediction.LocalResult;
+
+    ServerSubmitStroke(Stroke, Key);
+    SetComponentTickEnabled(true);
+
+    OnCastPredicted.Broadcast(Key, LocalResult);
+    return Key;
+}
+
+AActor* URuneRecognitionComponent::SpawnPredictedEffect(const FPredictionResult& LocalResult)
+{
+    const TSubclassOf<AActor>* EffectClass = PredictedEffectClasses.Find(LocalResult.PredictedLabel);
+    APawn* Pawn = Cast<APawn>(GetOwner());
+    if (!EffectClass || !*EffectClass || !Pawn)
+    {
+        return nullptr;
+    }
+
+    FVector Location;
+    FRotator Rotation;
+    Pawn->GetActorEyesViewPoint(Location, Rotation);
+
+    // Auf dem Client geholt, also rein lokal: der Server sieht diesen Actor nie.
+    UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+    return Pool ? Pool->AcquireActor(*EffectClass, FTransform(Rotation, Location), Pawn, Pawn) : nullptr;
+}
+
+void URuneRecognitionComponent::ReleasePredictedEffect(AActor* Effect)
+{
+    if (UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>())
+    {
+        Pool->ReleaseActor(Effect);
+    }
+    else
+    {
+        Effect->Destroy();
+    }
+}
+
+void URuneRecognitionComponent::RejectPrediction(const FPendingPrediction& Prediction, const FPredictionResult& ServerResult)
+{
+    if (AActor* Effect = Prediction.Effect.Get())
+    {
+        ReleasePredictedEffect(Effect);
+    }
+
+    OnCastPredictionRejected.Broadcast(Prediction.Key, ServerResult);
+}
+
+TSubclassOf<AActor> URuneRecognitionComponent::GetSpellClass(const FPredictionResult& Result) const
+{
+    const URuneRecognitionSubsystem* Recognition = Result.bSuccess ? GetWorld()->GetSubsystem<URuneRecognitionSubsystem>() : nullptr;
+    const URuneSpellTable* SpellTable = Recognition ? Recognition->GetSpellTable() : nullptr;
+    return SpellTable ? SpellTable->GetSpellClass(Result.PredictedIndex) : nullptr;
+}
+
+bool URuneRecognitionComponent::ServerSubmitStroke_Validate(const FRuneStrokeData& Stroke, FRunePredictionKey Key)
+{
+    return Stroke.IsValid();
+}
+
+void URuneRecognitionComponent::ServerSubmitStroke_Implementation(const FRuneStrokeData& Stroke, FRunePredictionKey Key)
+{
+    URuneRecognitionSubsystem* Recognition = GetWorld()->GetSubsystem<URuneRecognitionSubsystem>();
+    if (!Recognition)
+    {
+        UE_LOG(LogTemp, Error, TEXT("SubmitStroke: no rune recognition subsystem in this world."));
+        return;
+    }
+
+    Recognition->QueueRecognition(this, Stroke, Key);
+}
+
+void URuneRecognitionComponent::HandleRecognitionResult(const FPredictionResult& Result, FRunePredictionKey Key)
+{
+    OnRuneRecognized.Broadcast(Result);
+
+    // Ein lokal gesteuerter Pawn (Listen-Server, Standalone) hat das Ergebnis schon.
+    const APawn* Pawn = Cast<APawn>(GetOwner());
+    if (!Pawn || !Pawn->IsLocallyControlled())
+    {
+        ClientRecognitionResult(Result, Key);
+    }
+}
+
+void URuneRecognitionComponent::ClientRecognitionResult_Implementation(const FPredictionResult& Result, FRunePredictionKey Key)
+{
+    const int32 Index = PendingPredictions.IndexOfByPredicate([&Key](const FPendingPrediction& Prediction) { return Prediction.Key == Key; });
+    if (Key.IsValid() && Index != INDEX_NONE)
+    {
+        const FPendingPrediction Prediction = PendingPredictions[Index];
+        PendingPredictions.RemoveAt(Index);
+
+        // Beide Seiten nutzen dasselbe Modell, der Index reicht also zum Vergleich.
+        const bool bConfirmed = Result.bSuccess && Prediction.LocalResult.bSuccess
+            && Result.PredictedIndex == Prediction.LocalResult.PredictedIndex;
+        if (bConfirmed)
+        {
+            RunePrediction::InputToConfirmationMs.Add((FPlatformTime::Seconds() - Prediction.InputTime) * 1000.0);
+
+            // Der Server spawnt den echten Spell, der vorhergesagte Effekt weicht ihm, sobald er da ist.
+            if (AActor* Effect = Prediction.Effect.Get())
+            {
+                if (!ActorSpawnedHandle.IsValid())
+                {
+                    ActorSpawnedHandle = GetWorld()->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &URuneRecognitionComponent::OnActorSpawned));
+                }
+                const double LifeSpan = ConfirmedEffectLifeSpan > 0.0f ? ConfirmedEffectLifeSpan : PredictionTimeoutSeconds;
+                ConfirmedEffects.Add(Effect, GetSpellClass(Result), FPlatformTime::Seconds() + LifeSpan);
+                SetComponentTickEnabled(true);
+            }
+
+            OnCastPredictionConfirmed.Broadcast(Key, Result);
+        }
+        else
+        {
+            RejectPrediction(Prediction, Result);
+        }
+    }
+
+    OnRuneRecognized.Broadcast(Result);
+}
+
+void URuneRecognitionComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    // Bleibt eine Antwort aus, darf der vorhergesagte Effekt nicht stehen bleiben.
+    const double TimeoutTime = FPlatformTime::Seconds() - PredictionTimeoutSeconds;
+    for (int32 i = PendingPredictions.Num() - 1; i >= 0; --i)
+    {
+        if (PendingPredictions[i].InputTime < TimeoutTime)
+        {
+            const FPendingPrediction Prediction = PendingPredictions[i];
+            PendingPredictions.RemoveAt(i);
+
+            FPredictionResult TimedOut;
+            TimedOut.bSuccess = false;
+            TimedOut.PredictedIndex = -1;
+            TimedOut.Confidence = 0.f;
+            TimedOut.PredictedLabel = TEXT("Unknown");
+            RejectPrediction(Prediction, TimedOut);
+        }
+    }
+
+    TArray<AActor*> EffectsToRelease;
+    ConfirmedEffects.Update(Cast<APawn>(GetOwner()), FPlatformTime::Seconds(), EffectsToRelease);
+    for (AActor* Effect : EffectsToRelease)
+    {
+        ReleasePredictedEffect(Effect);
+    }
+
+    if (ConfirmedEffects.IsEmpty())
+    {
+        StopWatchingSpawns();
+    }
+
+    if (PendingPredictions.Num() == 0 && ConfirmedEffects.IsEmpty())
+    {
+        SetComponentTickEnabled(false);
+    }
+}
+
+void URuneRecognitionComponent::OnActorSpawned(AActor* Actor)
+{
+    ConfirmedEffects.NotifyActorSpawned(Actor);
+}
+
+void URuneRecognitionComponent::StopWatchingSpawns()
+{
+    if (ActorSpawnedHandle.IsValid())
+    {
+        GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+        ActorSpawnedHandle.Reset();
+    }
+}
+
+void URuneRecognitionComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    for (const FPendingPrediction& Prediction : PendingPredictions)
+    {
+        if (AActor* Effect = Prediction.Effect.Get())
+        {
+            ReleasePredictedEffect(Effect);
+        }
+    }
+    PendingPredictions.Empty();
+
+    TArray<AActor*> EffectsToRelease;
+    ConfirmedEffects.Reset(EffectsToRelease);
+    for (AActor* Effect : EffectsToRelease)
+    {
+        ReleasePredictedEffect(Effect);
+    }
+    StopWatchingSpawns();
+
+    Super::EndPlay(EndPlayReason);
+}
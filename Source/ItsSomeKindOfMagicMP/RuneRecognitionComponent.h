@@ -0,0 +1,147 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ONNXInferenceActor.h"
+#include "RunePredictionHandoff.h"
+#include "RuneStrokeData.h"
+#include "RuneRecognitionComponent.generated.h"
+
+/**
+ * FRunePredictionKey
+ *
+ * Verknüpft einen vorhergesagten Cast auf dem Client mit der Antwort des Servers.
+ * Id 0 bedeutet "keine Vorhersage".
+ */
+USTRUCT(BlueprintType)
+struct ITSSOMEKINDOFMAGICMP_API FRunePredictionKey
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Prediction")
+    int32 Id = 0;
+
+    bool IsValid() const { return Id != 0; }
+    bool operator==(const FRunePredictionKey& Other) const { return Id == Other.Id; }
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnRuneRecognized, const FPredictionResult&, Result);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnRunePrediction, FRunePredictionKey, Key, const FPredictionResult&, Result);
+
+/**
+ * URuneRecognitionComponent
+ *
+ * Schickt gezeichnete Striche an den Server, der sie selbst erkennt (URuneRecognitionSubsystem).
+ * Das Ergebnis ist damit autoritativ und kommt über OnRuneRecognized zurück – auf dem Server
+ * und beim besitzenden Client. Gehört an den Spieler-Pawn.
+ *
+ * Mit PredictCast erkennt ein entfernter Client die Rune zusätzlich lokal und holt sofort den
+ * kosmetischen Effekt aus PredictedEffectClasses aus dem UActorPoolSubsystem. Die Antwort des
+ * Servers bestätigt die Vorhersage (OnCastPredictionConfirmed) oder verwirft sie: dann geht der
+ * Effekt zurück in den Pool und OnCastPredictionRejected wird mit dem Ergebnis des Servers ausgelöst.
+ * Ein bestätigter Effekt geht zurück in den Pool, sobald der Spell des Servers repliziert ist
+ * (FRunePredictionHandoff), damit nicht beide gleichzeitig zu sehen sind.
+ *
+ * Latenz messen (ein Rechner, simulierte Verzögerung):
+ *   Server: UnrealEditor ItsSomeKindOfMagicMP.uproject /Game/Levels/L_MainWorld -server -log
+ *   Client: UnrealEditor ItsSomeKindOfMagicMP.uproject 127.0.0.1 -game -ExecCmds="NetEmulation.PktLag 60"
+ * Nach einigen Casts gibt "rune.Prediction.ReportLatency" im Client p50/p90/p99 für Eingabe bis
+ * sichtbarem Effekt (vorhergesagt) und Eingabe bis Bestätigung durch den Server aus.
+ */
+UCLASS(ClassGroup = (Rune), meta = (BlueprintSpawnableComponent))
+class ITSSOMEKINDOFMAGICMP_API URuneRecognitionComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    URuneRecognitionComponent();
+
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    /**
+     * Reicht einen fertigen Strich zur Erkennung ein.
+     * @param Points Die Punkte des Strichs in normierten Canvas-Koordinaten (0.0 - 1.0).
+     */
+    UFUNCTION(BlueprintCallable, Category = "Rune")
+    void SubmitStroke(const TArray<FVector2D>& Points);
+
+    /** Wie SubmitStroke, für nativen Code, der den Strich schon als FRuneStrokeData hat. */
+    void SubmitStrokeData(const FRuneStrokeData& Stroke);
+
+    /**
+     * Wie SubmitStroke, erkennt die Rune aber sofort lokal und spawnt den kosmetischen Effekt, ohne
+     * auf den Server zu warten. Mit Autorität (Listen-Server, Standalone) wird nicht vorhergesagt.
+     * @return Der Schlüssel der Vorhersage, ungültig, wenn nichts vorhergesagt wurde.
+     */
+    UFUNCTION(BlueprintCallable, Category = "Rune")
+    FRunePredictionKey PredictCast(const TArray<FVector2D>& Points);
+
+    /**
+     * Der Spell zu einem Erkennungsergebnis aus der Spell-Tabelle des Modells (URuneSpellTable).
+     * Ein Array-Zugriff über PredictedIndex, für OnRuneRecognized statt eines Vergleichs der Labels.
+     * @return Leer, wenn nichts erkannt wurde, die Rune keinen Spell hat oder keine gültige Tabelle gesetzt ist.
+     */
+    UFUNCTION(BlueprintPure, Category = "Rune")
+    TSubclassOf<AActor> GetSpellClass(const FPredictionResult& Result) const;
+
+    /** Wird vom Subsystem mit dem Erkennungsergebnis aufgerufen (nur auf dem Server). */
+    void HandleRecognitionResult(const FPredictionResult& Result, FRunePredictionKey Key);
+
+    /** Wird mit dem autoritativen Ergebnis des Servers ausgelöst. */
+    UPROPERTY(BlueprintAssignable, Category = "Rune")
+    FOnRuneRecognized OnRuneRecognized;
+
+    /** Die lokale Erkennung hat einen Cast vorhergesagt (nur auf dem besitzenden Client). */
+    UPROPERTY(BlueprintAssignable, Category = "Rune|Prediction")
+    FOnRunePrediction OnCastPredicted;
+
+    /** Der Server hat die Vorhersage bestätigt. */
+    UPROPERTY(BlueprintAssignable, Category = "Rune|Prediction")
+    FOnRunePrediction OnCastPredictionConfirmed;
+
+    /** Der Server hat anders oder gar nicht erkannt, der vorhergesagte Effekt ist entfernt. */
+    UPROPERTY(BlueprintAssignable, Category = "Rune|Prediction")
+    FOnRunePrediction OnCastPredictionRejected;
+
+    /** Kosmetischer Effekt pro Rune-Label, z. B. BP_BaseSpell_Projectile oder BP_BaseSpell_Raycast. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rune|Prediction")
+    TMap<FString, TSubclassOf<AActor>> PredictedEffectClasses;
+
+    /** Höchste Lebensdauer des vorhergesagten Effekts nach der Bestätigung, 0 = PredictionTimeoutSeconds. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rune|Prediction")
+    float ConfirmedEffectLifeSpan = 0.0f;
+
+    /** Nach dieser Zeit ohne Antwort gilt eine Vorhersage als verworfen. */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rune|Prediction")
+    float PredictionTimeoutSeconds = 2.0f;
+
+protected:
+    UFUNCTION(Server, Reliable, WithValidation)
+    void ServerSubmitStroke(const FRuneStrokeData& Stroke, FRunePredictionKey Key);
+
+    UFUNCTION(Client, Reliable)
+    void ClientRecognitionResult(const FPredictionResult& Result, FRunePredictionKey Key);
+
+private:
+    struct FPendingPrediction
+    {
+        FRunePredictionKey Key;
+        FPredictionResult LocalResult;
+        TWeakObjectPtr<AActor> Effect;
+        double InputTime = 0.0;
+    };
+
+    AActor* SpawnPredictedEffect(const FPredictionResult& LocalResult);
+    void ReleasePredictedEffect(AActor* Effect);
+    void RejectPrediction(const FPendingPrediction& Prediction, const FPredictionResult& ServerResult);
+    void OnActorSpawned(AActor* Actor);
+    void StopWatchingSpawns();
+
+    TArray<FPendingPrediction> PendingPredictions;
+
+    /** Bestätigte Effekte, die auf den Spell des Servers warten */
+    FRunePredictionHandoff ConfirmedEffects;
+    FDelegateHandle ActorSpawnedHandle;
+    int32 LastPredictionId = 0;
+};
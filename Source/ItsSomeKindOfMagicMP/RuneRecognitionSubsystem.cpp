@@ -0,0 +1,165 @@
+﻿#include "RuneRecognitionSubsystem.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "RuneFunctionLibrary.h"
+#include "RuneRecognitionComponent.h"
+
+DECLARE_STATS_GROUP(TEXT("RuneRecognition"), STATGROUP_RuneRecognition, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Tick"), STAT_RuneRecognition_Tick, STATGROUP_RuneRecognition);
+DECLARE_CYCLE_STAT(TEXT("Cast (total)"), STAT_RuneRecognition_Cast, STATGROUP_RuneRecognition);
+DECLARE_CYCLE_STAT(TEXT("Rasterize"), STAT_RuneRecognition_Rasterize, STATGROUP_RuneRecognition);
+DECLARE_CYCLE_STAT(TEXT("Inference"), STAT_RuneRecognition_Inference, STATGROUP_RuneRecognition);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Casts per tick"), STAT_RuneRecognition_Casts, STATGROUP_RuneRecognition);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pending casts"), STAT_RuneRecognition_Pending, STATGROUP_RuneRecognition);
+
+namespace RuneRecognition
+{
+    static const TCHAR* InferenceActorClassPath = TEXT("/Game/Mechanics/RuneAI/Blueprints/BP_ONNXInferenceActor.BP_ONNXInferenceActor_C");
+
+    static constexpr int32 CanvasSize = 64;
+
+    static TAutoConsoleVariable<int32> CVarMaxRecognitionsPerTick(
+        TEXT("rune.Server.MaxRecognitionsPerTick"), 8,
+        TEXT("Maximale Anzahl Runenerkennungen pro Server-Tick, der Rest wartet auf den nächsten Tick. 0 = unbegrenzt."));
+
+    static TAutoConsoleVariable<int32> CVarMaxPendingPerRequester(
+        TEXT("rune.Server.MaxPendingPerRequester"), 2,
+        TEXT("Maximale Anzahl wartender Striche pro Spieler, weitere werden als nicht erkannt beantwortet. 0 = unbegrenzt."));
+
+    static FPredictionResult MakeFailedResult()
+    {
+        FPredictionResult Result;
+        Result.bSuccess = false;
+        Result.PredictedIndex = -1;
+        Result.Confidence = 0.f;
+        Result.PredictedLabel = TEXT("Unknown");
+        return Result;
+    }
+}
+
+bool URuneRecognitionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URuneRecognitionSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // Einen im Level platzierten Actor weiterverwenden, sonst den Blueprint mit dem Modell spawnen.
+    for (TActorIterator<AONNXInferenceActor> It(&InWorld); It; ++It)
+    {
+        InferenceActor = *It;
+        break;
+    }
+
+    if (!InferenceActor)
+    {
+        UClass* InferenceClass = LoadClass<AONNXInferenceActor>(nullptr, RuneRecognition::InferenceActorClassPath);
+        InferenceActor = InferenceClass ? InWorld.SpawnActor<AONNXInferenceActor>(InferenceClass) : nullptr;
+    }
+
+    if (!InferenceActor)
+    {
+        UE_LOG(LogTemp, Error, TEXT("RuneRecognition: failed to create the inference actor, casts cannot be recognized."));
+    }
+}
+
+void URuneRecognitionSubsystem::Deinitialize()
+{
+    Pending.Empty();
+    InferenceActor = nullptr;
+
+    Super::Deinitialize();
+}
+
+void URuneRecognitionSubsystem::QueueRecognition(URuneRecognitionComponent* Requester, const FRuneStrokeData& Stroke, FRunePredictionKey Key)
+{
+    // Ein Client, der schneller einreicht, als der Server erkennt, soll die Warteschlange nicht für alle füllen.
+    const int32 MaxPending = RuneRecognition::CVarMaxPendingPerRequester.GetValueOnGameThread();
+    if (MaxPending > 0)
+    {
+        int32 NumPending = 0;
+        for (const FPendingRecognition& Request : Pending)
+        {
+            NumPending += Request.Requester == Requester ? 1 : 0;
+        }
+
+        if (NumPending >= MaxPending)
+        {
+            UE_LOG(LogTemp, Verbose, TEXT("RuneRecognition: %s already has %d pending strokes, stroke rejected."), *GetNameSafe(Requester), NumPending);
+            Requester->HandleRecognitionResult(RuneRecognition::MakeFailedResult(), Key);
+            return;
+        }
+    }
+
+    Pending.Add({ Requester, Stroke, Key });
+}
+
+FPredictionResult URuneRecognitionSubsystem::Recognize(const FRuneStrokeData& Stroke)
+{
+    SCOPE_CYCLE_COUNTER(STAT_RuneRecognition_Cast);
+    INC_DWORD_STAT(STAT_RuneRecognition_Casts);
+
+    if (!InferenceActor)
+    {
+        return RuneRecognition::MakeFailedResult();
+    }
+
+    TArray<float> Tensor;
+    {
+        SCOPE_CYCLE_COUNTER(STAT_RuneRecognition_Rasterize);
+
+        TArray<FColor> Pixels;
+        URuneFunctionLibrary::RasterizeStroke(Stroke.Points, RuneRecognition::CanvasSize, Pixels);
+        URuneFunctionLibrary::ConvertPixelsToGrayscale(Pixels, Tensor);
+    }
+
+    SCOPE_CYCLE_COUNTER(STAT_RuneRecognition_Inference);
+    return InferenceActor->RunInferenceBP(Tensor);
+}
+
+URuneSpellTable* URuneRecognitionSubsystem::GetSpellTable() const
+{
+    URuneSpellTable* SpellTable = InferenceActor ? InferenceActor->SpellTable.Get() : nullptr;
+    return SpellTable && SpellTable->IsCompiled() ? SpellTable : nullptr;
+}
+
+void URuneRecognitionSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    SCOPE_CYCLE_COUNTER(STAT_RuneRecognition_Tick);
+
+    if (Pending.Num() > 0)
+    {
+        // Herauslösen, damit Callbacks, die neue Striche einreichen, die Schleife nicht stören.
+        const int32 MaxPerTick = RuneRecognition::CVarMaxRecognitionsPerTick.GetValueOnGameThread();
+        const int32 NumToProcess = MaxPerTick > 0 ? FMath::Min(MaxPerTick, Pending.Num()) : Pending.Num();
+
+        TArray<FPendingRecognition> Batch;
+        Batch.Reserve(NumToProcess);
+        for (int32 i = 0; i < NumToProcess; ++i)
+        {
+            Batch.Add(MoveTemp(Pending[i]));
+        }
+        Pending.RemoveAt(0, NumToProcess);
+
+        for (const FPendingRecognition& Request : Batch)
+        {
+            // Der Spieler kann inzwischen weg sein, dann lohnt die Erkennung nicht mehr.
+            if (URuneRecognitionComponent* Requester = Request.Requester.Get())
+            {
+                Requester->HandleRecognitionResult(Recognize(Request.Stroke), Request.Key);
+            }
+        }
+    }
+
+    SET_DWORD_STAT(STAT_RuneRecognition_Pending, Pending.Num());
+}
+
+TStatId URuneRecognitionSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(URuneRecognitionSubsystem, STATGROUP_Tickables);
+}
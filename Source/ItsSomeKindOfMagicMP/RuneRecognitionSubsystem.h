@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ONNXInferenceActor.h"
+#include "RuneRecognitionComponent.h"
+#include "RuneStrokeData.h"
+#include "RuneRecognitionSubsystem.generated.h"
+
+/**
+ * URuneRecognitionSubsystem
+ *
+ * Serverseitige Runenerkennung. Auf dem Server (Dedicated, Listen oder Standalone) werden die von
+ * URuneRecognitionComponent eingereichten Striche gesammelt und im Tick abgearbeitet: rasterisieren,
+ * in den Tensor umwandeln und mit der CPU-Runtime erkennen. Es wird kein Rendering benötigt, das
+ * funktioniert also auch mit dem Server-Target oder -nullrhi.
+ *
+ * Auf Clients dient Recognize nur der Vorhersage (URuneRecognitionComponent::PredictCast).
+ *
+ * Kosten pro Cast und pro Tick erscheinen unter "stat RuneRecognition".
+ */
+UCLASS()
+class ITSSOMEKINDOFMAGICMP_API URuneRecognitionSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /**
+     * Reiht einen Strich zur Erkennung ein. Das Ergebnis geht an Requester->HandleRecognitionResult.
+     * Wartet für Requester schon rune.Server.MaxPendingPerRequester Striche, wird der neue sofort
+     * mit einem Fehlschlag beantwortet.
+     */
+    void QueueRecognition(URuneRecognitionComponent* Requester, const FRuneStrokeData& Stroke, FRunePredictionKey Key);
+
+    /** Erkennt einen Strich sofort. Auf Clients nicht autoritativ. */
+    FPredictionResult Recognize(const FRuneStrokeData& Stroke);
+
+    /** Die gegen das Modell geprüfte Spell-Tabelle des Inference-Actors, nullptr ohne gültige Tabelle */
+    URuneSpellTable* GetSpellTable() const;
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    struct FPendingRecognition
+    {
+        TWeakObjectPtr<URuneRecognitionComponent> Requester;
+        FRuneStrokeData Stroke;
+        FRunePredictionKey Key;
+    };
+
+    TArray<FPendingRecognition> Pending;
+
+    /** Der Actor mit der Modellinstanz */
+    UPROPERTY()
+    TObjectPtr<AONNXInferenceActor> InferenceActor;
+};
@@ -0,0 +1,723 @@
+﻿#include "RuneSoakBenchmarkSubsystem.h"
+#include "ActorPoolSubsystem.h"
+#include "AIController.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "EnemySignificanceSubsystem.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerStart.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+#include "NavigationSystem.h"
+#include "ONNXInferenceActor.h"
+#include "RuneFunctionLibrary.h"
+#include "RunePerfStatistics.h"
+
+namespace RuneSoakBenchmark
+{
+    static const TCHAR* InferenceActorClassPath = TEXT("/Game/Mechanics/RuneAI/Blueprints/BP_ONNXInferenceActor.BP_ONNXInferenceActor_C");
+    static const TCHAR* EnemyClassPaths[] = {
+        TEXT("/Game/Mechanics/Enemy/Blueprints/BP_Enemy_Golem.BP_Enemy_Golem_C"),
+        TEXT("/Game/Mechanics/Enemy/Blueprints/BP_Enemy_Cloak.BP_Enemy_Cloak_C"),
+    };
+
+    static const FName CastSpellFunctionName = TEXT("RS_CastSpell");
+
+    static constexpr int32 CanvasSize = 64;
+    static constexpr float SpawnRadius = 1500.0f;
+    static constexpr float MoveRadius = 2000.0f;
+    static constexpr int32 CsvFlushInterval = 256;
+
+    /**
+     * Ruft eine Blueprint-Funktion mit Standardwerten für alle Parameter auf. Der erste String- bzw.
+     * Name-Parameter erhält das Label der erkannten Rune.
+     */
+    static void CallWithLabel(UObject* Target, UFunction* Function, const FString& Label)
+    {
+        uint8* Params = static_cast<uint8*>(FMemory_Alloca(FMath::Max<int32>(Function->ParmsSize, 1)));
+        FMemory::Memzero(Params, Function->ParmsSize);
+
+        bool bLabelSet = false;
+        for (TFieldIterator<FProperty> It(Function); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+        {
+            It->InitializeValue_InContainer(Params);
+
+            if (bLabelSet || It->HasAnyPropertyFlags(CPF_ReturnParm | CPF_OutParm))
+            {
+                continue;
+            }
+
+            if (FStrProperty* StrProperty = CastField<FStrProperty>(*It))
+            {
+                StrProperty->SetPropertyValue_InContainer(Params, Label);
+                bLabelSet = true;
+            }
+            else if (FNameProperty* NameProperty = CastField<FNameProperty>(*It))
+            {
+                NameProperty->SetPropertyValue_InContainer(Params, FName(*Label));
+                bLabelSet = true;
+            }
+        }
+
+        Target->ProcessEvent(Function, Params);
+
+        for (TFieldIterator<FProperty> It(Function); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+        {
+            It->DestroyValue_InContainer(Params);
+        }
+    }
+}
+
+void UBenchmarkBehaviorTreeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    const double Start = FPlatformTime::Seconds();
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+    TickMs += (FPlatformTime::Seconds() - Start) * 1000.0;
+}
+
+double UBenchmarkBehaviorTreeComponent::ConsumeTickMs()
+{
+    const double Ms = TickMs;
+    TickMs = 0.0;
+    return Ms;
+}
+
+TArray<FRuneStroke> URuneSoakBenchmarkSubsystem::MakeDefaultCorpus()
+{
+    TArray<FRuneStroke> Strokes;
+
+    FRuneStroke& Circle = Strokes.AddDefaulted_GetRef();
+    Circle.Label = TEXT("circle");
+    for (int32 i = 0; i <= 32; ++i)
+    {
+        const float Angle = 2.0f * PI * i / 32.0f;
+        Circle.Points.Add(FVector2f(0.5f + 0.3f * FMath::Cos(Angle), 0.5f + 0.3f * FMath::Sin(Angle)));
+    }
+
+    FRuneStroke& Triangle = Strokes.AddDefaulted_GetRef();
+    Triangle.Label = TEXT("triangle");
+    Triangle.Points = { { 0.5f, 0.15f }, { 0.85f, 0.8f }, { 0.15f, 0.8f }, { 0.5f, 0.15f } };
+
+    FRuneStroke& Zigzag = Strokes.AddDefaulted_GetRef();
+    Zigzag.Label = TEXT("zigzag");
+    Zigzag.Points = { { 0.1f, 0.3f }, { 0.3f, 0.7f }, { 0.5f, 0.3f }, { 0.7f, 0.7f }, { 0.9f, 0.3f } };
+
+    FRuneStroke& Line = Strokes.AddDefaulted_GetRef();
+    Line.Label = TEXT("line");
+    Line.Points = { { 0.2f, 0.5f }, { 0.8f, 0.5f } };
+
+    return Strokes;
+}
+
+bool URuneSoakBenchmarkSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    return FParse::Param(FCommandLine::Get(), TEXT("benchmark")) && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool URuneSoakBenchmarkSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URuneSoakBenchmarkSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    ReadOptions();
+
+    BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddUObject(this, &URuneSoakBenchmarkSubsystem::OnBeginFrame);
+    EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &URuneSoakBenchmarkSubsystem::OnEndFrame);
+    PreGarbageCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this, &URuneSoakBenchmarkSubsystem::OnPreGarbageCollect);
+    PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &URuneSoakBenchmarkSubsystem::OnPostGarbageCollect);
+}
+
+void URuneSoakBenchmarkSubsystem::Deinitialize()
+{
+    FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+    FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+    FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGarbageCollectHandle);
+    FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+
+    // Auch bei vorzeitigem Beenden die bisherigen Messwerte auswerten.
+    if (!bFinished && Samples.Num() > 0)
+    {
+        WriteSummary();
+    }
+
+    CsvFile.Reset();
+
+    Super::Deinitialize();
+}
+
+void URuneSoakBenchmarkSubsystem::ReadOptions()
+{
+    const TCHAR* CommandLine = FCommandLine::Get();
+    FParse::Value(CommandLine, TEXT("benchmarkbots="), NumBots);
+    FParse::Value(CommandLine, TEXT("benchmarkenemies="), NumEnemies);
+    FParse::Value(CommandLine, TEXT("benchmarkseconds="), DurationSeconds);
+    FParse::Value(CommandLine, TEXT("benchmarkwarmup="), WarmupSeconds);
+    FParse::Value(CommandLine, TEXT("benchmarkcastinterval="), CastInterval);
+
+    int32 Seed = 1;
+    FParse::Value(CommandLine, TEXT("benchmarkseed="), Seed);
+    Random.Initialize(Seed);
+
+    FString CorpusPath;
+    if (FParse::Value(CommandLine, TEXT("benchmarkcorpus="), CorpusPath) && !LoadStrokeCorpus(CorpusPath, Strokes))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Benchmark: failed to read the rune corpus %s, using the default shapes."), *CorpusPath);
+    }
+
+    if (Strokes.Num() == 0)
+    {
+        Strokes = MakeDefaultCorpus();
+    }
+
+    int32 ForcedTier = INDEX_NONE;
+    if (FParse::Value(CommandLine, TEXT("benchmarktier="), ForcedTier))
+    {
+        if (IConsoleVariable* ForceTier = IConsoleManager::Get().FindConsoleVariable(TEXT("rune.AI.Significance.ForceTier")))
+        {
+            ForceTier->Set(ForcedTier, ECVF_SetByCommandline);
+        }
+    }
+
+    if (!FParse::Value(CommandLine, TEXT("benchmarkcsv="), CsvPath))
+    {
+        CsvPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("RuneSoak_%s.csv"), *FDateTime::Now().ToString());
+    }
+}
+
+bool URuneSoakBenchmarkSubsystem::LoadStrokeCorpus(const FString& FilePath, TArray<FRuneStroke>& OutStrokes)
+{
+    TArray<FString> Lines;
+    if (!FFileHelper::LoadFileToStringArray(Lines, *FilePath))
+    {
+        return false;
+    }
+
+    for (const FString& Line : Lines)
+    {
+        FString Label;
+        FString PointList;
+        if (Line.IsEmpty() || Line.StartsWith(TEXT("#")) || !Line.Split(TEXT("|"), &Label, &PointList))
+        {
+            continue;
+        }
+
+        FRuneStroke Stroke;
+        Stroke.Label = Label.TrimStartAndEnd();
+
+        TArray<FString> Points;
+        PointList.ParseIntoArray(Points, TEXT(";"));
+        for (const FString& Point : Points)
+        {
+            TArray<FString> Values;
+            Point.ParseIntoArray(Values, TEXT(","));
+            if (Values.Num() >= 2)
+            {
+                Stroke.Points.Add(FVector2f(FCString::Atof(*Values[0]), FCString::Atof(*Values[1])));
+                if (Values.Num() >= 3)
+                {
+                    Stroke.TimesMs.Add(FCString::Atoi(*Values[2]));
+                }
+            }
+        }
+
+        // Zeiten nur übernehmen, wenn jeder Punkt eine hat.
+        if (Stroke.TimesMs.Num() != Stroke.Points.Num())
+        {
+            Stroke.TimesMs.Reset();
+        }
+
+        if (Stroke.Points.Num() > 0)
+        {
+            OutStrokes.Add(MoveTemp(Stroke));
+        }
+    }
+
+    return OutStrokes.Num() > 0;
+}
+
+void URuneSoakBenchmarkSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    UE_LOG(LogTemp, Display, TEXT("Benchmark: %s with %d bots, %d enemies, %.0f s warmup and %.0f s measurement."),
+        *InWorld.GetMapName(), NumBots, NumEnemies, WarmupSeconds, DurationSeconds);
+
+    LoadAllSublevels();
+
+    for (TActorIterator<APlayerStart> It(&InWorld); It; ++It)
+    {
+        SpawnOrigins.Add(It->GetActorLocation());
+    }
+
+    if (SpawnOrigins.Num() == 0)
+    {
+        SpawnOrigins.Add(FVector::ZeroVector);
+    }
+}
+
+void URuneSoakBenchmarkSubsystem::LoadAllSublevels()
+{
+    UWorld* World = GetWorld();
+    for (ULevelStreaming* StreamingLevel : World->GetStreamingLevels())
+    {
+        if (StreamingLevel)
+        {
+            StreamingLevel->SetShouldBeLoaded(true);
+            StreamingLevel->SetShouldBeVisible(true);
+        }
+    }
+
+    World->FlushLevelStreaming();
+    UE_LOG(LogTemp, Display, TEXT("Benchmark: %d sublevels loaded."), World->GetStreamingLevels().Num());
+}
+
+FVector URuneSoakBenchmarkSubsystem::GetSpawnLocation()
+{
+    const FVector Origin = SpawnOrigins[Random.RandHelper(SpawnOrigins.Num())];
+    const FVector Offset(Random.FRandRange(-1.0f, 1.0f) * RuneSoakBenchmark::SpawnRadius, Random.FRandRange(-1.0f, 1.0f) * RuneSoakBenchmark::SpawnRadius, 0.0f);
+
+    if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+    {
+        FNavLocation NavLocation;
+        if (NavSys->ProjectPointToNavigation(Origin + Offset, NavLocation))
+        {
+            return NavLocation.Location + FVector(0.0f, 0.0f, 100.0f);
+        }
+    }
+
+    return Origin + Offset;
+}
+
+void URuneSoakBenchmarkSubsystem::SpawnBots()
+{
+    UWorld* World = GetWorld();
+    AGameModeBase* GameMode = World->GetAuthGameMode();
+    UClass* PawnClass = GameMode ? GameMode->DefaultPawnClass.Get() : nullptr;
+    if (!PawnClass)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Benchmark: no default pawn class, no bots are spawned."));
+        return;
+    }
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+    for (int32 i = 0; i < NumBots; ++i)
+    {
+        APawn* Pawn = World->SpawnActor<APawn>(PawnClass, GetSpawnLocation(), FRotator::ZeroRotator, SpawnParams);
+        if (!Pawn)
+        {
+            continue;
+        }
+
+        if (!Pawn->GetController())
+        {
+            Pawn->SpawnDefaultController();
+        }
+
+        // Versetzt starten, damit nicht alle Bots im selben Frame casten.
+        FBot& Bot = Bots.AddDefaulted_GetRef();
+        Bot.Pawn = Pawn;
+        Bot.NextCastTime = World->GetTimeSeconds() + Random.FRandRange(0.0f, CastInterval);
+        Bot.NextStroke = i % Strokes.Num();
+    }
+}
+
+void URuneSoakBenchmarkSubsystem::SpawnEnemies()
+{
+    UWorld* World = GetWorld();
+
+    TArray<UClass*> EnemyClasses;
+    for (const TCHAR* ClassPath : RuneSoakBenchmark::EnemyClassPaths)
+    {
+        if (UClass* EnemyClass = LoadClass<APawn>(nullptr, ClassPath))
+        {
+            EnemyClasses.Add(EnemyClass);
+        }
+        else
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Benchmark: failed to load the enemy class %s."), ClassPath);
+        }
+    }
+
+    if (EnemyClasses.Num() == 0)
+    {
+        return;
+    }
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+    for (int32 i = 0; i < NumEnemies; ++i)
+    {
+        APawn* Enemy = World->SpawnActor<APawn>(EnemyClasses[i % EnemyClasses.Num()], GetSpawnLocation(), FRotator::ZeroRotator, SpawnParams);
+        if (Enemy)
+        {
+            if (!Enemy->GetController())
+            {
+                Enemy->SpawnDefaultController();
+            }
+            NumSpawnedEnemies++;
+
+            if (AAIController* Controller = Cast<AAIController>(Enemy->GetController()))
+            {
+                InstrumentBehaviorTree(Controller);
+            }
+        }
+    }
+
+    if (BehaviorTrees.Num() < NumSpawnedEnemies)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Benchmark: only %d of %d enemies run a behavior tree right after spawning, only those are measured."),
+            BehaviorTrees.Num(), NumSpawnedEnemies);
+    }
+}
+
+void URuneSoakBenchmarkSubsystem::InstrumentBehaviorTree(AAIController* Controller)
+{
+    UBehaviorTreeComponent* Current = Cast<UBehaviorTreeComponent>(Controller->GetBrainComponent());
+    UBehaviorTree* Tree = Current ? Current->GetRootTree() : nullptr;
+    if (!Tree)
+    {
+        return;
+    }
+
+    // Denselben Baum neu starten, das Blackboard mit den Werten aus OnPossess bleibt erhalten.
+    Current->StopTree(EBTStopMode::Forced);
+    Current->DestroyComponent();
+
+    UBenchmarkBehaviorTreeComponent* Timed = NewObject<UBenchmarkBehaviorTreeComponent>(Controller, TEXT("BenchmarkBTComponent"));
+    Timed->RegisterComponent();
+    Controller->BrainComponent = Timed;
+
+    if (Controller->RunBehaviorTree(Tree))
+    {
+        BehaviorTrees.Add(Timed);
+
+        // Neu anmelden, damit die Detailstufe auf den neuen Baum angewendet wird.
+        if (UEnemySignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UEnemySignificanceSubsystem>())
+        {
+            Significance->UnregisterEnemy(Controller->GetPawn());
+            Significance->RegisterEnemy(Controller->GetPawn());
+        }
+    }
+}
+
+void URuneSoakBenchmarkSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    UWorld* World = GetWorld();
+    if (bFinished || !World->HasBegunPlay())
+    {
+        return;
+    }
+
+    const double Now = World->GetTimeSeconds();
+
+    // Erst nach BeginPlay aller Level-Actors spawnen.
+    if (BenchmarkStartTime < 0.0)
+    {
+        UClass* InferenceClass = LoadClass<AONNXInferenceActor>(nullptr, RuneSoakBenchmark::InferenceActorClassPath);
+        InferenceActor = InferenceClass ? World->SpawnActor<AONNXInferenceActor>(InferenceClass) : nullptr;
+        if (!InferenceActor)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Benchmark: failed to spawn the inference actor, the bots only cast without recognition."));
+        }
+
+        SpawnBots();
+        SpawnEnemies();
+
+        BenchmarkStartTime = Now + WarmupSeconds;
+        UE_LOG(LogTemp, Display, TEXT("Benchmark: spawned %d bots and %d enemies."), Bots.Num(), NumSpawnedEnemies);
+        return;
+    }
+
+    for (FBot& Bot : Bots)
+    {
+        UpdateBot(Bot, Now);
+    }
+
+    if (Now >= BenchmarkStartTime + DurationSeconds)
+    {
+        WriteSummary();
+        bFinished = true;
+        FPlatformMisc::RequestExit(false, TEXT("Rune soak benchmark finished"));
+    }
+}
+
+void URuneSoakBenchmarkSubsystem::UpdateBot(FBot& Bot, double Now)
+{
+    APawn* Pawn = Bot.Pawn.Get();
+    if (!Pawn)
+    {
+        return;
+    }
+
+    if (Now >= Bot.NextMoveTime)
+    {
+        Bot.NextMoveTime = Now + Random.FRandRange(5.0f, 10.0f);
+
+        AAIController* Controller = Cast<AAIController>(Pawn->GetController());
+        UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+        FNavLocation Destination;
+        if (Controller && NavSys && NavSys->GetRandomReachablePointInRadius(Pawn->GetActorLocation(), RuneSoakBenchmark::MoveRadius, Destination))
+        {
+            Controller->MoveToLocation(Destination.Location);
+        }
+    }
+
+    if (Now >= Bot.NextCastTime)
+    {
+        Bot.NextCastTime = Now + CastInterval;
+        CastRune(Bot);
+    }
+}
+
+void URuneSoakBenchmarkSubsystem::CastRune(FBot& Bot)
+{
+    const FRuneStroke& Stroke = Strokes[Bot.NextStroke];
+    Bot.NextStroke = (Bot.NextStroke + 1) % Strokes.Num();
+
+    // Gleicher Weg wie beim Spieler: Canvas -> Graustufen-Tensor -> Inferenz.
+    TArray<FColor> Pixels;
+    URuneFunctionLibrary::RasterizeStroke(Stroke.Points, RuneSoakBenchmark::CanvasSize, Pixels);
+
+    TArray<float> Tensor;
+    URuneFunctionLibrary::ConvertPixelsToGrayscale(Pixels, Tensor);
+
+    FString Label = Stroke.Label;
+    if (InferenceActor)
+    {
+        const FPredictionResult Result = InferenceActor->RunInferenceBP(Tensor);
+        if (Result.bSuccess)
+        {
+            Label = Result.PredictedLabel;
+            RecognizedCasts += Label.Equals(Stroke.Label, ESearchCase::IgnoreCase) ? 1 : 0;
+        }
+    }
+
+    // Der Cast selbst läuft über das Rune-System des Pawns, falls vorhanden.
+    for (UActorComponent* Component : Bot.Pawn->GetComponents())
+    {
+        if (UFunction* CastSpell = Component ? Component->FindFunction(RuneSoakBenchmark::CastSpellFunctionName) : nullptr)
+        {
+            RuneSoakBenchmark::CallWithLabel(Component, CastSpell, Label);
+            break;
+        }
+    }
+
+    CastsThisFrame++;
+    TotalCasts++;
+}
+
+void URuneSoakBenchmarkSubsystem::OnBeginFrame()
+{
+    const double Now = FPlatformTime::Seconds();
+    LastFrameMs = FrameStartSeconds > 0.0 ? (Now - FrameStartSeconds) * 1000.0 : 0.0;
+    FrameStartSeconds = Now;
+    CastsThisFrame = 0;
+    GcMsThisFrame = 0.0;
+}
+
+void URuneSoakBenchmarkSubsystem::OnPreGarbageCollect()
+{
+    GcStartSeconds = FPlatformTime::Seconds();
+}
+
+void URuneSoakBenchmarkSubsystem::OnPostGarbageCollect()
+{
+    if (GcStartSeconds > 0.0)
+    {
+        GcMsThisFrame += (FPlatformTime::Seconds() - GcStartSeconds) * 1000.0;
+        GcStartSeconds = 0.0;
+    }
+}
+
+void URuneSoakBenchmarkSubsystem::OnEndFrame()
+{
+    const UWorld* World = GetWorld();
+    if (bFinished || BenchmarkStartTime < 0.0 || !World || World->GetTimeSeconds() < BenchmarkStartTime || LastFrameMs <= 0.0)
+    {
+        return;
+    }
+
+    if (!CsvFile)
+    {
+        CsvFile.Reset(IFileManager::Get().CreateFileWriter(*CsvPath));
+        if (!CsvFile)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Benchmark: failed to create %s."), *CsvPath);
+            bFinished = true;
+            return;
+        }
+
+        const FString Header = TEXT("Frame,WorldSeconds,FrameMs,GameThreadMs,ProcessCpuPct,WorkerUtilizationPct,UsedPhysicalMB,Bots,Enemies,Casts,GcMs,PoolHits,PoolMisses,PoolSpawnMs,BehaviorTreeMs,EnemiesHigh,EnemiesMedium,EnemiesLow,EnemiesDormant\n");
+        CsvFile->Serialize(TCHAR_TO_ANSI(*Header), Header.Len());
+        UE_LOG(LogTemp, Display, TEXT("Benchmark: recording to %s"), *CsvPath);
+
+        // Prewarm und Aufwärmphase nicht mitzählen.
+        if (const UActorPoolSubsystem* Pool = World->GetSubsystem<UActorPoolSubsystem>())
+        {
+            LastPoolStats = Pool->GetStats();
+        }
+
+        for (const TWeakObjectPtr<UBenchmarkBehaviorTreeComponent>& BehaviorTree : BehaviorTrees)
+        {
+            if (BehaviorTree.IsValid())
+            {
+                BehaviorTree->ConsumeTickMs();
+            }
+        }
+    }
+
+    FFrameSample& Sample = Samples.AddDefaulted_GetRef();
+    // Mit festem Zeitschritt ist die Delta-Zeit konstant, gemessen wird deshalb die Wanduhrzeit.
+    Sample.FrameMs = LastFrameMs;
+
+    // Die Wartezeit der Framerate-Begrenzung gehört nicht zur Arbeit des Game-Threads.
+    Sample.GameThreadMs = FMath::Max((FPlatformTime::Seconds() - FrameStartSeconds - FApp::GetIdleTime()) * 1000.0, 0.0);
+
+    // Näherung: CPU-Zeit des Prozesses ohne den Game-Thread, verteilt auf die Task-Worker.
+    const float ProcessCpuPct = FPlatformTime::GetCPUTime().CPUTimePct;
+    const int32 NumWorkers = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+    const double GameThreadBusy = Sample.FrameMs > 0.0 ? FMath::Min(Sample.GameThreadMs / Sample.FrameMs, 1.0) : 0.0;
+    Sample.WorkerUtilizationPct = FMath::Clamp((ProcessCpuPct / 100.0 - GameThreadBusy) / NumWorkers * 100.0, 0.0, 100.0);
+
+    Sample.UsedPhysicalMB = FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0);
+
+    Sample.GcMs = GcMsThisFrame;
+
+    if (const UActorPoolSubsystem* Pool = World->GetSubsystem<UActorPoolSubsystem>())
+    {
+        const FActorPoolStats PoolStats = Pool->GetStats();
+        Sample.PoolHits = PoolStats.Hits - LastPoolStats.Hits;
+        Sample.PoolMisses = PoolStats.Misses - LastPoolStats.Misses;
+        Sample.PoolSpawnMs = PoolStats.SpawnMs - LastPoolStats.SpawnMs;
+        LastPoolStats = PoolStats;
+    }
+
+    for (const TWeakObjectPtr<UBenchmarkBehaviorTreeComponent>& BehaviorTree : BehaviorTrees)
+    {
+        if (BehaviorTree.IsValid())
+        {
+            Sample.BehaviorTreeMs += BehaviorTree->ConsumeTickMs();
+        }
+    }
+
+    // Die Zeit der Behavior Trees ist nur zusammen mit den Stufen vergleichbar.
+    if (const UEnemySignificanceSubsystem* Significance = World->GetSubsystem<UEnemySignificanceSubsystem>())
+    {
+        for (int32 Tier = 0; Tier < UE_ARRAY_COUNT(Sample.EnemiesPerTier); ++Tier)
+        {
+            Sample.EnemiesPerTier[Tier] = Significance->GetNumEnemies(static_cast<EEnemySignificanceTier>(Tier));
+        }
+    }
+
+    const FString Line = FString::Printf(TEXT("%d,%.3f,%.3f,%.3f,%.1f,%.1f,%.1f,%d,%d,%d,%.3f,%d,%d,%.3f,%.3f,%d,%d,%d,%d\n"),
+        FrameIndex++, World->GetTimeSeconds(), Sample.FrameMs, Sample.GameThreadMs, ProcessCpuPct,
+        Sample.WorkerUtilizationPct, Sample.UsedPhysicalMB, Bots.Num(), NumSpawnedEnemies, CastsThisFrame,
+        Sample.GcMs, Sample.PoolHits, Sample.PoolMisses, Sample.PoolSpawnMs, Sample.BehaviorTreeMs,
+        Sample.EnemiesPerTier[0], Sample.EnemiesPerTier[1], Sample.EnemiesPerTier[2], Sample.EnemiesPerTier[3]);
+    CsvFile->Serialize(TCHAR_TO_ANSI(*Line), Line.Len());
+
+    if (FrameIndex % RuneSoakBenchmark::CsvFlushInterval == 0)
+    {
+        CsvFile->Flush();
+    }
+}
+
+void URuneSoakBenchmarkSubsystem::WriteSummary()
+{
+    TArray<double> FrameMs;
+    TArray<double> GameThreadMs;
+    TArray<double> BehaviorTreeMs;
+    double WorkerUtilizationSum = 0.0;
+    double PeakMemoryMB = 0.0;
+    double GcMsTotal = 0.0;
+    double GcMsMax = 0.0;
+    double PoolSpawnMs = 0.0;
+    int32 PoolHits = 0;
+    int32 PoolMisses = 0;
+    double EnemiesPerTierSum[UE_ARRAY_COUNT(FFrameSample::EnemiesPerTier)] = {};
+    for (const FFrameSample& Sample : Samples)
+    {
+        for (int32 Tier = 0; Tier < UE_ARRAY_COUNT(EnemiesPerTierSum); ++Tier)
+        {
+            EnemiesPerTierSum[Tier] += Sample.EnemiesPerTier[Tier];
+        }
+        GcMsTotal += Sample.GcMs;
+        GcMsMax = FMath::Max(GcMsMax, Sample.GcMs);
+        PoolSpawnMs += Sample.PoolSpawnMs;
+        PoolHits += Sample.PoolHits;
+        PoolMisses += Sample.PoolMisses;
+        FrameMs.Add(Sample.FrameMs);
+        GameThreadMs.Add(Sample.GameThreadMs);
+        BehaviorTreeMs.Add(Sample.BehaviorTreeMs);
+        WorkerUtilizationSum += Sample.WorkerUtilizationPct;
+        PeakMemoryMB = FMath::Max(PeakMemoryMB, Sample.UsedPhysicalMB);
+    }
+
+    FrameMs.Sort();
+    GameThreadMs.Sort();
+    BehaviorTreeMs.Sort();
+
+    using RunePerf::Percentile;
+
+    FString Summary;
+    Summary += FString::Printf(TEXT("Frames: %d, bots: %d, enemies: %d, casts: %d (%d recognized as drawn)\n"),
+        Samples.Num(), Bots.Num(), NumSpawnedEnemies, TotalCasts, RecognizedCasts);
+    Summary += FString::Printf(TEXT("Frame ms:       p50 %.3f | p90 %.3f | p99 %.3f | max %.3f\n"),
+        Percentile(FrameMs, 50.0), Percentile(FrameMs, 90.0), Percentile(FrameMs, 99.0), Percentile(FrameMs, 100.0));
+    Summary += FString::Printf(TEXT("Game thread ms: p50 %.3f | p90 %.3f | p99 %.3f | max %.3f\n"),
+        Percentile(GameThreadMs, 50.0), Percentile(GameThreadMs, 90.0), Percentile(GameThreadMs, 99.0), Percentile(GameThreadMs, 100.0));
+    Summary += FString::Printf(TEXT("Worker utilization: %.1f %% average\n"), Samples.Num() > 0 ? WorkerUtilizationSum / Samples.Num() : 0.0);
+    Summary += FString::Printf(TEXT("Peak used physical memory: %.1f MB\n"), PeakMemoryMB);
+    Summary += FString::Printf(TEXT("Garbage collection: %.1f ms total, %.1f ms worst frame\n"), GcMsTotal, GcMsMax);
+    Summary += FString::Printf(TEXT("Actor pool: %d hits, %d misses (%.1f %% hit rate), %.1f ms spawning\n"),
+        PoolHits, PoolMisses, PoolHits + PoolMisses > 0 ? 100.0 * PoolHits / (PoolHits + PoolMisses) : 0.0, PoolSpawnMs);
+
+    // Pro Gegner in µs, damit Läufe mit unterschiedlich vielen Gegnern vergleichbar bleiben.
+    const double PerEnemyUs = BehaviorTrees.Num() > 0 ? 1000.0 / BehaviorTrees.Num() : 0.0;
+    Summary += FString::Printf(TEXT("Behavior trees (%d enemies) ms: p50 %.3f | p90 %.3f | p99 %.3f | max %.3f\n"),
+        BehaviorTrees.Num(), Percentile(BehaviorTreeMs, 50.0), Percentile(BehaviorTreeMs, 90.0), Percentile(BehaviorTreeMs, 99.0), Percentile(BehaviorTreeMs, 100.0));
+    Summary += FString::Printf(TEXT("Behavior tree us per enemy: p50 %.2f | p90 %.2f | p99 %.2f | max %.2f\n"),
+        Percentile(BehaviorTreeMs, 50.0) * PerEnemyUs, Percentile(BehaviorTreeMs, 90.0) * PerEnemyUs,
+        Percentile(BehaviorTreeMs, 99.0) * PerEnemyUs, Percentile(BehaviorTreeMs, 100.0) * PerEnemyUs);
+    const double NumSamples = FMath::Max(Samples.Num(), 1);
+    Summary += FString::Printf(TEXT("Enemies per significance tier (average): high %.1f | medium %.1f | low %.1f | dormant %.1f\n"),
+        EnemiesPerTierSum[0] / NumSamples, EnemiesPerTierSum[1] / NumSamples, EnemiesPerTierSum[2] / NumSamples, EnemiesPerTierSum[3] / NumSamples);
+
+    UE_LOG(LogTemp, Display, TEXT("Benchmark summary:\n%s"), *Summary);
+
+    if (CsvFile)
+    {
+        CsvFile->Flush();
+    }
+
+    const FString SummaryPath = FPaths::ChangeExtension(CsvPath, TEXT("")) + TEXT("_Summary.txt");
+    if (!FFileHelper::SaveStringToFile(Summary, *SummaryPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Benchmark: failed to save the summary to %s"), *SummaryPath);
+    }
+}
+
+TStatId URuneSoakBenchmarkSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(URuneSoakBenchmarkSubsystem, STATGROUP_Tickables);
+}
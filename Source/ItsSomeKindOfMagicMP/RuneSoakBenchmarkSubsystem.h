@@ -0,0 +1,183 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ActorPoolSubsystem.h"
+#include "EnemyBehaviorTreeComponent.h"
+#include "EnemySignificanceSubsystem.h"
+#include "RuneSoakBenchmarkSubsystem.generated.h"
+
+class AAIController;
+class AONNXInferenceActor;
+class APawn;
+
+/**
+ * UBenchmarkBehaviorTreeComponent
+ *
+ * Ein UEnemyBehaviorTreeComponent, der die Zeit in seinem Tick misst, einschließlich aller Tasks,
+ * Services und Decorators, ob Blueprint oder nativ. Wird nur vom Soak-Benchmark eingesetzt und
+ * bleibt wie im Spiel vom UEnemySignificanceSubsystem gedrosselt.
+ */
+UCLASS()
+class ITSSOMEKINDOFMAGICMP_API UBenchmarkBehaviorTreeComponent : public UEnemyBehaviorTreeComponent
+{
+    GENERATED_BODY()
+
+public:
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+    /** Gibt die seit dem letzten Aufruf gemessene Zeit in ms zurück und setzt sie zurück. */
+    double ConsumeTickMs();
+
+private:
+    double TickMs = 0.0;
+};
+
+/**
+ * FRuneStroke
+ *
+ * Eine aufgezeichnete Rune aus dem Replay-Korpus: der Strich als Punktfolge in normierten
+ * Canvas-Koordinaten (0.0 - 1.0) und das erwartete Label.
+ */
+struct FRuneStroke
+{
+    FString Label;
+    TArray<FVector2f> Points;
+
+    /** Zeit seit Beginn des Strichs in ms pro Punkt, leer, wenn der Korpus keine Zeiten enthält. */
+    TArray<int32> TimesMs;
+};
+
+/**
+ * URuneSoakBenchmarkSubsystem
+ *
+ * Headless-Lasttest für Server und Client. Wird nur mit -benchmark erstellt, z. B.:
+ *   UnrealEditor ItsSomeKindOfMagicMP.uproject /Game/Levels/L_MainWorld -game -benchmark -nullrhi -nosound -unattended
+ *       [-benchmarkbots=8] [-benchmarkenemies=16] [-benchmarkseconds=300] [-benchmarkwarmup=10]
+ *       [-benchmarkcastinterval=2] [-benchmarkcorpus=<Datei>] [-benchmarkseed=1] [-benchmarkcsv=<Datei>]
+ *       [-benchmarktier=<0-3>]
+ *
+ * Lädt alle Sublevel der Map, spawnt N von der KI gesteuerte Spieler-Pawns, die reihum Runen aus dem
+ * Replay-Korpus zeichnen (Rasterisierung, Tensor, Inferenz) und über das Rune-System casten, sowie
+ * M Gegner (BP_Enemy_Golem / BP_Enemy_Cloak im Wechsel). Der Behavior Tree jedes Gegners läuft
+ * dabei in einem UBenchmarkBehaviorTreeComponent, so wird seine Zeit pro Frame messbar.
+ *
+ * Pro Frame werden Game-Thread-Zeit, Auslastung der Task-Worker, Speicher, GC-Zeit, die Treffer
+ * des UActorPoolSubsystem, die Zeit der Behavior Trees und die Anzahl Gegner pro Detailstufe des
+ * UEnemySignificanceSubsystem als CSV geschrieben, am Ende eine Zusammenfassung mit Perzentilen.
+ * Die Bots sind keine Spieler, die Stufen hängen also nur am Zustand der Gegner; -benchmarktier
+ * setzt alle Gegner fest auf eine Stufe (rune.AI.Significance.ForceTier). Für einen Vorher-Nachher-Vergleich von Tasks denselben Lauf
+ * (gleicher -benchmarkseed) mit beiden Varianten der Bäume wiederholen.
+ * Danach beendet sich das Spiel von selbst.
+ *
+ * -benchmark schaltet in der Engine auch den festen Zeitschritt ein: die Simulation ist damit
+ * unabhängig von der Framerate reproduzierbar, die Dauer wird in Simulationssekunden gemessen.
+ * Der Delta-Zeitwert ist dann in jedem Frame gleich, FrameMs ist deshalb die gemessene Zeit
+ * zwischen zwei Frame-Anfängen.
+ */
+UCLASS()
+class ITSSOMEKINDOFMAGICMP_API URuneSoakBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    /**
+     * Liest den Replay-Korpus: eine Rune pro Zeile im Format "Label|x0,y0;x1,y1;..." oder mit
+     * Zeitstempeln in ms "Label|x0,y0,t0;x1,y1,t1;...". Leere Zeilen und Zeilen mit # werden ignoriert.
+     */
+    static bool LoadStrokeCorpus(const FString& FilePath, TArray<FRuneStroke>& OutStrokes);
+
+    /** Ersatz-Korpus, wenn kein Replay-Korpus vorliegt: einfache, reproduzierbare Formen. */
+    static TArray<FRuneStroke> MakeDefaultCorpus();
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    struct FBot
+    {
+        TWeakObjectPtr<APawn> Pawn;
+        double NextCastTime = 0.0;
+        double NextMoveTime = 0.0;
+        int32 NextStroke = 0;
+    };
+
+    struct FFrameSample
+    {
+        double FrameMs = 0.0;
+        double GameThreadMs = 0.0;
+        double WorkerUtilizationPct = 0.0;
+        double UsedPhysicalMB = 0.0;
+        double GcMs = 0.0;
+        double PoolSpawnMs = 0.0;
+        int32 PoolHits = 0;
+        int32 PoolMisses = 0;
+        double BehaviorTreeMs = 0.0;
+        int32 EnemiesPerTier[static_cast<int32>(EEnemySignificanceTier::Count)] = {};
+    };
+
+    void ReadOptions();
+    void LoadAllSublevels();
+    void SpawnBots();
+    void SpawnEnemies();
+    void InstrumentBehaviorTree(AAIController* Controller);
+    FVector GetSpawnLocation();
+
+    void UpdateBot(FBot& Bot, double Now);
+    void CastRune(FBot& Bot);
+
+    void OnBeginFrame();
+    void OnEndFrame();
+    void OnPreGarbageCollect();
+    void OnPostGarbageCollect();
+    void WriteSummary();
+
+    // Optionen von der Kommandozeile
+    int32 NumBots = 8;
+    int32 NumEnemies = 16;
+    double DurationSeconds = 300.0;
+    double WarmupSeconds = 10.0;
+    double CastInterval = 2.0;
+    FString CsvPath;
+
+    FRandomStream Random;
+    TArray<FRuneStroke> Strokes;
+    TArray<FVector> SpawnOrigins;
+    TArray<FBot> Bots;
+    int32 NumSpawnedEnemies = 0;
+
+    /** Die Behavior Trees der Gegner, deren Zeit gemessen wird */
+    TArray<TWeakObjectPtr<UBenchmarkBehaviorTreeComponent>> BehaviorTrees;
+
+    UPROPERTY()
+    TObjectPtr<AONNXInferenceActor> InferenceActor;
+
+    // Messung
+    TUniquePtr<FArchive> CsvFile;
+    TArray<FFrameSample> Samples;
+    double FrameStartSeconds = 0.0;
+    /** Wanduhrzeit zwischen den Anfängen des vorigen und des aktuellen Frames */
+    double LastFrameMs = 0.0;
+    double BenchmarkStartTime = -1.0;
+    int32 FrameIndex = 0;
+    int32 CastsThisFrame = 0;
+    int32 TotalCasts = 0;
+    int32 RecognizedCasts = 0;
+    bool bFinished = false;
+
+    double GcStartSeconds = 0.0;
+    double GcMsThisFrame = 0.0;
+    FActorPoolStats LastPoolStats;
+
+    FDelegateHandle BeginFrameHandle;
+    FDelegateHandle EndFrameHandle;
+    FDelegateHandle PreGarbageCollectHandle;
+    FDelegateHandle PostGarbageCollectHandle;
+};
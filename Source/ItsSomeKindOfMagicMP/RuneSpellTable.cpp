@@ -0,0 +1,83 @@
+﻿#include "RuneSpellTable.h"
+
+bool URuneSpellTable::Compile(int32 NumModelClasses)
+{
+    CompiledNames.Reset();
+    CompiledSpellClasses.Reset();
+    UnknownIndex = INDEX_NONE;
+
+    if (NumModelClasses <= 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("RuneSpellTable %s: the model reports %d output classes."), *GetName(), NumModelClasses);
+        return false;
+    }
+
+    TArray<FName> Names;
+    TArray<TSubclassOf<AActor>> SpellClasses;
+    Names.SetNum(NumModelClasses);
+    SpellClasses.SetNum(NumModelClasses);
+
+    bool bValid = true;
+    for (const FRuneSpellEntry& Entry : Entries)
+    {
+        if (Entry.RuneName.IsNone())
+        {
+            UE_LOG(LogTemp, Error, TEXT("RuneSpellTable %s: the entry for index %d has no rune name."), *GetName(), Entry.Index);
+            bValid = false;
+            continue;
+        }
+
+        if (!Names.IsValidIndex(Entry.Index))
+        {
+            UE_LOG(LogTemp, Error, TEXT("RuneSpellTable %s: rune %s has index %d, but the model only has %d output classes."),
+                *GetName(), *Entry.RuneName.ToString(), Entry.Index, NumModelClasses);
+            bValid = false;
+            continue;
+        }
+
+        if (!Names[Entry.Index].IsNone())
+        {
+            UE_LOG(LogTemp, Error, TEXT("RuneSpellTable %s: index %d is used by both %s and %s."),
+                *GetName(), Entry.Index, *Names[Entry.Index].ToString(), *Entry.RuneName.ToString());
+            bValid = false;
+            continue;
+        }
+
+        Names[Entry.Index] = Entry.RuneName;
+        SpellClasses[Entry.Index] = Entry.SpellClass;
+
+        if (Entry.RuneName == UnknownRuneName)
+        {
+            UnknownIndex = Entry.Index;
+        }
+    }
+
+    if (!bValid)
+    {
+        UnknownIndex = INDEX_NONE;
+        return false;
+    }
+
+    // Eine Klasse ohne Eintrag ist kein Fehler, ihre Erkennung löst nur nichts aus.
+    for (int32 Index = 0; Index < NumModelClasses; ++Index)
+    {
+        if (Names[Index].IsNone())
+        {
+            UE_LOG(LogTemp, Warning, TEXT("RuneSpellTable %s: model output class %d has no entry."), *GetName(), Index);
+        }
+    }
+
+    CompiledNames = MoveTemp(Names);
+    CompiledSpellClasses = MoveTemp(SpellClasses);
+    return true;
+}
+
+FName URuneSpellTable::GetRuneName(int32 Index) const
+{
+    return CompiledNames.IsValidIndex(Index) ? CompiledNames[Index] : NAME_None;
+}
+
+TSubclassOf<AActor> URuneSpellTable::GetSpellClass(int32 Index) const
+{
+    return CompiledSpellClasses.IsValidIndex(Index) ? CompiledSpellClasses[Index] : nullptr;
+}
@@ -0,0 +1,78 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "GameFramework/Actor.h"
+#include "RuneSpellTable.generated.h"
+
+/** Eine Klasse des Modells: welcher Index welche Rune ist und welchen Spell sie auslöst. */
+USTRUCT(BlueprintType)
+struct ITSSOMEKINDOFMAGICMP_API FRuneSpellEntry
+{
+    GENERATED_BODY()
+
+    /** Der vom Modell zurückgegebene Index */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rune Spells", meta = (ClampMin = "0"))
+    int32 Index = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rune Spells")
+    FName RuneName;
+
+    /** Leer für Runen ohne Spell, z. B. "Unknown" */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rune Spells")
+    TSubclassOf<AActor> SpellClass;
+};
+
+/**
+ * URuneSpellTable
+ *
+ * Ordnet jedem Output-Index des Modells einen Rune-Namen und einen Spell zu und ersetzt damit die
+ * RuneMappings am AONNXInferenceActor und den Namensvergleich in BPC_RuneSystem. Beim Start des
+ * Modells wird die Tabelle gegen die Anzahl der Output-Klassen geprüft und in Arrays übersetzt,
+ * die direkt mit FPredictionResult::PredictedIndex indiziert werden.
+ */
+UCLASS(BlueprintType)
+class ITSSOMEKINDOFMAGICMP_API URuneSpellTable : public UPrimaryDataAsset
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rune Spells", meta = (TitleProperty = "RuneName"))
+    TArray<FRuneSpellEntry> Entries;
+
+    /** Diese Rune wird gewählt, wenn die Confidence unter dem Threshold liegt. */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rune Spells")
+    FName UnknownRuneName = TEXT("Unknown");
+
+    /**
+     * Prüft die Einträge gegen das Modell und baut die Lookup-Arrays auf. Jeder Fehler wird geloggt.
+     * @param NumModelClasses Die Anzahl der Output-Klassen des Modells.
+     * @return false, wenn die Tabelle nicht zum Modell passt. Dann liefern alle Abfragen nichts.
+     */
+    bool Compile(int32 NumModelClasses);
+
+    bool IsCompiled() const { return CompiledNames.Num() > 0; }
+
+    /** Die Anzahl der Klassen, für die zuletzt kompiliert wurde, 0 = nicht kompiliert */
+    int32 GetNumClasses() const { return CompiledNames.Num(); }
+
+    /** Der Rune-Name zum Modell-Index, NAME_None für unbekannte Indizes */
+    UFUNCTION(BlueprintPure, Category = "Rune Spells")
+    FName GetRuneName(int32 Index) const;
+
+    /** Der Spell zum Modell-Index, leer für unbekannte Indizes oder Runen ohne Spell */
+    UFUNCTION(BlueprintPure, Category = "Rune Spells")
+    TSubclassOf<AActor> GetSpellClass(int32 Index) const;
+
+    /** Der Index von UnknownRuneName, INDEX_NONE wenn die Tabelle keinen hat */
+    UFUNCTION(BlueprintPure, Category = "Rune Spells")
+    int32 GetUnknownIndex() const { return UnknownIndex; }
+
+private:
+    TArray<FName> CompiledNames;
+
+    UPROPERTY(Transient)
+    TArray<TSubclassOf<AActor>> CompiledSpellClasses;
+
+    int32 UnknownIndex = INDEX_NONE;
+};
@@ -0,0 +1,320 @@
+﻿#include "RuneStrokeCodec.h"
+
+namespace RuneStrokeCodec
+{
+    // Zigzag-Deltas zwischen 0 und 255 brauchen höchstens 9 Bit.
+    static constexpr int32 MaxDeltaBits = 9;
+
+    // Längere Pausen innerhalb eines Strichs werden beim Kodieren gekappt.
+    static constexpr uint32 MaxTimeDeltaMs = 60 * 1000;
+
+    /** Schreibt einzelne Bits in ein Byte-Array, LSB zuerst. */
+    struct FStrokeBitWriter
+    {
+        TArray<uint8>& Bytes;
+        int32 NumBits = 0;
+
+        explicit FStrokeBitWriter(TArray<uint8>& InBytes)
+            : Bytes(InBytes)
+        {
+        }
+
+        void WriteBits(uint32 Value, int32 Count)
+        {
+            for (int32 i = 0; i < Count; ++i)
+            {
+                if ((NumBits & 7) == 0)
+                {
+                    Bytes.Add(0);
+                }
+
+                if ((Value >> i) & 1)
+                {
+                    Bytes.Last() |= 1 << (NumBits & 7);
+                }
+                ++NumBits;
+            }
+        }
+
+        /** 7 Bit Nutzdaten plus 1 Fortsetzungsbit pro Gruppe. */
+        void WriteVarint(uint32 Value)
+        {
+            do
+            {
+                const uint32 Group = Value & 0x7F;
+                Value >>= 7;
+                WriteBits(Group | (Value != 0 ? 0x80 : 0), 8);
+            } while (Value != 0);
+        }
+    };
+
+    /** Gegenstück zu FStrokeBitWriter. Liest nie über das Ende hinaus, sondern setzt bOverflow. */
+    struct FStrokeBitReader
+    {
+        TArrayView<const uint8> Bytes;
+        int32 BitPos = 0;
+        bool bOverflow = false;
+
+        explicit FStrokeBitReader(TArrayView<const uint8> InBytes)
+            : Bytes(InBytes)
+        {
+        }
+
+        uint32 ReadBits(int32 Count)
+        {
+            uint32 Value = 0;
+            for (int32 i = 0; i < Count; ++i)
+            {
+                if (BitPos >= Bytes.Num() * 8)
+                {
+                    bOverflow = true;
+                    return 0;
+                }
+
+                if ((Bytes[BitPos >> 3] >> (BitPos & 7)) & 1)
+                {
+                    Value |= 1u << i;
+                }
+                ++BitPos;
+            }
+            return Value;
+        }
+
+        uint32 ReadVarint()
+        {
+            uint32 Value = 0;
+            for (int32 Shift = 0; Shift < 32; Shift += 7)
+            {
+                const uint32 Group = ReadBits(8);
+                Value |= (Group & 0x7F) << Shift;
+                if ((Group & 0x80) == 0)
+                {
+                    return Value;
+                }
+            }
+
+            bOverflow = true;
+            return 0;
+        }
+    };
+
+    static uint32 ZigZag(int32 Value)
+    {
+        return (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+    }
+
+    static int32 UnZigZag(uint32 Value)
+    {
+        return static_cast<int32>(Value >> 1) ^ -static_cast<int32>(Value & 1);
+    }
+
+    uint8 Quantize(float Value)
+    {
+        return static_cast<uint8>(FMath::Clamp(FMath::RoundToInt32(Value * (QuantizationSteps - 1)), 0, QuantizationSteps - 1));
+    }
+
+    float Dequantize(uint8 Value)
+    {
+        return Value / static_cast<float>(QuantizationSteps - 1);
+    }
+
+    void Encode(const FRuneStrokeData& Stroke, TArray<uint8>& OutBytes)
+    {
+        OutBytes.Reset();
+
+        const bool bHasTiming = Stroke.TimesMs.Num() > 0 && Stroke.TimesMs.Num() == Stroke.Points.Num();
+
+        TArray<FIntPoint, TInlineAllocator<128>> Quantized;
+        TArray<int32, TInlineAllocator<128>> Times;
+        for (int32 i = 0; i < Stroke.Points.Num(); ++i)
+        {
+            const FIntPoint Point(Quantize(Stroke.Points[i].X), Quantize(Stroke.Points[i].Y));
+            if (Quantized.Num() > 0 && Quantized.Last() == Point)
+            {
+                // Den späteren Zeitpunkt behalten, damit die Dauer des Strichs erhalten bleibt.
+                if (bHasTiming && Quantized.Num() > 1)
+                {
+                    Times.Last() = Stroke.TimesMs[i];
+                }
+                continue;
+            }
+
+            Quantized.Add(Point);
+            if (bHasTiming)
+            {
+                Times.Add(Stroke.TimesMs[i]);
+            }
+        }
+
+        // Eine Bitbreite für alle Deltas des Strichs, passend zum größten Sprung.
+        int32 DeltaBits = 1;
+        for (int32 i = 1; i < Quantized.Num(); ++i)
+        {
+            const FIntPoint Delta = Quantized[i] - Quantized[i - 1];
+            const uint32 Largest = FMath::Max(ZigZag(Delta.X), ZigZag(Delta.Y));
+            if (Largest != 0)
+            {
+                DeltaBits = FMath::Max(DeltaBits, static_cast<int32>(FMath::FloorLog2(Largest)) + 1);
+            }
+        }
+
+        FStrokeBitWriter Writer(OutBytes);
+        Writer.WriteVarint(Quantized.Num());
+        Writer.WriteBits(bHasTiming ? 1 : 0, 1);
+
+        if (Quantized.Num() == 0)
+        {
+            return;
+        }
+
+        Writer.WriteBits(Quantized[0].X, 8);
+        Writer.WriteBits(Quantized[0].Y, 8);
+
+        if (Quantized.Num() > 1)
+        {
+            Writer.WriteBits(DeltaBits, 4);
+            for (int32 i = 1; i < Quantized.Num(); ++i)
+            {
+                const FIntPoint Delta = Quantized[i] - Quantized[i - 1];
+                Writer.WriteBits(ZigZag(Delta.X), DeltaBits);
+                Writer.WriteBits(ZigZag(Delta.Y), DeltaBits);
+            }
+        }
+
+        if (bHasTiming)
+        {
+            for (int32 i = 1; i < Times.Num(); ++i)
+            {
+                Writer.WriteVarint(static_cast<uint32>(FMath::Clamp<int64>(int64(Times[i]) - Times[i - 1], 0, MaxTimeDeltaMs)));
+            }
+        }
+    }
+
+    bool Decode(TArrayView<const uint8> Bytes, FRuneStrokeData& OutStroke)
+    {
+        OutStroke.Points.Reset();
+        OutStroke.TimesMs.Reset();
+
+        if (Bytes.Num() == 0 || Bytes.Num() > MaxEncodedBytes)
+        {
+            return false;
+        }
+
+        FStrokeBitReader Reader(Bytes);
+        const uint32 NumPoints = Reader.ReadVarint();
+        const bool bHasTiming = Reader.ReadBits(1) != 0;
+        if (Reader.bOverflow || NumPoints == 0 || NumPoints > static_cast<uint32>(FRuneStrokeData::MaxPoints))
+        {
+            return false;
+        }
+
+        OutStroke.Points.Reserve(NumPoints);
+
+        int32 X = Reader.ReadBits(8);
+        int32 Y = Reader.ReadBits(8);
+        OutStroke.Points.Add(FVector2f(Dequantize(X), Dequantize(Y)));
+
+        if (NumPoints > 1)
+        {
+            const int32 DeltaBits = Reader.ReadBits(4);
+            if (DeltaBits < 1 || DeltaBits > MaxDeltaBits)
+            {
+                return false;
+            }
+
+            for (uint32 i = 1; i < NumPoints; ++i)
+            {
+                X += UnZigZag(Reader.ReadBits(DeltaBits));
+                Y += UnZigZag(Reader.ReadBits(DeltaBits));
+                if (Reader.bOverflow || X < 0 || X >= QuantizationSteps || Y < 0 || Y >= QuantizationSteps)
+                {
+                    return false;
+                }
+
+                OutStroke.Points.Add(FVector2f(Dequantize(X), Dequantize(Y)));
+            }
+        }
+
+        if (bHasTiming)
+        {
+            OutStroke.TimesMs.Reserve(NumPoints);
+            OutStroke.TimesMs.Add(0);
+
+            int32 Time = 0;
+            for (uint32 i = 1; i < NumPoints; ++i)
+            {
+                const uint32 Delta = Reader.ReadVarint();
+                if (Delta > MaxTimeDeltaMs)
+                {
+                    return false;
+                }
+
+                Time += Delta;
+                OutStroke.TimesMs.Add(Time);
+            }
+        }
+
+        return !Reader.bOverflow;
+    }
+
+    void Rasterize(TArrayView<const FVector2f> Points, int32 Size, TArray<FColor>& OutPixels)
+    {
+        OutPixels.Init(FColor::Black, Size * Size);
+
+        // Alles in ganzzahligen 1/256 Pixel: ein quantisierter Punkt Q liegt bei Q * Size,
+        // die Mitte von Pixel X bei X * 256 + 128. Keine Gleitkommazahlen, damit jede Plattform
+        // dieselben Pixel setzt.
+        const int64 Unit = QuantizationSteps;
+        const int64 BrushRadius = Unit * 3 / 2;
+        const int64 BrushRadiusSquared = BrushRadius * BrushRadius;
+
+        auto Stamp = [&](int64 CenterX, int64 CenterY)
+        {
+            const int32 MinX = static_cast<int32>(FMath::Max<int64>((CenterX - BrushRadius) / Unit, 0));
+            const int32 MaxX = static_cast<int32>(FMath::Min<int64>((CenterX + BrushRadius) / Unit, Size - 1));
+            const int32 MinY = static_cast<int32>(FMath::Max<int64>((CenterY - BrushRadius) / Unit, 0));
+            const int32 MaxY = static_cast<int32>(FMath::Min<int64>((CenterY + BrushRadius) / Unit, Size - 1));
+
+            for (int32 PixelY = MinY; PixelY <= MaxY; ++PixelY)
+            {
+                const int64 DY = PixelY * Unit + Unit / 2 - CenterY;
+                for (int32 PixelX = MinX; PixelX <= MaxX; ++PixelX)
+                {
+                    const int64 DX = PixelX * Unit + Unit / 2 - CenterX;
+                    if (DX * DX + DY * DY <= BrushRadiusSquared)
+                    {
+                        OutPixels[PixelY * Size + PixelX] = FColor::White;
+                    }
+                }
+            }
+        };
+
+        int64 PrevX = 0;
+        int64 PrevY = 0;
+        for (int32 i = 0; i < Points.Num(); ++i)
+        {
+            const int64 X = int64(Quantize(Points[i].X)) * Size;
+            const int64 Y = int64(Quantize(Points[i].Y)) * Size;
+
+            if (i == 0)
+            {
+                Stamp(X, Y);
+            }
+            else
+            {
+                // In höchstens halben Pixelschritten entlang des Segments stempeln.
+                const int64 DX = X - PrevX;
+                const int64 DY = Y - PrevY;
+                const int64 HalfPixel = Unit / 2;
+                const int64 Steps = FMath::Max<int64>((FMath::Max(FMath::Abs(DX), FMath::Abs(DY)) + HalfPixel - 1) / HalfPixel, 1);
+                for (int64 Step = 1; Step <= Steps; ++Step)
+                {
+                    Stamp(PrevX + DX * Step / Steps, PrevY + DY * Step / Steps);
+                }
+            }
+
+            PrevX = X;
+            PrevY = Y;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "RuneStrokeData.h"
+
+/**
+ * RuneStrokeCodec
+ *
+ * Kompakte Kodierung eines Runen-Strichs für das Netz und deterministische Rasterisierung.
+ *
+ * Format (Bitstrom, LSB zuerst):
+ *   Varint   Anzahl Punkte
+ *   1 Bit    Zeitstempel vorhanden
+ *   8+8 Bit  erster Punkt (quantisiert auf 0 - 255)
+ *   4 Bit    Bitbreite B der Deltas (nur bei mehr als einem Punkt)
+ *   je Punkt B+B Bit Zigzag-Delta zum Vorgänger
+ *   je Punkt Varint Zeit-Delta in ms (nur mit Zeitstempeln, ab dem zweiten Punkt)
+ *
+ * Aufeinanderfolgende Punkte, die auf dieselbe Stelle quantisiert werden, fallen beim Kodieren weg.
+ *
+ * Client und Server rasterisieren ausschließlich die quantisierten Punkte mit Ganzzahl-Arithmetik,
+ * so entsteht auf beiden Seiten exakt derselbe Eingabetensor.
+ */
+namespace RuneStrokeCodec
+{
+    /** Auflösung der Quantisierung pro Achse */
+    static constexpr int32 QuantizationSteps = 256;
+
+    /** Obergrenze für einen kodierten Strich, größere Pakete werden beim Dekodieren abgelehnt. */
+    static constexpr int32 MaxEncodedBytes = 8 * 1024;
+
+    /** Quantisiert eine normierte Koordinate (0.0 - 1.0) auf 0 - 255. */
+    ITSSOMEKINDOFMAGICMP_API uint8 Quantize(float Value);
+
+    /** Kehrwert von Quantize. Quantize(Dequantize(Q)) == Q. */
+    ITSSOMEKINDOFMAGICMP_API float Dequantize(uint8 Value);
+
+    /** Kodiert den Strich. Der Strich muss IsValid() erfüllen. */
+    ITSSOMEKINDOFMAGICMP_API void Encode(const FRuneStrokeData& Stroke, TArray<uint8>& OutBytes);
+
+    /** Dekodiert einen Strich. Gibt false bei beschädigten oder zu großen Daten zurück. */
+    ITSSOMEKINDOFMAGICMP_API bool Decode(TArrayView<const uint8> Bytes, FRuneStrokeData& OutStroke);
+
+    /** Zeichnet die quantisierten Punkte weiß auf schwarz in eine Canvas der gegebenen Größe. */
+    ITSSOMEKINDOFMAGICMP_API void Rasterize(TArrayView<const FVector2f> Points, int32 Size, TArray<FColor>& OutPixels);
+}
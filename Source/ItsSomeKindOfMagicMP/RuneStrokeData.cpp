@@ -0,0 +1,31 @@
+#include "RuneStrokeData.h"
+#include "RuneStrokeCodec.h"
+
+bool FRuneStrokeData::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+    TArray<uint8> Bytes;
+    if (Ar.IsSaving())
+    {
+        RuneStrokeCodec::Encode(*this, Bytes);
+    }
+
+    uint32 NumBytes = Bytes.Num();
+    Ar.SerializeIntPacked(NumBytes);
+
+    if (Ar.IsLoading())
+    {
+        if (NumBytes > static_cast<uint32>(RuneStrokeCodec::MaxEncodedBytes))
+        {
+            Ar.SetError();
+            bOutSuccess = false;
+            return true;
+        }
+
+        Bytes.SetNumUninitialized(NumBytes);
+    }
+
+    Ar.Serialize(Bytes.GetData(), NumBytes);
+
+    bOutSuccess = !Ar.IsError() && (Ar.IsSaving() || RuneStrokeCodec::Decode(Bytes, *this));
+    return true;
+}
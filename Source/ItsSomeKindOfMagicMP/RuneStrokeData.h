@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "RuneStrokeData.generated.h"
+
+/**
+ * FRuneStrokeData
+ *
+ * Ein gezeichneter Runen-Strich, wie ihn der Client an den Server schickt: nur die Punktfolge in
+ * normierten Canvas-Koordinaten (0.0 - 1.0), nicht die fertige Canvas. Der Server rasterisiert
+ * daraus selbst den Eingabetensor.
+ *
+ * Über das Netz geht der Strich quantisiert und delta-kodiert (siehe RuneStrokeCodec), typischerweise
+ * wenige hundert Bytes statt 16 KB für den Tensor.
+ */
+USTRUCT(BlueprintType)
+struct ITSSOMEKINDOFMAGICMP_API FRuneStrokeData
+{
+    GENERATED_BODY()
+
+    /** Obergrenze für die Anzahl der Punkte pro Strich, größere Striche lehnt der Server ab. */
+    static constexpr int32 MaxPoints = 512;
+
+    /** Die Punkte des Strichs in Zeichenreihenfolge */
+    UPROPERTY()
+    TArray<FVector2f> Points;
+
+    /** Optional: Zeit seit Beginn des Strichs in Millisekunden, ein Eintrag pro Punkt */
+    UPROPERTY()
+    TArray<int32> TimesMs;
+
+    /** Prüft, ob der Strich vom Server verarbeitet werden darf. */
+    bool IsValid() const
+    {
+        if (Points.Num() == 0 || Points.Num() > MaxPoints || (TimesMs.Num() > 0 && TimesMs.Num() != Points.Num()))
+        {
+            return false;
+        }
+
+        for (const FVector2f& Point : Points)
+        {
+            if (!(Point.X >= 0.0f && Point.X <= 1.0f && Point.Y >= 0.0f && Point.Y <= 1.0f))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /** Kodiert den Strich kompakt für RPCs, siehe RuneStrokeCodec. */
+    bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FRuneStrokeData> : public TStructOpsTypeTraitsBase2<FRuneStrokeData>
+{
+    enum
+    {
+        WithNetSerializer = true,
+    };
+};
@@ -0,0 +1,391 @@
+﻿#include "SpatialHashSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "StatusEffectComponent.h"
+
+DECLARE_STATS_GROUP(TEXT("SpatialHash"), STATGROUP_SpatialHash, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Query"), STAT_SpatialHash_Query, STATGROUP_SpatialHash);
+DECLARE_CYCLE_STAT(TEXT("Query batch"), STAT_SpatialHash_QueryBatch, STATGROUP_SpatialHash);
+DECLARE_CYCLE_STAT(TEXT("Move"), STAT_SpatialHash_Move, STATGROUP_SpatialHash);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Cell changes"), STAT_SpatialHash_CellChanges, STATGROUP_SpatialHash);
+
+namespace SpatialHash
+{
+    static const TCHAR* EffectTargetInterfacePath = TEXT("/Game/Mechanics/Interfaces/BPI_EffectTargetInterface.BPI_EffectTargetInterface_C");
+
+    static TAutoConsoleVariable<float> CVarCellSize(
+        TEXT("rune.SpatialHash.CellSize"), 400.0f,
+        TEXT("Kantenlänge einer Zelle des Spatial Hash in cm. Gilt ab der nächsten geladenen Welt."));
+
+    /** Ab so vielen Abfragen verteilt QueryBatch die Arbeit auf die Task-Worker. */
+    static constexpr int32 MinParallelBatch = 16;
+}
+
+bool USpatialHashSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USpatialHashSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    CellSize = FMath::Max(SpatialHash::CVarCellSize.GetValueOnGameThread(), 50.0f);
+
+    EffectTargetInterface = LoadObject<UClass>(nullptr, SpatialHash::EffectTargetInterfacePath);
+    if (!EffectTargetInterface)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SpatialHash: failed to load %s, only actors with a status effect component are tracked."), SpatialHash::EffectTargetInterfacePath);
+    }
+
+    ActorSpawnedHandle = GetWorld()->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &USpatialHashSubsystem::OnActorSpawned));
+}
+
+void USpatialHashSubsystem::Deinitialize()
+{
+    GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+
+    for (int32 TargetIndex = 0; TargetIndex < TargetRoots.Num(); ++TargetIndex)
+    {
+        if (USceneComponent* Root = TargetRoots[TargetIndex].Get())
+        {
+            Root->TransformUpdated.Remove(TargetMoveHandles[TargetIndex]);
+        }
+    }
+
+    Cells.Empty();
+    TargetActors.Empty();
+    TargetRoots.Empty();
+    TargetLocations.Empty();
+    TargetRadii.Empty();
+    TargetCells.Empty();
+    TargetMoveHandles.Empty();
+    FreeTargets.Empty();
+    ActorToTarget.Empty();
+
+    Super::Deinitialize();
+}
+
+void USpatialHashSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // Im Level platzierte Ziele, alles Gespawnte kommt über OnActorSpawned.
+    for (TActorIterator<AActor> It(&InWorld); It; ++It)
+    {
+        if (ShouldTrack(*It))
+        {
+            RegisterActor(*It);
+        }
+    }
+}
+
+bool USpatialHashSubsystem::ShouldTrack(const AActor* Actor) const
+{
+    if (!Actor)
+    {
+        return false;
+    }
+
+    if (EffectTargetInterface && Actor->GetClass()->ImplementsInterface(EffectTargetInterface))
+    {
+        return true;
+    }
+
+    if (Actor->FindComponentByClass<UStatusEffectComponent>() != nullptr)
+    {
+        return true;
+    }
+
+    // Physik-Props, damit Kraftfelder sie finden. Das Flag gilt schon vor dem Anlegen des Bodys.
+    const UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+    return Primitive && Primitive->BodyInstance.bSimulatePhysics;
+}
+
+void USpatialHashSubsystem::OnActorSpawned(AActor* Actor)
+{
+    if (ShouldTrack(Actor))
+    {
+        RegisterActor(Actor);
+    }
+}
+
+FIntPoint USpatialHashSubsystem::GetCell(const FVector& Location) const
+{
+    return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void USpatialHashSubsystem::AddToCell(int32 TargetIndex)
+{
+    Cells.FindOrAdd(TargetCells[TargetIndex]).Add(TargetIndex);
+}
+
+void USpatialHashSubsystem::RemoveFromCell(int32 TargetIndex)
+{
+    if (TArray<int32>* Cell = Cells.Find(TargetCells[TargetIndex]))
+    {
+        Cell->RemoveSingleSwap(TargetIndex, EAllowShrinking::No);
+    }
+}
+
+void USpatialHashSubsystem::RegisterActor(AActor* Actor)
+{
+    USceneComponent* Root = Actor ? Actor->GetRootComponent() : nullptr;
+    if (!Root || ActorToTarget.Contains(Actor))
+    {
+        return;
+    }
+
+    int32 TargetIndex;
+    if (FreeTargets.Num() > 0)
+    {
+        TargetIndex = FreeTargets.Pop(EAllowShrinking::No);
+    }
+    else
+    {
+        TargetIndex = TargetActors.AddDefaulted();
+        TargetRoots.AddDefaulted();
+        TargetLocations.AddDefaulted();
+        TargetRadii.AddDefaulted();
+        TargetCells.AddDefaulted();
+        TargetMoveHandles.AddDefaulted();
+    }
+
+    TargetActors[TargetIndex] = Actor;
+    TargetRoots[TargetIndex] = Root;
+    TargetLocations[TargetIndex] = Root->GetComponentLocation();
+    TargetRadii[TargetIndex] = Actor->GetSimpleCollisionRadius();
+    TargetCells[TargetIndex] = GetCell(TargetLocations[TargetIndex]);
+    TargetMoveHandles[TargetIndex] = Root->TransformUpdated.AddUObject(this, &USpatialHashSubsystem::OnTargetMoved, TargetIndex);
+
+    MaxTargetRadius = FMath::Max(MaxTargetRadius, TargetRadii[TargetIndex]);
+    ActorToTarget.Add(Actor, TargetIndex);
+    AddToCell(TargetIndex);
+
+    Actor->OnEndPlay.AddUniqueDynamic(this, &USpatialHashSubsystem::OnTargetEndPlay);
+}
+
+void USpatialHashSubsystem::UnregisterActor(AActor* Actor)
+{
+    int32 TargetIndex;
+    if (!ActorToTarget.RemoveAndCopyValue(Actor, TargetIndex))
+    {
+        return;
+    }
+
+    RemoveFromCell(TargetIndex);
+    if (USceneComponent* Root = TargetRoots[TargetIndex].Get())
+    {
+        Root->TransformUpdated.Remove(TargetMoveHandles[TargetIndex]);
+    }
+    if (Actor)
+    {
+        Actor->OnEndPlay.RemoveDynamic(this, &USpatialHashSubsystem::OnTargetEndPlay);
+    }
+
+    TargetActors[TargetIndex] = nullptr;
+    TargetRoots[TargetIndex] = nullptr;
+    TargetMoveHandles[TargetIndex].Reset();
+    FreeTargets.Add(TargetIndex);
+}
+
+void USpatialHashSubsystem::OnTargetEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+    UnregisterActor(Actor);
+}
+
+void USpatialHashSubsystem::OnTargetMoved(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport, int32 TargetIndex)
+{
+    SCOPE_CYCLE_COUNTER(STAT_SpatialHash_Move);
+
+    TargetLocations[TargetIndex] = Component->GetComponentLocation();
+
+    const FIntPoint NewCell = GetCell(TargetLocations[TargetIndex]);
+    if (NewCell != TargetCells[TargetIndex])
+    {
+        RemoveFromCell(TargetIndex);
+        TargetCells[TargetIndex] = NewCell;
+        AddToCell(TargetIndex);
+        INC_DWORD_STAT(STAT_SpatialHash_CellChanges);
+    }
+}
+
+void USpatialHashSubsystem::CollectTargets(const FSpatialQuery& Query, TArray<int32>& OutTargets) const
+{
+    // Ausdehnung der Form in XY, erweitert um den größten Zielradius.
+    FBox2D Bounds(ForceInit);
+    switch (Query.Shape)
+    {
+    case ESpatialQueryShape::Sphere:
+    case ESpatialQueryShape::Cone:
+        Bounds = FBox2D(FVector2D(Query.Origin), FVector2D(Query.Origin)).ExpandBy(Query.Radius);
+        break;
+    case ESpatialQueryShape::Capsule:
+        Bounds += FVector2D(Query.Origin);
+        Bounds += FVector2D(Query.DirectionOrEnd);
+        Bounds = Bounds.ExpandBy(Query.Radius);
+        break;
+    }
+    Bounds = Bounds.ExpandBy(MaxTargetRadius);
+
+    const FVector ConeDirection = Query.DirectionOrEnd.GetSafeNormal();
+    const float ConeHalfAngle = FMath::DegreesToRadians(FMath::Clamp(Query.HalfAngleDegrees, 0.0f, 180.0f));
+
+    auto TestTarget = [&](int32 TargetIndex)
+    {
+        const FVector& Location = TargetLocations[TargetIndex];
+        const float TargetRadius = TargetRadii[TargetIndex];
+
+        switch (Query.Shape)
+        {
+        case ESpatialQueryShape::Sphere:
+            return FVector::DistSquared(Location, Query.Origin) <= FMath::Square(Query.Radius + TargetRadius);
+
+        case ESpatialQueryShape::Capsule:
+            return FMath::PointDistToSegmentSquared(Location, Query.Origin, Query.DirectionOrEnd) <= FMath::Square(Query.Radius + TargetRadius);
+
+        case ESpatialQueryShape::Cone:
+        {
+            const FVector ToTarget = Location - Query.Origin;
+            const double Distance = ToTarget.Size();
+            if (Distance > Query.Radius + TargetRadius)
+            {
+                return false;
+            }
+            if (Distance <= TargetRadius)
+            {
+                return true;
+            }
+
+            // Der Winkel zum Mittelpunkt abzüglich der Winkelgröße des Ziels.
+            const double Angle = FMath::Acos(FMath::Clamp(FVector::DotProduct(ConeDirection, ToTarget / Distance), -1.0, 1.0));
+            return Angle - FMath::Asin(TargetRadius / Distance) <= ConeHalfAngle;
+        }
+        }
+        return false;
+    };
+
+    auto TestCell = [&](const TArray<int32>& Cell)
+    {
+        for (const int32 TargetIndex : Cell)
+        {
+            if (TestTarget(TargetIndex))
+            {
+                OutTargets.Add(TargetIndex);
+            }
+        }
+    };
+
+    const FIntPoint MinCell = GetCell(FVector(Bounds.Min, 0.0));
+    const FIntPoint MaxCell = GetCell(FVector(Bounds.Max, 0.0));
+    const int64 NumCellsInBounds = int64(MaxCell.X - MinCell.X + 1) * int64(MaxCell.Y - MinCell.Y + 1);
+
+    // Sehr große Formen: lieber die belegten Zellen durchgehen als jede Zelle im Rechteck nachschlagen.
+    if (NumCellsInBounds > Cells.Num())
+    {
+        for (const TPair<FIntPoint, TArray<int32>>& Cell : Cells)
+        {
+            if (Cell.Key.X >= MinCell.X && Cell.Key.X <= MaxCell.X && Cell.Key.Y >= MinCell.Y && Cell.Key.Y <= MaxCell.Y)
+            {
+                TestCell(Cell.Value);
+            }
+        }
+        return;
+    }
+
+    for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+    {
+        for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+        {
+            if (const TArray<int32>* Cell = Cells.Find(FIntPoint(X, Y)))
+            {
+                TestCell(*Cell);
+            }
+        }
+    }
+}
+
+void USpatialHashSubsystem::ResolveActors(TArrayView<const int32> Targets, TArray<AActor*>& OutActors) const
+{
+    OutActors.Reset(Targets.Num());
+    for (const int32 TargetIndex : Targets)
+    {
+        if (AActor* Actor = TargetActors[TargetIndex].Get())
+        {
+            OutActors.Add(Actor);
+        }
+    }
+}
+
+void USpatialHashSubsystem::QuerySphere(const FVector& Center, float Radius, TArray<AActor*>& OutActors) const
+{
+    FSpatialQuery Query;
+    Query.Shape = ESpatialQueryShape::Sphere;
+    Query.Origin = Center;
+    Query.Radius = Radius;
+
+    SCOPE_CYCLE_COUNTER(STAT_SpatialHash_Query);
+    TArray<int32> Targets;
+    CollectTargets(Query, Targets);
+    ResolveActors(Targets, OutActors);
+}
+
+void USpatialHashSubsystem::QueryCone(const FVector& Origin, const FVector& Direction, float Length, float HalfAngleDegrees, TArray<AActor*>& OutActors) const
+{
+    FSpatialQuery Query;
+    Query.Shape = ESpatialQueryShape::Cone;
+    Query.Origin = Origin;
+    Query.DirectionOrEnd = Direction;
+    Query.Radius = Length;
+    Query.HalfAngleDegrees = HalfAngleDegrees;
+
+    SCOPE_CYCLE_COUNTER(STAT_SpatialHash_Query);
+    TArray<int32> Targets;
+    CollectTargets(Query, Targets);
+    ResolveActors(Targets, OutActors);
+}
+
+void USpatialHashSubsystem::QueryCapsule(const FVector& Start, const FVector& End, float Radius, TArray<AActor*>& OutActors) const
+{
+    FSpatialQuery Query;
+    Query.Shape = ESpatialQueryShape::Capsule;
+    Query.Origin = Start;
+    Query.DirectionOrEnd = End;
+    Query.Radius = Radius;
+
+    SCOPE_CYCLE_COUNTER(STAT_SpatialHash_Query);
+    TArray<int32> Targets;
+    CollectTargets(Query, Targets);
+    ResolveActors(Targets, OutActors);
+}
+
+void USpatialHashSubsystem::QueryBatch(const TArray<FSpatialQuery>& Queries, TArray<FSpatialQueryResult>& OutResults) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_SpatialHash_QueryBatch);
+
+    // Die Worker lesen nur die Arrays des Gitters, Actors werden danach auf dem Game-Thread aufgelöst.
+    TArray<TArray<int32>> Targets;
+    Targets.SetNum(Queries.Num());
+    ParallelFor(Queries.Num(), [this, &Queries, &Targets](int32 Index)
+    {
+        CollectTargets(Queries[Index], Targets[Index]);
+    }, Queries.Num() < SpatialHash::MinParallelBatch ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+    OutResults.SetNum(Queries.Num());
+    for (int32 i = 0; i < Queries.Num(); ++i)
+    {
+        TArray<TObjectPtr<AActor>>& Actors = OutResults[i].Actors;
+        Actors.Reset(Targets[i].Num());
+        for (const int32 TargetIndex : Targets[i])
+        {
+            if (AActor* Actor = TargetActors[TargetIndex].Get())
+            {
+                Actors.Add(Actor);
+            }
+        }
+    }
+}
@@ -0,0 +1,141 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SpatialHashSubsystem.generated.h"
+
+UENUM(BlueprintType)
+enum class ESpatialQueryShape : uint8
+{
+    Sphere,
+    Cone,
+    Capsule
+};
+
+/** Eine Abfrage für USpatialHashSubsystem::QueryBatch. Welche Felder zählen, hängt von Shape ab. */
+USTRUCT(BlueprintType)
+struct FSpatialQuery
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spatial")
+    ESpatialQueryShape Shape = ESpatialQueryShape::Sphere;
+
+    /** Mittelpunkt der Kugel, Spitze des Kegels oder Anfang der Kapsel */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spatial")
+    FVector Origin = FVector::ZeroVector;
+
+    /** Cone: Blickrichtung, Capsule: Ende der Kapsel */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spatial")
+    FVector DirectionOrEnd = FVector::ForwardVector;
+
+    /** Sphere und Capsule: Radius, Cone: Länge */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spatial")
+    float Radius = 500.0f;
+
+    /** Nur Cone: halber Öffnungswinkel in Grad */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spatial")
+    float HalfAngleDegrees = 30.0f;
+};
+
+USTRUCT(BlueprintType)
+struct FSpatialQueryResult
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Spatial")
+    TArray<TObjectPtr<AActor>> Actors;
+};
+
+/**
+ * USpatialHashSubsystem
+ *
+ * Gleichmäßiges 2D-Gitter über alle Effektziele der Welt: Actors mit BPI_EffectTargetInterface,
+ * UStatusEffectComponent oder simulierender Root-Komponente werden beim Spawnen automatisch
+ * aufgenommen, andere über RegisterActor. Actors, die erst später zu simulieren beginnen, müssen
+ * ebenfalls über RegisterActor angemeldet werden.
+ * Bewegt sich die Root-Komponente eines Ziels, wird nur dieses Ziel umsortiert; Abfragen prüfen
+ * nur die Zellen, die die Form berührt, statt Overlap-Komponenten oder Physik-Abfragen zu nutzen.
+ *
+ * Die Zellgröße kommt aus rune.SpatialHash.CellSize. Kosten erscheinen unter "stat SpatialHash".
+ */
+UCLASS()
+class ITSSOMEKINDOFMAGICMP_API USpatialHashSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+    /** Nimmt einen Actor auf, der kein Effektziel ist, z. B. Spawnable Objects. */
+    UFUNCTION(BlueprintCallable, Category = "Spatial")
+    void RegisterActor(AActor* Actor);
+
+    UFUNCTION(BlueprintCallable, Category = "Spatial")
+    void UnregisterActor(AActor* Actor);
+
+    /** Alle Ziele, deren Kollisionsradius die Kugel berührt */
+    UFUNCTION(BlueprintCallable, Category = "Spatial")
+    void QuerySphere(const FVector& Center, float Radius, TArray<AActor*>& OutActors) const;
+
+    /** Alle Ziele im Kegel ab Origin in Direction, bis Length entfernt */
+    UFUNCTION(BlueprintCallable, Category = "Spatial")
+    void QueryCone(const FVector& Origin, const FVector& Direction, float Length, float HalfAngleDegrees, TArray<AActor*>& OutActors) const;
+
+    /** Alle Ziele, die die Kapsel von Start bis End berühren, z. B. Strahlen und Wände */
+    UFUNCTION(BlueprintCallable, Category = "Spatial")
+    void QueryCapsule(const FVector& Start, const FVector& End, float Radius, TArray<AActor*>& OutActors) const;
+
+    /** Mehrere Abfragen auf einmal, große Mengen laufen parallel. Ein Ergebnis pro Abfrage, gleiche Reihenfolge. */
+    UFUNCTION(BlueprintCallable, Category = "Spatial")
+    void QueryBatch(const TArray<FSpatialQuery>& Queries, TArray<FSpatialQueryResult>& OutResults) const;
+
+    UFUNCTION(BlueprintPure, Category = "Spatial")
+    int32 GetNumTargets() const { return ActorToTarget.Num(); }
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    bool ShouldTrack(const AActor* Actor) const;
+    void OnActorSpawned(AActor* Actor);
+    void OnTargetMoved(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport, int32 TargetIndex);
+
+    UFUNCTION()
+    void OnTargetEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+    FIntPoint GetCell(const FVector& Location) const;
+    void AddToCell(int32 TargetIndex);
+    void RemoveFromCell(int32 TargetIndex);
+
+    /** Sammelt die Indizes aller getroffenen Ziele, ohne UObjects anzufassen (auch von Worker-Threads). */
+    void CollectTargets(const FSpatialQuery& Query, TArray<int32>& OutTargets) const;
+    void ResolveActors(TArrayView<const int32> Targets, TArray<AActor*>& OutActors) const;
+
+    /** Kantenlänge einer Zelle in cm */
+    float CellSize = 400.0f;
+
+    /** Größter Kollisionsradius aller Ziele, um so viel werden Abfragen erweitert */
+    float MaxTargetRadius = 0.0f;
+
+    TMap<FIntPoint, TArray<int32>> Cells;
+
+    // Ziele, ein Array pro Feld, freie Plätze werden wiederverwendet
+    TArray<TWeakObjectPtr<AActor>> TargetActors;
+    TArray<TWeakObjectPtr<USceneComponent>> TargetRoots;
+    TArray<FVector> TargetLocations;
+    TArray<float> TargetRadii;
+    TArray<FIntPoint> TargetCells;
+    TArray<FDelegateHandle> TargetMoveHandles;
+    TArray<int32> FreeTargets;
+
+    TMap<TObjectKey<AActor>, int32> ActorToTarget;
+
+    UPROPERTY()
+    TObjectPtr<UClass> EffectTargetInterface;
+
+    FDelegateHandle ActorSpawnedHandle;
+};
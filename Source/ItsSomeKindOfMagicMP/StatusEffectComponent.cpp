@@ -0,0 +1,196 @@
+#include "StatusEffectComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "StatusEffectSubsystem.h"
+
+UStatusEffectComponent::UStatusEffectComponent()
+{
+    // Getaktet wird zentral im Subsystem.
+    PrimaryComponentTick.bCanEverTick = false;
+    SetIsReplicatedByDefault(true);
+}
+
+void UStatusEffectComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    DOREPLIFETIME(UStatusEffectComponent, Modifiers);
+}
+
+void UStatusEffectComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (GetOwner()->HasAuthority())
+    {
+        if (UStatusEffectSubsystem* Subsystem = GetSubsystem())
+        {
+            TargetIndex = Subsystem->RegisterTarget(this);
+        }
+    }
+}
+
+void UStatusEffectComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UStatusEffectSubsystem* Subsystem = GetSubsystem())
+    {
+        Subsystem->UnregisterTarget(TargetIndex);
+    }
+    TargetIndex = INDEX_NONE;
+
+    Super::EndPlay(EndPlayReason);
+}
+
+UStatusEffectSubsystem* UStatusEffectComponent::GetSubsystem() const
+{
+    const UWorld* World = GetWorld();
+    return World ? World->GetSubsystem<UStatusEffectSubsystem>() : nullptr;
+}
+
+FStatusEffectHandle UStatusEffectComponent::ApplyEffect(const UStatusEffectDefinition* Definition, AActor* EffectInstigator)
+{
+    UStatusEffectSubsystem* Subsystem = GetSubsystem();
+    if (!Definition || !Subsystem || TargetIndex == INDEX_NONE)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("ApplyEffect: %s cannot receive effects (no definition, no subsystem or no authority)."), *GetNameSafe(GetOwner()));
+        return FStatusEffectHandle();
+    }
+
+    return Subsystem->ApplyEffect(TargetIndex, Definition, EffectInstigator);
+}
+
+bool UStatusEffectComponent::RemoveEffect(FStatusEffectHandle Handle)
+{
+    UStatusEffectSubsystem* Subsystem = GetSubsystem();
+    return Subsystem && TargetIndex != INDEX_NONE && Subsystem->RemoveEffect(Handle);
+}
+
+int32 UStatusEffectComponent::RemoveEffectsOfType(EStatusEffectType Type)
+{
+    UStatusEffectSubsystem* Subsystem = GetSubsystem();
+    return Subsystem ? Subsystem->RemoveEffectsOfType(TargetIndex, Type) : 0;
+}
+
+bool UStatusEffectComponent::HasEffect(EStatusEffectType Type) const
+{
+    const UStatusEffectSubsystem* Subsystem = GetSubsystem();
+    return Subsystem && Subsystem->HasEffect(TargetIndex, Type);
+}
+
+int32 UStatusEffectComponent::GetActiveEffectCount() const
+{
+    const UStatusEffectSubsystem* Subsystem = GetSubsystem();
+    return Subsystem ? Subsystem->GetEffectCount(TargetIndex) : 0;
+}
+
+float UStatusEffectComponent::GetRemainingTime(FStatusEffectHandle Handle) const
+{
+    const UStatusEffectSubsystem* Subsystem = GetSubsystem();
+    return Subsystem ? Subsystem->GetRemainingTime(Handle) : 0.0f;
+}
+
+float UStatusEffectComponent::AbsorbDamage(float Damage)
+{
+    UStatusEffectSubsystem* Subsystem = GetSubsystem();
+    return Subsystem ? Subsystem->AbsorbDamage(TargetIndex, Damage) : Damage;
+}
+
+void UStatusEffectComponent::SetModifiers(const FStatusEffectModifiers& NewModifiers)
+{
+    if (Modifiers == NewModifiers)
+    {
+        return;
+    }
+
+    Modifiers = NewModifiers;
+    ApplyModifiersToMovement();
+}
+
+void UStatusEffectComponent::OnRep_Modifiers()
+{
+    ApplyModifiersToMovement();
+}
+
+void UStatusEffectComponent::UpdateBaseFromMovement(const UCharacterMovementComponent& Movement)
+{
+    // Werte, die nicht von dieser Komponente stammen, sind die neue Basis ohne Effekte.
+    if (!bMovementApplied || Movement.MaxWalkSpeed != AppliedMaxWalkSpeed)
+    {
+        BaseMaxWalkSpeed = Movement.MaxWalkSpeed;
+    }
+    if (!bMovementApplied || Movement.GravityScale != AppliedGravityScale)
+    {
+        BaseGravityScale = Movement.GravityScale;
+    }
+}
+
+void UStatusEffectComponent::ApplyModifiersToMovement()
+{
+    UCharacterMovementComponent* Movement = GetOwner()->FindComponentByClass<UCharacterMovementComponent>();
+    if (!Movement)
+    {
+        return;
+    }
+
+    UpdateBaseFromMovement(*Movement);
+
+    AppliedMaxWalkSpeed = BaseMaxWalkSpeed * Modifiers.SpeedMultiplier;
+    AppliedGravityScale = BaseGravityScale * Modifiers.GravityScale;
+    bMovementApplied = true;
+
+    Movement->MaxWalkSpeed = AppliedMaxWalkSpeed;
+    Movement->GravityScale = AppliedGravityScale;
+
+    if (Modifiers.bFlying && Movement->MovementMode != MOVE_Flying)
+    {
+        Movement->SetMovementMode(MOVE_Flying);
+    }
+    else if (!Modifiers.bFlying && Movement->MovementMode == MOVE_Flying)
+    {
+        // Fallen lassen, die CharacterMovement erkennt die Landung selbst.
+        Movement->SetMovementMode(MOVE_Falling);
+    }
+}
+
+void UStatusEffectComponent::SetBaseMaxWalkSpeed(float Speed)
+{
+    BaseMaxWalkSpeed = Speed;
+
+    UCharacterMovementComponent* Movement = GetOwner()->FindComponentByClass<UCharacterMovementComponent>();
+    if (!Movement)
+    {
+        return;
+    }
+
+    // Die Schwerkraft behält ihre Basis, auch wenn noch nichts angewendet wurde.
+    if (!bMovementApplied)
+    {
+        BaseGravityScale = Movement->GravityScale;
+        AppliedGravityScale = Movement->GravityScale;
+        bMovementApplied = true;
+    }
+
+    AppliedMaxWalkSpeed = BaseMaxWalkSpeed * Modifiers.SpeedMultiplier;
+    Movement->MaxWalkSpeed = AppliedMaxWalkSpeed;
+}
+
+float UStatusEffectComponent::GetBaseMaxWalkSpeed() const
+{
+    const UCharacterMovementComponent* Movement = GetOwner()->FindComponentByClass<UCharacterMovementComponent>();
+    if (Movement && (!bMovementApplied || Movement->MaxWalkSpeed != AppliedMaxWalkSpeed))
+    {
+        return Movement->MaxWalkSpeed;
+    }
+
+    return BaseMaxWalkSpeed;
+}
+
+void UStatusEffectComponent::Dash(float Force)
+{
+    if (ACharacter* Character = Cast<ACharacter>(GetOwner()))
+    {
+        Character->LaunchCharacter(Character->GetActorForwardVector() * Force, true, false);
+    }
+}
@@ -0,0 +1,155 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "StatusEffectDefinition.h"
+#include "StatusEffectComponent.generated.h"
+
+class UCharacterMovementComponent;
+class UStatusEffectSubsystem;
+
+/**
+ * FStatusEffectHandle
+ *
+ * Verweist auf eine aktive Effekt-Instanz im UStatusEffectSubsystem. Nach dem Ende des Effekts
+ * wird das Handle ungültig, auch wenn der Platz schon wieder vergeben ist.
+ */
+USTRUCT(BlueprintType)
+struct ITSSOMEKINDOFMAGICMP_API FStatusEffectHandle
+{
+    GENERATED_BODY()
+
+    int32 Slot = INDEX_NONE;
+    uint32 Generation = 0;
+
+    bool IsValid() const { return Slot != INDEX_NONE; }
+    bool operator==(const FStatusEffectHandle& Other) const { return Slot == Other.Slot && Generation == Other.Generation; }
+};
+
+/** Summe aller Bewegungs-Effekte eines Ziels, wird repliziert. */
+USTRUCT()
+struct FStatusEffectModifiers
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    float SpeedMultiplier = 1.0f;
+
+    UPROPERTY()
+    float GravityScale = 1.0f;
+
+    UPROPERTY()
+    bool bFlying = false;
+
+    bool operator==(const FStatusEffectModifiers& Other) const
+    {
+        return SpeedMultiplier == Other.SpeedMultiplier && GravityScale == Other.GravityScale && bFlying == Other.bFlying;
+    }
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnStatusEffectChanged, FStatusEffectHandle, Handle, const UStatusEffectDefinition*, Definition);
+
+/**
+ * UStatusEffectComponent
+ *
+ * Ersetzt BPC_EffectManager. Effekte werden als UStatusEffectDefinition angewendet und laufen nur
+ * auf dem Server; gespeichert, getaktet und verrechnet werden sie im UStatusEffectSubsystem. Die
+ * Komponente überträgt das Ergebnis auf die CharacterMovement des Owners (Geschwindigkeit,
+ * Schwerkraft, Fliegen) und repliziert es, damit der besitzende Client dieselben Werte vorhersagt.
+ *
+ * Änderungen an der Bewegung greifen im nächsten Tick des Subsystems, Schaden von Thorns kommt
+ * über UGameplayStatics::ApplyDamage (Event AnyDamage).
+ *
+ * Die Effekte wirken als Faktor auf eine Basis-Geschwindigkeit und -Schwerkraft. Wer MaxWalkSpeed
+ * sonst ändert (Sprint, BTT_SetMovementSpeed), ruft SetBaseMaxWalkSpeed auf, dann gilt der Faktor
+ * sofort. Direkt gesetzte Werte werden beim nächsten Wechsel der Effekte als neue Basis übernommen.
+ */
+UCLASS(ClassGroup = (Effects), meta = (BlueprintSpawnableComponent))
+class ITSSOMEKINDOFMAGICMP_API UStatusEffectComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UStatusEffectComponent();
+
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+    /**
+     * Wendet den Effekt auf den Owner an.
+     * @param EffectInstigator Verursacher, z. B. der Spell oder der Spieler, der ihn gecastet hat.
+     * @return Das Handle der Instanz, ungültig bei sofort wirkenden Effekten (Dash).
+     */
+    UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Effects")
+    FStatusEffectHandle ApplyEffect(const UStatusEffectDefinition* Definition, AActor* EffectInstigator);
+
+    UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Effects")
+    bool RemoveEffect(FStatusEffectHandle Handle);
+
+    /** @return Die Anzahl entfernter Instanzen */
+    UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Effects")
+    int32 RemoveEffectsOfType(EStatusEffectType Type);
+
+    /** Nur auf dem Server aussagekräftig */
+    UFUNCTION(BlueprintPure, Category = "Effects")
+    bool HasEffect(EStatusEffectType Type) const;
+
+    /** Nur auf dem Server aussagekräftig */
+    UFUNCTION(BlueprintPure, Category = "Effects")
+    int32 GetActiveEffectCount() const;
+
+    /** Restlaufzeit in Sekunden, -1 bei unbegrenzten Effekten, 0 bei ungültigem Handle. */
+    UFUNCTION(BlueprintPure, Category = "Effects")
+    float GetRemainingTime(FStatusEffectHandle Handle) const;
+
+    /**
+     * Lässt aktive Shield-Effekte den Schaden abfangen, bevor er angewendet wird.
+     * @return Der Schaden, der durch die Schilde geht.
+     */
+    UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Effects")
+    float AbsorbDamage(float Damage);
+
+    UPROPERTY(BlueprintAssignable, Category = "Effects")
+    FOnStatusEffectChanged OnEffectAdded;
+
+    UPROPERTY(BlueprintAssignable, Category = "Effects")
+    FOnStatusEffectChanged OnEffectRemoved;
+
+    /** Wird vom Subsystem nach dem Verrechnen aufgerufen (nur auf dem Server). */
+    void SetModifiers(const FStatusEffectModifiers& NewModifiers);
+
+    /** Impuls in Blickrichtung für Dash */
+    void Dash(float Force);
+
+    /** Setzt die Geschwindigkeit ohne Effekte, die CharacterMovement bekommt sie mal dem aktuellen Faktor. */
+    UFUNCTION(BlueprintCallable, Category = "Effects")
+    void SetBaseMaxWalkSpeed(float Speed);
+
+    UFUNCTION(BlueprintPure, Category = "Effects")
+    float GetBaseMaxWalkSpeed() const;
+
+private:
+    friend class UStatusEffectSubsystem;
+
+    UFUNCTION()
+    void OnRep_Modifiers();
+
+    void ApplyModifiersToMovement();
+    void UpdateBaseFromMovement(const UCharacterMovementComponent& Movement);
+    UStatusEffectSubsystem* GetSubsystem() const;
+
+    UPROPERTY(ReplicatedUsing = OnRep_Modifiers)
+    FStatusEffectModifiers Modifiers;
+
+    float BaseMaxWalkSpeed = 0.0f;
+    float BaseGravityScale = 1.0f;
+
+    /** Zuletzt auf die CharacterMovement geschrieben, weicht der Wert dort ab, hat ihn jemand anders gesetzt. */
+    float AppliedMaxWalkSpeed = 0.0f;
+    float AppliedGravityScale = 1.0f;
+    bool bMovementApplied = false;
+
+    /** Platz im Subsystem, nur mit Autorität gesetzt */
+    int32 TargetIndex = INDEX_NONE;
+};
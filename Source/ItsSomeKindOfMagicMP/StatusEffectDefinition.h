@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "GameFramework/DamageType.h"
+#include "StatusEffectDefinition.generated.h"
+
+/** Art des Effekts. Instanzen gleicher Art liegen im UStatusEffectSubsystem in einem gemeinsamen Array. */
+UENUM(BlueprintType)
+enum class EStatusEffectType : uint8
+{
+    SlowDown,
+    Thorns,
+    Dash,
+    Freeze,
+    Shield,
+    Fly,
+    GravityReversal,
+
+    Count UMETA(Hidden)
+};
+
+/** Was passiert, wenn dieselbe Definition ein Ziel erneut trifft, solange sie noch aktiv ist. */
+UENUM(BlueprintType)
+enum class EStatusEffectStacking : uint8
+{
+    /** Die laufende Instanz beginnt von vorn (bei Shield wird auch der Schild wieder aufgefüllt). */
+    Refresh,
+
+    /** Eine weitere, unabhängige Instanz */
+    Independent
+};
+
+/**
+ * UStatusEffectDefinition
+ *
+ * Ein Statuseffekt als Daten, ersetzt die BP_Effect_*-Klassen. Im Editor als Data Asset anlegen
+ * und an UStatusEffectComponent::ApplyEffect übergeben. Welche Werte zählen, hängt von Type ab.
+ */
+UCLASS(BlueprintType)
+class ITSSOMEKINDOFMAGICMP_API UStatusEffectDefinition : public UPrimaryDataAsset
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effect")
+    EStatusEffectType Type = EStatusEffectType::SlowDown;
+
+    /** Laufzeit in Sekunden, 0 = bis der Effekt entfernt wird. Dash wirkt immer sofort. */
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effect", meta = (ClampMin = "0.0"))
+    float Duration = 5.0f;
+
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effect")
+    EStatusEffectStacking Stacking = EStatusEffectStacking::Refresh;
+
+    /** SlowDown: Faktor auf die Laufgeschwindigkeit. Mehrere Effekte: der stärkste gilt. */
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effect|SlowDown", meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = "Type == EStatusEffectType::SlowDown", EditConditionHides))
+    float SpeedMultiplier = 0.5f;
+
+    /** Thorns: Schaden pro Intervall */
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effect|Thorns", meta = (EditCondition = "Type == EStatusEffectType::Thorns", EditConditionHides))
+    float DamageAmount = 5.0f;
+
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effect|Thorns", meta = (ClampMin = "0.05", EditCondition = "Type == EStatusEffectType::Thorns", EditConditionHides))
+    float DamageInterval = 1.0f;
+
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effect|Thorns", meta = (EditCondition = "Type == EStatusEffectType::Thorns", EditConditionHides))
+    TSubclassOf<UDamageType> DamageType;
+
+    /** Dash: Impuls in Blickrichtung */
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effect|Dash", meta = (EditCondition = "Type == EStatusEffectType::Dash", EditConditionHides))
+    float DashForce = 2000.0f;
+
+    /** Shield: so viel Schaden wird abgefangen, danach endet der Effekt. */
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effect|Shield", meta = (ClampMin = "0.0", EditCondition = "Type == EStatusEffectType::Shield", EditConditionHides))
+    float ShieldAmount = 50.0f;
+
+    /** GravityReversal: Faktor auf die Schwerkraft, negativ kehrt sie um. */
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effect|GravityReversal", meta = (EditCondition = "Type == EStatusEffectType::GravityReversal", EditConditionHides))
+    float GravityScale = -1.0f;
+};
@@ -0,0 +1,575 @@
+﻿#include "StatusEffectSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_STATS_GROUP(TEXT("StatusEffects"), STATGROUP_StatusEffects, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT(TEXT("Tick"), STAT_StatusEffects_Tick, STATGROUP_StatusEffects);
+DECLARE_CYCLE_STAT(TEXT("Timers"), STAT_StatusEffects_Timers, STATGROUP_StatusEffects);
+DECLARE_CYCLE_STAT(TEXT("Modifiers"), STAT_StatusEffects_Modifiers, STATGROUP_StatusEffects);
+DECLARE_CYCLE_STAT(TEXT("Damage"), STAT_StatusEffects_Damage, STATGROUP_StatusEffects);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Timers fired"), STAT_StatusEffects_TimersFired, STATGROUP_StatusEffects);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active effects"), STAT_StatusEffects_Active, STATGROUP_StatusEffects);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pending timers"), STAT_StatusEffects_PendingTimers, STATGROUP_StatusEffects);
+
+namespace StatusEffects
+{
+    /** Effekt-Arten, die in die Bewegungs-Modifikatoren eingehen */
+    static const EStatusEffectType MovementTypes[] =
+    {
+        EStatusEffectType::SlowDown,
+        EStatusEffectType::Freeze,
+        EStatusEffectType::Fly,
+        EStatusEffectType::GravityReversal
+    };
+
+    static bool AffectsMovement(EStatusEffectType Type)
+    {
+        for (EStatusEffectType MovementType : MovementTypes)
+        {
+            if (MovementType == Type)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+bool UStatusEffectSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UStatusEffectSubsystem::Deinitialize()
+{
+    for (FEffectArrays& Arrays : Effects)
+    {
+        Arrays = FEffectArrays();
+    }
+    EffectSlots.Empty();
+    FreeEffectSlots.Empty();
+
+    TargetComponents.Empty();
+    TargetModifiers.Empty();
+    TargetEffectCounts.Empty();
+    TargetDirty.Empty();
+    FreeTargets.Empty();
+    DirtyTargets.Empty();
+
+    TimerWheel.Reset();
+    PendingDamage.Empty();
+    DamageBatch.Empty();
+    ReferencedDefinitions.Empty();
+
+    Super::Deinitialize();
+}
+
+TStatId UStatusEffectSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UStatusEffectSubsystem, STATGROUP_Tickables);
+}
+
+int32 UStatusEffectSubsystem::RegisterTarget(UStatusEffectComponent* Component)
+{
+    int32 TargetIndex;
+    if (FreeTargets.Num() > 0)
+    {
+        TargetIndex = FreeTargets.Pop(EAllowShrinking::No);
+        TargetComponents[TargetIndex] = Component;
+        TargetModifiers[TargetIndex] = FStatusEffectModifiers();
+        TargetEffectCounts[TargetIndex] = 0;
+    }
+    else
+    {
+        TargetIndex = TargetComponents.Add(Component);
+        TargetModifiers.AddDefaulted();
+        TargetEffectCounts.Add(0);
+        TargetDirty.Add(false);
+    }
+
+    return TargetIndex;
+}
+
+void UStatusEffectSubsystem::UnregisterTarget(int32 TargetIndex)
+{
+    if (!IsValidTarget(TargetIndex))
+    {
+        return;
+    }
+
+    for (int32 TypeIndex = 0; TypeIndex < static_cast<int32>(EStatusEffectType::Count); ++TypeIndex)
+    {
+        const FEffectArrays& Arrays = Effects[TypeIndex];
+        for (int32 i = Arrays.Num() - 1; i >= 0; --i)
+        {
+            if (Arrays.Targets[i] == TargetIndex)
+            {
+                RemoveInstance(static_cast<EStatusEffectType>(TypeIndex), i, false);
+            }
+        }
+    }
+
+    TargetComponents[TargetIndex] = nullptr;
+    FreeTargets.Add(TargetIndex);
+}
+
+bool UStatusEffectSubsystem::IsValidTarget(int32 TargetIndex) const
+{
+    return TargetComponents.IsValidIndex(TargetIndex) && TargetComponents[TargetIndex].IsValid();
+}
+
+uint64 UStatusEffectSubsystem::MakeTimerPayload(FStatusEffectHandle Handle, ETimerKind Kind)
+{
+    return (uint64(Handle.Generation) << 32) | (uint64(Handle.Slot) << 1) | uint64(Kind == ETimerKind::Period ? 1 : 0);
+}
+
+FStatusEffectHandle UStatusEffectSubsystem::MakeHandle(int32 Slot) const
+{
+    FStatusEffectHandle Handle;
+    Handle.Slot = Slot;
+    Handle.Generation = EffectSlots[Slot].Generation;
+    return Handle;
+}
+
+bool UStatusEffectSubsystem::ResolveHandle(FStatusEffectHandle Handle, EStatusEffectType& OutType, int32& OutIndex) const
+{
+    if (!EffectSlots.IsValidIndex(Handle.Slot))
+    {
+        return false;
+    }
+
+    const FEffectSlot& Slot = EffectSlots[Handle.Slot];
+    if (Slot.Generation != Handle.Generation || Slot.Index == INDEX_NONE)
+    {
+        return false;
+    }
+
+    OutType = Slot.Type;
+    OutIndex = Slot.Index;
+    return true;
+}
+
+void UStatusEffectSubsystem::MarkDirty(int32 TargetIndex)
+{
+    if (!TargetDirty[TargetIndex])
+    {
+        TargetDirty[TargetIndex] = true;
+        DirtyTargets.Add(TargetIndex);
+    }
+}
+
+int32 UStatusEffectSubsystem::FindRefreshableInstance(int32 TargetIndex, const UStatusEffectDefinition* Definition) const
+{
+    const FEffectArrays& Arrays = Effects[static_cast<int32>(Definition->Type)];
+    for (int32 i = 0; i < Arrays.Num(); ++i)
+    {
+        if (Arrays.Targets[i] == TargetIndex && Arrays.Definitions[i] == Definition)
+        {
+            return i;
+        }
+    }
+    return INDEX_NONE;
+}
+
+FStatusEffectHandle UStatusEffectSubsystem::ApplyEffect(int32 TargetIndex, const UStatusEffectDefinition* Definition, AActor* EffectInstigator)
+{
+    if (!Definition || !IsValidTarget(TargetIndex))
+    {
+        return FStatusEffectHandle();
+    }
+
+    UStatusEffectComponent* Component = TargetComponents[TargetIndex].Get();
+
+    // Dash wirkt sofort und braucht keinen Platz in den Arrays.
+    if (Definition->Type == EStatusEffectType::Dash)
+    {
+        Component->Dash(Definition->DashForce);
+        Component->OnEffectAdded.Broadcast(FStatusEffectHandle(), Definition);
+        Component->OnEffectRemoved.Broadcast(FStatusEffectHandle(), Definition);
+        return FStatusEffectHandle();
+    }
+
+    const int32 TypeIndex = static_cast<int32>(Definition->Type);
+    FEffectArrays& Arrays = Effects[TypeIndex];
+
+    float Value = 0.0f;
+    switch (Definition->Type)
+    {
+    case EStatusEffectType::SlowDown:        Value = Definition->SpeedMultiplier; break;
+    case EStatusEffectType::Shield:          Value = Definition->ShieldAmount; break;
+    case EStatusEffectType::GravityReversal: Value = Definition->GravityScale; break;
+    default: break;
+    }
+    const double EndTime = Definition->Duration > 0.0f ? Now + Definition->Duration : 0.0;
+
+    if (Definition->Stacking == EStatusEffectStacking::Refresh)
+    {
+        const int32 Existing = FindRefreshableInstance(TargetIndex, Definition);
+        if (Existing != INDEX_NONE)
+        {
+            // Der alte Ablauf-Timer sieht beim Auslösen die neue Endzeit und plant sich neu ein.
+            Arrays.Values[Existing] = Value;
+            Arrays.EndTimes[Existing] = EndTime;
+            Arrays.Instigators[Existing] = EffectInstigator;
+            return MakeHandle(Arrays.Slots[Existing]);
+        }
+    }
+
+    int32 Slot;
+    if (FreeEffectSlots.Num() > 0)
+    {
+        Slot = FreeEffectSlots.Pop(EAllowShrinking::No);
+    }
+    else
+    {
+        Slot = EffectSlots.AddDefaulted();
+    }
+
+    EffectSlots[Slot].Type = Definition->Type;
+    EffectSlots[Slot].Index = Arrays.Num();
+
+    Arrays.Slots.Add(Slot);
+    Arrays.Targets.Add(TargetIndex);
+    Arrays.Definitions.Add(Definition);
+    Arrays.Instigators.Add(EffectInstigator);
+    Arrays.Values.Add(Value);
+    Arrays.EndTimes.Add(EndTime);
+
+    ++ReferencedDefinitions.FindOrAdd(Definition);
+    ++TargetEffectCounts[TargetIndex];
+
+    if (StatusEffects::AffectsMovement(Definition->Type))
+    {
+        MarkDirty(TargetIndex);
+    }
+
+    const FStatusEffectHandle Handle = MakeHandle(Slot);
+    if (EndTime > 0.0)
+    {
+        TimerWheel.Schedule(MakeTimerPayload(Handle, ETimerKind::Expire), Definition->Duration);
+    }
+    if (Definition->Type == EStatusEffectType::Thorns)
+    {
+        TimerWheel.Schedule(MakeTimerPayload(Handle, ETimerKind::Period), Definition->DamageInterval);
+    }
+
+    Component->OnEffectAdded.Broadcast(Handle, Definition);
+    return Handle;
+}
+
+void UStatusEffectSubsystem::RemoveInstance(EStatusEffectType Type, int32 Index, bool bNotify)
+{
+    FEffectArrays& Arrays = Effects[static_cast<int32>(Type)];
+
+    const int32 Slot = Arrays.Slots[Index];
+    const int32 TargetIndex = Arrays.Targets[Index];
+    const UStatusEffectDefinition* Definition = Arrays.Definitions[Index];
+    const FStatusEffectHandle Handle = MakeHandle(Slot);
+
+    // Die letzte Instanz rückt an die frei gewordene Stelle.
+    const int32 LastIndex = Arrays.Num() - 1;
+    if (Index != LastIndex)
+    {
+        EffectSlots[Arrays.Slots[LastIndex]].Index = Index;
+    }
+    Arrays.Slots.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    Arrays.Targets.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    Arrays.Definitions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    Arrays.Instigators.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    Arrays.Values.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+    Arrays.EndTimes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+    // Neue Generation: ausstehende Timer und alte Handles laufen damit ins Leere.
+    EffectSlots[Slot].Index = INDEX_NONE;
+    ++EffectSlots[Slot].Generation;
+    FreeEffectSlots.Add(Slot);
+
+    // Bis zum nächsten GC bleibt die Definition gültig, OnEffectRemoved kann sie noch nutzen.
+    int32& DefinitionCount = ReferencedDefinitions.FindChecked(Definition);
+    if (--DefinitionCount == 0)
+    {
+        ReferencedDefinitions.Remove(Definition);
+    }
+
+    --TargetEffectCounts[TargetIndex];
+    if (StatusEffects::AffectsMovement(Type))
+    {
+        MarkDirty(TargetIndex);
+    }
+
+    if (bNotify)
+    {
+        if (UStatusEffectComponent* Component = TargetComponents[TargetIndex].Get())
+        {
+            Component->OnEffectRemoved.Broadcast(Handle, Definition);
+        }
+    }
+}
+
+bool UStatusEffectSubsystem::RemoveEffect(FStatusEffectHandle Handle)
+{
+    EStatusEffectType Type;
+    int32 Index;
+    if (!ResolveHandle(Handle, Type, Index))
+    {
+        return false;
+    }
+
+    RemoveInstance(Type, Index, true);
+    return true;
+}
+
+int32 UStatusEffectSubsystem::RemoveEffectsOfType(int32 TargetIndex, EStatusEffectType Type)
+{
+    if (!IsValidTarget(TargetIndex) || Type == EStatusEffectType::Count)
+    {
+        return 0;
+    }
+
+    int32 NumRemoved = 0;
+    for (int32 i = Effects[static_cast<int32>(Type)].Num() - 1; i >= 0; --i)
+    {
+        // Handler von OnEffectRemoved können weitere Instanzen entfernen.
+        const FEffectArrays& Arrays = Effects[static_cast<int32>(Type)];
+        if (Arrays.Num() > i && Arrays.Targets[i] == TargetIndex)
+        {
+            RemoveInstance(Type, i, true);
+            ++NumRemoved;
+        }
+    }
+    return NumRemoved;
+}
+
+bool UStatusEffectSubsystem::HasEffect(int32 TargetIndex, EStatusEffectType Type) const
+{
+    if (!IsValidTarget(TargetIndex) || Type == EStatusEffectType::Count)
+    {
+        return false;
+    }
+
+    return Effects[static_cast<int32>(Type)].Targets.Contains(TargetIndex);
+}
+
+int32 UStatusEffectSubsystem::GetEffectCount(int32 TargetIndex) const
+{
+    return IsValidTarget(TargetIndex) ? TargetEffectCounts[TargetIndex] : 0;
+}
+
+float UStatusEffectSubsystem::GetRemainingTime(FStatusEffectHandle Handle) const
+{
+    EStatusEffectType Type;
+    int32 Index;
+    if (!ResolveHandle(Handle, Type, Index))
+    {
+        return 0.0f;
+    }
+
+    const double EndTime = Effects[static_cast<int32>(Type)].EndTimes[Index];
+    return EndTime > 0.0 ? static_cast<float>(FMath::Max(EndTime - Now, 0.0)) : -1.0f;
+}
+
+float UStatusEffectSubsystem::AbsorbDamage(int32 TargetIndex, float Damage)
+{
+    if (!IsValidTarget(TargetIndex))
+    {
+        return Damage;
+    }
+
+    for (int32 i = Effects[static_cast<int32>(EStatusEffectType::Shield)].Num() - 1; i >= 0 && Damage > 0.0f; --i)
+    {
+        FEffectArrays& Shields = Effects[static_cast<int32>(EStatusEffectType::Shield)];
+        if (Shields.Num() <= i || Shields.Targets[i] != TargetIndex)
+        {
+            continue;
+        }
+
+        const float Absorbed = FMath::Min(Shields.Values[i], Damage);
+        Shields.Values[i] -= Absorbed;
+        Damage -= Absorbed;
+
+        if (Shields.Values[i] <= 0.0f)
+        {
+            RemoveInstance(EStatusEffectType::Shield, i, true);
+        }
+    }
+
+    return Damage;
+}
+
+int32 UStatusEffectSubsystem::GetNumActiveEffects() const
+{
+    int32 NumActive = 0;
+    for (const FEffectArrays& Arrays : Effects)
+    {
+        NumActive += Arrays.Num();
+    }
+    return NumActive;
+}
+
+void UStatusEffectSubsystem::Tick(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_StatusEffects_Tick);
+
+    Now += DeltaTime;
+
+    {
+        SCOPE_CYCLE_COUNTER(STAT_StatusEffects_Timers);
+
+        FiredTimers.Reset();
+        TimerWheel.Advance(DeltaTime, FiredTimers);
+        for (const uint64 Payload : FiredTimers)
+        {
+            ProcessTimer(Payload);
+        }
+        INC_DWORD_STAT_BY(STAT_StatusEffects_TimersFired, FiredTimers.Num());
+    }
+
+    UpdateModifiers();
+    ApplyPendingDamage();
+
+    SET_DWORD_STAT(STAT_StatusEffects_Active, GetNumActiveEffects());
+    SET_DWORD_STAT(STAT_StatusEffects_PendingTimers, TimerWheel.Num());
+}
+
+void UStatusEffectSubsystem::ProcessTimer(uint64 Payload)
+{
+    FStatusEffectHandle Handle;
+    Handle.Generation = static_cast<uint32>(Payload >> 32);
+    Handle.Slot = static_cast<int32>((Payload & 0xFFFFFFFF) >> 1);
+    const ETimerKind Kind = (Payload & 1) ? ETimerKind::Period : ETimerKind::Expire;
+
+    EStatusEffectType Type;
+    int32 Index;
+    if (!ResolveHandle(Handle, Type, Index))
+    {
+        return;
+    }
+
+    FEffectArrays& Arrays = Effects[static_cast<int32>(Type)];
+    if (Kind == ETimerKind::Expire)
+    {
+        // Wurde der Effekt inzwischen erneuert, läuft er weiter.
+        const double Remaining = Arrays.EndTimes[Index] - Now;
+        if (Arrays.EndTimes[Index] <= 0.0)
+        {
+            return;
+        }
+        if (Remaining > TimerWheel.GetQuantumSeconds())
+        {
+            TimerWheel.Schedule(Payload, Remaining);
+            return;
+        }
+
+        RemoveInstance(Type, Index, true);
+        return;
+    }
+
+    const UStatusEffectDefinition* Definition = Arrays.Definitions[Index];
+    if (const UStatusEffectComponent* Component = TargetComponents[Arrays.Targets[Index]].Get())
+    {
+        FPendingDamage& Damage = PendingDamage.AddDefaulted_GetRef();
+        Damage.Target = Component->GetOwner();
+        Damage.Instigator = Arrays.Instigators[Index];
+        Damage.DamageType = Definition->DamageType;
+        Damage.Amount = Definition->DamageAmount;
+    }
+
+    TimerWheel.Schedule(Payload, Definition->DamageInterval);
+}
+
+void UStatusEffectSubsystem::UpdateModifiers()
+{
+    if (DirtyTargets.Num() == 0)
+    {
+        return;
+    }
+
+    SCOPE_CYCLE_COUNTER(STAT_StatusEffects_Modifiers);
+
+    for (const int32 TargetIndex : DirtyTargets)
+    {
+        TargetModifiers[TargetIndex] = FStatusEffectModifiers();
+    }
+
+    // Ein Durchlauf pro Art über die zusammenhängenden Arrays, nur geänderte Ziele werden verrechnet.
+    for (const EStatusEffectType Type : StatusEffects::MovementTypes)
+    {
+        const FEffectArrays& Arrays = Effects[static_cast<int32>(Type)];
+        for (int32 i = 0; i < Arrays.Num(); ++i)
+        {
+            const int32 TargetIndex = Arrays.Targets[i];
+            if (!TargetDirty[TargetIndex])
+            {
+                continue;
+            }
+
+            FStatusEffectModifiers& Modifiers = TargetModifiers[TargetIndex];
+            switch (Type)
+            {
+            case EStatusEffectType::SlowDown:
+                Modifiers.SpeedMultiplier = FMath::Min(Modifiers.SpeedMultiplier, Arrays.Values[i]);
+                break;
+            case EStatusEffectType::Freeze:
+                Modifiers.SpeedMultiplier = 0.0f;
+                break;
+            case EStatusEffectType::Fly:
+                Modifiers.bFlying = true;
+                break;
+            case EStatusEffectType::GravityReversal:
+                Modifiers.GravityScale = FMath::Min(Modifiers.GravityScale, Arrays.Values[i]);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    for (const int32 TargetIndex : DirtyTargets)
+    {
+        TargetDirty[TargetIndex] = false;
+        if (UStatusEffectComponent* Component = TargetComponents[TargetIndex].Get())
+        {
+            Component->SetModifiers(TargetModifiers[TargetIndex]);
+        }
+    }
+    DirtyTargets.Reset();
+}
+
+void UStatusEffectSubsystem::ApplyPendingDamage()
+{
+    if (PendingDamage.Num() == 0)
+    {
+        return;
+    }
+
+    SCOPE_CYCLE_COUNTER(STAT_StatusEffects_Damage);
+
+    // Schaden kann Effekte entfernen oder Actors zerstören, daher erst nach allen Durchläufen.
+    Swap(DamageBatch, PendingDamage);
+
+    for (const FPendingDamage& Damage : DamageBatch)
+    {
+        AActor* Target = Damage.Target.Get();
+        if (!Target)
+        {
+            continue;
+        }
+
+        AActor* Causer = Damage.Instigator.Get();
+        AController* InstigatorController = nullptr;
+        if (const APawn* InstigatorPawn = Cast<APawn>(Causer))
+        {
+            InstigatorController = InstigatorPawn->GetController();
+        }
+        else if (Causer)
+        {
+            InstigatorController = Causer->GetInstigatorController();
+        }
+
+        UGameplayStatics::ApplyDamage(Target, Damage.Amount, InstigatorController, Causer, Damage.DamageType);
+    }
+    DamageBatch.Reset();
+}
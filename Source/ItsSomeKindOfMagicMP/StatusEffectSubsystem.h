@@ -0,0 +1,133 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StatusEffectComponent.h"
+#include "StatusEffectDefinition.h"
+#include "StatusEffectTimerWheel.h"
+#include "StatusEffectSubsystem.generated.h"
+
+/**
+ * UStatusEffectSubsystem
+ *
+ * Hält alle aktiven Statuseffekte der Welt. Statt eines Objekts mit eigenem Tick und Timer pro
+ * Effekt liegt jede Effekt-Art in zusammenhängenden Arrays (ein Array pro Feld), Laufzeiten und
+ * periodischer Schaden laufen über ein gemeinsames FStatusEffectTimerWheel.
+ *
+ * Pro Tick: fällige Timer auslösen, dann in einem Durchlauf über die Bewegungs-Effekte die
+ * Modifikatoren aller geänderten Ziele neu berechnen, zuletzt den gesammelten Schaden anwenden.
+ * Ohne Änderungen kostet ein Tick nur das Weiterdrehen des Rads, unabhängig von der Anzahl Effekte.
+ *
+ * Kosten erscheinen unter "stat StatusEffects". Zugriff über UStatusEffectComponent.
+ */
+UCLASS()
+class ITSSOMEKINDOFMAGICMP_API UStatusEffectSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    int32 RegisterTarget(UStatusEffectComponent* Component);
+
+    /** Entfernt alle Effekte des Ziels ohne Benachrichtigung. */
+    void UnregisterTarget(int32 TargetIndex);
+
+    FStatusEffectHandle ApplyEffect(int32 TargetIndex, const UStatusEffectDefinition* Definition, AActor* EffectInstigator);
+    bool RemoveEffect(FStatusEffectHandle Handle);
+    int32 RemoveEffectsOfType(int32 TargetIndex, EStatusEffectType Type);
+
+    bool HasEffect(int32 TargetIndex, EStatusEffectType Type) const;
+    int32 GetEffectCount(int32 TargetIndex) const;
+    float GetRemainingTime(FStatusEffectHandle Handle) const;
+    float AbsorbDamage(int32 TargetIndex, float Damage);
+
+    /** Aktive Instanzen über alle Ziele */
+    int32 GetNumActiveEffects() const;
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    /** Alle Instanzen einer Effekt-Art, gleicher Index in jedem Array = eine Instanz. */
+    struct FEffectArrays
+    {
+        TArray<int32> Slots;
+        TArray<int32> Targets;
+        TArray<const UStatusEffectDefinition*> Definitions;
+        TArray<TWeakObjectPtr<AActor>> Instigators;
+
+        /** SlowDown: Geschwindigkeitsfaktor, Shield: verbleibender Schild, GravityReversal: Schwerkraftfaktor */
+        TArray<float> Values;
+
+        /** Weltzeit des Endes, 0 = unbegrenzt */
+        TArray<double> EndTimes;
+
+        int32 Num() const { return Slots.Num(); }
+    };
+
+    /** Stabiler Verweis von einem Handle auf den aktuellen Index im Array seiner Art. */
+    struct FEffectSlot
+    {
+        EStatusEffectType Type = EStatusEffectType::SlowDown;
+        int32 Index = INDEX_NONE;
+        uint32 Generation = 0;
+    };
+
+    struct FPendingDamage
+    {
+        TWeakObjectPtr<AActor> Target;
+        TWeakObjectPtr<AActor> Instigator;
+        TSubclassOf<UDamageType> DamageType;
+        float Amount = 0.0f;
+    };
+
+    enum class ETimerKind : uint8
+    {
+        Expire,
+        Period
+    };
+
+    static uint64 MakeTimerPayload(FStatusEffectHandle Handle, ETimerKind Kind);
+    FStatusEffectHandle MakeHandle(int32 Slot) const;
+    bool ResolveHandle(FStatusEffectHandle Handle, EStatusEffectType& OutType, int32& OutIndex) const;
+    bool IsValidTarget(int32 TargetIndex) const;
+
+    int32 FindRefreshableInstance(int32 TargetIndex, const UStatusEffectDefinition* Definition) const;
+    void RemoveInstance(EStatusEffectType Type, int32 Index, bool bNotify);
+    void MarkDirty(int32 TargetIndex);
+
+    void ProcessTimer(uint64 Payload);
+    void UpdateModifiers();
+    void ApplyPendingDamage();
+
+    FEffectArrays Effects[static_cast<int32>(EStatusEffectType::Count)];
+
+    TArray<FEffectSlot> EffectSlots;
+    TArray<int32> FreeEffectSlots;
+
+    // Ziele, ebenfalls ein Array pro Feld
+    TArray<TWeakObjectPtr<UStatusEffectComponent>> TargetComponents;
+    TArray<FStatusEffectModifiers> TargetModifiers;
+    TArray<int32> TargetEffectCounts;
+    TArray<bool> TargetDirty;
+    TArray<int32> FreeTargets;
+    TArray<int32> DirtyTargets;
+
+    FStatusEffectTimerWheel TimerWheel = FStatusEffectTimerWheel(1.0 / 60.0);
+    TArray<uint64> FiredTimers;
+    TArray<FPendingDamage> PendingDamage;
+    TArray<FPendingDamage> DamageBatch;
+
+    /** Summe der Tick-Zeiten, Zeitbasis für EndTimes */
+    double Now = 0.0;
+
+    /**
+     * Hält die Definitionen laufender Effekte am Leben, die Arrays speichern nur Zeiger.
+     * Der Wert zählt die Instanzen, mit der letzten wird auch die Definition freigegeben.
+     */
+    UPROPERTY()
+    TMap<TObjectPtr<const UStatusEffectDefinition>, int32> ReferencedDefinitions;
+};
@@ -0,0 +1,98 @@
+﻿#include "StatusEffectTimerWheel.h"
+
+FStatusEffectTimerWheel::FStatusEffectTimerWheel(double InQuantumSeconds)
+    : QuantumSeconds(FMath::Max(InQuantumSeconds, UE_DOUBLE_KINDA_SMALL_NUMBER))
+{
+}
+
+double FStatusEffectTimerWheel::GetMaxDelaySeconds() const
+{
+    return ((uint64(1) << (SlotBits * NumLevels)) - 1) * QuantumSeconds;
+}
+
+void FStatusEffectTimerWheel::Schedule(uint64 Payload, double DelaySeconds)
+{
+    const uint64 MaxSteps = (uint64(1) << (SlotBits * NumLevels)) - 1;
+    const double Steps = FMath::CeilToDouble(DelaySeconds / QuantumSeconds);
+
+    FTimer Timer;
+    Timer.DueStep = CurrentStep + FMath::Clamp<uint64>(static_cast<uint64>(FMath::Max(Steps, 1.0)), 1, MaxSteps);
+    Timer.Payload = Payload;
+
+    Insert(Timer);
+    ++NumTimers;
+}
+
+void FStatusEffectTimerWheel::Insert(const FTimer& Timer)
+{
+    const uint64 Delta = Timer.DueStep - CurrentStep;
+
+    int32 Level = 0;
+    while (Level < NumLevels - 1 && Delta >= (uint64(1) << (SlotBits * (Level + 1))))
+    {
+        ++Level;
+    }
+
+    const int32 Slot = static_cast<int32>((Timer.DueStep >> (SlotBits * Level)) & (SlotsPerLevel - 1));
+    Slots[Level * SlotsPerLevel + Slot].Add(Timer);
+}
+
+void FStatusEffectTimerWheel::Cascade(int32 Level)
+{
+    const int32 Slot = static_cast<int32>((CurrentStep >> (SlotBits * Level)) & (SlotsPerLevel - 1));
+
+    // Tauschen statt kopieren, so behalten beide Arrays ihren Speicher.
+    Swap(CascadeScratch, Slots[Level * SlotsPerLevel + Slot]);
+    for (const FTimer& Timer : CascadeScratch)
+    {
+        Insert(Timer);
+    }
+    CascadeScratch.Reset();
+}
+
+void FStatusEffectTimerWheel::Advance(double DeltaSeconds, TArray<uint64>& OutFired)
+{
+    AccumulatedSeconds += FMath::Max(DeltaSeconds, 0.0);
+
+    const uint64 Steps = static_cast<uint64>(AccumulatedSeconds / QuantumSeconds);
+    AccumulatedSeconds -= Steps * QuantumSeconds;
+
+    if (NumTimers == 0)
+    {
+        CurrentStep += Steps;
+        return;
+    }
+
+    for (uint64 Step = 0; Step < Steps; ++Step)
+    {
+        ++CurrentStep;
+
+        // Beginnt ein neues Fach auf höheren Ebenen, zuerst von oben nach unten einsortieren.
+        int32 TopLevel = 0;
+        while (TopLevel < NumLevels - 1 && (CurrentStep & ((uint64(1) << (SlotBits * (TopLevel + 1))) - 1)) == 0)
+        {
+            ++TopLevel;
+        }
+        for (int32 Level = TopLevel; Level > 0; --Level)
+        {
+            Cascade(Level);
+        }
+
+        TArray<FTimer>& Due = Slots[CurrentStep & (SlotsPerLevel - 1)];
+        for (const FTimer& Timer : Due)
+        {
+            OutFired.Add(Timer.Payload);
+        }
+        NumTimers -= Due.Num();
+        Due.Reset();
+    }
+}
+
+void FStatusEffectTimerWheel::Reset()
+{
+    for (TArray<FTimer>& Slot : Slots)
+    {
+        Slot.Reset();
+    }
+    NumTimers = 0;
+}
@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FStatusEffectTimerWheel
+ *
+ * Hierarchisches Timer-Rad für Laufzeiten und periodische Ticks aller Statuseffekte einer Welt.
+ * Die Zeit läuft in festen Schritten (Quantum), jede Ebene hat 64 Fächer, jede höhere Ebene
+ * deckt das 64-fache der darunter ab. Einplanen und Auslösen kosten konstante Zeit, egal wie
+ * viele Timer laufen; beim Übergang in ein neues Fach einer höheren Ebene werden dessen Einträge
+ * eine Ebene tiefer einsortiert.
+ *
+ * Timer lassen sich nicht abbrechen: die Payload muss beim Auslösen selbst erkennen, ob sie noch gilt.
+ */
+class ITSSOMEKINDOFMAGICMP_API FStatusEffectTimerWheel
+{
+public:
+    static constexpr int32 SlotBits = 6;
+    static constexpr int32 SlotsPerLevel = 1 << SlotBits;
+    static constexpr int32 NumLevels = 4;
+
+    explicit FStatusEffectTimerWheel(double InQuantumSeconds);
+
+    /** Löst Payload nach DelaySeconds aus, frühestens beim nächsten Schritt. Zu lange Zeiten werden gekürzt. */
+    void Schedule(uint64 Payload, double DelaySeconds);
+
+    /** Lässt die Zeit laufen und hängt die Payloads aller fälligen Timer in Fälligkeitsreihenfolge an OutFired an. */
+    void Advance(double DeltaSeconds, TArray<uint64>& OutFired);
+
+    /** Verwirft alle Timer, die Zeit läuft weiter. */
+    void Reset();
+
+    int32 Num() const { return NumTimers; }
+    double GetQuantumSeconds() const { return QuantumSeconds; }
+
+    /** Längste Verzögerung, die ohne Kürzen eingeplant werden kann */
+    double GetMaxDelaySeconds() const;
+
+private:
+    struct FTimer
+    {
+        uint64 DueStep = 0;
+        uint64 Payload = 0;
+    };
+
+    void Insert(const FTimer& Timer);
+    void Cascade(int32 Level);
+
+    double QuantumSeconds;
+    double AccumulatedSeconds = 0.0;
+    uint64 CurrentStep = 0;
+    int32 NumTimers = 0;
+
+    /** Fächer aller Ebenen hintereinander, Level * SlotsPerLevel + Slot. Die Arrays behalten ihren Speicher. */
+    TArray<FTimer> Slots[NumLevels * SlotsPerLevel];
+
+    /** Zwischenspeicher beim Umsortieren */
+    TArray<FTimer> CascadeScratch;
+};
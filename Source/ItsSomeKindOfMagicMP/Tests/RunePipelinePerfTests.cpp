@@ -0,0 +1,445 @@
+﻿// Performance-Tests für die Runen-Pipeline: Canvas -> Tensor -> Inferenz -> Auswertung -> Statistik.
+// Die Tests laufen headless (z. B. als Commandlet mit -nullrhi unter Linux) und werden über
+// VSTestAdapter mit -filters=perf gefunden. Jeder Test meldet seine Messwerte als Telemetrie
+// und schlägt fehl, wenn das p99-Budget überschritten wird.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "DebugRuneCount.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "ONNXInferenceActor.h"
+#include "RuneFunctionLibrary.h"
+#include "RunePerfStatistics.h"
+#include "RuneSoakBenchmarkSubsystem.h"
+#include "RuneStrokeCodec.h"
+
+namespace RunePipelinePerf
+{
+    // Budgets als p99 in Millisekunden. Über CVars anpassbar, z. B. für langsamere CI-Maschinen.
+    static TAutoConsoleVariable<int32> CVarIterations(
+        TEXT("rune.PerfTest.Iterations"), 500,
+        TEXT("Anzahl der Messungen pro Performance-Test der Runen-Pipeline."));
+
+    static TAutoConsoleVariable<float> CVarGrayscaleBudgetMs(
+        TEXT("rune.PerfTest.GrayscaleBudgetMs"), 0.5f,
+        TEXT("p99-Budget in ms für die Umwandlung der Canvas-Pixel in den Eingabetensor."));
+
+    static TAutoConsoleVariable<float> CVarInferenceBudgetMs(
+        TEXT("rune.PerfTest.InferenceBudgetMs"), 10.0f,
+        TEXT("p99-Budget in ms für eine synchrone Inferenz (RunInferenceBP)."));
+
+    static TAutoConsoleVariable<float> CVarProcessOutputBudgetMs(
+        TEXT("rune.PerfTest.ProcessOutputBudgetMs"), 1.0f,
+        TEXT("p99-Budget in ms für die Auswertung des Modell-Outputs (ProcessOutput)."));
+
+    static TAutoConsoleVariable<float> CVarDebugCountBudgetMs(
+        TEXT("rune.PerfTest.DebugCountBudgetMs"), 0.05f,
+        TEXT("p99-Budget in ms für 100 Aktualisierungen eines UDebugRuneCount."));
+
+    static TAutoConsoleVariable<float> CVarStatsExportBudgetMs(
+        TEXT("rune.PerfTest.StatsExportBudgetMs"), 25.0f,
+        TEXT("p99-Budget in ms für den Export der Statistiken (SaveDebugStatsToText)."));
+
+    static TAutoConsoleVariable<float> CVarStrokeEncodeBudgetMs(
+        TEXT("rune.PerfTest.StrokeEncodeBudgetMs"), 0.05f,
+        TEXT("p99-Budget in ms für das Kodieren eines Strichs (RuneStrokeCodec::Encode)."));
+
+    static TAutoConsoleVariable<float> CVarStrokeDecodeBudgetMs(
+        TEXT("rune.PerfTest.StrokeDecodeBudgetMs"), 0.05f,
+        TEXT("p99-Budget in ms für das Dekodieren eines Strichs (RuneStrokeCodec::Decode)."));
+
+    static TAutoConsoleVariable<FString> CVarStrokeCorpus(
+        TEXT("rune.PerfTest.StrokeCorpus"), TEXT(""),
+        TEXT("Replay-Korpus für den Stroke-Codec-Test (Format siehe URuneSoakBenchmarkSubsystem). Leer = eingebaute Formen."));
+
+    static constexpr int32 CanvasSize = 64;
+    static constexpr int32 WarmupIterations = 10;
+    static constexpr int32 DebugCountUpdatesPerSample = 100;
+
+    // Der Datei-Export ist I/O-lastig, daher weniger Messungen.
+    static constexpr int32 MaxStatsExportIterations = 50;
+
+    static constexpr auto InferenceActorClassPath = TEXT("/Game/Mechanics/RuneAI/Blueprints/BP_ONNXInferenceActor.BP_ONNXInferenceActor_C");
+    static constexpr auto StatsFileName = TEXT("PerfTest_Stats.txt");
+
+    /** Messwerte in Millisekunden. */
+    struct FTimingSamples
+    {
+        TArray<double> Milliseconds;
+
+        void AddSince(double StartSeconds)
+        {
+            Milliseconds.Add((FPlatformTime::Seconds() - StartSeconds) * 1000.0);
+        }
+
+        /** Perzentil nach dem Nearest-Rank-Verfahren, P zwischen 0 und 100. */
+        double Percentile(double P) const
+        {
+            TArray<double> Sorted = Milliseconds;
+            Sorted.Sort();
+            return RunePerf::Percentile(Sorted, P);
+        }
+
+        double Mean() const
+        {
+            double Sum = 0.0;
+            for (double Value : Milliseconds)
+            {
+                Sum += Value;
+            }
+            return Milliseconds.Num() > 0 ? Sum / Milliseconds.Num() : 0.0;
+        }
+    };
+
+    /** Meldet Mittelwert, p50 und p99 an das Automation-Framework und prüft das Budget. */
+    static bool ReportAndCheckBudget(FAutomationTestBase& Test, const FString& Name, const FTimingSamples& Samples, float BudgetMs)
+    {
+        const double Mean = Samples.Mean();
+        const double P50 = Samples.Percentile(50.0);
+        const double P99 = Samples.Percentile(99.0);
+
+        Test.AddTelemetryData(Name + TEXT(".MeanMs"), Mean);
+        Test.AddTelemetryData(Name + TEXT(".P50Ms"), P50);
+        Test.AddTelemetryData(Name + TEXT(".P99Ms"), P99);
+        Test.AddInfo(FString::Printf(TEXT("%s: %d samples, mean %.4f ms, p50 %.4f ms, p99 %.4f ms (budget %.4f ms)"),
+            *Name, Samples.Milliseconds.Num(), Mean, P50, P99, BudgetMs));
+
+        if (P99 > BudgetMs)
+        {
+            Test.AddError(FString::Printf(TEXT("%s: p99 of %.4f ms exceeds the budget of %.4f ms."), *Name, P99, BudgetMs));
+            return false;
+        }
+
+        return true;
+    }
+
+    /** Erzeugt eine deterministische Canvas mit einem Kreis als Rune, weiß auf schwarz. */
+    static TArray<FColor> MakeCanvasPixels()
+    {
+        TArray<FColor> Pixels;
+        Pixels.Init(FColor::Black, CanvasSize * CanvasSize);
+
+        const float Center = CanvasSize * 0.5f;
+        const float Radius = CanvasSize * 0.3f;
+        for (int32 Y = 0; Y < CanvasSize; ++Y)
+        {
+            for (int32 X = 0; X < CanvasSize; ++X)
+            {
+                const float Distance = FMath::Sqrt(FMath::Square(X - Center) + FMath::Square(Y - Center));
+                if (FMath::Abs(Distance - Radius) < 2.0f)
+                {
+                    Pixels[Y * CanvasSize + X] = FColor::White;
+                }
+            }
+        }
+
+        return Pixels;
+    }
+
+    /**
+     * Spawnt den Inferenz-Actor aus dem Blueprint in einer eigenen Welt, damit Modell und
+     * Rune-Mappings der Spielkonfiguration entsprechen. Die Welt wird im Destruktor zerstört.
+     */
+    struct FInferenceActorScope
+    {
+        UWorld* World = nullptr;
+        AONNXInferenceActor* Actor = nullptr;
+
+        explicit FInferenceActorScope(FAutomationTestBase& Test)
+        {
+            UClass* ActorClass = LoadClass<AONNXInferenceActor>(nullptr, InferenceActorClassPath);
+            if (!ActorClass)
+            {
+                Test.AddError(FString::Printf(TEXT("Failed to load the inference actor class %s."), InferenceActorClassPath));
+                return;
+            }
+
+            World = UWorld::CreateWorld(EWorldType::Game, false);
+            Actor = World->SpawnActor<AONNXInferenceActor>(ActorClass);
+            if (!Actor)
+            {
+                Test.AddError(TEXT("Failed to spawn the inference actor."));
+            }
+        }
+
+        ~FInferenceActorScope()
+        {
+            if (World)
+            {
+                World->DestroyWorld(false);
+            }
+        }
+    };
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRunePipelineGrayscalePerfTest, "ItsSomeKindOfMagic.Perf.RunePipeline.CanvasToTensor",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRunePipelineGrayscalePerfTest::RunTest(const FString& Parameters)
+{
+    using namespace RunePipelinePerf;
+
+    const TArray<FColor> Pixels = MakeCanvasPixels();
+    TArray<float> Tensor;
+
+    for (int32 i = 0; i < WarmupIterations; ++i)
+    {
+        URuneFunctionLibrary::ConvertPixelsToGrayscale(Pixels, Tensor);
+    }
+
+    FTimingSamples Samples;
+    for (int32 i = 0; i < CVarIterations.GetValueOnGameThread(); ++i)
+    {
+        const double Start = FPlatformTime::Seconds();
+        URuneFunctionLibrary::ConvertPixelsToGrayscale(Pixels, Tensor);
+        Samples.AddSince(Start);
+    }
+
+    TestEqual(TEXT("Tensor size"), Tensor.Num(), CanvasSize * CanvasSize);
+    return ReportAndCheckBudget(*this, TEXT("CanvasToTensor"), Samples, CVarGrayscaleBudgetMs.GetValueOnGameThread());
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRunePipelineInferencePerfTest, "ItsSomeKindOfMagic.Perf.RunePipeline.SyncInference",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRunePipelineInferencePerfTest::RunTest(const FString& Parameters)
+{
+    using namespace RunePipelinePerf;
+
+    FInferenceActorScope Scope(*this);
+    if (!Scope.Actor)
+    {
+        return false;
+    }
+
+    if (!Scope.Actor->InitializeModel())
+    {
+        AddError(TEXT("Failed to create the model instance, is the NNERuntimeORTCpu plugin enabled?"));
+        return false;
+    }
+
+    TArray<float> Tensor;
+    URuneFunctionLibrary::ConvertPixelsToGrayscale(MakeCanvasPixels(), Tensor);
+
+    // Die ersten Aufrufe allokieren noch Puffer in der Runtime.
+    for (int32 i = 0; i < WarmupIterations; ++i)
+    {
+        Scope.Actor->RunInferenceBP(Tensor);
+    }
+
+    FTimingSamples Samples;
+    bool bAllSucceeded = true;
+    for (int32 i = 0; i < CVarIterations.GetValueOnGameThread(); ++i)
+    {
+        const double Start = FPlatformTime::Seconds();
+        const FPredictionResult Result = Scope.Actor->RunInferenceBP(Tensor);
+        Samples.AddSince(Start);
+
+        bAllSucceeded &= Result.bSuccess;
+    }
+
+    TestTrue(TEXT("All inferences succeeded"), bAllSucceeded);
+    return ReportAndCheckBudget(*this, TEXT("SyncInference"), Samples, CVarInferenceBudgetMs.GetValueOnGameThread());
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRunePipelineProcessOutputPerfTest, "ItsSomeKindOfMagic.Perf.RunePipeline.ProcessOutput",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRunePipelineProcessOutputPerfTest::RunTest(const FString& Parameters)
+{
+    using namespace RunePipelinePerf;
+
+    FInferenceActorScope Scope(*this);
+    if (!Scope.Actor)
+    {
+        return false;
+    }
+
+    // Eindeutiger Output für die erste gemappte Klasse, unabhängig vom Modell.
+    const int32 NumClasses = FMath::Max(Scope.Actor->RuneMappings.Num(), 2);
+    const int32 ExpectedIndex = Scope.Actor->RuneMappings.Num() > 0 ? Scope.Actor->RuneMappings[0].Index : 0;
+
+    TArray<float> Predictions;
+    Predictions.Init(0.0f, FMath::Max(NumClasses, ExpectedIndex + 1));
+    Predictions[ExpectedIndex] = FMath::Max(Scope.Actor->ConfidenceThreshold, 0.0f) + 0.1f;
+
+    UE::NNE::FTensorBindingCPU OutputTensor;
+    OutputTensor.Data = Predictions.GetData();
+    OutputTensor.SizeInBytes = Predictions.Num() * sizeof(float);
+    const TArray<UE::NNE::FTensorBindingCPU> Outputs = { OutputTensor };
+
+    FTimingSamples Samples;
+    FPredictionResult Result;
+    for (int32 i = 0; i < CVarIterations.GetValueOnGameThread(); ++i)
+    {
+        const double Start = FPlatformTime::Seconds();
+        Result = Scope.Actor->ProcessOutput(Outputs, Predictions.Num());
+        Samples.AddSince(Start);
+    }
+
+    TestEqual(TEXT("Predicted index"), Result.PredictedIndex, ExpectedIndex);
+    return ReportAndCheckBudget(*this, TEXT("ProcessOutput"), Samples, CVarProcessOutputBudgetMs.GetValueOnGameThread());
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRunePipelineDebugCountPerfTest, "ItsSomeKindOfMagic.Perf.RunePipeline.DebugRuneCount",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRunePipelineDebugCountPerfTest::RunTest(const FString& Parameters)
+{
+    using namespace RunePipelinePerf;
+
+    FPredictionResult Prediction;
+    Prediction.PredictedLabel = TEXT("fire");
+    Prediction.PredictedIndex = 0;
+    Prediction.Confidence = 0.5f;
+    Prediction.bSuccess = true;
+
+    UDebugRuneCount* RuneCount = UDebugRuneCount::CreateDebugRuneCountObject(GetTransientPackage(), Prediction);
+
+    // Einzelne Aufrufe liegen unter der Timer-Auflösung, daher wird pro Stichprobe ein Block gemessen.
+    FTimingSamples Samples;
+    const int32 NumSamples = CVarIterations.GetValueOnGameThread();
+    for (int32 i = 0; i < NumSamples; ++i)
+    {
+        const double Start = FPlatformTime::Seconds();
+        for (int32 Update = 0; Update < DebugCountUpdatesPerSample; ++Update)
+        {
+            RuneCount->IncrementCount(static_cast<float>(Update % 10) / 10.0f);
+        }
+        Samples.AddSince(Start);
+    }
+
+    TestEqual(TEXT("Rune counter"), RuneCount->RuneCounter, 1 + NumSamples * DebugCountUpdatesPerSample);
+    return ReportAndCheckBudget(*this, TEXT("DebugRuneCount"), Samples, CVarDebugCountBudgetMs.GetValueOnGameThread());
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRunePipelineStatsExportPerfTest, "ItsSomeKindOfMagic.Perf.RunePipeline.StatsExport",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRunePipelineStatsExportPerfTest::RunTest(const FString& Parameters)
+{
+    using namespace RunePipelinePerf;
+
+    const TArray<FString> RuneNames = { TEXT("fire"), TEXT("water"), TEXT("earth"), TEXT("air"), TEXT("Unknown") };
+
+    TArray<UDebugRuneCount*> RuneCounts;
+    TMap<FString, int32> SpellCounts;
+    for (int32 i = 0; i < RuneNames.Num(); ++i)
+    {
+        FPredictionResult Prediction;
+        Prediction.PredictedLabel = RuneNames[i];
+        Prediction.PredictedIndex = i;
+        Prediction.Confidence = 0.8f;
+        Prediction.bSuccess = true;
+
+        RuneCounts.Add(UDebugRuneCount::CreateDebugRuneCountObject(GetTransientPackage(), Prediction));
+        SpellCounts.Add(FString::Printf(TEXT("Spell_%d"), i), i * 3);
+    }
+
+    const FString StatsFilePath = FPaths::ProjectDir() / TEXT("DebugFiles") / StatsFileName;
+    ON_SCOPE_EXIT
+    {
+        IFileManager::Get().Delete(*StatsFilePath, false, false, true);
+    };
+
+    FTimingSamples Samples;
+    bool bAllSaved = true;
+    const int32 NumSamples = FMath::Min(CVarIterations.GetValueOnGameThread(), MaxStatsExportIterations);
+    for (int32 i = 0; i < NumSamples; ++i)
+    {
+        const double Start = FPlatformTime::Seconds();
+        bAllSaved &= URuneFunctionLibrary::SaveDebugStatsToText(RuneCounts, SpellCounts, StatsFileName);
+        Samples.AddSince(Start);
+    }
+
+    TestTrue(TEXT("All stats exports succeeded"), bAllSaved);
+    return ReportAndCheckBudget(*this, TEXT("StatsExport"), Samples, CVarStatsExportBudgetMs.GetValueOnGameThread());
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRunePipelineStrokeCodecPerfTest, "ItsSomeKindOfMagic.Perf.RunePipeline.StrokeCodec",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FRunePipelineStrokeCodecPerfTest::RunTest(const FString& Parameters)
+{
+    using namespace RunePipelinePerf;
+
+    TArray<FRuneStroke> Corpus;
+    const FString CorpusPath = CVarStrokeCorpus.GetValueOnGameThread();
+    if (!CorpusPath.IsEmpty() && !URuneSoakBenchmarkSubsystem::LoadStrokeCorpus(CorpusPath, Corpus))
+    {
+        AddWarning(FString::Printf(TEXT("Failed to read the stroke corpus %s, using the default shapes."), *CorpusPath));
+    }
+
+    if (Corpus.Num() == 0)
+    {
+        Corpus = URuneSoakBenchmarkSubsystem::MakeDefaultCorpus();
+    }
+
+    TArray<FRuneStrokeData> Strokes;
+    for (const FRuneStroke& Entry : Corpus)
+    {
+        FRuneStrokeData Stroke;
+        Stroke.Points = Entry.Points;
+        Stroke.TimesMs = Entry.TimesMs;
+        if (Stroke.IsValid())
+        {
+            Strokes.Add(MoveTemp(Stroke));
+        }
+    }
+
+    if (!TestTrue(TEXT("Corpus contains valid strokes"), Strokes.Num() > 0))
+    {
+        return false;
+    }
+
+    // Bytes pro Cast, verglichen mit dem rohen Tensor (4096 Floats).
+    TArray<TArray<uint8>> Encoded;
+    int64 TotalBytes = 0;
+    int32 MaxBytes = 0;
+    for (const FRuneStrokeData& Stroke : Strokes)
+    {
+        TArray<uint8>& Bytes = Encoded.AddDefaulted_GetRef();
+        RuneStrokeCodec::Encode(Stroke, Bytes);
+        TotalBytes += Bytes.Num();
+        MaxBytes = FMath::Max(MaxBytes, Bytes.Num());
+    }
+
+    const double MeanBytes = static_cast<double>(TotalBytes) / Strokes.Num();
+    const int32 TensorBytes = CanvasSize * CanvasSize * sizeof(float);
+    AddTelemetryData(TEXT("StrokeCodec.MeanBytesPerCast"), MeanBytes);
+    AddTelemetryData(TEXT("StrokeCodec.MaxBytesPerCast"), MaxBytes);
+    AddInfo(FString::Printf(TEXT("StrokeCodec: %d strokes, mean %.1f bytes, max %d bytes per cast (raw tensor: %d bytes)"),
+        Strokes.Num(), MeanBytes, MaxBytes, TensorBytes));
+
+    FTimingSamples EncodeSamples;
+    FTimingSamples DecodeSamples;
+    TArray<uint8> Bytes;
+    FRuneStrokeData Decoded;
+    bool bAllDecoded = true;
+    for (int32 i = 0; i < CVarIterations.GetValueOnGameThread(); ++i)
+    {
+        const int32 Index = i % Strokes.Num();
+
+        const double EncodeStart = FPlatformTime::Seconds();
+        RuneStrokeCodec::Encode(Strokes[Index], Bytes);
+        EncodeSamples.AddSince(EncodeStart);
+
+        const double DecodeStart = FPlatformTime::Seconds();
+        bAllDecoded &= RuneStrokeCodec::Decode(Encoded[Index], Decoded);
+        DecodeSamples.AddSince(DecodeStart);
+    }
+
+    TestTrue(TEXT("All strokes decoded"), bAllDecoded);
+    const bool bEncodeInBudget = ReportAndCheckBudget(*this, TEXT("StrokeEncode"), EncodeSamples, CVarStrokeEncodeBudgetMs.GetValueOnGameThread());
+    const bool bDecodeInBudget = ReportAndCheckBudget(*this, TEXT("StrokeDecode"), DecodeSamples, CVarStrokeDecodeBudgetMs.GetValueOnGameThread());
+    return bEncodeInBudget && bDecodeInBudget;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
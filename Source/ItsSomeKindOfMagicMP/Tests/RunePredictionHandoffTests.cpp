@@ -0,0 +1,87 @@
+﻿// Tests für die Übergabe vorhergesagter Rune-Effekte an den Spell des Servers. Die Netzwerk-
+// Verzögerung ist simuliert: die Zeit wird vorgegeben und der Spell des Servers erst nach der
+// Paketlaufzeit gespawnt, wie er mit NetEmulation.PktLag auf dem Client ankäme.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "RunePredictionHandoff.h"
+
+namespace RunePredictionHandoffTest
+{
+    /** Einfache Laufzeit vom Server zum Client */
+    static constexpr double SimulatedLagSeconds = 0.06;
+    static constexpr double LifeSpanSeconds = 2.0;
+    static constexpr double FrameSeconds = 1.0 / 60.0;
+
+    static AActor* SpawnSpell(UWorld& World, APawn* Instigator)
+    {
+        FActorSpawnParameters SpawnParams;
+        SpawnParams.Instigator = Instigator;
+        return World.SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRunePredictionHandoffTest, "ItsSomeKindOfMagic.Rune.Prediction.HandoffAfterLag",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FRunePredictionHandoffTest::RunTest(const FString& Parameters)
+{
+    using namespace RunePredictionHandoffTest;
+
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+    if (!World)
+    {
+        AddError(TEXT("Failed to create a world."));
+        return false;
+    }
+
+    APawn* Pawn = World->SpawnActor<APawn>();
+    APawn* OtherPawn = World->SpawnActor<APawn>();
+    AActor* ConfirmedEffect = World->SpawnActor<AActor>();
+    AActor* UnansweredEffect = World->SpawnActor<AActor>();
+
+    FRunePredictionHandoff Handoff;
+    TArray<AActor*> Released;
+
+    // Beide Casts sind bestätigt, nur für den ersten spawnt der Server einen replizierten Spell.
+    double Now = 0.0;
+    Handoff.Add(ConfirmedEffect, AActor::StaticClass(), Now + LifeSpanSeconds);
+    Handoff.Add(UnansweredEffect, APawn::StaticClass(), Now + LifeSpanSeconds);
+
+    // Ein Spell eines anderen Spielers darf keinen eigenen Effekt beenden.
+    Handoff.NotifyActorSpawned(SpawnSpell(*World, OtherPawn));
+    Handoff.Update(Pawn, Now, Released);
+    TestEqual(TEXT("A foreign spell releases nothing"), Released.Num(), 0);
+
+    // Bis der Spell ankommt, bleibt der vorhergesagte Effekt sichtbar.
+    while (Now + FrameSeconds < SimulatedLagSeconds)
+    {
+        Now += FrameSeconds;
+        Handoff.Update(Pawn, Now, Released);
+    }
+    TestEqual(TEXT("The predicted effect stays until the server spell arrives"), Released.Num(), 0);
+
+    Now = SimulatedLagSeconds;
+    Handoff.NotifyActorSpawned(SpawnSpell(*World, Pawn));
+    Handoff.Update(Pawn, Now, Released);
+    TestTrue(TEXT("The predicted effect is released when the server spell arrives"), Released.Num() == 1 && Released[0] == ConfirmedEffect);
+    TestFalse(TEXT("A cast without a replicated spell keeps waiting"), Handoff.IsEmpty());
+
+    // Ohne Spell endet der Effekt erst mit seiner Frist.
+    Released.Reset();
+    Handoff.Update(Pawn, LifeSpanSeconds - FrameSeconds, Released);
+    TestEqual(TEXT("The unanswered effect stays until its deadline"), Released.Num(), 0);
+
+    Handoff.Update(Pawn, LifeSpanSeconds, Released);
+    TestTrue(TEXT("The unanswered effect is released at its deadline"), Released.Num() == 1 && Released[0] == UnansweredEffect);
+    TestTrue(TEXT("Nothing is left waiting"), Handoff.IsEmpty());
+
+    World->DestroyWorld(false);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
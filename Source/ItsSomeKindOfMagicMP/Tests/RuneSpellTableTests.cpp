@@ -0,0 +1,71 @@
+﻿// Tests für die Spell-Tabelle der Runen: dichte Lookups nach dem Kompilieren und Ablehnung von
+// Tabellen, die nicht zur Anzahl der Output-Klassen des Modells passen.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "GameFramework/Character.h"
+#include "GameFramework/Pawn.h"
+#include "RuneSpellTable.h"
+
+namespace RuneSpellTableTests
+{
+    static URuneSpellTable* MakeTable()
+    {
+        URuneSpellTable* Table = NewObject<URuneSpellTable>();
+
+        auto AddEntry = [Table](int32 Index, const TCHAR* RuneName, TSubclassOf<AActor> SpellClass)
+        {
+            FRuneSpellEntry& Entry = Table->Entries.AddDefaulted_GetRef();
+            Entry.Index = Index;
+            Entry.RuneName = RuneName;
+            Entry.SpellClass = SpellClass;
+        };
+
+        // Absichtlich nicht nach Index sortiert, Index 2 bleibt frei.
+        AddEntry(3, TEXT("Water"), APawn::StaticClass());
+        AddEntry(0, TEXT("Fire"), ACharacter::StaticClass());
+        AddEntry(1, TEXT("Unknown"), nullptr);
+        return Table;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRuneSpellTableTest, "ItsSomeKindOfMagic.Rune.SpellTable.Compile",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FRuneSpellTableTest::RunTest(const FString& Parameters)
+{
+    using namespace RuneSpellTableTests;
+
+    URuneSpellTable* Table = MakeTable();
+
+    AddExpectedError(TEXT("has no entry"), EAutomationExpectedErrorFlags::Contains, 1);
+    if (!TestTrue(TEXT("Table matching the model compiles"), Table->Compile(4)))
+    {
+        return false;
+    }
+
+    TestEqual(TEXT("Number of classes"), Table->GetNumClasses(), 4);
+    TestTrue(TEXT("Rune name by index"), Table->GetRuneName(3) == FName(TEXT("Water")));
+    TestTrue(TEXT("Spell class by index"), Table->GetSpellClass(0) == ACharacter::StaticClass());
+    TestTrue(TEXT("Unknown has no spell"), Table->GetSpellClass(1) == nullptr);
+    TestEqual(TEXT("Unknown index"), Table->GetUnknownIndex(), 1);
+    TestTrue(TEXT("Class without entry has no name"), Table->GetRuneName(2).IsNone());
+    TestTrue(TEXT("Out of range index has no spell"), Table->GetSpellClass(INDEX_NONE) == nullptr && Table->GetSpellClass(4) == nullptr);
+
+    // Das Modell hat weniger Klassen, als die Tabelle erwartet.
+    AddExpectedError(TEXT("but the model only has 3 output classes"), EAutomationExpectedErrorFlags::Contains, 1);
+    TestFalse(TEXT("Table with an index beyond the model is rejected"), Table->Compile(3));
+    TestFalse(TEXT("Rejected table is not compiled"), Table->IsCompiled());
+    TestTrue(TEXT("Rejected table dispatches nothing"), Table->GetSpellClass(0) == nullptr);
+
+    URuneSpellTable* Duplicate = MakeTable();
+    Duplicate->Entries[0].Index = 0;
+    AddExpectedError(TEXT("is used by both"), EAutomationExpectedErrorFlags::Contains, 1);
+    TestFalse(TEXT("Table with a duplicate index is rejected"), Duplicate->Compile(4));
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
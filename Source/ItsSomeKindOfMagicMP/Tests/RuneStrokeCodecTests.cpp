@@ -0,0 +1,134 @@
+﻿// Tests für die kompakte Strich-Kodierung: Round-Trip, identische Rasterisierung auf beiden
+// Seiten und robuste Ablehnung beschädigter Pakete.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Math/RandomStream.h"
+#include "RuneFunctionLibrary.h"
+#include "RuneSoakBenchmarkSubsystem.h"
+#include "RuneStrokeCodec.h"
+
+namespace RuneStrokeCodecTests
+{
+    static constexpr int32 CanvasSize = 64;
+    static constexpr int32 NumRandomStrokes = 200;
+
+    /** Korpus aus den eingebauten Formen und zufälligen Strichen mit Zeitstempeln. */
+    static TArray<FRuneStrokeData> MakeStrokes()
+    {
+        TArray<FRuneStrokeData> Strokes;
+        for (const FRuneStroke& Entry : URuneSoakBenchmarkSubsystem::MakeDefaultCorpus())
+        {
+            FRuneStrokeData& Stroke = Strokes.AddDefaulted_GetRef();
+            Stroke.Points = Entry.Points;
+        }
+
+        FRandomStream Random(42);
+        for (int32 i = 0; i < NumRandomStrokes; ++i)
+        {
+            FRuneStrokeData& Stroke = Strokes.AddDefaulted_GetRef();
+            const int32 NumPoints = Random.RandRange(8, FRuneStrokeData::MaxPoints);
+
+            FVector2f Point(Random.FRand(), Random.FRand());
+            int32 Time = 0;
+            for (int32 j = 0; j < NumPoints; ++j)
+            {
+                // Meist kleine Schritte wie beim Zeichnen, gelegentlich ein großer Sprung.
+                const float Step = Random.FRand() < 0.05f ? 1.0f : 0.02f;
+                Point.X = FMath::Clamp(Point.X + Random.FRandRange(-Step, Step), 0.0f, 1.0f);
+                Point.Y = FMath::Clamp(Point.Y + Random.FRandRange(-Step, Step), 0.0f, 1.0f);
+                Time += Random.RandRange(0, 40);
+
+                Stroke.Points.Add(Point);
+                Stroke.TimesMs.Add(Time);
+            }
+        }
+
+        return Strokes;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRuneStrokeCodecRoundTripTest, "ItsSomeKindOfMagic.Rune.StrokeCodec.RoundTrip",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FRuneStrokeCodecRoundTripTest::RunTest(const FString& Parameters)
+{
+    using namespace RuneStrokeCodecTests;
+
+    for (const FRuneStrokeData& Stroke : MakeStrokes())
+    {
+        TArray<uint8> Bytes;
+        RuneStrokeCodec::Encode(Stroke, Bytes);
+
+        FRuneStrokeData Decoded;
+        if (!TestTrue(TEXT("Stroke decodes"), RuneStrokeCodec::Decode(Bytes, Decoded)))
+        {
+            return false;
+        }
+
+        // Der Empfänger muss exakt dieselbe Canvas erzeugen wie der Sender.
+        TArray<FColor> SentPixels;
+        TArray<FColor> ReceivedPixels;
+        URuneFunctionLibrary::RasterizeStroke(Stroke.Points, CanvasSize, SentPixels);
+        URuneFunctionLibrary::RasterizeStroke(Decoded.Points, CanvasSize, ReceivedPixels);
+        if (!TestTrue(TEXT("Decoded stroke rasterizes identically"), SentPixels == ReceivedPixels))
+        {
+            return false;
+        }
+
+        TestTrue(TEXT("Decoded stroke is valid"), Decoded.IsValid());
+        TestEqual(TEXT("Timing survives the round trip"), Decoded.TimesMs.Num() > 0, Stroke.TimesMs.Num() > 0);
+        if (Decoded.TimesMs.Num() > 0)
+        {
+            TestEqual(TEXT("Stroke duration"), Decoded.TimesMs.Last(), Stroke.TimesMs.Last() - Stroke.TimesMs[0]);
+        }
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRuneStrokeCodecCorruptionTest, "ItsSomeKindOfMagic.Rune.StrokeCodec.RejectsCorruptData",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FRuneStrokeCodecCorruptionTest::RunTest(const FString& Parameters)
+{
+    using namespace RuneStrokeCodecTests;
+
+    const TArray<FRuneStrokeData> Strokes = MakeStrokes();
+    const FRuneStrokeData& Stroke = Strokes.Last();
+
+    TArray<uint8> Bytes;
+    RuneStrokeCodec::Encode(Stroke, Bytes);
+
+    FRuneStrokeData Decoded;
+    TestFalse(TEXT("Empty data is rejected"), RuneStrokeCodec::Decode(TArrayView<const uint8>(), Decoded));
+    TestFalse(TEXT("Truncated data is rejected"), RuneStrokeCodec::Decode(TArrayView<const uint8>(Bytes.GetData(), Bytes.Num() / 2), Decoded));
+
+    TArray<uint8> TooLarge;
+    TooLarge.Init(0xFF, RuneStrokeCodec::MaxEncodedBytes + 1);
+    TestFalse(TEXT("Oversized data is rejected"), RuneStrokeCodec::Decode(TooLarge, Decoded));
+
+    // Zufällige Daten dürfen nie zu einem ungültigen Strich führen.
+    FRandomStream Random(7);
+    for (int32 i = 0; i < 1000; ++i)
+    {
+        TArray<uint8> Garbage;
+        Garbage.SetNumUninitialized(Random.RandRange(1, 256));
+        for (uint8& Byte : Garbage)
+        {
+            Byte = static_cast<uint8>(Random.RandHelper(256));
+        }
+
+        if (RuneStrokeCodec::Decode(Garbage, Decoded) && !Decoded.IsValid())
+        {
+            AddError(TEXT("Random data decoded into an invalid stroke."));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,199 @@
+﻿// Performance-Test für den Spatial Hash der Flächenzauber im Vergleich zur bisherigen
+// Physik-Abfrage (OverlapMultiByObjectType) bei 50, 200 und 1000 Zielen.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Components/SphereComponent.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "RunePerfStatistics.h"
+#include "SpatialHashSubsystem.h"
+
+namespace SpatialHashPerf
+{
+    static TAutoConsoleVariable<int32> CVarIterations(
+        TEXT("rune.PerfTest.SpatialHashIterations"), 100,
+        TEXT("Anzahl der Messungen pro Zielanzahl im Spatial-Hash-Test."));
+
+    static TAutoConsoleVariable<float> CVarQueryBudgetMs(
+        TEXT("rune.PerfTest.SpatialHashBudgetMs"), 0.5f,
+        TEXT("p99-Budget in ms für alle Abfragen eines Frames über den Spatial Hash bei 1000 Zielen."));
+
+    static const int32 TargetCounts[] = { 50, 200, 1000 };
+
+    /** So viele Flächenzauber fragen pro Frame ihre Umgebung ab. */
+    static constexpr int32 QueriesPerFrame = 64;
+    static constexpr float QueryRadius = 600.0f;
+    static constexpr float TargetRadius = 40.0f;
+    static constexpr float ArenaHalfSize = 5000.0f;
+
+    /** Ziele, die die Kugel gerade berühren, darf nur einer der beiden Wege finden. In cm. */
+    static constexpr float ContactTolerance = 1.0f;
+
+    static AActor* SpawnTarget(UWorld& World, const FVector& Location)
+    {
+        AActor* Actor = World.SpawnActor<AActor>(AActor::StaticClass(), FTransform(Location));
+        USphereComponent* Sphere = NewObject<USphereComponent>(Actor, TEXT("Collision"));
+        Sphere->SetSphereRadius(TargetRadius);
+        Sphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+        Sphere->SetCollisionObjectType(ECC_Pawn);
+        Sphere->SetCollisionResponseToAllChannels(ECR_Overlap);
+        Actor->SetRootComponent(Sphere);
+        Sphere->RegisterComponent();
+        Sphere->SetWorldLocation(Location);
+        return Actor;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSpatialHashPerfTest, "ItsSomeKindOfMagic.Perf.Spells.SpatialHashVsOverlap",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSpatialHashPerfTest::RunTest(const FString& Parameters)
+{
+    using namespace SpatialHashPerf;
+
+    bool bWithinBudget = true;
+    for (const int32 NumTargets : TargetCounts)
+    {
+        UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+        USpatialHashSubsystem* Hash = World ? World->GetSubsystem<USpatialHashSubsystem>() : nullptr;
+        if (!Hash)
+        {
+            AddError(TEXT("Failed to create a world with the spatial hash subsystem."));
+            if (World)
+            {
+                World->DestroyWorld(false);
+            }
+            return false;
+        }
+
+        FRandomStream Random(NumTargets);
+        auto RandomLocation = [&Random]()
+        {
+            return FVector(Random.FRandRange(-ArenaHalfSize, ArenaHalfSize), Random.FRandRange(-ArenaHalfSize, ArenaHalfSize), 100.0);
+        };
+
+        for (int32 i = 0; i < NumTargets; ++i)
+        {
+            Hash->RegisterActor(SpawnTarget(*World, RandomLocation()));
+        }
+
+        TArray<FSpatialQuery> Queries;
+        for (int32 i = 0; i < QueriesPerFrame; ++i)
+        {
+            FSpatialQuery& Query = Queries.AddDefaulted_GetRef();
+            Query.Origin = RandomLocation();
+            Query.Radius = QueryRadius;
+        }
+
+        // Neue Körper landen erst mit einem Tick in der Beschleunigungsstruktur der Physik-Szene.
+        World->Tick(LEVELTICK_All, 1.0f / 60.0f);
+        World->Tick(LEVELTICK_All, 1.0f / 60.0f);
+
+        const FCollisionObjectQueryParams ObjectParams(ECC_Pawn);
+        const FCollisionShape QueryShape = FCollisionShape::MakeSphere(QueryRadius);
+
+        TArray<double> OverlapMs;
+        TArray<double> HashMs;
+        TArray<double> BatchMs;
+        TArray<FOverlapResult> Overlaps;
+        TArray<AActor*> HashActors;
+        TArray<FSpatialQueryResult> BatchResults;
+        int32 Mismatches = 0;
+        int32 ContactMismatches = 0;
+
+        for (int32 Iteration = 0; Iteration < CVarIterations.GetValueOnGameThread(); ++Iteration)
+        {
+            double Start = FPlatformTime::Seconds();
+            for (const FSpatialQuery& Query : Queries)
+            {
+                World->OverlapMultiByObjectType(Overlaps, Query.Origin, FQuat::Identity, ObjectParams, QueryShape);
+            }
+            OverlapMs.Add((FPlatformTime::Seconds() - Start) * 1000.0);
+
+            Start = FPlatformTime::Seconds();
+            for (const FSpatialQuery& Query : Queries)
+            {
+                Hash->QuerySphere(Query.Origin, Query.Radius, HashActors);
+            }
+            HashMs.Add((FPlatformTime::Seconds() - Start) * 1000.0);
+
+            Start = FPlatformTime::Seconds();
+            Hash->QueryBatch(Queries, BatchResults);
+            BatchMs.Add((FPlatformTime::Seconds() - Start) * 1000.0);
+        }
+
+        // Beide Wege müssen dieselben Ziele finden. Abweichen dürfen nur Ziele, die die Kugel
+        // gerade berühren, dort rundet die Kollision anders als der Abstandsvergleich.
+        TSet<AActor*> OverlapActors;
+        TSet<AActor*> BatchActors;
+        for (int32 i = 0; i < Queries.Num(); ++i)
+        {
+            World->OverlapMultiByObjectType(Overlaps, Queries[i].Origin, FQuat::Identity, ObjectParams, QueryShape);
+
+            OverlapActors.Reset();
+            for (const FOverlapResult& Overlap : Overlaps)
+            {
+                OverlapActors.Add(Overlap.GetActor());
+            }
+            BatchActors.Reset();
+            BatchActors.Append(BatchResults[i].Actors);
+
+            for (AActor* Actor : OverlapActors.Difference(BatchActors).Union(BatchActors.Difference(OverlapActors)))
+            {
+                const double Distance = Actor ? FVector::Dist(Actor->GetActorLocation(), Queries[i].Origin) : 0.0;
+                if (Actor && FMath::Abs(Distance - (QueryRadius + TargetRadius)) <= ContactTolerance)
+                {
+                    ++ContactMismatches;
+                }
+                else
+                {
+                    AddError(FString::Printf(TEXT("%d targets, query %d: %s at %.1f cm is only found by %s."), NumTargets, i,
+                        *GetNameSafe(Actor), Distance, OverlapActors.Contains(Actor) ? TEXT("the overlap query") : TEXT("the spatial hash")));
+                    ++Mismatches;
+                }
+            }
+        }
+        TestTrue(FString::Printf(TEXT("%d targets: spatial hash finds the same actors as the overlap query"), NumTargets), Mismatches == 0);
+        if (ContactMismatches > 0)
+        {
+            AddInfo(FString::Printf(TEXT("%d targets: %d targets touching a query sphere were found by only one method."), NumTargets, ContactMismatches));
+        }
+
+        auto Report = [this, NumTargets](const TCHAR* Method, TArray<double>& Samples)
+        {
+            Samples.Sort();
+            const FString Name = FString::Printf(TEXT("SpatialHash.%s.N%d"), Method, NumTargets);
+            AddTelemetryData(Name + TEXT(".P50Ms"), RunePerf::Percentile(Samples, 50.0));
+            AddTelemetryData(Name + TEXT(".P99Ms"), RunePerf::Percentile(Samples, 99.0));
+            AddInfo(FString::Printf(TEXT("%s: %d queries per frame, p50 %.4f ms, p99 %.4f ms"),
+                *Name, QueriesPerFrame, RunePerf::Percentile(Samples, 50.0), RunePerf::Percentile(Samples, 99.0)));
+        };
+        Report(TEXT("Overlap"), OverlapMs);
+        Report(TEXT("Query"), HashMs);
+        Report(TEXT("QueryBatch"), BatchMs);
+
+        if (NumTargets == TargetCounts[UE_ARRAY_COUNT(TargetCounts) - 1])
+        {
+            // Report hat HashMs schon sortiert.
+            const double P99 = RunePerf::Percentile(HashMs, 99.0);
+            const float BudgetMs = CVarQueryBudgetMs.GetValueOnGameThread();
+            if (P99 > BudgetMs)
+            {
+                AddError(FString::Printf(TEXT("SpatialHash: p99 of %.4f ms with %d targets exceeds the budget of %.4f ms."), P99, NumTargets, BudgetMs));
+                bWithinBudget = false;
+            }
+        }
+
+        World->DestroyWorld(false);
+    }
+
+    return bWithinBudget;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
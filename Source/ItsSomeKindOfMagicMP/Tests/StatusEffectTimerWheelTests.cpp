@@ -0,0 +1,86 @@
+﻿// Tests für das Timer-Rad der Statuseffekte: jeder Timer löst genau einmal im richtigen Schritt
+// aus, auch über die Grenzen der Ebenen hinweg.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Math/RandomStream.h"
+#include "StatusEffectTimerWheel.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStatusEffectTimerWheelTest, "ItsSomeKindOfMagic.Effects.TimerWheel.FiresOnTime",
+    EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FStatusEffectTimerWheelTest::RunTest(const FString& Parameters)
+{
+    // Ein Schritt pro Sekunde, so bleiben alle Zeiten ganzzahlig.
+    FStatusEffectTimerWheel Wheel(1.0);
+    FRandomStream Random(11);
+
+    TArray<uint64> DueSteps;
+    TArray<bool> Fired;
+    TArray<uint64> FiredPayloads;
+    uint64 CurrentStep = 0;
+
+    auto ScheduleRandom = [&]()
+    {
+        // Meist kurze Effekte, dazu Laufzeiten bis in die dritte Ebene.
+        const int32 Delay = Random.FRand() < 0.8f ? Random.RandRange(0, 200) : Random.RandRange(200, 300000);
+        const uint64 Payload = DueSteps.Num();
+        DueSteps.Add(CurrentStep + FMath::Max(Delay, 1));
+        Fired.Add(false);
+        Wheel.Schedule(Payload, Delay);
+    };
+
+    for (int32 i = 0; i < 2000; ++i)
+    {
+        ScheduleRandom();
+    }
+
+    while (Wheel.Num() > 0)
+    {
+        const int32 Steps = Random.RandRange(1, 500);
+        FiredPayloads.Reset();
+        Wheel.Advance(Steps, FiredPayloads);
+
+        const uint64 PreviousStep = CurrentStep;
+        CurrentStep += Steps;
+
+        uint64 LastDue = 0;
+        for (const uint64 Payload : FiredPayloads)
+        {
+            if (!TestTrue(TEXT("Payload is known"), DueSteps.IsValidIndex(Payload)) || !TestFalse(TEXT("Timer fires only once"), Fired[Payload]))
+            {
+                return false;
+            }
+            Fired[Payload] = true;
+
+            const uint64 Due = DueSteps[Payload];
+            if (Due <= PreviousStep || Due > CurrentStep)
+            {
+                AddError(FString::Printf(TEXT("Timer due at step %llu fired between steps %llu and %llu."), Due, PreviousStep, CurrentStep));
+                return false;
+            }
+            TestTrue(TEXT("Timers fire in due order"), Due >= LastDue);
+            LastDue = Due;
+        }
+
+        // Während des Laufs neue Timer einplanen, wie es periodische Effekte tun.
+        if (DueSteps.Num() < 4000)
+        {
+            ScheduleRandom();
+        }
+    }
+
+    TestFalse(TEXT("Every timer fired"), Fired.Contains(false));
+
+    // Zu lange Verzögerungen werden gekürzt statt verloren zu gehen.
+    Wheel.Schedule(0, Wheel.GetMaxDelaySeconds() * 4.0);
+    TestEqual(TEXT("Clamped timer is pending"), Wheel.Num(), 1);
+    Wheel.Reset();
+    TestEqual(TEXT("Reset drops all timers"), Wheel.Num(), 0);
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS